@@ -37,6 +37,9 @@ namespace carla {
   /// buffer is retrieved from a BufferPool, the memory is automatically pushed
   /// back to the pool on destruction.
   ///
+  /// A buffer made with MakeView does not own its memory, it only keeps a
+  /// reference to the owner of that memory until it is destroyed.
+  ///
   /// @warning Creating a buffer bigger than max_size() is undefined.
   class Buffer {
 
@@ -55,6 +58,20 @@ namespace carla {
 
     using const_iterator = const value_type *;
 
+    /// Deletes the memory allocated by the buffer. The memory of a view is
+    /// not deleted, the deleter just holds a reference to its owner.
+    struct deleter_type {
+      std::shared_ptr<const void> owner;
+
+      void operator()(value_type *data) const noexcept {
+        if (owner == nullptr) {
+          delete[] data;
+        }
+      }
+    };
+
+    using storage_type = std::unique_ptr<value_type[], deleter_type>;
+
     /// @}
     // =========================================================================
     /// @name Construction and destruction
@@ -70,7 +87,7 @@ namespace carla {
     explicit Buffer(size_type size)
       : _size(size),
         _capacity(size),
-        _data(std::make_unique<value_type[]>(size)) {}
+        _data(new value_type[size]()) {}
 
     /// @copydoc Buffer(size_type)
     explicit Buffer(uint64_t size)
@@ -100,6 +117,19 @@ namespace carla {
           return static_cast<size_type>(size);
         } ()) {}
 
+    /// Create a buffer that views @a size bytes at @a data without copying
+    /// them. The memory must stay valid as long as @a owner is alive. The
+    /// buffer keeps @a owner alive until it is destroyed, or until it needs
+    /// more capacity and allocates its own memory.
+    static Buffer MakeView(value_type *data, size_type size, std::shared_ptr<const void> owner) {
+      DEBUG_ASSERT(owner != nullptr);
+      Buffer view;
+      view._size = size;
+      view._capacity = size;
+      view._data = storage_type(data, deleter_type{std::move(owner)});
+      return view;
+    }
+
     Buffer(const Buffer &) = delete;
 
     Buffer(Buffer &&rhs) noexcept
@@ -251,7 +281,7 @@ namespace carla {
     void reset(size_type size) {
       if (_capacity < size) {
         log_debug("allocating buffer of", size, "bytes");
-        _data = std::make_unique<value_type[]>(size);
+        _data = storage_type(new value_type[size]());
         _capacity = size;
       }
       _size = size;
@@ -269,7 +299,7 @@ namespace carla {
     /// allocated if the capacity is not enough and the data is copied.
     void resize(uint64_t size) {
       if(_capacity < size) {
-        std::unique_ptr<value_type[]> data = std::move(_data);
+        storage_type data = std::move(_data);
         uint64_t old_size = size;
         reset(size);
         copy_from(data.get(), static_cast<size_type>(old_size));
@@ -279,7 +309,7 @@ namespace carla {
 
     /// Release the contents of this buffer and set its size and capacity to
     /// zero.
-    std::unique_ptr<value_type[]> pop() noexcept {
+    storage_type pop() noexcept {
       _size = 0u;
       _capacity = 0u;
       return std::move(_data);
@@ -367,7 +397,7 @@ namespace carla {
 
     size_type _capacity = 0u;
 
-    std::unique_ptr<value_type[]> _data = nullptr;
+    storage_type _data = nullptr;
   };
 
 } // namespace carla
@@ -0,0 +1,199 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/BufferPool.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef _WIN32
+#  include <malloc.h>
+#elif defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+namespace carla {
+
+  constexpr size_t BufferPool::MIN_CLASS_SIZE;
+  constexpr size_t BufferPool::CLASS_COUNT;
+
+  static_assert(
+      BufferPool::GetClassSize(BufferPool::CLASS_COUNT - 1u) <= Buffer::max_size(),
+      "The biggest size class must fit in a buffer.");
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2u << 20u;
+
+  static void *AllocateAligned(const size_t size) {
+#ifdef _WIN32
+    return _aligned_malloc(size, HUGE_PAGE_SIZE);
+#else
+    void *data = nullptr;
+    if (::posix_memalign(&data, HUGE_PAGE_SIZE, size) != 0) {
+      return nullptr;
+    }
+#  if defined(__linux__) && defined(MADV_HUGEPAGE)
+    ::madvise(data, size, MADV_HUGEPAGE); // only a hint, failing is fine.
+#  endif
+    return data;
+#endif // _WIN32
+  }
+
+  static void DeleteAligned(void *data) {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif // _WIN32
+  }
+
+  BufferPool::BufferPool(const Settings &settings)
+    : _settings(settings) {}
+
+  size_t BufferPool::GetClassAtMost(const size_t capacity) {
+    if (capacity < MIN_CLASS_SIZE) {
+      return CLASS_COUNT;
+    }
+    size_t index = 0u;
+    while ((index + 2u < CLASS_COUNT) && (GetClassSize(index + 2u) <= capacity)) {
+      index += 2u;
+    }
+    if ((index + 1u < CLASS_COUNT) && (GetClassSize(index + 1u) <= capacity)) {
+      ++index;
+    }
+    return index;
+  }
+
+  size_t BufferPool::GetClassAtLeast(const size_t size) {
+    const size_t index = GetClassAtMost(size);
+    if (index == CLASS_COUNT) {
+      return 0u;
+    }
+    return GetClassSize(index) < size ? index + 1u : index;
+  }
+
+  Buffer BufferPool::Pop(const size_t size) {
+    if (size > Buffer::max_size()) {
+      throw_exception(std::invalid_argument("message size too big"));
+    }
+    Buffer item;
+    const size_t index = GetClassAtLeast(size);
+    // Buffers allocated by other means, with a capacity in between classes,
+    // return to the class below them, so that one is worth a look too.
+    const size_t below = GetClassAtMost(size);
+    if (TryPop(index, size, item) || ((below != index) && TryPop(below, size, item))) {
+      ++_hits;
+    } else {
+      ++_misses;
+      item = Allocate(index < CLASS_COUNT ? GetClassSize(index) : size);
+    }
+#if __cplusplus >= 201703L // C++17
+    item._parent_pool = weak_from_this();
+#else
+    item._parent_pool = shared_from_this();
+#endif
+    return item;
+  }
+
+  bool BufferPool::TryPop(const size_t index, const size_t size, Buffer &buffer) {
+    if (index >= CLASS_COUNT) {
+      return false;
+    }
+    SizeClass &size_class = _classes[index];
+    if (!size_class.queue.try_dequeue(buffer)) {
+      return false;
+    }
+    --size_class.count;
+    _bytes_retained -= buffer.capacity();
+    if (buffer.capacity() < size) {
+      Retain(std::move(buffer));
+      buffer = Buffer();
+      return false;
+    }
+    return true;
+  }
+
+  Buffer BufferPool::Allocate(const size_t capacity) const {
+    Buffer buffer;
+    if (capacity == 0u) {
+      return buffer;
+    }
+    log_debug("buffer pool: allocating buffer of", capacity, "bytes");
+    if ((_settings.huge_page_threshold > 0u) && (capacity >= _settings.huge_page_threshold)) {
+      void *data = AllocateAligned(capacity);
+      if (data != nullptr) {
+        std::shared_ptr<const void> owner(data, DeleteAligned);
+        buffer._data = Buffer::storage_type(
+            static_cast<Buffer::value_type *>(data),
+            Buffer::deleter_type{std::move(owner)});
+      }
+    }
+    if (buffer._data == nullptr) {
+      buffer._data = Buffer::storage_type(new Buffer::value_type[capacity]);
+    }
+    buffer._capacity = static_cast<Buffer::size_type>(capacity);
+    return buffer;
+  }
+
+  void BufferPool::Push(Buffer &&buffer) {
+    _last_size.store(buffer.size(), std::memory_order_relaxed);
+    Retain(std::move(buffer));
+  }
+
+  void BufferPool::Retain(Buffer &&buffer) {
+    const size_t capacity = buffer.capacity();
+    const size_t index = GetClassAtMost(capacity);
+    if (index == CLASS_COUNT) {
+      ++_discarded;
+      return;
+    }
+    // Leaving the buffer where it is deletes it.
+    SizeClass &size_class = _classes[index];
+    if (size_class.count++ >= _settings.max_buffers_per_class) {
+      --size_class.count;
+      ++_discarded;
+      return;
+    }
+    if (_bytes_retained.fetch_add(capacity) + capacity > _settings.max_retained_bytes) {
+      _bytes_retained -= capacity;
+      --size_class.count;
+      ++_discarded;
+      return;
+    }
+    size_class.queue.enqueue(std::move(buffer));
+  }
+
+  size_t BufferPool::Trim(const size_t max_bytes) {
+    size_t released = 0u;
+    for (size_t index = CLASS_COUNT; index > 0u; --index) {
+      SizeClass &size_class = _classes[index - 1u];
+      Buffer buffer;
+      while ((_bytes_retained.load() > max_bytes) && size_class.queue.try_dequeue(buffer)) {
+        --size_class.count;
+        _bytes_retained -= buffer.capacity();
+        released += buffer.capacity();
+        // Cleared buffers do not come back to the pool.
+        buffer.clear();
+      }
+    }
+    return released;
+  }
+
+  BufferPool::Stats BufferPool::GetStats() const {
+    Stats stats;
+    stats.hits = _hits.load(std::memory_order_relaxed);
+    stats.misses = _misses.load(std::memory_order_relaxed);
+    stats.discarded = _discarded.load(std::memory_order_relaxed);
+    for (auto &size_class : _classes) {
+      stats.buffers_retained += size_class.count.load(std::memory_order_relaxed);
+    }
+    stats.bytes_retained = _bytes_retained.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+} // namespace carla
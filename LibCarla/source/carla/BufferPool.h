@@ -17,6 +17,9 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <memory>
 
 namespace carla {
@@ -24,37 +27,119 @@ namespace carla {
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
+  /// Buffers are kept in size classes, two per power of two from 4 KiB up to
+  /// 2 GiB, so a Pop for a given size only reuses buffers big enough to hold
+  /// it. The number of buffers kept per class and the bytes kept by the whole
+  /// pool are capped, buffers returning to a full pool are deleted.
+  ///
   /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
+  /// unless explicitly cleared.
   class BufferPool : public std::enable_shared_from_this<BufferPool> {
   public:
 
-    BufferPool() = default;
+    struct Settings {
+      /// Maximum number of buffers kept in each size class.
+      size_t max_buffers_per_class = 8u;
+
+      /// Maximum number of bytes kept by the pool, all classes included.
+      size_t max_retained_bytes = 256u << 20u;
+
+      /// Buffers of this capacity or more are allocated aligned to huge
+      /// pages, and transparent huge pages requested for them where
+      /// supported. Zero disables it.
+      size_t huge_page_threshold = 2u << 20u;
+    };
+
+    struct Stats {
+      /// Pops served with a buffer of the pool.
+      size_t hits = 0u;
+
+      /// Pops that had to allocate a new buffer.
+      size_t misses = 0u;
+
+      /// Buffers deleted on return because the pool was full.
+      size_t discarded = 0u;
+
+      size_t buffers_retained = 0u;
+
+      size_t bytes_retained = 0u;
+    };
+
+    static constexpr size_t MIN_CLASS_SIZE = 4u << 10u;
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    static constexpr size_t CLASS_COUNT = 39u;
 
-    /// Pop a Buffer from the queue, creates a new one if the queue is empty.
+    /// Capacity of the buffers allocated for size class @a index.
+    static constexpr size_t GetClassSize(size_t index) {
+      return (MIN_CLASS_SIZE << (index / 2u)) + ((index % 2u) * (MIN_CLASS_SIZE << (index / 2u)) / 2u);
+    }
+
+    BufferPool() : BufferPool(Settings{}) {}
+
+    explicit BufferPool(const Settings &settings);
+
+    /// Pop a Buffer able to hold @a size bytes without allocating, creates a
+    /// new one if the pool has none. The size and contents of the buffer
+    /// are whatever its previous user left.
+    Buffer Pop(size_t size);
+
+    /// Pop a Buffer able to hold as much as the last buffer that returned to
+    /// the pool.
     Buffer Pop() {
-      Buffer item;
-      _queue.try_dequeue(item); // we don't care if it fails.
-#if __cplusplus >= 201703L // C++17
-      item._parent_pool = weak_from_this();
-#else
-      item._parent_pool = shared_from_this();
-#endif
-      return item;
+      return Pop(_last_size.load(std::memory_order_relaxed));
+    }
+
+    /// Delete buffers of the pool, biggest first, until at most @a max_bytes
+    /// are kept. Returns the number of bytes released.
+    size_t Trim(size_t max_bytes = 0u);
+
+    Stats GetStats() const;
+
+    const Settings &GetSettings() const {
+      return _settings;
     }
 
   private:
 
     friend class Buffer;
 
-    void Push(Buffer &&buffer) {
-      _queue.enqueue(std::move(buffer));
-    }
+    struct SizeClass {
+      SizeClass() : queue(0u) {}
+
+      moodycamel::ConcurrentQueue<Buffer> queue;
+
+      std::atomic_size_t count{0u};
+    };
+
+    /// Index of the smallest class holding @a size bytes, CLASS_COUNT if none.
+    static size_t GetClassAtLeast(size_t size);
+
+    /// Index of the biggest class fitting in @a capacity, CLASS_COUNT if none.
+    static size_t GetClassAtMost(size_t capacity);
+
+    bool TryPop(size_t index, size_t size, Buffer &buffer);
+
+    Buffer Allocate(size_t capacity) const;
+
+    void Push(Buffer &&buffer);
+
+    /// Keeps @a buffer in its class, or leaves it to be deleted if the pool
+    /// is full.
+    void Retain(Buffer &&buffer);
+
+    const Settings _settings;
+
+    std::array<SizeClass, CLASS_COUNT> _classes;
+
+    std::atomic_size_t _last_size{0u};
+
+    std::atomic_size_t _bytes_retained{0u};
+
+    std::atomic_size_t _hits{0u};
+
+    std::atomic_size_t _misses{0u};
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;
+    std::atomic_size_t _discarded{0u};
   };
 
 } // namespace carla
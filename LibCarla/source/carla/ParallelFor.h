@@ -0,0 +1,100 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace carla {
+
+  /// Calls @a func with every index in [0, size), split in contiguous chunks
+  /// among @a number_of_threads threads, the calling one included. Zero uses
+  /// one thread per hardware thread. No thread is started for less than
+  /// @a min_chunk_size indices. Exceptions are rethrown once every chunk has
+  /// finished.
+  template <typename FuncT>
+  void ParallelFor(size_t size, size_t number_of_threads, size_t min_chunk_size, FuncT &&func) {
+    if (number_of_threads == 0u) {
+      number_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    min_chunk_size = std::max<size_t>(min_chunk_size, 1u);
+    number_of_threads = std::max<size_t>(
+        std::min(number_of_threads, (size + min_chunk_size - 1u) / min_chunk_size),
+        1u);
+    const size_t chunk_size = (size + number_of_threads - 1u) / number_of_threads;
+    auto run_chunk = [&](size_t chunk) {
+      const size_t end = std::min(size, (chunk + 1u) * chunk_size);
+      for (size_t i = chunk * chunk_size; i < end; ++i) {
+        func(i);
+      }
+    };
+    std::vector<std::future<void>> chunks;
+    chunks.reserve(number_of_threads - 1u);
+    for (size_t chunk = 1u; chunk < number_of_threads; ++chunk) {
+      chunks.emplace_back(std::async(std::launch::async, run_chunk, chunk));
+    }
+    run_chunk(0u);
+    for (auto &chunk : chunks) {
+      chunk.get();
+    }
+  }
+
+  /// Calls @a func with every index in [0, size) on the calling thread and up
+  /// to @a number_of_threads - 1 tasks posted to @a pool. The indices are
+  /// handed out one at a time, so uneven items balance out. Runs serially if
+  /// @a pool is null. Exceptions are rethrown once every task has finished.
+  template <typename PoolT, typename FuncT>
+  void ParallelFor(PoolT *pool, size_t size, size_t number_of_threads, FuncT &&func) {
+    std::atomic<size_t> next_index{0u};
+    auto work = [&]() {
+      for (size_t i = next_index++; i < size; i = next_index++) {
+        func(i);
+      }
+    };
+    std::vector<std::future<void>> tasks;
+    if ((pool != nullptr) && (size > 1u)) {
+      const size_t number_of_tasks = std::min(std::max<size_t>(number_of_threads, 1u), size) - 1u;
+      tasks.reserve(number_of_tasks);
+      for (size_t task = 0u; task < number_of_tasks; ++task) {
+        tasks.emplace_back(pool->Post(work));
+      }
+    }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    // The tasks reference this frame, so all of them finish before any
+    // exception leaves it.
+    std::exception_ptr exception;
+    try {
+      work();
+    } catch (...) {
+      exception = std::current_exception();
+      next_index = size;
+    }
+    for (auto &task : tasks) {
+      try {
+        task.get();
+      } catch (...) {
+        if (exception == nullptr) {
+          exception = std::current_exception();
+        }
+      }
+    }
+    if (exception != nullptr) {
+      std::rethrow_exception(exception);
+    }
+#else
+    work();
+    for (auto &task : tasks) {
+      task.get();
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+
+} // namespace carla
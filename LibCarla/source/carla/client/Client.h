@@ -137,6 +137,12 @@ namespace client {
       _simulator->SetReplayerIgnoreHero(ignore_hero);
     }
 
+    /// Return the counters and latencies of the sensor streams received by
+    /// this client.
+    streaming::TelemetrySnapshot GetStreamingTelemetry() const {
+      return _simulator->GetStreamingTelemetry();
+    }
+
     void ApplyBatch(
         std::vector<rpc::Command> commands,
         bool do_tick_cue = false) const {
@@ -153,6 +159,13 @@ namespace client {
       return responses;
     }
 
+    /// Same as ApplyBatchSync, but returns without waiting for the
+    /// responses, so several batches can be in flight at once.
+    std::future<std::vector<rpc::CommandResponse>> ApplyBatchSyncAsync(
+        std::vector<rpc::Command> commands) const {
+      return _simulator->ApplyBatchSyncAsync(std::move(commands), false);
+    }
+
   private:
 
     std::shared_ptr<detail::Simulator> _simulator;
@@ -6,21 +6,48 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/Map.h"
+#include "carla/road/MapImage.h"
 #include "carla/road/RoadTypes.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
-#include <sstream>
+#include <memory>
+#include <vector>
 
 namespace carla {
 namespace client {
 
+  /// Stores the binary image of a map in the cache folder, a failure only
+  /// means the next client parses the OpenDRIVE again.
+  static void CacheMapImage(const std::string &file_name, const std::vector<uint8_t> &image) {
+    try {
+      if (!FileTransfer::WriteFile(file_name, image)) {
+        log_warning("unable to cache the map image", file_name);
+      }
+    } catch (const std::exception &e) {
+      log_warning("unable to cache the map image", file_name, ':', e.what());
+    }
+  }
+
   static auto MakeMap(const std::string &opendrive_contents) {
-    auto stream = std::istringstream(opendrive_contents);
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+    // Reuse the binary image of this OpenDRIVE if a previous client left one
+    // in the cache, it skips parsing the XML.
+    const auto image_name = road::MapImage::GetFileName(opendrive_contents);
+    auto map = opendrive::OpenDriveParser::LoadImage(
+        opendrive_contents,
+        FileTransfer::ReadFile(image_name));
+    if (!map.has_value()) {
+      std::vector<uint8_t> image;
+      map = opendrive::OpenDriveParser::Load(opendrive_contents, image);
+      if (map.has_value()) {
+        CacheMapImage(image_name, image);
+      }
+    }
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
@@ -56,6 +83,31 @@ namespace client {
     nullptr;
   }
 
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    std::vector<road::element::Waypoint> waypoints(locations.size());
+    // Not std::vector<bool>, every thread writes its own elements.
+    std::unique_ptr<bool[]> found(new bool[locations.size()]);
+    _map.GetWaypoints(
+        locations.data(),
+        locations.size(),
+        project_to_road,
+        lane_type,
+        waypoints.data(),
+        nullptr,
+        found.get());
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      result.emplace_back(found[i] ?
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoints[i]}) :
+          nullptr);
+    }
+    return result;
+  }
+
   SharedPtr<Waypoint> Map::GetWaypointXODR(
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
@@ -67,6 +119,18 @@ namespace client {
         nullptr;
   }
 
+  SharedPtr<Waypoint> Map::GetWaypointInSection(
+      carla::road::RoadId road_id,
+      carla::road::SectionId section_id,
+      carla::road::LaneId lane_id,
+      double s) const {
+    boost::optional<road::element::Waypoint> waypoint;
+    waypoint = _map.GetWaypoint(road_id, section_id, lane_id, s);
+    return waypoint.has_value() ?
+        SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+        nullptr;
+  }
+
   Map::TopologyList Map::GetTopology() const {
     namespace re = carla::road::element;
     std::unordered_map<re::Waypoint, SharedPtr<Waypoint>> waypoints;
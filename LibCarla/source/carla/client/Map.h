@@ -56,11 +56,27 @@ namespace client {
         bool project_to_road = true,
         int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
 
+    /// Same as GetWaypoint for each of the @a locations, computed in
+    /// parallel. Locations without waypoint get a null pointer.
+    std::vector<SharedPtr<Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        int32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+
     SharedPtr<Waypoint> GetWaypointXODR(
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
       float s) const;
 
+    /// Same as GetWaypointXODR in the lane section @a section_id, with @a s
+    /// in double precision, so a waypoint can be made again exactly from its
+    /// road, section, lane and s.
+    SharedPtr<Waypoint> GetWaypointInSection(
+      carla::road::RoadId road_id,
+      carla::road::SectionId section_id,
+      carla::road::LaneId lane_id,
+      double s) const;
+
     using TopologyList = std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>>;
 
     TopologyList GetTopology() const;
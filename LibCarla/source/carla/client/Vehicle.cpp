@@ -103,6 +103,13 @@ namespace client {
     return GetEpisode().Lock()->GetVehicleLightState(*this).GetLightStateEnum();
   }
 
+  std::future<Vehicle::LightState> Vehicle::GetLightStateAsync() const {
+    auto future = GetEpisode().Lock()->GetVehicleLightStateAsync(*this);
+    return std::async(std::launch::deferred, [future=std::move(future)]() mutable {
+      return future.get().GetLightStateEnum();
+    });
+  }
+
   float Vehicle::GetSpeedLimit() const {
     return GetEpisode().Lock()->GetActorSnapshot(*this).state.vehicle_data.speed_limit;
   }
@@ -17,6 +17,8 @@
 #include "carla/rpc/VehicleWheels.h"
 #include "carla/trafficmanager/TrafficManager.h"
 
+#include <future>
+
 using carla::traffic_manager::constants::Networking::TM_DEFAULT_PORT;
 
 namespace carla {
@@ -100,6 +102,10 @@ namespace client {
     /// received in the last tick.
     LightState GetLightState() const;
 
+    /// Same as GetLightState, but returns without waiting for the simulator
+    /// to answer.
+    std::future<LightState> GetLightStateAsync() const;
+
     /// Return the speed limit currently affecting this vehicle.
     ///
     /// @note This function does not call the simulator, it returns the data
@@ -41,6 +41,10 @@ namespace client {
     return _episode.Lock()->GetVehiclesLightStates();
   }
 
+  std::future<rpc::VehicleLightStateList> World::GetVehiclesLightStatesAsync() const {
+    return _episode.Lock()->GetVehiclesLightStatesAsync();
+  }
+
   boost::optional<geom::Location> World::GetRandomLocationFromNavigation() const {
     return _episode.Lock()->GetRandomLocationFromNavigation();
   }
@@ -227,6 +231,10 @@ namespace client {
     return _episode.Lock()->GetLevelBBs(queried_tag);
   }
 
+  std::future<std::vector<geom::BoundingBox>> World::GetLevelBBsAsync(uint8_t queried_tag) const {
+    return _episode.Lock()->GetLevelBBsAsync(queried_tag);
+  }
+
   std::vector<rpc::EnvironmentObject> World::GetEnvironmentObjects(uint8_t queried_tag) const {
     return _episode.Lock()->GetEnvironmentObjects(queried_tag);
   }
@@ -31,6 +31,8 @@
 
 #include <boost/optional.hpp>
 
+#include <future>
+
 namespace carla {
 namespace client {
 
@@ -75,6 +77,10 @@ namespace client {
     /// and the second one is the light state
     rpc::VehicleLightStateList GetVehiclesLightStates() const;
 
+    /// Same as GetVehiclesLightStates, but returns without waiting for the
+    /// simulator to answer.
+    std::future<rpc::VehicleLightStateList> GetVehiclesLightStatesAsync() const;
+
     /// Get a random location from the pedestrians navigation mesh
     boost::optional<geom::Location> GetRandomLocationFromNavigation() const;
 
@@ -171,6 +177,10 @@ namespace client {
     /// Returns all the BBs of all the elements of the level
     std::vector<geom::BoundingBox> GetLevelBBs(uint8_t queried_tag) const;
 
+    /// Same as GetLevelBBs, but returns without waiting for the simulator to
+    /// answer.
+    std::future<std::vector<geom::BoundingBox>> GetLevelBBsAsync(uint8_t queried_tag) const;
+
     std::vector<rpc::EnvironmentObject> GetEnvironmentObjects(uint8_t queried_tag) const;
 
     void EnableEnvironmentObjects(
@@ -26,6 +26,7 @@
 
 #include <rpc/rpc_error.h>
 
+#include <chrono>
 #include <thread>
 
 namespace carla {
@@ -41,6 +42,16 @@ namespace detail {
     return true;
   }
 
+  template <typename T, typename ObjectT>
+  static auto GetResponse(const ObjectT &object) {
+    using R = typename carla::rpc::Response<T>;
+    auto response = object.template as<R>();
+    if (response.HasError()) {
+      throw_exception(std::runtime_error(response.GetError().What()));
+    }
+    return Get(response);
+  }
+
   // ===========================================================================
   // -- Client::Pimpl ----------------------------------------------------------
   // ===========================================================================
@@ -69,12 +80,37 @@ namespace detail {
     template <typename T, typename ... Args>
     auto CallAndWait(const std::string &function, Args && ... args) {
       auto object = RawCall(function, std::forward<Args>(args) ...);
-      using R = typename carla::rpc::Response<T>;
-      auto response = object.template as<R>();
-      if (response.HasError()) {
-        throw_exception(std::runtime_error(response.GetError().What()));
-      }
-      return Get(response);
+      return GetResponse<T>(object);
+    }
+
+    /// Sends the call and returns without waiting for the response. The
+    /// returned future waits for it on get(), with the timeout the client had
+    /// at the time of the call, and passes it to @a convert.
+    template <typename ConvertT, typename ... Args>
+    auto RawCallAsync(ConvertT &&convert, const std::string &function, Args && ... args) {
+      const auto timeout = GetTimeout();
+      const auto deadline = std::chrono::steady_clock::now() + timeout.to_chrono();
+      auto future = rpc_client.future_call(function, std::forward<Args>(args) ...);
+      return std::async(std::launch::deferred, [
+          future = std::move(future),
+          convert = std::forward<ConvertT>(convert),
+          endpoint = endpoint,
+          timeout,
+          deadline]() mutable {
+        if (future.wait_until(deadline) == std::future_status::timeout) {
+          throw_exception(TimeoutException(endpoint, timeout));
+        }
+        auto object = future.get();
+        return convert(object);
+      });
+    }
+
+    template <typename T, typename ... Args>
+    auto CallAsync(const std::string &function, Args && ... args) {
+      return RawCallAsync(
+          [](const auto &object) { return GetResponse<T>(object); },
+          function,
+          std::forward<Args>(args) ...);
     }
 
     template <typename ... Args>
@@ -273,6 +309,12 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("get_actors_by_id", ids);
   }
 
+  std::future<std::vector<rpc::Actor>> Client::GetActorsByIdAsync(
+      const std::vector<ActorId> &ids) {
+    using return_t = std::vector<rpc::Actor>;
+    return _pimpl->CallAsync<return_t>("get_actors_by_id", ids);
+  }
+
   rpc::VehiclePhysicsControl Client::GetVehiclePhysicsControl(
       rpc::ActorId vehicle) const {
     return _pimpl->CallAndWait<carla::rpc::VehiclePhysicsControl>("get_physics_control", vehicle);
@@ -283,6 +325,11 @@ namespace detail {
     return _pimpl->CallAndWait<carla::rpc::VehicleLightState>("get_vehicle_light_state", vehicle);
   }
 
+  std::future<rpc::VehicleLightState> Client::GetVehicleLightStateAsync(
+      rpc::ActorId vehicle) const {
+    return _pimpl->CallAsync<carla::rpc::VehicleLightState>("get_vehicle_light_state", vehicle);
+  }
+
   void Client::ApplyPhysicsControlToVehicle(
       rpc::ActorId vehicle,
       const rpc::VehiclePhysicsControl &physics_control) {
@@ -531,6 +578,10 @@ namespace detail {
     return _pimpl->CallAndWait<std::vector<std::pair<carla::ActorId, uint32_t>>>("get_vehicle_light_states");
   }
 
+  std::future<rpc::VehicleLightStateList> Client::GetVehiclesLightStatesAsync() {
+    return _pimpl->CallAsync<std::vector<std::pair<carla::ActorId, uint32_t>>>("get_vehicle_light_states");
+  }
+
   std::vector<ActorId> Client::GetGroupTrafficLights(rpc::ActorId traffic_light) {
     using return_t = std::vector<ActorId>;
     return _pimpl->CallAndWait<return_t>("get_group_traffic_lights", traffic_light);
@@ -586,6 +637,10 @@ namespace detail {
     _pimpl->streaming_client.UnSubscribe(token);
   }
 
+  streaming::TelemetrySnapshot Client::GetStreamingTelemetry() const {
+    return _pimpl->streaming_client.GetTelemetry();
+  }
+
   void Client::SubscribeToGBuffer(
       rpc::ActorId ActorId,
       uint32_t GBufferId,
@@ -622,6 +677,31 @@ namespace detail {
     return result.as<std::vector<rpc::CommandResponse>>();
   }
 
+  std::future<std::vector<rpc::CommandResponse>> Client::ApplyBatchSyncAsync(
+      std::vector<rpc::Command> commands,
+      bool do_tick_cue) {
+    return _pimpl->RawCallAsync(
+        [](const auto &result) { return result.template as<std::vector<rpc::CommandResponse>>(); },
+        "apply_batch",
+        std::move(commands),
+        do_tick_cue);
+  }
+
+  void Client::ApplyVehicleControlBatch(
+      const rpc::VehicleControlBatch &batch,
+      const std::vector<rpc::Command> &commands,
+      bool do_tick_cue) {
+    _pimpl->AsyncCall("apply_vehicle_control_batch", batch, commands, do_tick_cue);
+  }
+
+  std::vector<rpc::ActorId> Client::ApplyVehicleControlBatchSync(
+      const rpc::VehicleControlBatch &batch,
+      const std::vector<rpc::Command> &commands,
+      bool do_tick_cue) {
+    using return_t = std::vector<rpc::ActorId>;
+    return _pimpl->CallAndWait<return_t>("apply_vehicle_control_batch", batch, commands, do_tick_cue);
+  }
+
   uint64_t Client::SendTickCue() {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
@@ -644,6 +724,11 @@ namespace detail {
     return _pimpl->CallAndWait<return_t>("get_all_level_BBs", queried_tag);
   }
 
+  std::future<std::vector<geom::BoundingBox>> Client::GetLevelBBsAsync(uint8_t queried_tag) const {
+    using return_t = std::vector<geom::BoundingBox>;
+    return _pimpl->CallAsync<return_t>("get_all_level_BBs", queried_tag);
+  }
+
   std::vector<rpc::EnvironmentObject> Client::GetEnvironmentObjects(uint8_t queried_tag) const {
     using return_t = std::vector<rpc::EnvironmentObject>;
     return _pimpl->CallAndWait<return_t>("get_environment_objects", queried_tag);
@@ -25,6 +25,7 @@
 #include "carla/rpc/MapLayer.h"
 #include "carla/rpc/OpendriveGenerationParameters.h"
 #include "carla/rpc/TrafficLightState.h"
+#include "carla/rpc/VehicleControlBatch.h"
 #include "carla/rpc/VehicleDoor.h"
 #include "carla/rpc/VehicleLightStateList.h"
 #include "carla/rpc/VehicleLightState.h"
@@ -33,8 +34,10 @@
 #include "carla/rpc/WeatherParameters.h"
 #include "carla/rpc/Texture.h"
 #include "carla/rpc/MaterialParameter.h"
+#include "carla/streaming/Telemetry.h"
 
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -66,6 +69,11 @@ namespace detail {
 
   /// Provides communication with the rpc and streaming servers of a CARLA
   /// simulator.
+  ///
+  /// The calls ending in Async send the request and return right away, so
+  /// many of them can be in flight on the connection at once. Getting the
+  /// future waits for the response with the timeout set at the time of the
+  /// call, and throws the same exceptions as the blocking call.
   class Client : private NonCopyable {
   public:
 
@@ -151,10 +159,14 @@ namespace detail {
 
     std::vector<rpc::Actor> GetActorsById(const std::vector<ActorId> &ids);
 
+    std::future<std::vector<rpc::Actor>> GetActorsByIdAsync(const std::vector<ActorId> &ids);
+
     rpc::VehiclePhysicsControl GetVehiclePhysicsControl(rpc::ActorId vehicle) const;
 
     rpc::VehicleLightState GetVehicleLightState(rpc::ActorId vehicle) const;
 
+    std::future<rpc::VehicleLightState> GetVehicleLightStateAsync(rpc::ActorId vehicle) const;
+
     void ApplyPhysicsControlToVehicle(
         rpc::ActorId vehicle,
         const rpc::VehiclePhysicsControl &physics_control);
@@ -342,6 +354,8 @@ namespace detail {
     /// and the second one is the light state
     rpc::VehicleLightStateList GetVehiclesLightStates();
 
+    std::future<rpc::VehicleLightStateList> GetVehiclesLightStatesAsync();
+
     std::vector<ActorId> GetGroupTrafficLights(
         rpc::ActorId traffic_light);
 
@@ -375,6 +389,9 @@ namespace detail {
 
     void UnSubscribeFromStream(const streaming::Token &token);
 
+    /// Counters and latencies of every sensor stream subscribed to so far.
+    streaming::TelemetrySnapshot GetStreamingTelemetry() const;
+
     void UnSubscribeFromGBuffer(
         rpc::ActorId ActorId,
         uint32_t GBufferId);
@@ -389,6 +406,23 @@ namespace detail {
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
 
+    std::future<std::vector<rpc::CommandResponse>> ApplyBatchSyncAsync(
+        std::vector<rpc::Command> commands,
+        bool do_tick_cue);
+
+    /// Applies the controls of @a batch and then @a commands in a single call.
+    void ApplyVehicleControlBatch(
+        const rpc::VehicleControlBatch &batch,
+        const std::vector<rpc::Command> &commands,
+        bool do_tick_cue);
+
+    /// Returns the ids of the vehicles the control could not be applied to,
+    /// the results of @a commands are not reported.
+    std::vector<rpc::ActorId> ApplyVehicleControlBatchSync(
+        const rpc::VehicleControlBatch &batch,
+        const std::vector<rpc::Command> &commands,
+        bool do_tick_cue);
+
     uint64_t SendTickCue();
 
     std::vector<rpc::LightState> QueryLightsStateToServer() const;
@@ -402,6 +436,8 @@ namespace detail {
     /// Returns all the BBs of all the elements of the level
     std::vector<geom::BoundingBox> GetLevelBBs(uint8_t queried_tag) const;
 
+    std::future<std::vector<geom::BoundingBox>> GetLevelBBsAsync(uint8_t queried_tag) const;
+
     std::vector<rpc::EnvironmentObject> GetEnvironmentObjects(uint8_t queried_tag) const;
 
     void EnableEnvironmentObjects(
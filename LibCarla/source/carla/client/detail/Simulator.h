@@ -229,6 +229,10 @@ namespace detail {
     /// and the second one is the light state
     rpc::VehicleLightStateList GetVehiclesLightStates();
 
+    std::future<rpc::VehicleLightStateList> GetVehiclesLightStatesAsync() {
+      return _client.GetVehiclesLightStatesAsync();
+    }
+
     SharedPtr<Actor> GetSpectator();
 
     rpc::EpisodeSettings GetEpisodeSettings() {
@@ -253,11 +257,19 @@ namespace detail {
       return _client.GetVehicleLightState(vehicle.GetId());
     }
 
+    std::future<rpc::VehicleLightState> GetVehicleLightStateAsync(const Vehicle &vehicle) const {
+      return _client.GetVehicleLightStateAsync(vehicle.GetId());
+    }
+
     /// Returns all the BBs of all the elements of the level
     std::vector<geom::BoundingBox> GetLevelBBs(uint8_t queried_tag) const {
       return _client.GetLevelBBs(queried_tag);
     }
 
+    std::future<std::vector<geom::BoundingBox>> GetLevelBBsAsync(uint8_t queried_tag) const {
+      return _client.GetLevelBBsAsync(queried_tag);
+    }
+
     std::vector<rpc::EnvironmentObject> GetEnvironmentObjects(uint8_t queried_tag) const {
       return _client.GetEnvironmentObjects(queried_tag);
     }
@@ -592,6 +604,10 @@ namespace detail {
 
     void UnSubscribeFromSensor(Actor &sensor);
 
+    streaming::TelemetrySnapshot GetStreamingTelemetry() const {
+      return _client.GetStreamingTelemetry();
+    }
+
     void SubscribeToGBuffer(
         Actor & sensor,
         uint32_t gbuffer_id,
@@ -667,6 +683,24 @@ namespace detail {
       return _client.ApplyBatchSync(std::move(commands), do_tick_cue);
     }
 
+    auto ApplyBatchSyncAsync(std::vector<rpc::Command> commands, bool do_tick_cue) {
+      return _client.ApplyBatchSyncAsync(std::move(commands), do_tick_cue);
+    }
+
+    void ApplyVehicleControlBatch(
+        const rpc::VehicleControlBatch &batch,
+        const std::vector<rpc::Command> &commands,
+        bool do_tick_cue) {
+      _client.ApplyVehicleControlBatch(batch, commands, do_tick_cue);
+    }
+
+    auto ApplyVehicleControlBatchSync(
+        const rpc::VehicleControlBatch &batch,
+        const std::vector<rpc::Command> &commands,
+        bool do_tick_cue) {
+      return _client.ApplyVehicleControlBatchSync(batch, commands, do_tick_cue);
+    }
+
     /// @}
     // =========================================================================
     /// @name Operations lights
@@ -0,0 +1,144 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace carla {
+namespace geom {
+
+  /// Maps the arc length of a parametric curve to its parameter. Keeps the
+  /// parameter, arc length and derivative of the parameter with respect to
+  /// the arc length of a few samples of the curve, in order of arc length.
+  ///
+  /// A lookup finds the samples around the arc length with a binary search
+  /// and interpolates the parameter between them with a cubic Hermite spline.
+  class ArcLengthTable {
+  public:
+
+    /// How the arc length between two consecutive samples is computed.
+    enum class Integration {
+      /// Length of the straight line between them, needs dense samples.
+      Chords,
+      /// Five-point Gauss–Legendre quadrature of the speed of the curve,
+      /// accurate enough for sparse samples.
+      GaussLegendre
+    };
+
+    void Reserve(size_t size) {
+      _s.reserve(size);
+      _p.reserve(size);
+      _dp_ds.reserve(size);
+    }
+
+    /// Appends a sample, @a s must not be less than the one of the previous
+    /// sample. @a speed is the derivative of the arc length with respect to
+    /// the parameter at @a p.
+    void Add(double p, double s, double speed) {
+      DEBUG_ASSERT(_s.empty() || (s >= _s.back()));
+      _p.emplace_back(p);
+      _s.emplace_back(s);
+      _dp_ds.emplace_back(speed > EPSILON ? 1.0 / speed : 0.0);
+    }
+
+    /// Releases the memory reserved and not used.
+    void ShrinkToFit() {
+      _s.shrink_to_fit();
+      _p.shrink_to_fit();
+      _dp_ds.shrink_to_fit();
+    }
+
+    bool empty() const {
+      return _s.empty();
+    }
+
+    size_t size() const {
+      return _s.size();
+    }
+
+    /// Arc length of the last sample.
+    double GetLength() const {
+      DEBUG_ASSERT(!empty());
+      return _s.back();
+    }
+
+    /// Parameter of the curve at arc length @a s. Outside of the samples the
+    /// parameter is extrapolated linearly from the closest one.
+    double GetParameter(double s) const {
+      DEBUG_ASSERT(!empty());
+      if (s <= _s.front()) {
+        return _p.front() + Slope(0u) * (s - _s.front());
+      }
+      const size_t last = _s.size() - 1u;
+      if (s >= _s.back()) {
+        return _p.back() + Slope(last) * (s - _s.back());
+      }
+      const size_t i = static_cast<size_t>(
+          std::upper_bound(_s.begin(), _s.end(), s) - _s.begin()) - 1u;
+      const double h = _s[i + 1u] - _s[i];
+      if (h <= EPSILON) {
+        return _p[i];
+      }
+      const double t = (s - _s[i]) / h;
+      const double t2 = t * t;
+      const double t3 = t2 * t;
+      return
+          (2.0 * t3 - 3.0 * t2 + 1.0) * _p[i] +
+          (t3 - 2.0 * t2 + t) * h * Slope(i) +
+          (-2.0 * t3 + 3.0 * t2) * _p[i + 1u] +
+          (t3 - t2) * h * Slope(i + 1u);
+    }
+
+    /// Length of the curve between the parameters @a p0 and @a p1 given its
+    /// @a speed, by five-point Gauss–Legendre quadrature.
+    template <typename SpeedFunctor>
+    static double GaussLegendreLength(SpeedFunctor &&speed, double p0, double p1) {
+      static constexpr double nodes[] = {
+          0.0,
+          0.5384693101056831,
+          0.9061798459386640};
+      static constexpr double weights[] = {
+          0.5688888888888889,
+          0.4786286704993665,
+          0.2369268850561891};
+      const double half = 0.5 * (p1 - p0);
+      const double middle = 0.5 * (p1 + p0);
+      double sum = weights[0u] * speed(middle);
+      for (auto i = 1u; i < 3u; ++i) {
+        sum += weights[i] * (speed(middle - half * nodes[i]) + speed(middle + half * nodes[i]));
+      }
+      return half * sum;
+    }
+
+  private:
+
+    static constexpr double EPSILON = 1e-9;
+
+    /// Derivative of the parameter at sample @a i. Where the curve stops (zero
+    /// speed) it falls back to the slope of the secant to the next sample.
+    double Slope(size_t i) const {
+      if (_dp_ds[i] > 0.0) {
+        return _dp_ds[i];
+      }
+      const size_t first = (i + 1u < _s.size()) ? i : (i > 0u ? i - 1u : i);
+      const size_t second = std::min(first + 1u, _s.size() - 1u);
+      const double h = _s[second] - _s[first];
+      return h > EPSILON ? (_p[second] - _p[first]) / h : 0.0;
+    }
+
+    std::vector<double> _s;
+
+    std::vector<double> _p;
+
+    std::vector<double> _dp_ds;
+  };
+
+} // namespace geom
+} // namespace carla
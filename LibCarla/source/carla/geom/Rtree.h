@@ -37,6 +37,13 @@ namespace geom {
       _rtree.insert(elements.begin(), elements.end());
     }
 
+    /// Replaces the content of the tree by @a elements. Uses the packing
+    /// algorithm of the bulk loading constructor, much faster than inserting
+    /// them one by one and giving a tree with less overlap between nodes.
+    void SetElements(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
+
     /// Return nearest neighbors with a user defined filter.
     /// The filter reveices as an argument a TreeElement value and needs to
     /// return a bool to accept or reject the value
@@ -94,6 +101,13 @@ namespace geom {
       _rtree.insert(elements.begin(), elements.end());
     }
 
+    /// Replaces the content of the tree by @a elements. Uses the packing
+    /// algorithm of the bulk loading constructor, much faster than inserting
+    /// them one by one and giving a tree with less overlap between nodes.
+    void SetElements(const std::vector<TreeElement> &elements) {
+      _rtree = RtreeType(elements.begin(), elements.end());
+    }
+
     /// Return nearest neighbors with a user defined filter.
     /// The filter reveices as an argument a TreeElement value and needs to
     /// return a bool to accept or reject the value
@@ -138,7 +152,9 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
 
   };
 
@@ -17,11 +17,11 @@ namespace carla {
 namespace multigpu {
 
   /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// a single buffer, taken from @a pool once its size is known.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _buffer(std::move(buffer)) {}
+    explicit IncomingMessage(std::shared_ptr<BufferPool> pool) : _pool(std::move(pool)) {}
 
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
@@ -29,6 +29,7 @@ namespace multigpu {
 
     boost::asio::mutable_buffer buffer() {
       DEBUG_ASSERT(_size > 0u);
+      _buffer = _pool->Pop(_size);
       _buffer.reset(_size);
       return _buffer.buffer();
     }
@@ -43,6 +44,8 @@ namespace multigpu {
 
   private:
 
+    const std::shared_ptr<BufferPool> _pool;
+
     carla::streaming::detail::message_size_type _size = 0u;
 
     Buffer _buffer;
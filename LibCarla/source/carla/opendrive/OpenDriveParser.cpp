@@ -18,15 +18,23 @@
 #include "carla/opendrive/parser/SignalParser.h"
 #include "carla/opendrive/parser/TrafficGroupParser.h"
 #include "carla/road/MapBuilder.h"
+#include "carla/road/MapImage.h"
 
 #include <pugixml/pugixml.hpp>
 
 namespace carla {
 namespace opendrive {
 
-  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+  static boost::optional<road::Map> Parse(const std::string &opendrive, road::MapImage *image) {
     pugi::xml_document xml;
-    pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());
+    // pugixml parses its own copy of the content in place, in-situ parsing of
+    // the string itself would need a buffer we own. Passing the size at least
+    // skips measuring the string.
+    pugi::xml_parse_result parse_result = xml.load_buffer(
+        opendrive.data(),
+        opendrive.size(),
+        pugi::parse_default,
+        pugi::encoding_utf8);
 
     if (parse_result == false) {
       log_error("unable to parse the OpenDRIVE XML string");
@@ -34,6 +42,7 @@ namespace opendrive {
     }
 
     carla::road::MapBuilder map_builder;
+    map_builder.SetRecorder(image);
 
     parser::GeoReferenceParser::Parse(xml, map_builder);
     parser::RoadParser::Parse(xml, map_builder);
@@ -49,5 +58,26 @@ namespace opendrive {
     return map_builder.Build();
   }
 
+  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+    return Parse(opendrive, nullptr);
+  }
+
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      std::vector<uint8_t> &image) {
+    road::MapImage recorder(road::MapImage::Hash(opendrive));
+    auto map = Parse(opendrive, &recorder);
+    if (map.has_value()) {
+      image = recorder.Finish();
+    }
+    return map;
+  }
+
+  boost::optional<road::Map> OpenDriveParser::LoadImage(
+      const std::string &opendrive,
+      const std::vector<uint8_t> &image) {
+    return road::MapImage::Load(image, road::MapImage::Hash(opendrive));
+  }
+
 } // namespace opendrive
 } // namespace carla
@@ -10,7 +10,9 @@
 
 #include <boost/optional.hpp>
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace carla {
 namespace opendrive {
@@ -19,6 +21,19 @@ namespace opendrive {
   public:
 
     static boost::optional<road::Map> Load(const std::string &opendrive);
+
+    /// Same as Load, and also stores the binary image of the map in
+    /// @a image, see road::MapImage.
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        std::vector<uint8_t> &image);
+
+    /// Builds the map from a binary image of @a opendrive previously stored
+    /// by Load, without parsing the XML. Returns nothing if @a image does not
+    /// belong to @a opendrive or cannot be read.
+    static boost::optional<road::Map> LoadImage(
+        const std::string &opendrive,
+        const std::vector<uint8_t> &image);
   };
 
 } // namespace opendrive
@@ -6,6 +6,7 @@
 
 #include "carla/opendrive/parser/GeometryParser.h"
 
+#include "carla/opendrive/parser/ParallelRoadParser.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
@@ -62,9 +63,9 @@ namespace parser {
       const pugi::xml_document &xml,
       carla::road::MapBuilder &map_builder) {
 
-    std::vector<Geometry> geometry;
-
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+    // parse the plan view of the roads in parallel
+    const auto geometry_per_road = ParseRoadsInParallel<std::vector<Geometry>>(xml,
+        [](const pugi::xml_node &node_road, std::vector<Geometry> &geometry) {
 
       // parse plan view
       pugi::xml_node node_plan_view = node_road.child("planView");
@@ -112,51 +113,53 @@ namespace parser {
           geometry.emplace_back(geo);
         }
       }
-    }
-
-    // map_builder calls
-    for (auto const geo : geometry) {
-      carla::road::Road *road = map_builder.GetRoad(geo.road_id);
-      if (geo.type == "line") {
-        map_builder.AddRoadGeometryLine(road, geo.s, geo.x, geo.y, geo.hdg, geo.length);
-      } else if (geo.type == "arc") {
-        map_builder.AddRoadGeometryArc(road, geo.s, geo.x, geo.y, geo.hdg, geo.length, geo.arc.curvature);
-      } else if (geo.type == "spiral") {
-        map_builder.AddRoadGeometrySpiral(road,
-            geo.s,
-            geo.x,
-            geo.y,
-            geo.hdg,
-            geo.length,
-            geo.spiral.curvStart,
-            geo.spiral.curvEnd);
-      } else if (geo.type == "poly3") {
-        map_builder.AddRoadGeometryPoly3(road,
-            geo.s,
-            geo.x,
-            geo.y,
-            geo.hdg,
-            geo.length,
-            geo.poly3.a,
-            geo.poly3.b,
-            geo.poly3.c,
-            geo.poly3.d);
-      } else if (geo.type == "paramPoly3") {
-        map_builder.AddRoadGeometryParamPoly3(road,
-            geo.s,
-            geo.x,
-            geo.y,
-            geo.hdg,
-            geo.length,
-            geo.param_poly3.aU,
-            geo.param_poly3.bU,
-            geo.param_poly3.cU,
-            geo.param_poly3.dU,
-            geo.param_poly3.aV,
-            geo.param_poly3.bV,
-            geo.param_poly3.cV,
-            geo.param_poly3.dV,
-            geo.param_poly3.p_range);
+    });
+
+    // map_builder calls, in the order of the roads
+    for (auto const &geometry : geometry_per_road) {
+      for (auto const &geo : geometry) {
+        carla::road::Road *road = map_builder.GetRoad(geo.road_id);
+        if (geo.type == "line") {
+          map_builder.AddRoadGeometryLine(road, geo.s, geo.x, geo.y, geo.hdg, geo.length);
+        } else if (geo.type == "arc") {
+          map_builder.AddRoadGeometryArc(road, geo.s, geo.x, geo.y, geo.hdg, geo.length, geo.arc.curvature);
+        } else if (geo.type == "spiral") {
+          map_builder.AddRoadGeometrySpiral(road,
+              geo.s,
+              geo.x,
+              geo.y,
+              geo.hdg,
+              geo.length,
+              geo.spiral.curvStart,
+              geo.spiral.curvEnd);
+        } else if (geo.type == "poly3") {
+          map_builder.AddRoadGeometryPoly3(road,
+              geo.s,
+              geo.x,
+              geo.y,
+              geo.hdg,
+              geo.length,
+              geo.poly3.a,
+              geo.poly3.b,
+              geo.poly3.c,
+              geo.poly3.d);
+        } else if (geo.type == "paramPoly3") {
+          map_builder.AddRoadGeometryParamPoly3(road,
+              geo.s,
+              geo.x,
+              geo.y,
+              geo.hdg,
+              geo.length,
+              geo.param_poly3.aU,
+              geo.param_poly3.bU,
+              geo.param_poly3.cU,
+              geo.param_poly3.dU,
+              geo.param_poly3.aV,
+              geo.param_poly3.bV,
+              geo.param_poly3.cV,
+              geo.param_poly3.dV,
+              geo.param_poly3.p_range);
+        }
       }
     }
   }
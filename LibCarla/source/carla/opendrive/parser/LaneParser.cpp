@@ -6,24 +6,38 @@
 
 #include "carla/opendrive/parser/LaneParser.h"
 
+#include "carla/opendrive/parser/ParallelRoadParser.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
 
+#include <functional>
+#include <vector>
+
 namespace carla {
 namespace opendrive {
 namespace parser {
 
+  /// Calls to the map builder parsed from a lane, made once the lane is
+  /// looked up.
+  struct LaneCalls {
+    road::RoadId road_id;
+    road::LaneId lane_id;
+    double s;
+    std::vector<std::function<void(road::MapBuilder &, road::Lane *)>> calls;
+  };
+
   static void ParseLanes(
       road::RoadId road_id,
       double s,
       const pugi::xml_node &parent_node,
-      carla::road::MapBuilder &map_builder) {
+      std::vector<LaneCalls> &lanes) {
     for (pugi::xml_node lane_node : parent_node.children("lane")) {
 
       road::LaneId lane_id = lane_node.attribute("id").as_int();
 
-      road::Lane *lane = map_builder.GetLane(road_id, lane_id, s);
+      lanes.push_back({road_id, lane_id, s, {}});
+      auto &calls = lanes.back().calls;
 
       // Lane Width
       int width_count = 0;
@@ -35,13 +49,17 @@ namespace parser {
         const double d = lane_width_node.attribute("d").as_double();
 
         // Call Map builder create Lane Width function
-        map_builder.CreateLaneWidth(lane, s_offset + s, a, b, c, d);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneWidth(lane, s_offset + s, a, b, c, d);
+        });
         width_count++;
       }
-      if (width_count == 0 && lane->GetId() != 0) {
-        map_builder.CreateLaneWidth(lane, s, 0.0, 0.0, 0.0, 0.0);
-        std::cout << "WARNING: In road " << lane->GetRoad()->GetId() << " lane " << lane->GetId() <<
-        " no \"<width>\" parameter found under \"<lane>\" tag. Using default values." << std::endl;
+      if (width_count == 0 && lane_id != 0) {
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneWidth(lane, s, 0.0, 0.0, 0.0, 0.0);
+          std::cout << "WARNING: In road " << lane->GetRoad()->GetId() << " lane " << lane->GetId() <<
+          " no \"<width>\" parameter found under \"<lane>\" tag. Using default values." << std::endl;
+        });
       }
 
       // Lane Border
@@ -53,7 +71,9 @@ namespace parser {
         const double d = lane_border_node.attribute("d").as_double();
 
         // Call Map builder create Lane Border function
-        map_builder.CreateLaneBorder(lane, s_offset + s, a, b, c, d);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneBorder(lane, s_offset + s, a, b, c, d);
+        });
       }
 
       // Lane Road Mark
@@ -81,19 +101,21 @@ namespace parser {
           }
 
           // Call map builder for LaneRoadMark
-          map_builder.CreateRoadMark(
-              lane,
-              road_mark_id,
-              s_offset + s,
-              type,
-              weight,
-              color,
-              material,
-              width,
-              lane_change,
-              height,
-              type_name,
-              type_width);
+          calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+            map_builder.CreateRoadMark(
+                lane,
+                road_mark_id,
+                s_offset + s,
+                type,
+                weight,
+                color,
+                material,
+                width,
+                lane_change,
+                height,
+                type_name,
+                type_width);
+          });
         }
 
         for (pugi::xml_node road_mark_type_line_node : road_mark_type.children("line")) {
@@ -106,15 +128,17 @@ namespace parser {
           const double width = road_mark_type_line_node.attribute("width").as_double();
 
           // Call map builder for LaneRoadMarkType LaneRoadMarkTypeLine
-          map_builder.CreateRoadMarkTypeLine(
-              lane,
-              road_mark_id,
-              length,
-              space,
-              t,
-              s_offset + s,
-              rule,
-              width);
+          calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+            map_builder.CreateRoadMarkTypeLine(
+                lane,
+                road_mark_id,
+                length,
+                space,
+                t,
+                s_offset + s,
+                rule,
+                width);
+          });
         }
         ++road_mark_id;
       }
@@ -128,7 +152,9 @@ namespace parser {
         const double roughness = lane_material_node.attribute("roughness").as_double();
 
         // Create map builder for Lane Material
-        map_builder.CreateLaneMaterial(lane, s_offset + s, surface, friction, roughness);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneMaterial(lane, s_offset + s, surface, friction, roughness);
+        });
       }
 
       // Lane Visibility
@@ -140,7 +166,9 @@ namespace parser {
         const double right = lane_visibility_node.attribute("right").as_double();
 
         // Create map builder for Lane Visibility
-        map_builder.CreateLaneVisibility(lane, s_offset + s, forward, back, left, right);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneVisibility(lane, s_offset + s, forward, back, left, right);
+        });
       }
 
       // Lane Speed
@@ -150,7 +178,9 @@ namespace parser {
         std::string unit = lane_speed_node.attribute("unit").value();
 
         // Create map builder for Lane Speed
-        map_builder.CreateLaneSpeed(lane, s_offset + s, max, unit);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneSpeed(lane, s_offset + s, max, unit);
+        });
       }
 
       // Lane Access
@@ -159,7 +189,9 @@ namespace parser {
         const std::string restriction = lane_access_node.attribute("restriction").value();
 
         // Create map builder for Lane Access
-        map_builder.CreateLaneAccess(lane, s_offset + s, restriction);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneAccess(lane, s_offset + s, restriction);
+        });
       }
 
       // Lane Height
@@ -169,7 +201,9 @@ namespace parser {
         const double outer = lane_height_node.attribute("outer").as_double();
 
         // Create map builder for Lane Height
-        map_builder.CreateLaneHeight(lane, s_offset + s, inner, outer);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneHeight(lane, s_offset + s, inner, outer);
+        });
       }
 
       // Lane Rule
@@ -178,7 +212,9 @@ namespace parser {
         const std::string value = lane_rule_node.attribute("value").value();
 
         // Create map builder for Lane Height
-        map_builder.CreateLaneRule(lane, s_offset + s, value);
+        calls.emplace_back([=](road::MapBuilder &map_builder, road::Lane *lane) {
+          map_builder.CreateLaneRule(lane, s_offset + s, value);
+        });
       }
 
     }
@@ -188,10 +224,9 @@ namespace parser {
       const pugi::xml_document &xml,
       carla::road::MapBuilder &map_builder) {
 
-    pugi::xml_node open_drive_node = xml.child("OpenDRIVE");
-
-    // Lanes
-    for (pugi::xml_node road_node : open_drive_node.children("road")) {
+    // parse the lanes of the roads in parallel
+    const auto lanes_per_road = ParseRoadsInParallel<std::vector<LaneCalls>>(xml,
+        [](const pugi::xml_node &road_node, std::vector<LaneCalls> &lanes) {
       road::RoadId road_id = road_node.attribute("id").as_uint();
 
       for (pugi::xml_node lanes_node : road_node.children("lanes")) {
@@ -200,20 +235,30 @@ namespace parser {
           double s = lane_section_node.attribute("s").as_double();
           pugi::xml_node left_node = lane_section_node.child("left");
           if (left_node) {
-            ParseLanes(road_id, s, left_node, map_builder);
+            ParseLanes(road_id, s, left_node, lanes);
           }
 
           pugi::xml_node center_node = lane_section_node.child("center");
           if (center_node) {
-            ParseLanes(road_id, s, center_node, map_builder);
+            ParseLanes(road_id, s, center_node, lanes);
           }
 
           pugi::xml_node right_node = lane_section_node.child("right");
           if (right_node) {
-            ParseLanes(road_id, s, right_node, map_builder);
+            ParseLanes(road_id, s, right_node, lanes);
           }
         }
       }
+    });
+
+    // map_builder calls, in the order of the roads
+    for (auto const &lanes : lanes_per_road) {
+      for (auto const &lane_calls : lanes) {
+        road::Lane *lane = map_builder.GetLane(lane_calls.road_id, lane_calls.lane_id, lane_calls.s);
+        for (auto const &call : lane_calls.calls) {
+          call(map_builder, lane);
+        }
+      }
     }
   }
 
@@ -0,0 +1,43 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ParallelFor.h"
+
+#include <pugixml/pugixml.hpp>
+
+#include <vector>
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  /// Calls @a parse_road(road_node, result) for every road of @a xml, using
+  /// several threads. Each road is parsed into a result of its own, so the
+  /// parsing must only read the document and shared data. Returns the results
+  /// in the order of the roads in the document, for the caller to add them to
+  /// the MapBuilder in the same order as a sequential parser would.
+  template <typename ResultT, typename ParseRoadT>
+  std::vector<ResultT> ParseRoadsInParallel(
+      const pugi::xml_document &xml,
+      ParseRoadT &&parse_road) {
+    // A few roads are not worth starting a thread.
+    constexpr size_t min_roads_per_thread = 32u;
+    std::vector<pugi::xml_node> road_nodes;
+    for (pugi::xml_node road_node : xml.child("OpenDRIVE").children("road")) {
+      road_nodes.emplace_back(road_node);
+    }
+    std::vector<ResultT> results(road_nodes.size());
+    ParallelFor(road_nodes.size(), 0u, min_roads_per_thread, [&](size_t i) {
+      parse_road(road_nodes[i], results[i]);
+    });
+    return results;
+  }
+
+} // namespace parser
+} // namespace opendrive
+} // namespace carla
@@ -6,6 +6,7 @@
 
 #include "carla/opendrive/parser/ProfilesParser.h"
 
+#include "carla/opendrive/parser/ParallelRoadParser.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
@@ -43,14 +44,21 @@ namespace parser {
     LateralShape shape;
   };
 
+  struct RoadProfiles {
+    std::vector<ElevationProfile> elevation_profile;
+    std::vector<LateralProfile> lateral_profile;
+  };
+
   void ProfilesParser::Parse(
       const pugi::xml_document &xml,
       carla::road::MapBuilder &map_builder) {
 
-    std::vector<ElevationProfile> elevation_profile;
-    std::vector<LateralProfile> lateral_profile;
-
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+    // parse the profiles of the roads in parallel, only looking up the roads
+    // in the map builder
+    const auto profiles_per_road = ParseRoadsInParallel<RoadProfiles>(xml,
+        [&](const pugi::xml_node &node_road, RoadProfiles &profiles) {
+      auto &elevation_profile = profiles.elevation_profile;
+      auto &lateral_profile = profiles.lateral_profile;
 
       // parse elevation profile
       pugi::xml_node node_profile = node_road.child("elevationProfile");
@@ -122,11 +130,13 @@ namespace parser {
           lateral_profile.emplace_back(lateral);
         }
       }
-    }
+    });
 
-    // map_builder calls
-    for (auto const pro : elevation_profile) {
-      map_builder.AddRoadElevationProfile(pro.road, pro.s, pro.a, pro.b, pro.c, pro.d);
+    // map_builder calls, in the order of the roads
+    for (auto const &profiles : profiles_per_road) {
+      for (auto const &pro : profiles.elevation_profile) {
+        map_builder.AddRoadElevationProfile(pro.road, pro.s, pro.a, pro.b, pro.c, pro.d);
+      }
     }
     /// @todo: RoadInfo classes must be created to fit this information
     // for (auto const pro : lateral_profile) {
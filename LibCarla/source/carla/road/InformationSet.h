@@ -9,64 +9,149 @@
 #include "carla/NonCopyable.h"
 #include "carla/road/RoadElementSet.h"
 #include "carla/road/element/RoadInfo.h"
-#include "carla/road/element/RoadInfoIterator.h"
+#include "carla/road/element/RoadInfoVisitor.h"
 
-#include <vector>
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 namespace carla {
 namespace road {
 
+  /// The infos of a road or a lane. Besides owning them all, keeps the infos
+  /// of each type in an array of their own sorted by distance, so looking up
+  /// an info of a given type is a binary search that never touches the infos
+  /// of other types.
   class InformationSet : private MovableNonCopyable {
   public:
 
     InformationSet() = default;
 
     InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
-      : _road_set(std::move(vec)) {}
+      : _road_set(std::move(vec)) {
+      Indexer indexer(_by_type);
+      for (auto &info : _road_set.GetAll()) {
+        DEBUG_ASSERT(info != nullptr);
+        indexer.Index(*info);
+      }
+    }
 
     /// Return all infos given a type from the start of the road
     template <typename T>
     std::vector<const T *> GetInfos() const {
-      std::vector<const T *> vec;
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll());
-      for (; !it.IsAtEnd(); ++it) {
-        vec.emplace_back(&*it);
-      }
-      return vec;
+      return GetInfosOfType<T>().infos;
     }
 
     /// Returns single info given a type and a distance (s) from
     /// the start of the road
     template <typename T>
     const T *GetInfo(const double s) const {
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s));
-      return it.IsAtEnd() ? nullptr : &*it;
+      const auto &infos = GetInfosOfType<T>();
+      const auto it = std::upper_bound(infos.s.begin(), infos.s.end(), s);
+      return it == infos.s.begin() ? nullptr : infos.infos[(it - infos.s.begin()) - 1];
     }
 
     /// Return all infos given a type in a given range of the road
     template <typename T>
     std::vector<const T *> GetInfos(const double min_s, const double max_s) const {
-      std::vector<const T *> vec;
-      if(min_s < max_s) {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetSubsetInRange(min_s, max_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
-        }
+      const auto &infos = GetInfosOfType<T>();
+      if (min_s < max_s) {
+        const auto first = std::lower_bound(infos.s.begin(), infos.s.end(), min_s);
+        const auto last = std::upper_bound(first, infos.s.end(), max_s);
+        return {
+            infos.infos.begin() + (first - infos.s.begin()),
+            infos.infos.begin() + (last - infos.s.begin())};
       } else {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetReverseSubsetInRange(max_s, min_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
-        }
+        const auto first = std::lower_bound(infos.s.begin(), infos.s.end(), max_s);
+        const auto last = std::upper_bound(first, infos.s.end(), min_s);
+        return {
+            std::make_reverse_iterator(infos.infos.begin() + (last - infos.s.begin())),
+            std::make_reverse_iterator(infos.infos.begin() + (first - infos.s.begin()))};
       }
-      return vec;
     }
 
   private:
 
+    /// The infos of type T in order, and their distances in a separate array
+    /// so the search runs over contiguous memory.
+    template <typename T>
+    struct InfosOfType {
+      std::vector<double> s;
+
+      std::vector<const T *> infos;
+    };
+
+    using InfosByType = std::tuple<
+        InfosOfType<element::RoadInfoElevation>,
+        InfosOfType<element::RoadInfoGeometry>,
+        InfosOfType<element::RoadInfoLane>,
+        InfosOfType<element::RoadInfoLaneAccess>,
+        InfosOfType<element::RoadInfoLaneBorder>,
+        InfosOfType<element::RoadInfoLaneHeight>,
+        InfosOfType<element::RoadInfoLaneMaterial>,
+        InfosOfType<element::RoadInfoLaneOffset>,
+        InfosOfType<element::RoadInfoLaneRule>,
+        InfosOfType<element::RoadInfoLaneVisibility>,
+        InfosOfType<element::RoadInfoLaneWidth>,
+        InfosOfType<element::RoadInfoMarkRecord>,
+        InfosOfType<element::RoadInfoMarkTypeLine>,
+        InfosOfType<element::RoadInfoSpeed>,
+        InfosOfType<element::RoadInfoCrosswalk>,
+        InfosOfType<element::RoadInfoSignal>>;
+
+    /// Appends every info it visits to the array of its type.
+    class Indexer : public element::RoadInfoVisitor {
+    public:
+
+      explicit Indexer(InfosByType &by_type) : _by_type(by_type) {}
+
+      void Index(element::RoadInfo &info) {
+        _s = info.GetDistance();
+        info.AcceptVisitor(*this);
+      }
+
+      void Visit(element::RoadInfoElevation &info) override { Add(info); }
+      void Visit(element::RoadInfoGeometry &info) override { Add(info); }
+      void Visit(element::RoadInfoLane &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneAccess &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneBorder &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneHeight &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneMaterial &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneOffset &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneRule &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneVisibility &info) override { Add(info); }
+      void Visit(element::RoadInfoLaneWidth &info) override { Add(info); }
+      void Visit(element::RoadInfoMarkRecord &info) override { Add(info); }
+      void Visit(element::RoadInfoMarkTypeLine &info) override { Add(info); }
+      void Visit(element::RoadInfoSpeed &info) override { Add(info); }
+      void Visit(element::RoadInfoCrosswalk &info) override { Add(info); }
+      void Visit(element::RoadInfoSignal &info) override { Add(info); }
+
+    private:
+
+      template <typename T>
+      void Add(T &info) {
+        auto &infos = std::get<InfosOfType<T>>(_by_type);
+        infos.s.emplace_back(_s);
+        infos.infos.emplace_back(&info);
+      }
+
+      InfosByType &_by_type;
+
+      /// Distance of the info being visited.
+      double _s = 0.0;
+    };
+
+    template <typename T>
+    const InfosOfType<T> &GetInfosOfType() const {
+      return std::get<InfosOfType<T>>(_by_type);
+    }
+
     RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set;
+
+    InfosByType _by_type;
   };
 
 } // road
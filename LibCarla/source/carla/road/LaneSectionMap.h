@@ -27,6 +27,10 @@ namespace road {
       return result;
     }
 
+    bool ContainsId(SectionId id) const {
+      return _by_id.find(id) != _by_id.end();
+    }
+
     LaneSection &GetById(SectionId id) {
       return *_by_id.at(id);
     }
@@ -6,6 +6,7 @@
 
 #include "carla/road/Map.h"
 #include "carla/Exception.h"
+#include "carla/ParallelFor.h"
 #include "carla/geom/Math.h"
 #include "carla/road/MeshFactory.h"
 #include "carla/road/element/LaneCrossingCalculator.h"
@@ -20,6 +21,7 @@
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
+#include <algorithm>
 
 namespace carla {
 namespace road {
@@ -30,6 +32,12 @@ namespace road {
   /// sections to avoid floating point precision errors.
   static constexpr double EPSILON = 10.0 * std::numeric_limits<double>::epsilon();
 
+  /// Smaller chunks of a batched query are not worth starting a thread.
+  static constexpr size_t MIN_BATCH_CHUNK_SIZE = 256u;
+
+  /// Same for the lanes split among threads to create the R-tree.
+  static constexpr size_t MIN_RTREE_CHUNK_SIZE = 16u;
+
   // ===========================================================================
   // -- Static local methods ---------------------------------------------------
   // ===========================================================================
@@ -261,10 +269,61 @@ namespace road {
     return waypoint;
   }
 
+  boost::optional<Waypoint> Map::GetWaypoint(
+      RoadId road_id,
+      SectionId section_id,
+      LaneId lane_id,
+      double s) const {
+    if (!_data.ContainsRoad(road_id)) {
+      return boost::optional<Waypoint>{};
+    }
+    const Road &road = _data.GetRoad(road_id);
+    if (s < 0.0 || s > road.GetLength() || !road.ContainsLaneSection(section_id)) {
+      return boost::optional<Waypoint>{};
+    }
+    if (!road.GetLaneSectionById(section_id).ContainsLane(lane_id)) {
+      return boost::optional<Waypoint>{};
+    }
+    return Waypoint{road_id, section_id, lane_id, s};
+  }
+
   geom::Transform Map::ComputeTransform(Waypoint waypoint) const {
     return GetLane(waypoint).ComputeTransform(waypoint.s);
   }
 
+  void Map::GetWaypoints(
+      const geom::Location *locations,
+      size_t size,
+      bool project_to_road,
+      int32_t lane_type,
+      Waypoint *waypoints,
+      geom::Transform *transforms,
+      bool *found,
+      size_t number_of_threads) const {
+    DEBUG_ASSERT((size == 0u) || ((locations != nullptr) && (waypoints != nullptr) && (found != nullptr)));
+    ParallelFor(size, number_of_threads, MIN_BATCH_CHUNK_SIZE, [&](size_t i) {
+      const auto waypoint = project_to_road ?
+          GetClosestWaypointOnRoad(locations[i], lane_type) :
+          GetWaypoint(locations[i], lane_type);
+      found[i] = waypoint.has_value();
+      waypoints[i] = waypoint.has_value() ? *waypoint : Waypoint{};
+      if (transforms != nullptr) {
+        transforms[i] = waypoint.has_value() ? ComputeTransform(*waypoint) : geom::Transform{};
+      }
+    });
+  }
+
+  void Map::ComputeTransforms(
+      const Waypoint *waypoints,
+      size_t size,
+      geom::Transform *transforms,
+      size_t number_of_threads) const {
+    DEBUG_ASSERT((size == 0u) || ((waypoints != nullptr) && (transforms != nullptr)));
+    ParallelFor(size, number_of_threads, MIN_BATCH_CHUNK_SIZE, [&](size_t i) {
+      transforms[i] = ComputeTransform(waypoints[i]);
+    });
+  }
+
   // ===========================================================================
   // -- Map: Road information --------------------------------------------------
   // ===========================================================================
@@ -896,11 +955,12 @@ namespace road {
       });
     }
 
-    // Container of segments and waypoints
-    std::vector<Rtree::TreeElement> rtree_elements;
-    // Loop through all lanes
-    for (auto &waypoint : topology) {
-      auto &lane_start_waypoint = waypoint;
+    // Segments and waypoints of each lane, the lanes are independent of each
+    // other and split among threads
+    std::vector<std::vector<Rtree::TreeElement>> lane_elements(topology.size());
+    ParallelFor(topology.size(), 0u, MIN_RTREE_CHUNK_SIZE, [&](size_t i) {
+      auto &rtree_elements = lane_elements[i];
+      auto &lane_start_waypoint = topology[i];
 
       auto current_waypoint = lane_start_waypoint;
 
@@ -916,7 +976,7 @@ namespace road {
         remaining_length -= epsilon;
         delta_s = remaining_length;
         if (delta_s < epsilon) {
-          continue;
+          return;
         }
         auto next = GetNext(current_waypoint, delta_s);
 
@@ -980,9 +1040,22 @@ namespace road {
           }
         }
       }
+    });
+
+    // Bulk load the segments of every lane into the Rtree
+    std::vector<Rtree::TreeElement> rtree_elements;
+    size_t number_of_elements = 0u;
+    for (const auto &elements : lane_elements) {
+      number_of_elements += elements.size();
+    }
+    rtree_elements.reserve(number_of_elements);
+    for (auto &elements : lane_elements) {
+      rtree_elements.insert(
+          rtree_elements.end(),
+          std::make_move_iterator(elements.begin()),
+          std::make_move_iterator(elements.end()));
     }
-    // Add segments to Rtree
-    _rtree.InsertElements(rtree_elements);
+    _rtree.SetElements(rtree_elements);
   }
 
   Junction* Map::GetJunction(JuncId id) {
@@ -62,8 +62,43 @@ namespace road {
         LaneId lane_id,
         float s) const;
 
+    /// Returns the waypoint at @a s of the lane @a lane_id in the section
+    /// @a section_id, as given, or nothing if the lane does not exist.
+    boost::optional<element::Waypoint> GetWaypoint(
+        RoadId road_id,
+        SectionId section_id,
+        LaneId lane_id,
+        double s) const;
+
     geom::Transform ComputeTransform(Waypoint waypoint) const;
 
+    /// Same as GetClosestWaypointOnRoad (or GetWaypoint if not @a
+    /// project_to_road) for each of the @a size @a locations. Writes the
+    /// waypoint of each location at the same index of @a waypoints, whether
+    /// it was found at the same index of @a found, and, unless @a transforms
+    /// is null, its transform as well. Locations without waypoint get a
+    /// default constructed waypoint and transform.
+    ///
+    /// The locations are split among @a number_of_threads threads, the
+    /// calling one included; zero uses one per hardware thread.
+    void GetWaypoints(
+        const geom::Location *locations,
+        size_t size,
+        bool project_to_road,
+        int32_t lane_type,
+        Waypoint *waypoints,
+        geom::Transform *transforms,
+        bool *found,
+        size_t number_of_threads = 0u) const;
+
+    /// ComputeTransform of each of the @a size @a waypoints, written at the
+    /// same index of @a transforms, split among threads as GetWaypoints.
+    void ComputeTransforms(
+        const Waypoint *waypoints,
+        size_t size,
+        geom::Transform *transforms,
+        size_t number_of_threads = 0u) const;
+
     /// ========================================================================
     /// -- Road information ----------------------------------------------------
     /// ========================================================================
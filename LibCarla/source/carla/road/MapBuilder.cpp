@@ -4,10 +4,12 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/ParallelFor.h"
 #include "carla/StringUtil.h"
 #include "carla/road/MapBuilder.h"
 #include "carla/road/element/RoadInfoElevation.h"
 #include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoIterator.h"
 #include "carla/road/element/RoadInfoLaneAccess.h"
 #include "carla/road/element/RoadInfoLaneBorder.h"
 #include "carla/road/element/RoadInfoLaneHeight.h"
@@ -37,6 +39,10 @@ namespace road {
 
   boost::optional<Map> MapBuilder::Build() {
 
+    // Everything below is derived from the recorded calls.
+    _image = nullptr;
+
+    CreateGeometries();
     CreatePointersBetweenRoadSegments();
     RemoveZeroLaneValiditySignalReferences();
 
@@ -78,6 +84,7 @@ namespace road {
       const double b,
       const double c,
       const double d) {
+    Record(MapImage::Op::AddRoadElevationProfile, road, s, a, b, c, d);
     DEBUG_ASSERT(road != nullptr);
     auto elevation = std::make_unique<RoadInfoElevation>(s, a, b, c, d);
     _temp_road_info_container[road].emplace_back(std::move(elevation));
@@ -96,6 +103,8 @@ namespace road {
       const double width,
       const double length,
       const std::vector<road::element::CrosswalkPoint> points) {
+    Record(MapImage::Op::AddRoadObjectCrosswalk, road, name, s, t, zOffset, hdg, pitch, roll,
+        orientation, width, length, points);
     DEBUG_ASSERT(road != nullptr);
     auto cross = std::make_unique<RoadInfoCrosswalk>(s, name, t, zOffset, hdg, pitch, roll, std::move(orientation), width, length, std::move(points));
     _temp_road_info_container[road].emplace_back(std::move(cross));
@@ -106,6 +115,7 @@ namespace road {
       Lane *lane,
       const double s,
       const std::string restriction) {
+    Record(MapImage::Op::CreateLaneAccess, lane, s, restriction);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneAccess>(s, restriction));
   }
@@ -117,6 +127,7 @@ namespace road {
       const double b,
       const double c,
       const double d) {
+    Record(MapImage::Op::CreateLaneBorder, lane, s, a, b, c, d);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneBorder>(s, a, b, c, d));
   }
@@ -126,6 +137,7 @@ namespace road {
       const double s,
       const double inner,
       const double outer) {
+    Record(MapImage::Op::CreateLaneHeight, lane, s, inner, outer);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneHeight>(s, inner, outer));
   }
@@ -136,6 +148,7 @@ namespace road {
       const std::string surface,
       const double friction,
       const double roughness) {
+    Record(MapImage::Op::CreateLaneMaterial, lane, s, surface, friction, roughness);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneMaterial>(s, surface, friction,
         roughness));
@@ -145,6 +158,7 @@ namespace road {
       Lane *lane,
       const double s,
       const std::string value) {
+    Record(MapImage::Op::CreateLaneRule, lane, s, value);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneRule>(s, value));
   }
@@ -156,6 +170,7 @@ namespace road {
       const double back,
       const double left,
       const double right) {
+    Record(MapImage::Op::CreateLaneVisibility, lane, s, forward, back, left, right);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneVisibility>(s, forward, back,
         left, right));
@@ -168,6 +183,7 @@ namespace road {
       const double b,
       const double c,
       const double d) {
+    Record(MapImage::Op::CreateLaneWidth, lane, s, a, b, c, d);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneWidth>(s, a, b, c, d));
   }
@@ -185,6 +201,8 @@ namespace road {
       const double height,
       const std::string type_name,
       const double type_width) {
+    Record(MapImage::Op::CreateRoadMark, lane, road_mark_id, s, type, weight, color, material,
+        width, lane_change, height, type_name, type_width);
     DEBUG_ASSERT(lane != nullptr);
     RoadInfoMarkRecord::LaneChange lc;
 
@@ -213,6 +231,8 @@ namespace road {
       const double s,
       const std::string rule,
       const double width) {
+    Record(MapImage::Op::CreateRoadMarkTypeLine, lane, road_mark_id, length, space, tOffset, s,
+        rule, width);
     DEBUG_ASSERT(lane != nullptr);
     auto it = MakeRoadInfoIterator<RoadInfoMarkRecord>(_temp_lane_info_container[lane]);
     for (; !it.IsAtEnd(); ++it) {
@@ -229,7 +249,8 @@ namespace road {
       Lane *lane,
       const double s,
       const double max,
-      const std::string /*unit*/) {
+      const std::string unit) {
+    Record(MapImage::Op::CreateLaneSpeed, lane, s, max, unit);
     DEBUG_ASSERT(lane != nullptr);
     _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoSpeed>(s, max));
   }
@@ -255,6 +276,8 @@ namespace road {
       const double hOffset,
       const double pitch,
       const double roll) {
+    Record(MapImage::Op::AddSignal, road, signal_id, s, t, name, dynamic, orientation, zOffset,
+        country, type, subtype, value, unit, height, width, text, hOffset, pitch, roll);
     _temp_signal_container[signal_id] = std::make_unique<Signal>(
         road->GetId(),
         signal_id,
@@ -276,7 +299,7 @@ namespace road {
         pitch,
         roll);
 
-    return AddSignalReference(road, signal_id, s, t, orientation);
+    return CreateSignalReference(road, signal_id, s, t, orientation);
   }
 
   void MapBuilder::AddSignalPositionInertial(
@@ -287,6 +310,7 @@ namespace road {
       const double hdg,
       const double pitch,
       const double roll) {
+    Record(MapImage::Op::AddSignalPositionInertial, signal_id, x, y, z, hdg, pitch, roll);
     std::unique_ptr<Signal> &signal = _temp_signal_container[signal_id];
     signal->_using_inertial_position = true;
     geom::Location location = geom::Location(x, -y, z);
@@ -305,6 +329,8 @@ namespace road {
       const double hOffset,
       const double pitch,
       const double roll) {
+    Record(MapImage::Op::AddSignalPositionRoad, signal_id, road_id, s, t, zOffset, hOffset, pitch,
+        roll);
     std::unique_ptr<Signal> &signal = _temp_signal_container[signal_id];
     signal->_road_id = road_id;
     signal->_s = s;
@@ -321,6 +347,17 @@ namespace road {
         const double s_position,
         const double t_position,
         const std::string signal_reference_orientation) {
+      Record(MapImage::Op::AddSignalReference, road, signal_id, s_position, t_position,
+          signal_reference_orientation);
+      return CreateSignalReference(road, signal_id, s_position, t_position, signal_reference_orientation);
+    }
+
+    element::RoadInfoSignal* MapBuilder::CreateSignalReference(
+        Road* road,
+        const SignId signal_id,
+        const double s_position,
+        const double t_position,
+        const std::string signal_reference_orientation) {
 
       const double epsilon = 0.00001;
       RELEASE_ASSERT(s_position >= 0.0);
@@ -338,6 +375,14 @@ namespace road {
         element::RoadInfoSignal* signal_reference,
         const LaneId from_lane,
         const LaneId to_lane) {
+      if (_image != nullptr) {
+        // The image refers to a signal reference by its order of creation.
+        const auto &references = _temp_signal_reference_container;
+        const auto it = std::find(references.rbegin(), references.rend(), signal_reference);
+        DEBUG_ASSERT(it != references.rend());
+        const auto index = static_cast<uint32_t>(std::distance(it, references.rend()) - 1);
+        _image->Record(MapImage::Op::AddValidityToSignalReference, index, from_lane, to_lane);
+      }
       signal_reference->_validities.emplace_back(LaneValidity(from_lane, to_lane));
     }
 
@@ -345,6 +390,7 @@ namespace road {
         const SignId signal_id,
         const std::string dependency_id,
         const std::string dependency_type) {
+      Record(MapImage::Op::AddDependencyToSignal, signal_id, dependency_id, dependency_type);
       _temp_signal_container[signal_id]->_dependencies.emplace_back(
           SignalDependency(dependency_id, dependency_type));
     }
@@ -358,6 +404,7 @@ namespace road {
         const RoadId predecessor,
         const RoadId successor)
     {
+      Record(MapImage::Op::AddRoad, road_id, name, length, junction_id, predecessor, successor);
 
       // add it
       auto road = &(_map_data._roads.emplace(road_id, Road()).first->second);
@@ -379,6 +426,7 @@ namespace road {
       Road *road,
       const SectionId id,
       const double s) {
+    Record(MapImage::Op::AddRoadSection, road, id, s);
     DEBUG_ASSERT(road != nullptr);
     carla::road::LaneSection &sec = road->_lane_sections.Emplace(id, s);
     sec._road = road;
@@ -392,6 +440,8 @@ namespace road {
       const bool lane_level,
       const int32_t predecessor,
       const int32_t successor) {
+    Record(MapImage::Op::AddRoadSectionLane, section, lane_id, lane_type, lane_level, predecessor,
+        successor);
     DEBUG_ASSERT(section != nullptr);
 
     // add the lane
@@ -408,6 +458,31 @@ namespace road {
     return lane;
   }
 
+  void MapBuilder::AddRoadGeometry(
+      Road *road,
+      const double s,
+      std::function<std::unique_ptr<Geometry>()> make_geometry) {
+    auto &infos = _temp_road_info_container[road];
+    _temp_geometry_container.push_back({road, infos.size(), s, std::move(make_geometry)});
+    // Left empty until the geometry is created.
+    infos.emplace_back(nullptr);
+  }
+
+  void MapBuilder::CreateGeometries() {
+    // Some geometries precompute their arc length, create them in parallel and
+    // then place each one where it was added in the infos of its road.
+    std::vector<std::unique_ptr<RoadInfo>> geometries(_temp_geometry_container.size());
+    ParallelFor(geometries.size(), 0u, 64u, [&](size_t i) {
+      auto &pending = _temp_geometry_container[i];
+      geometries[i] = std::make_unique<RoadInfoGeometry>(pending.s, pending.make_geometry());
+    });
+    for (auto i = 0u; i < geometries.size(); ++i) {
+      const auto &pending = _temp_geometry_container[i];
+      _temp_road_info_container[pending.road][pending.index] = std::move(geometries[i]);
+    }
+    _temp_geometry_container.clear();
+  }
+
   void MapBuilder::AddRoadGeometryLine(
       Road *road,
       const double s,
@@ -415,24 +490,25 @@ namespace road {
       const double y,
       const double hdg,
       const double length) {
+    Record(MapImage::Op::AddRoadGeometryLine, road, s, x, y, hdg, length);
     DEBUG_ASSERT(road != nullptr);
     const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
-    auto line_geometry = std::make_unique<GeometryLine>(
-        s,
-        length,
-        hdg,
-        location);
-
-    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
-        std::move(line_geometry))));
+    AddRoadGeometry(road, s, [=]() -> std::unique_ptr<Geometry> {
+      return std::make_unique<GeometryLine>(
+          s,
+          length,
+          hdg,
+          location);
+    });
   }
 
   void MapBuilder::CreateRoadSpeed(
       Road *road,
       const double s,
-      const std::string /*type*/,
+      const std::string type,
       const double max,
-      const std::string /*unit*/) {
+      const std::string unit) {
+    Record(MapImage::Op::CreateRoadSpeed, road, s, type, max, unit);
     DEBUG_ASSERT(road != nullptr);
     _temp_road_info_container[road].emplace_back(std::make_unique<RoadInfoSpeed>(s, max));
   }
@@ -444,6 +520,7 @@ namespace road {
       const double b,
       const double c,
       const double d) {
+    Record(MapImage::Op::CreateSectionOffset, road, s, a, b, c, d);
     DEBUG_ASSERT(road != nullptr);
     _temp_road_info_container[road].emplace_back(std::make_unique<RoadInfoLaneOffset>(s, a, b, c, d));
   }
@@ -456,17 +533,17 @@ namespace road {
       const double hdg,
       const double length,
       const double curvature) {
+    Record(MapImage::Op::AddRoadGeometryArc, road, s, x, y, hdg, length, curvature);
     DEBUG_ASSERT(road != nullptr);
     const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
-    auto arc_geometry = std::make_unique<GeometryArc>(
-        s,
-        length,
-        hdg,
-        location,
-        curvature);
-
-    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
-        std::move(arc_geometry))));
+    AddRoadGeometry(road, s, [=]() -> std::unique_ptr<Geometry> {
+      return std::make_unique<GeometryArc>(
+          s,
+          length,
+          hdg,
+          location,
+          curvature);
+    });
   }
 
   void MapBuilder::AddRoadGeometrySpiral(
@@ -478,19 +555,19 @@ namespace road {
       const double length,
       const double curvStart,
       const double curvEnd) {
+    Record(MapImage::Op::AddRoadGeometrySpiral, road, s, x, y, hdg, length, curvStart, curvEnd);
     //throw_exception(std::runtime_error("geometry spiral not supported"));
     DEBUG_ASSERT(road != nullptr);
     const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
-    auto spiral_geometry = std::make_unique<GeometrySpiral>(
-        s,
-        length,
-        hdg,
-        location,
-        curvStart,
-        curvEnd);
-
-      _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
-        std::move(spiral_geometry))));
+    AddRoadGeometry(road, s, [=]() -> std::unique_ptr<Geometry> {
+      return std::make_unique<GeometrySpiral>(
+          s,
+          length,
+          hdg,
+          location,
+          curvStart,
+          curvEnd);
+    });
   }
 
   void MapBuilder::AddRoadGeometryPoly3(
@@ -504,20 +581,21 @@ namespace road {
       const double b,
       const double c,
       const double d) {
+    Record(MapImage::Op::AddRoadGeometryPoly3, road, s, x, y, hdg, length, a, b, c, d);
     //throw_exception(std::runtime_error("geometry poly3 not supported"));
     DEBUG_ASSERT(road != nullptr);
     const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
-    auto poly3_geometry = std::make_unique<GeometryPoly3>(
-        s,
-        length,
-        hdg,
-        location,
-        a,
-        b,
-        c,
-        d);
-    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
-        std::move(poly3_geometry))));
+    AddRoadGeometry(road, s, [=]() -> std::unique_ptr<Geometry> {
+      return std::make_unique<GeometryPoly3>(
+          s,
+          length,
+          hdg,
+          location,
+          a,
+          b,
+          c,
+          d);
+    });
   }
 
   void MapBuilder::AddRoadGeometryParamPoly3(
@@ -536,6 +614,8 @@ namespace road {
       const double cV,
       const double dV,
       const std::string p_range) {
+    Record(MapImage::Op::AddRoadGeometryParamPoly3, road, s, x, y, hdg, length, aU, bU, cU, dU, aV,
+        bV, cV, dV, p_range);
     //throw_exception(std::runtime_error("geometry poly3 not supported"));
     bool arcLength;
     if(p_range == "arcLength"){
@@ -545,25 +625,26 @@ namespace road {
     }
     DEBUG_ASSERT(road != nullptr);
     const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
-    auto parampoly3_geometry = std::make_unique<GeometryParamPoly3>(
-        s,
-        length,
-        hdg,
-        location,
-        aU,
-        bU,
-        cU,
-        dU,
-        aV,
-        bV,
-        cV,
-        dV,
-        arcLength);
-    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
-        std::move(parampoly3_geometry))));
+    AddRoadGeometry(road, s, [=]() -> std::unique_ptr<Geometry> {
+      return std::make_unique<GeometryParamPoly3>(
+          s,
+          length,
+          hdg,
+          location,
+          aU,
+          bU,
+          cU,
+          dU,
+          aV,
+          bV,
+          cV,
+          dV,
+          arcLength);
+    });
   }
 
   void MapBuilder::AddJunction(const int32_t id, const std::string name) {
+    Record(MapImage::Op::AddJunction, id, name);
     _map_data.GetJunctions().emplace(id, Junction(id, name));
   }
 
@@ -572,6 +653,7 @@ namespace road {
       const ConId connection_id,
       const RoadId incoming_road,
       const RoadId connecting_road) {
+    Record(MapImage::Op::AddConnection, junction_id, connection_id, incoming_road, connecting_road);
     DEBUG_ASSERT(_map_data.GetJunction(junction_id) != nullptr);
     _map_data.GetJunction(junction_id)->GetConnections().emplace(connection_id,
         Junction::Connection(connection_id, incoming_road, connecting_road));
@@ -582,6 +664,7 @@ namespace road {
       const ConId connection_id,
       const LaneId from,
       const LaneId to) {
+    Record(MapImage::Op::AddLaneLink, junction_id, connection_id, from, to);
     DEBUG_ASSERT(_map_data.GetJunction(junction_id) != nullptr);
     _map_data.GetJunction(junction_id)->GetConnection(connection_id)->AddLaneLink(from, to);
   }
@@ -589,6 +672,7 @@ namespace road {
   void MapBuilder::AddJunctionController(
       const JuncId junction_id,
       std::set<road::ContId>&& controllers) {
+    Record(MapImage::Op::AddJunctionController, junction_id, controllers);
     DEBUG_ASSERT(_map_data.GetJunction(junction_id) != nullptr);
     _map_data.GetJunction(junction_id)->_controllers = std::move(controllers);
   }
@@ -908,6 +992,8 @@ void MapBuilder::CreateController(
   const std::string controller_name,
   const uint32_t controller_sequence,
   const std::set<road::SignId>&& signals) {
+  Record(MapImage::Op::CreateController, controller_id, controller_name, controller_sequence,
+      signals);
 
     // Add the Controller to MapData
     auto controller_pair = _map_data._controllers.emplace(
@@ -7,11 +7,13 @@
 #pragma once
 
 #include "carla/road/Map.h"
+#include "carla/road/MapImage.h"
 #include "carla/road/element/RoadInfoCrosswalk.h"
 #include "carla/road/element/RoadInfoSignal.h"
 
 #include <boost/optional.hpp>
 
+#include <functional>
 #include <map>
 
 namespace carla {
@@ -22,6 +24,12 @@ namespace road {
 
     boost::optional<Map> Build();
 
+    /// Records every following call that adds data to the map into @a image,
+    /// until the map is built.
+    void SetRecorder(MapImage *image) {
+      _image = image;
+    }
+
     // called from road parser
     carla::road::Road *AddRoad(
         const RoadId road_id,
@@ -359,13 +367,43 @@ namespace road {
 
 
     void SetGeoReference(const geom::GeoLocation &geo_reference) {
+      Record(MapImage::Op::SetGeoReference, geo_reference);
       _map_data._geo_reference = geo_reference;
     }
 
   private:
 
+    friend class MapImageLoader;
+
+    template <typename... Args>
+    void Record(MapImage::Op op, const Args &... args) {
+      if (_image != nullptr) {
+        _image->Record(op, args...);
+      }
+    }
+
+    /// Adds a signal reference without recording it.
+    element::RoadInfoSignal* CreateSignalReference(
+        Road* road,
+        const SignId signal_id,
+        const double s_position,
+        const double t_position,
+        const std::string signal_reference_orientation);
+
     MapData _map_data;
 
+    MapImage *_image = nullptr;
+
+    /// Adds a road geometry info made by @a make_geometry when the map is
+    /// built.
+    void AddRoadGeometry(
+        Road *road,
+        const double s,
+        std::function<std::unique_ptr<element::Geometry>()> make_geometry);
+
+    /// Create the geometries added to the roads.
+    void CreateGeometries();
+
     /// Create the pointers between RoadSegments based on the ids.
     void CreatePointersBetweenRoadSegments();
 
@@ -421,6 +459,17 @@ namespace road {
 
     std::vector<element::RoadInfoSignal*> _temp_signal_reference_container;
 
+    /// Geometry left to create and the position of its info in the infos of
+    /// its road.
+    struct PendingGeometry {
+      Road *road;
+      size_t index;
+      double s;
+      std::function<std::unique_ptr<element::Geometry>()> make_geometry;
+    };
+
+    std::vector<PendingGeometry> _temp_geometry_container;
+
   };
 
 } // namespace road
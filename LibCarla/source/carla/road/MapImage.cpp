@@ -0,0 +1,704 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapImage.h"
+
+#include "carla/Logging.h"
+#include "carla/road/Junction.h"
+#include "carla/road/Lane.h"
+#include "carla/road/LaneSection.h"
+#include "carla/road/MapBuilder.h"
+#include "carla/road/Road.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+
+namespace carla {
+namespace road {
+
+namespace image {
+
+  static constexpr char MAGIC[8u] = {'C', 'A', 'R', 'L', 'A', 'O', 'D', 'R'};
+  static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+  struct Header {
+    char magic[8u];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t opendrive_hash;
+    uint64_t size;
+  };
+
+  /// Reads the values written by MapImage::Write. Reading past the end of
+  /// the image marks the reader as failed and returns default values.
+  class Reader {
+  public:
+
+    Reader(const uint8_t *begin, const uint8_t *end)
+      : _it(begin),
+        _end(end) {}
+
+    bool IsGood() const {
+      return _good;
+    }
+
+    template <typename T>
+    T Read() {
+      static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Not a plain value.");
+      T value{};
+      if (Consume(sizeof(T))) {
+        std::memcpy(&value, _it - sizeof(T), sizeof(T));
+      }
+      return value;
+    }
+
+    std::string ReadString() {
+      const auto size = Read<uint32_t>();
+      if (!Consume(size)) {
+        return {};
+      }
+      return std::string(reinterpret_cast<const char *>(_it - size), size);
+    }
+
+    geom::GeoLocation ReadGeoLocation() {
+      const double latitude = Read<double>();
+      const double longitude = Read<double>();
+      const double altitude = Read<double>();
+      return {latitude, longitude, altitude};
+    }
+
+    std::vector<element::CrosswalkPoint> ReadCrosswalkPoints() {
+      const auto size = Read<uint32_t>();
+      std::vector<element::CrosswalkPoint> points;
+      for (auto i = 0u; (i < size) && _good; ++i) {
+        const double u = Read<double>();
+        const double v = Read<double>();
+        const double z = Read<double>();
+        points.emplace_back(u, v, z);
+      }
+      return points;
+    }
+
+    std::set<std::string> ReadStringSet() {
+      const auto size = Read<uint32_t>();
+      std::set<std::string> values;
+      for (auto i = 0u; (i < size) && _good; ++i) {
+        values.emplace(ReadString());
+      }
+      return values;
+    }
+
+  private:
+
+    bool Consume(size_t size) {
+      if (!_good || (static_cast<size_t>(_end - _it) < size)) {
+        _good = false;
+        return false;
+      }
+      _it += size;
+      return true;
+    }
+
+    const uint8_t *_it;
+
+    const uint8_t *_end;
+
+    bool _good = true;
+  };
+
+} // namespace image
+
+  // ===========================================================================
+  // -- MapImage ---------------------------------------------------------------
+  // ===========================================================================
+
+  uint64_t MapImage::Hash(const std::string &opendrive) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : opendrive) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+  std::string MapImage::GetFileName(const std::string &opendrive) {
+    char hash[17u];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(Hash(opendrive)));
+    return std::string("OpenDrive/") + hash + ".bin";
+  }
+
+  MapImage::MapImage(const uint64_t hash) {
+    image::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, image::MAGIC, sizeof(image::MAGIC));
+    header.version = VERSION;
+    header.byte_order = image::BYTE_ORDER_MARK;
+    header.opendrive_hash = hash;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&header);
+    _content.assign(bytes, bytes + sizeof(header));
+  }
+
+  const std::vector<uint8_t> &MapImage::Finish() {
+    if (!_finished) {
+      Write(Op::End);
+      const uint64_t size = _content.size();
+      std::memcpy(_content.data() + offsetof(image::Header, size), &size, sizeof(size));
+      _finished = true;
+    }
+    return _content;
+  }
+
+  void MapImage::Write(const std::string &value) {
+    Write(static_cast<uint32_t>(value.size()));
+    _content.insert(_content.end(), value.begin(), value.end());
+  }
+
+  void MapImage::Write(const geom::GeoLocation &value) {
+    Write(value.latitude);
+    Write(value.longitude);
+    Write(value.altitude);
+  }
+
+  void MapImage::Write(const std::vector<element::CrosswalkPoint> &points) {
+    Write(static_cast<uint32_t>(points.size()));
+    for (const auto &point : points) {
+      Write(point.u);
+      Write(point.v);
+      Write(point.z);
+    }
+  }
+
+  void MapImage::Write(const std::set<std::string> &values) {
+    Write(static_cast<uint32_t>(values.size()));
+    for (const auto &value : values) {
+      Write(value);
+    }
+  }
+
+  void MapImage::Write(const Road *road) {
+    DEBUG_ASSERT(road != nullptr);
+    Write(road->GetId());
+  }
+
+  void MapImage::Write(const LaneSection *section) {
+    DEBUG_ASSERT(section != nullptr);
+    Write(section->GetRoad());
+    Write(section->GetId());
+  }
+
+  void MapImage::Write(const Lane *lane) {
+    DEBUG_ASSERT(lane != nullptr);
+    Write(lane->GetLaneSection());
+    Write(lane->GetId());
+  }
+
+  // ===========================================================================
+  // -- MapImage: Load ---------------------------------------------------------
+  // ===========================================================================
+
+  /// Replays the calls of an image into a MapBuilder, resolving the roads,
+  /// lane sections, lanes and signal references they refer to.
+  class MapImageLoader {
+  public:
+
+    explicit MapImageLoader(image::Reader &reader) : _reader(reader) {}
+
+    boost::optional<Map> Load() {
+      using Op = MapImage::Op;
+      for (;;) {
+        const auto op = _reader.Read<Op>();
+        if (!_reader.IsGood()) {
+          return Fail("truncated");
+        }
+        if (op == Op::End) {
+          return _builder.Build();
+        }
+        if (!Replay(op)) {
+          return Fail("malformed");
+        }
+      }
+    }
+
+  private:
+
+    static boost::optional<Map> Fail(const char *reason) {
+      log_warning("OpenDRIVE map image is", reason, "and was ignored");
+      return {};
+    }
+
+    Road *ReadRoad() {
+      const auto id = _reader.Read<RoadId>();
+      if (!_reader.IsGood() || !_builder._map_data.ContainsRoad(id)) {
+        _good = false;
+        return nullptr;
+      }
+      return _builder.GetRoad(id);
+    }
+
+    LaneSection *ReadLaneSection() {
+      Road *road = ReadRoad();
+      const auto id = _reader.Read<SectionId>();
+      if (!_good || !_reader.IsGood() || !road->ContainsLaneSection(id)) {
+        _good = false;
+        return nullptr;
+      }
+      return &road->GetLaneSectionById(id);
+    }
+
+    Lane *ReadLane() {
+      LaneSection *section = ReadLaneSection();
+      const auto id = _reader.Read<LaneId>();
+      Lane *lane = (section != nullptr) && _reader.IsGood() ? section->GetLane(id) : nullptr;
+      _good = _good && (lane != nullptr);
+      return lane;
+    }
+
+    /// The builder dereferences the signals it finds by id, so only the ids
+    /// of signals already added are accepted.
+    SignId ReadSignalId() {
+      auto id = ReadString();
+      const auto &signals = _builder._temp_signal_container;
+      _good = _good && _reader.IsGood() && (signals.find(id) != signals.end());
+      return id;
+    }
+
+    Junction *ReadJunction() {
+      const auto id = _reader.Read<JuncId>();
+      Junction *junction = _reader.IsGood() ? _builder._map_data.GetJunction(id) : nullptr;
+      _good = _good && (junction != nullptr);
+      return junction;
+    }
+
+    element::RoadInfoSignal *ReadSignalReference() {
+      const auto index = _reader.Read<uint32_t>();
+      auto &references = _builder._temp_signal_reference_container;
+      if (!_reader.IsGood() || (index >= references.size())) {
+        _good = false;
+        return nullptr;
+      }
+      return references[index];
+    }
+
+    double ReadDouble() {
+      return _reader.Read<double>();
+    }
+
+    std::string ReadString() {
+      return _reader.ReadString();
+    }
+
+    bool Replay(MapImage::Op op);
+
+    image::Reader &_reader;
+
+    MapBuilder _builder;
+
+    bool _good = true;
+  };
+
+  bool MapImageLoader::Replay(const MapImage::Op op) {
+    using Op = MapImage::Op;
+    // The arguments of each call are read in order into named values, the
+    // evaluation order of function arguments is unspecified.
+    switch (op) {
+      case Op::SetGeoReference: {
+        const auto geo_reference = _reader.ReadGeoLocation();
+        _builder.SetGeoReference(geo_reference);
+        break;
+      }
+      case Op::AddRoad: {
+        const auto id = _reader.Read<RoadId>();
+        const auto name = ReadString();
+        const auto length = ReadDouble();
+        const auto junction_id = _reader.Read<JuncId>();
+        const auto predecessor = _reader.Read<RoadId>();
+        const auto successor = _reader.Read<RoadId>();
+        if (_reader.IsGood()) {
+          _builder.AddRoad(id, name, length, junction_id, predecessor, successor);
+        }
+        break;
+      }
+      case Op::AddRoadSection: {
+        auto *road = ReadRoad();
+        const auto id = _reader.Read<SectionId>();
+        const auto s = ReadDouble();
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadSection(road, id, s);
+        }
+        break;
+      }
+      case Op::AddRoadSectionLane: {
+        auto *section = ReadLaneSection();
+        const auto id = _reader.Read<LaneId>();
+        const auto type = _reader.Read<uint32_t>();
+        const auto level = _reader.Read<bool>();
+        const auto predecessor = _reader.Read<LaneId>();
+        const auto successor = _reader.Read<LaneId>();
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadSectionLane(section, id, type, level, predecessor, successor);
+        }
+        break;
+      }
+      case Op::AddRoadGeometryLine: {
+        auto *road = ReadRoad();
+        double v[5u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadGeometryLine(road, v[0u], v[1u], v[2u], v[3u], v[4u]);
+        }
+        break;
+      }
+      case Op::AddRoadGeometryArc: {
+        auto *road = ReadRoad();
+        double v[6u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadGeometryArc(road, v[0u], v[1u], v[2u], v[3u], v[4u], v[5u]);
+        }
+        break;
+      }
+      case Op::AddRoadGeometrySpiral: {
+        auto *road = ReadRoad();
+        double v[7u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadGeometrySpiral(road, v[0u], v[1u], v[2u], v[3u], v[4u], v[5u], v[6u]);
+        }
+        break;
+      }
+      case Op::AddRoadGeometryPoly3: {
+        auto *road = ReadRoad();
+        double v[9u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadGeometryPoly3(road, v[0u], v[1u], v[2u], v[3u], v[4u], v[5u], v[6u], v[7u], v[8u]);
+        }
+        break;
+      }
+      case Op::AddRoadGeometryParamPoly3: {
+        auto *road = ReadRoad();
+        double v[13u];
+        for (auto &value : v) { value = ReadDouble(); }
+        const auto p_range = ReadString();
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadGeometryParamPoly3(
+              road, v[0u], v[1u], v[2u], v[3u], v[4u], v[5u], v[6u], v[7u], v[8u], v[9u], v[10u], v[11u], v[12u],
+              p_range);
+        }
+        break;
+      }
+      case Op::AddRoadElevationProfile: {
+        auto *road = ReadRoad();
+        double v[5u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadElevationProfile(road, v[0u], v[1u], v[2u], v[3u], v[4u]);
+        }
+        break;
+      }
+      case Op::AddRoadObjectCrosswalk: {
+        auto *road = ReadRoad();
+        const auto name = ReadString();
+        double v[6u];
+        for (auto &value : v) { value = ReadDouble(); }
+        const auto orientation = ReadString();
+        const auto width = ReadDouble();
+        const auto length = ReadDouble();
+        auto points = _reader.ReadCrosswalkPoints();
+        if (_good && _reader.IsGood()) {
+          _builder.AddRoadObjectCrosswalk(
+              road, name, v[0u], v[1u], v[2u], v[3u], v[4u], v[5u], orientation, width, length, std::move(points));
+        }
+        break;
+      }
+      case Op::AddSignal: {
+        auto *road = ReadRoad();
+        const auto signal_id = ReadString();
+        const auto s = ReadDouble();
+        const auto t = ReadDouble();
+        const auto name = ReadString();
+        const auto dynamic = ReadString();
+        const auto orientation = ReadString();
+        const auto zOffset = ReadDouble();
+        const auto country = ReadString();
+        const auto type = ReadString();
+        const auto subtype = ReadString();
+        const auto value = ReadDouble();
+        const auto unit = ReadString();
+        const auto height = ReadDouble();
+        const auto width = ReadDouble();
+        const auto text = ReadString();
+        const auto hOffset = ReadDouble();
+        const auto pitch = ReadDouble();
+        const auto roll = ReadDouble();
+        if (_good && _reader.IsGood()) {
+          _builder.AddSignal(
+              road, signal_id, s, t, name, dynamic, orientation, zOffset, country, type, subtype, value, unit,
+              height, width, text, hOffset, pitch, roll);
+        }
+        break;
+      }
+      case Op::AddSignalPositionInertial: {
+        const auto signal_id = ReadSignalId();
+        double v[6u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.AddSignalPositionInertial(signal_id, v[0u], v[1u], v[2u], v[3u], v[4u], v[5u]);
+        }
+        break;
+      }
+      case Op::AddSignalPositionRoad: {
+        const auto signal_id = ReadSignalId();
+        const auto road_id = _reader.Read<RoadId>();
+        double v[6u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.AddSignalPositionRoad(signal_id, road_id, v[0u], v[1u], v[2u], v[3u], v[4u], v[5u]);
+        }
+        break;
+      }
+      case Op::AddSignalReference: {
+        auto *road = ReadRoad();
+        const auto signal_id = ReadString();
+        const auto s = ReadDouble();
+        const auto t = ReadDouble();
+        const auto orientation = ReadString();
+        if (_good && _reader.IsGood()) {
+          _builder.AddSignalReference(road, signal_id, s, t, orientation);
+        }
+        break;
+      }
+      case Op::AddValidityToSignalReference: {
+        auto *reference = ReadSignalReference();
+        const auto from = _reader.Read<LaneId>();
+        const auto to = _reader.Read<LaneId>();
+        if (_good && _reader.IsGood()) {
+          _builder.AddValidityToSignalReference(reference, from, to);
+        }
+        break;
+      }
+      case Op::AddDependencyToSignal: {
+        const auto signal_id = ReadSignalId();
+        const auto dependency_id = ReadString();
+        const auto dependency_type = ReadString();
+        if (_good && _reader.IsGood()) {
+          _builder.AddDependencyToSignal(signal_id, dependency_id, dependency_type);
+        }
+        break;
+      }
+      case Op::AddJunction: {
+        const auto id = _reader.Read<JuncId>();
+        const auto name = ReadString();
+        if (_reader.IsGood()) {
+          _builder.AddJunction(id, name);
+        }
+        break;
+      }
+      case Op::AddConnection: {
+        const auto *junction = ReadJunction();
+        const auto connection_id = _reader.Read<ConId>();
+        const auto incoming_road = _reader.Read<RoadId>();
+        const auto connecting_road = _reader.Read<RoadId>();
+        if (_good && _reader.IsGood()) {
+          _builder.AddConnection(junction->GetId(), connection_id, incoming_road, connecting_road);
+        }
+        break;
+      }
+      case Op::AddLaneLink: {
+        auto *junction = ReadJunction();
+        const auto connection_id = _reader.Read<ConId>();
+        const auto from = _reader.Read<LaneId>();
+        const auto to = _reader.Read<LaneId>();
+        _good = _good && _reader.IsGood() && (junction->GetConnection(connection_id) != nullptr);
+        if (_good) {
+          _builder.AddLaneLink(junction->GetId(), connection_id, from, to);
+        }
+        break;
+      }
+      case Op::AddJunctionController: {
+        const auto *junction = ReadJunction();
+        auto controllers = _reader.ReadStringSet();
+        if (_good && _reader.IsGood()) {
+          _builder.AddJunctionController(junction->GetId(), std::move(controllers));
+        }
+        break;
+      }
+      case Op::CreateLaneAccess: {
+        auto *lane = ReadLane();
+        const auto s = ReadDouble();
+        const auto restriction = ReadString();
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneAccess(lane, s, restriction);
+        }
+        break;
+      }
+      case Op::CreateLaneBorder: {
+        auto *lane = ReadLane();
+        double v[5u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneBorder(lane, v[0u], v[1u], v[2u], v[3u], v[4u]);
+        }
+        break;
+      }
+      case Op::CreateLaneHeight: {
+        auto *lane = ReadLane();
+        double v[3u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneHeight(lane, v[0u], v[1u], v[2u]);
+        }
+        break;
+      }
+      case Op::CreateLaneMaterial: {
+        auto *lane = ReadLane();
+        const auto s = ReadDouble();
+        const auto surface = ReadString();
+        const auto friction = ReadDouble();
+        const auto roughness = ReadDouble();
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneMaterial(lane, s, surface, friction, roughness);
+        }
+        break;
+      }
+      case Op::CreateSectionOffset: {
+        auto *road = ReadRoad();
+        double v[5u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.CreateSectionOffset(road, v[0u], v[1u], v[2u], v[3u], v[4u]);
+        }
+        break;
+      }
+      case Op::CreateLaneRule: {
+        auto *lane = ReadLane();
+        const auto s = ReadDouble();
+        const auto value = ReadString();
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneRule(lane, s, value);
+        }
+        break;
+      }
+      case Op::CreateLaneVisibility: {
+        auto *lane = ReadLane();
+        double v[5u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneVisibility(lane, v[0u], v[1u], v[2u], v[3u], v[4u]);
+        }
+        break;
+      }
+      case Op::CreateLaneWidth: {
+        auto *lane = ReadLane();
+        double v[5u];
+        for (auto &value : v) { value = ReadDouble(); }
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneWidth(lane, v[0u], v[1u], v[2u], v[3u], v[4u]);
+        }
+        break;
+      }
+      case Op::CreateRoadMark: {
+        auto *lane = ReadLane();
+        const auto road_mark_id = _reader.Read<int>();
+        const auto s = ReadDouble();
+        const auto type = ReadString();
+        const auto weight = ReadString();
+        const auto color = ReadString();
+        const auto material = ReadString();
+        const auto width = ReadDouble();
+        const auto lane_change = ReadString();
+        const auto height = ReadDouble();
+        const auto type_name = ReadString();
+        const auto type_width = ReadDouble();
+        if (_good && _reader.IsGood()) {
+          _builder.CreateRoadMark(
+              lane, road_mark_id, s, type, weight, color, material, width, lane_change, height, type_name,
+              type_width);
+        }
+        break;
+      }
+      case Op::CreateRoadMarkTypeLine: {
+        auto *lane = ReadLane();
+        const auto road_mark_id = _reader.Read<int>();
+        const auto length = ReadDouble();
+        const auto space = ReadDouble();
+        const auto tOffset = ReadDouble();
+        const auto s = ReadDouble();
+        const auto rule = ReadString();
+        const auto width = ReadDouble();
+        if (_good && _reader.IsGood()) {
+          _builder.CreateRoadMarkTypeLine(lane, road_mark_id, length, space, tOffset, s, rule, width);
+        }
+        break;
+      }
+      case Op::CreateRoadSpeed: {
+        auto *road = ReadRoad();
+        const auto s = ReadDouble();
+        const auto type = ReadString();
+        const auto max = ReadDouble();
+        const auto unit = ReadString();
+        if (_good && _reader.IsGood()) {
+          _builder.CreateRoadSpeed(road, s, type, max, unit);
+        }
+        break;
+      }
+      case Op::CreateLaneSpeed: {
+        auto *lane = ReadLane();
+        const auto s = ReadDouble();
+        const auto max = ReadDouble();
+        const auto unit = ReadString();
+        if (_good && _reader.IsGood()) {
+          _builder.CreateLaneSpeed(lane, s, max, unit);
+        }
+        break;
+      }
+      case Op::CreateController: {
+        const auto id = ReadString();
+        const auto name = ReadString();
+        const auto sequence = _reader.Read<uint32_t>();
+        const auto signals = _reader.ReadStringSet();
+        if (_reader.IsGood()) {
+          _builder.CreateController(id, name, sequence, std::move(signals));
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+    return _good && _reader.IsGood();
+  }
+
+  boost::optional<Map> MapImage::Load(const std::vector<uint8_t> &content, const uint64_t hash) {
+    image::Header header;
+    if (content.size() < sizeof(header)) {
+      return {};
+    }
+    std::memcpy(&header, content.data(), sizeof(header));
+    if ((std::memcmp(header.magic, image::MAGIC, sizeof(image::MAGIC)) != 0) ||
+        (header.version != VERSION) ||
+        (header.byte_order != image::BYTE_ORDER_MARK) ||
+        (header.opendrive_hash != hash) ||
+        (header.size != content.size())) {
+      return {};
+    }
+    image::Reader reader(content.data() + sizeof(header), content.data() + content.size());
+    // The loader checks the ids it resolves, but building the map from a
+    // corrupt image may still fail further down. Any error means the OpenDRIVE
+    // file is parsed instead.
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+      return MapImageLoader(reader).Load();
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (const std::exception &e) {
+      log_warning("OpenDRIVE map image failed to load:", e.what());
+      return {};
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+
+} // namespace road
+} // namespace carla
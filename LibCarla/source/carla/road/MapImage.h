@@ -0,0 +1,141 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/GeoLocation.h"
+#include "carla/road/Map.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/RoadInfoCrosswalk.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Lane;
+  class LaneSection;
+  class MapBuilder;
+  class Road;
+
+  /// Versioned binary image of an OpenDRIVE map. It holds, in order, every
+  /// call the OpenDRIVE parsers made to a MapBuilder with its arguments in
+  /// binary; roads, lane sections, lanes, infos, junctions, signals and
+  /// controllers. Loading an image replays the calls into a new MapBuilder
+  /// and builds the map, skipping the XML document and the parsers.
+  ///
+  /// An image is keyed by the hash of the OpenDRIVE content it was made from.
+  /// It uses the byte order of the machine that wrote it, a reader with a
+  /// different byte order, version or hash rejects it.
+  class MapImage : private NonCopyable {
+  public:
+
+    static constexpr uint32_t VERSION = 1u;
+
+    /// The calls to MapBuilder stored in an image.
+    enum class Op : uint8_t {
+      End,
+      SetGeoReference,
+      AddRoad,
+      AddRoadSection,
+      AddRoadSectionLane,
+      AddRoadGeometryLine,
+      AddRoadGeometryArc,
+      AddRoadGeometrySpiral,
+      AddRoadGeometryPoly3,
+      AddRoadGeometryParamPoly3,
+      AddRoadElevationProfile,
+      AddRoadObjectCrosswalk,
+      AddSignal,
+      AddSignalPositionInertial,
+      AddSignalPositionRoad,
+      AddSignalReference,
+      AddValidityToSignalReference,
+      AddDependencyToSignal,
+      AddJunction,
+      AddConnection,
+      AddLaneLink,
+      AddJunctionController,
+      CreateLaneAccess,
+      CreateLaneBorder,
+      CreateLaneHeight,
+      CreateLaneMaterial,
+      CreateSectionOffset,
+      CreateLaneRule,
+      CreateLaneVisibility,
+      CreateLaneWidth,
+      CreateRoadMark,
+      CreateRoadMarkTypeLine,
+      CreateRoadSpeed,
+      CreateLaneSpeed,
+      CreateController
+    };
+
+    /// 64-bit FNV-1a hash of an OpenDRIVE content.
+    static uint64_t Hash(const std::string &opendrive);
+
+    /// Relative path of the image of @a opendrive in a cache folder.
+    static std::string GetFileName(const std::string &opendrive);
+
+    /// Builds the map stored in @a image. Returns nothing if @a image is
+    /// malformed, of another version or byte order, or was made from an
+    /// OpenDRIVE content other than the one hashed to @a hash.
+    static boost::optional<Map> Load(const std::vector<uint8_t> &image, uint64_t hash);
+
+    /// Starts an empty image of the OpenDRIVE content hashed to @a hash.
+    explicit MapImage(uint64_t hash);
+
+    /// Appends a call to the image.
+    template <typename... Args>
+    void Record(Op op, const Args &... args) {
+      DEBUG_ASSERT(!_finished);
+      Write(op);
+      // Writes the arguments in order.
+      using expander = int[];
+      (void)expander{0, (Write(args), 0)...};
+    }
+
+    /// Ends the image and returns its content.
+    const std::vector<uint8_t> &Finish();
+
+  private:
+
+    template <typename T>
+    std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>
+    Write(const T &value) {
+      const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+      _content.insert(_content.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(const std::string &value);
+
+    void Write(const geom::GeoLocation &value);
+
+    void Write(const std::vector<element::CrosswalkPoint> &points);
+
+    void Write(const std::set<std::string> &values);
+
+    void Write(const Road *road);
+
+    void Write(const LaneSection *section);
+
+    void Write(const Lane *lane);
+
+    std::vector<uint8_t> _content;
+
+    bool _finished = false;
+  };
+
+} // namespace road
+} // namespace carla
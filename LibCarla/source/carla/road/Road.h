@@ -160,6 +160,10 @@ namespace road {
           iterator::make_map_values_const_iterator(pair.second));
     }
 
+    bool ContainsLaneSection(SectionId id) const {
+      return _lane_sections.ContainsId(id);
+    }
+
     LaneSection &GetLaneSectionById(SectionId id) {
       return _lane_sections.GetById(id);
     }
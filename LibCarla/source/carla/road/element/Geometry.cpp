@@ -107,16 +107,9 @@ namespace element {
   }
 
   DirectedPoint GeometryPoly3::PosFromDist(double dist) const {
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
-
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
-
-    double rate = (val2.s - dist) / (val2.s - val1.s);
-    double u = rate * val1.u + (1.0 - rate) * val2.u;
-    double v = rate * val1.v + (1.0 - rate) * val2.v;
-    double tangent = atan((rate * val1.t + (1.0 - rate) * val2.t)); // ?
+    const double u = _arc_length.GetParameter(dist);
+    const double v = _poly.Evaluate(u);
+    const double tangent = std::atan(_poly.Tangent(u));
 
     geom::Vector2D pos = RotatebyAngle(_heading, u, v);
     DirectedPoint p(_start_position, _heading + tangent);
@@ -131,50 +124,43 @@ namespace element {
     return {_start_position.x, _start_position.y};
   }
 
-  void GeometryPoly3::PreComputeSpline() {
-    // Roughly the interval size in m
-    constexpr double interval_size = 0.3;
-    const double delta_u = interval_size; // interval between values of u
+  void GeometryPoly3::PreComputeSpline(geom::ArcLengthTable::Integration integration) {
+    const bool use_chords = (integration == geom::ArcLengthTable::Integration::Chords);
+    const auto speed = [this](double u) {
+      const double t = _poly.Tangent(u);
+      return std::sqrt(1.0 + t * t);
+    };
+    // Roughly the interval size in m, the quadrature is accurate with much
+    // fewer samples than the chords.
+    const double delta_u = use_chords ? 0.3 : 2.0;
     double current_s = 0;
-    double current_u = 0;
     double last_u = 0;
-    double last_v = _poly.Evaluate(current_u);
-    double last_s = 0;
-    RtreeValue last_val{last_u, last_v, last_s, _poly.Tangent(current_u)};
+    double last_v = _poly.Evaluate(last_u);
+    _arc_length.Reserve(static_cast<size_t>(_length / delta_u) + 3u);
+    _arc_length.Add(last_u, current_s, speed(last_u));
     while (current_s < _length + delta_u) {
-      current_u += delta_u;
-      double current_v = _poly.Evaluate(current_u);
-      double du = current_u - last_u;
-      double dv = current_v - last_v;
-      double ds = sqrt(du * du + dv * dv);
-      current_s += ds;
-      double current_t = _poly.Tangent(current_u);
-      RtreeValue current_val{current_u, current_v, current_s, current_t};
-
-      Rtree::BPoint p1(static_cast<float>(last_s));
-      Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+      const double current_u = last_u + delta_u;
+      const double current_v = _poly.Evaluate(current_u);
+      if (use_chords) {
+        const double du = current_u - last_u;
+        const double dv = current_v - last_v;
+        current_s += std::sqrt(du * du + dv * dv);
+      } else {
+        current_s += geom::ArcLengthTable::GaussLegendreLength(speed, last_u, current_u);
+      }
+      _arc_length.Add(current_u, current_s, speed(current_u));
 
       last_u = current_u;
       last_v = current_v;
-      last_s = current_s;
-      last_val = current_val;
-
     }
+    _arc_length.ShrinkToFit();
   }
 
   DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
-
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
-    double rate = (val2.s - dist) / (val2.s - val1.s);
-    double u = rate * val1.u + (1.0 - rate) * val2.u;
-    double v = rate * val1.v + (1.0 - rate) * val2.v;
-    double t_u = (rate * val1.t_u + (1.0 - rate) * val2.t_u);
-    double t_v = (rate * val1.t_v + (1.0 - rate) * val2.t_v);
-    double tangent = atan2(t_v, t_u); // ?
+    const double param_p = _arc_length.GetParameter(dist);
+    const double u = _polyU.Evaluate(param_p);
+    const double v = _polyV.Evaluate(param_p);
+    const double tangent = std::atan2(_polyV.Tangent(param_p), _polyU.Tangent(param_p));
 
     geom::Vector2D pos = RotatebyAngle(_heading, u, v);
     DirectedPoint p(_start_position, _heading + tangent);
@@ -182,15 +168,23 @@ namespace element {
     p.location.y += pos.y;
     return p;
   }
+
   std::pair<float, float> GeometryParamPoly3::DistanceTo(const geom::Location &) const {
     // No analytical expression (Newton-Raphson?/point search)
     // throw_exception(std::runtime_error("not implemented"));
     return {_start_position.x, _start_position.y};
   }
 
-  void GeometryParamPoly3::PreComputeSpline() {
-    // Roughly the interval size in m
-    constexpr double interval_size = 0.5;
+  void GeometryParamPoly3::PreComputeSpline(geom::ArcLengthTable::Integration integration) {
+    const bool use_chords = (integration == geom::ArcLengthTable::Integration::Chords);
+    const auto speed = [this](double param_p) {
+      const double t_u = _polyU.Tangent(param_p);
+      const double t_v = _polyV.Tangent(param_p);
+      return std::sqrt(t_u * t_u + t_v * t_v);
+    };
+    // Roughly the interval size in m, the quadrature is accurate with much
+    // fewer samples than the chords.
+    const double interval_size = use_chords ? 0.5 : 2.0;
     size_t number_intervals =
         std::max(static_cast<size_t>(_length / interval_size), size_t(5));
     double delta_p = 1.0 / number_intervals;
@@ -201,43 +195,30 @@ namespace element {
     double current_s = 0;
     double last_u = _polyU.Evaluate(param_p);
     double last_v = _polyV.Evaluate(param_p);
-    double last_s = 0;
-    RtreeValue last_val{
-        last_u,
-        last_v,
-        last_s,
-        _polyU.Tangent(param_p),
-        _polyV.Tangent(param_p) };
+    _arc_length.Reserve(number_intervals + 1u);
+    _arc_length.Add(param_p, current_s, speed(param_p));
     for(size_t i = 0; i < number_intervals; ++i) {
+      const double last_p = param_p;
       param_p += delta_p;
       double current_u = _polyU.Evaluate(param_p);
       double current_v = _polyV.Evaluate(param_p);
-      double du = current_u - last_u;
-      double dv = current_v - last_v;
-      double ds = sqrt(du * du + dv * dv);
-      current_s += ds;
-      double current_t_u = _polyU.Tangent(param_p);
-      double current_t_v = _polyV.Tangent(param_p);
-      RtreeValue current_val{
-          current_u,
-          current_v,
-          current_s,
-          current_t_u,
-          current_t_v };
-
-      Rtree::BPoint p1(static_cast<float>(last_s));
-      Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+      if (use_chords) {
+        double du = current_u - last_u;
+        double dv = current_v - last_v;
+        current_s += std::sqrt(du * du + dv * dv);
+      } else {
+        current_s += geom::ArcLengthTable::GaussLegendreLength(speed, last_p, param_p);
+      }
+      _arc_length.Add(param_p, current_s, speed(param_p));
 
       last_u = current_u;
       last_v = current_v;
-      last_s = current_s;
-      last_val = current_val;
 
       if(current_s > _length){
         break;
       }
     }
+    _arc_length.ShrinkToFit();
   }
 } // namespace element
 } // namespace road
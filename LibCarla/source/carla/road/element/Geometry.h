@@ -6,10 +6,10 @@
 
 #pragma once
 
+#include "carla/geom/ArcLengthTable.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 #include "carla/geom/CubicPolynomial.h"
-#include "carla/geom/Rtree.h"
 
 namespace carla {
 namespace road {
@@ -204,14 +204,15 @@ namespace element {
         double a,
         double b,
         double c,
-        double d)
+        double d,
+        geom::ArcLengthTable::Integration integration = geom::ArcLengthTable::Integration::Chords)
       : Geometry(GeometryType::POLY3, start_offset, length, heading, start_pos),
         _a(a),
         _b(b),
         _c(c),
         _d(d) {
       _poly.Set(a, b, c, d);
-      PreComputeSpline();
+      PreComputeSpline(integration);
     }
 
     double Geta() const {
@@ -240,16 +241,10 @@ namespace element {
     double _c;
     double _d;
 
-    struct RtreeValue {
-      double u = 0;
-      double v = 0;
-      double s = 0;
-      double t = 0;
-    };
-    using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-    using TreeElement = Rtree::TreeElement;
-    Rtree _rtree;
-    void PreComputeSpline();
+    /// Maps the distance along the geometry to u.
+    geom::ArcLengthTable _arc_length;
+
+    void PreComputeSpline(geom::ArcLengthTable::Integration integration);
   };
 
   class GeometryParamPoly3 final : public Geometry {
@@ -268,7 +263,8 @@ namespace element {
         double bV,
         double cV,
         double dV,
-        bool arcLength)
+        bool arcLength,
+        geom::ArcLengthTable::Integration integration = geom::ArcLengthTable::Integration::Chords)
       : Geometry(GeometryType::POLY3PARAM, start_offset, length, heading, start_pos),
         _aU(aU),
         _bU(bU),
@@ -281,7 +277,7 @@ namespace element {
         _arcLength(arcLength) {
         _polyU.Set(aU, bU, cU, dU);
         _polyV.Set(aV, bV, cV, dV);
-        PreComputeSpline();
+        PreComputeSpline(integration);
     }
 
     double GetaU() const {
@@ -327,17 +323,10 @@ namespace element {
     double _dV;
     bool _arcLength;
 
-    struct RtreeValue {
-      double u = 0;
-      double v = 0;
-      double s = 0;
-      double t_u = 0;
-      double t_v = 0;
-    };
-    using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-    using TreeElement = Rtree::TreeElement;
-    Rtree _rtree;
-    void PreComputeSpline();
+    /// Maps the distance along the geometry to the parameter p.
+    geom::ArcLengthTable _arc_length;
+
+    void PreComputeSpline(geom::ArcLengthTable::Integration integration);
   };
 
 } // namespace element
@@ -38,6 +38,13 @@ namespace rpc {
       _client.async_call(function, Metadata::MakeAsync(), std::forward<Args>(args)...);
     }
 
+    /// Like call, but returns without waiting for the response; the returned
+    /// future becomes ready once it arrives.
+    template <typename... Args>
+    auto future_call(const std::string &function, Args &&... args) {
+      return _client.async_call(function, Metadata::MakeSync(), std::forward<Args>(args)...);
+    }
+
   private:
 
     ::rpc::client _client;
@@ -0,0 +1,168 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Exception.h"
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/VehicleControl.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// The controls of many vehicles, applied at once with a single call. Each
+  /// field is kept in a column of its own, and every column is sent as a
+  /// single binary blob instead of one msgpack value per field and vehicle.
+  ///
+  /// @warning The columns are sent in the byte order of the host, both ends
+  /// must have the same.
+  class VehicleControlBatch {
+  public:
+
+    VehicleControlBatch() = default;
+
+    size_t size() const {
+      return _actor_ids.size();
+    }
+
+    bool empty() const {
+      return _actor_ids.empty();
+    }
+
+    void reserve(size_t size) {
+      _actor_ids.reserve(size);
+      _throttle.reserve(size);
+      _steer.reserve(size);
+      _brake.reserve(size);
+      _flags.reserve(size);
+    }
+
+    void clear() {
+      _actor_ids.clear();
+      _throttle.clear();
+      _steer.clear();
+      _brake.clear();
+      _flags.clear();
+      _gears.clear();
+    }
+
+    void Add(ActorId actor, const VehicleControl &control) {
+      _actor_ids.emplace_back(actor);
+      _throttle.emplace_back(control.throttle);
+      _steer.emplace_back(control.steer);
+      _brake.emplace_back(control.brake);
+      _flags.emplace_back(static_cast<uint8_t>(
+          (control.hand_brake ? HAND_BRAKE : 0) |
+          (control.reverse ? REVERSE : 0) |
+          (control.manual_gear_shift ? MANUAL_GEAR_SHIFT : 0)));
+      // Gears are only stored once a vehicle uses one.
+      if ((control.gear != 0) && _gears.empty()) {
+        _gears.resize(_actor_ids.size() - 1u, 0);
+      }
+      if (!_gears.empty()) {
+        _gears.emplace_back(control.gear);
+      }
+    }
+
+    ActorId GetActorId(size_t index) const {
+      return _actor_ids[index];
+    }
+
+    VehicleControl GetControl(size_t index) const {
+      const auto flags = _flags[index];
+      return VehicleControl{
+          _throttle[index],
+          _steer[index],
+          _brake[index],
+          (flags & HAND_BRAKE) != 0u,
+          (flags & REVERSE) != 0u,
+          (flags & MANUAL_GEAR_SHIFT) != 0u,
+          _gears.empty() ? 0 : _gears[index]};
+    }
+
+    template <typename Packer>
+    void msgpack_pack(Packer &pk) const {
+      pk.pack_array(6u);
+      PackColumn(pk, _actor_ids);
+      PackColumn(pk, _throttle);
+      PackColumn(pk, _steer);
+      PackColumn(pk, _brake);
+      PackColumn(pk, _flags);
+      PackColumn(pk, _gears);
+    }
+
+    void msgpack_unpack(const clmdep_msgpack::object &o) {
+      if ((o.type != clmdep_msgpack::type::ARRAY) || (o.via.array.size != 6u)) {
+        throw_exception(clmdep_msgpack::type_error());
+      }
+      const auto *columns = o.via.array.ptr;
+      UnpackColumn(columns[0u], _actor_ids);
+      const auto count = _actor_ids.size();
+      UnpackColumn(columns[1u], _throttle, count);
+      UnpackColumn(columns[2u], _steer, count);
+      UnpackColumn(columns[3u], _brake, count);
+      UnpackColumn(columns[4u], _flags, count);
+      UnpackColumn(columns[5u], _gears);
+      if (!_gears.empty() && (_gears.size() != count)) {
+        throw_exception(clmdep_msgpack::type_error());
+      }
+    }
+
+  private:
+
+    static constexpr uint8_t HAND_BRAKE = 1u << 0u;
+
+    static constexpr uint8_t REVERSE = 1u << 1u;
+
+    static constexpr uint8_t MANUAL_GEAR_SHIFT = 1u << 2u;
+
+    template <typename Packer, typename T>
+    static void PackColumn(Packer &pk, const std::vector<T> &column) {
+      const auto size = static_cast<uint32_t>(column.size() * sizeof(T));
+      pk.pack_bin(size);
+      pk.pack_bin_body(reinterpret_cast<const char *>(column.data()), size);
+    }
+
+    template <typename T>
+    static void UnpackColumn(const clmdep_msgpack::object &o, std::vector<T> &column) {
+      if ((o.type != clmdep_msgpack::type::BIN) || (o.via.bin.size % sizeof(T) != 0u)) {
+        throw_exception(clmdep_msgpack::type_error());
+      }
+      column.resize(o.via.bin.size / sizeof(T));
+      if (!column.empty()) {
+        std::memcpy(column.data(), o.via.bin.ptr, o.via.bin.size);
+      }
+    }
+
+    template <typename T>
+    static void UnpackColumn(const clmdep_msgpack::object &o, std::vector<T> &column, size_t count) {
+      UnpackColumn(o, column);
+      if (column.size() != count) {
+        throw_exception(clmdep_msgpack::type_error());
+      }
+    }
+
+    std::vector<ActorId> _actor_ids;
+
+    std::vector<float> _throttle;
+
+    std::vector<float> _steer;
+
+    std::vector<float> _brake;
+
+    std::vector<uint8_t> _flags;
+
+    /// Empty unless some vehicle has a gear other than zero.
+    std::vector<int32_t> _gears;
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -8,9 +8,12 @@
 
 #include "carla/Logging.h"
 #include "carla/ThreadPool.h"
+#include "carla/streaming/Telemetry.h"
 #include "carla/streaming/Token.h"
 #include "carla/streaming/detail/tcp/Client.h"
+#include "carla/streaming/detail/udp/Client.h"
 #include "carla/streaming/low_level/Client.h"
+#include "carla/streaming/low_level/MultiplexedClient.h"
 
 #include <boost/asio/io_context.hpp>
 
@@ -19,15 +22,18 @@ namespace streaming {
 
   using stream_token = detail::token_type;
 
-  /// A client able to subscribe to multiple streams.
+  /// A client able to subscribe to multiple streams. The TCP streams of each
+  /// server share a single connection.
   class Client {
-    using underlying_client = low_level::Client<detail::tcp::Client>;
+    using underlying_client = low_level::MultiplexedClient;
+    using underlying_udp_client = low_level::Client<detail::udp::Client>;
   public:
 
     Client() = default;
 
     explicit Client(const std::string &fallback_address)
-      : _client(fallback_address) {}
+      : _client(fallback_address),
+        _udp_client(fallback_address) {}
 
     ~Client() {
       _service.Stop();
@@ -37,11 +43,25 @@ namespace streaming {
     /// MultiStream).
     template <typename Functor>
     void Subscribe(const Token &token, Functor &&callback) {
-      _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      if (stream_token(token).protocol_is_udp()) {
+        _udp_client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      } else {
+        _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      }
     }
 
     void UnSubscribe(const Token &token) {
       _client.UnSubscribe(token);
+      _udp_client.UnSubscribe(token);
+    }
+
+    /// Counters and latencies of every stream subscribed to so far, through
+    /// any protocol. Latencies measure from the message starting to arrive
+    /// until it is handed to the callback.
+    TelemetrySnapshot GetTelemetry() const {
+      auto snapshot = _client.GetTelemetry();
+      snapshot.Merge(_udp_client.GetTelemetry());
+      return snapshot;
     }
 
     void Run() {
@@ -54,11 +74,13 @@ namespace streaming {
 
   private:
 
-    // The order of these two arguments is very important.
+    // The order of these arguments is very important.
 
     ThreadPool _service;
 
     underlying_client _client;
+
+    underlying_udp_client _udp_client;
   };
 
 } // namespace streaming
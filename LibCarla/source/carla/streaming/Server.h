@@ -7,17 +7,27 @@
 #pragma once
 
 #include "carla/ThreadPool.h"
+#include "carla/streaming/Telemetry.h"
 #include "carla/streaming/detail/tcp/Server.h"
+#include "carla/streaming/detail/udp/Server.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/low_level/Server.h"
 
 #include <boost/asio/io_context.hpp>
+#include <boost/optional.hpp>
+
+#include <memory>
+#include <mutex>
 
 namespace carla {
 namespace streaming {
 
   /// A streaming server. Each new stream has a token associated, this token can
   /// be used by a client to subscribe to the stream.
+  ///
+  /// Streams are sent through TCP unless made with MakeUdpStream. The UDP
+  /// server listens on the same port number as the TCP one, it is started
+  /// with the first UDP stream.
   class Server {
     using underlying_server = low_level::Server<detail::tcp::Server>;
     using protocol_type = low_level::Server<detail::tcp::Server>::protocol_type;
@@ -47,12 +57,25 @@ namespace streaming {
 
     void SetTimeout(time_duration timeout) {
       _server.SetTimeout(timeout);
+      std::lock_guard<std::mutex> lock(_udp_mutex);
+      _timeout = timeout;
+      if (_udp_server != nullptr) {
+        _udp_server->SetTimeout(timeout);
+      }
     }
 
     Stream MakeStream() {
       return _server.MakeStream();
     }
 
+    /// Make a stream for small, high-rate data that can tolerate losing some
+    /// messages. Its clients receive it through UDP, so a lost message never
+    /// delays the ones after it.
+    Stream MakeUdpStream() {
+      StartUdpServer();
+      return _server.MakeUdpStream();
+    }
+
     void CloseStream(carla::streaming::detail::stream_id_type id) {
       return _server.CloseStream(id);
     }
@@ -67,6 +90,37 @@ namespace streaming {
 
     void SetSynchronousMode(bool is_synchro) {
       _server.SetSynchronousMode(is_synchro);
+      std::lock_guard<std::mutex> lock(_udp_mutex);
+      _is_synchronous = is_synchro;
+      if (_udp_server != nullptr) {
+        _udp_server->SetSynchronousMode(is_synchro);
+      }
+    }
+
+    /// Set how many messages per stream wait for a slow client, and what to
+    /// do with the ones that do not fit. Synchronous mode always blocks.
+    void SetSendQueue(size_t depth, detail::tcp::SendQueuePolicy policy) {
+      _server.SetSendQueue(depth, policy);
+    }
+
+    /// Gather the small messages, up to @a max_message_size bytes, that wait
+    /// for the same client into a single write. A small message written while
+    /// the connection is idle waits @a window for the rest of its frame. Zero
+    /// @a max_message_size disables it. Only TCP streams coalesce.
+    void SetCoalescing(size_t max_message_size, time_duration window = time_duration()) {
+      _server.SetCoalescing(max_message_size, window);
+    }
+
+    /// Counters and latencies of every stream sent so far, through any
+    /// protocol. Latencies measure from the message being written to the
+    /// stream until it is sent.
+    TelemetrySnapshot GetTelemetry() const {
+      auto snapshot = _server.GetTelemetry();
+      std::lock_guard<std::mutex> lock(_udp_mutex);
+      if (_udp_server != nullptr) {
+        snapshot.Merge(_udp_server->GetTelemetry());
+      }
+      return snapshot;
     }
 
     carla::streaming::detail::token_type GetToken(carla::streaming::detail::stream_id_type sensor_id) {
@@ -75,10 +129,38 @@ namespace streaming {
 
   private:
 
-    // The order of these two arguments is very important.
+    /// Binding the UDP port may fail, so a server without UDP streams does
+    /// not bind it at all.
+    void StartUdpServer() {
+      std::lock_guard<std::mutex> lock(_udp_mutex);
+      if (_udp_server != nullptr) {
+        return;
+      }
+      const auto ep = _server.GetLocalEndpoint();
+      auto udp_server = std::make_unique<detail::udp::Server>(
+          _pool.io_context(),
+          detail::udp::Server::endpoint(ep.address(), ep.port()));
+      if (_timeout.has_value()) {
+        udp_server->SetTimeout(*_timeout);
+      }
+      udp_server->SetSynchronousMode(_is_synchronous);
+      _server.Attach(*udp_server);
+      _udp_server = std::move(udp_server);
+    }
+
+    // The order of these arguments is very important.
 
     ThreadPool _pool;
 
+    /// Guards the UDP server and the settings it is started with.
+    mutable std::mutex _udp_mutex;
+
+    boost::optional<time_duration> _timeout;
+
+    bool _is_synchronous = false;
+
+    std::unique_ptr<detail::udp::Server> _udp_server;
+
     underlying_server _server;
   };
 
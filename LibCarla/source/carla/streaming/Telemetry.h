@@ -0,0 +1,23 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Telemetry.h"
+
+namespace carla {
+namespace streaming {
+
+  /// Counters of every stream of a server or a client, see Server::GetTelemetry
+  /// and Client::GetTelemetry.
+  using TelemetrySnapshot = detail::TelemetrySnapshot;
+
+  using StreamTelemetrySnapshot = detail::StreamTelemetrySnapshot;
+
+  using LatencySnapshot = detail::LatencySnapshot;
+
+} // namespace streaming
+} // namespace carla
@@ -35,15 +35,28 @@ namespace detail {
   }
 
   carla::streaming::Stream Dispatcher::MakeStream() {
+    return MakeStream(_cached_token._token.protocol);
+  }
+
+  carla::streaming::Stream Dispatcher::MakeUdpStream() {
+    return MakeStream(token_data::protocol::udp);
+  }
+
+  carla::streaming::Stream Dispatcher::MakeStream(const decltype(token_data::protocol) protocol) {
     std::lock_guard<std::mutex> lock(_mutex);
-    ++_cached_token._token.stream_id; // id zero only happens in overflow.
+    // Id zero is reserved for multiplexed sessions, skip it on overflow.
+    if (++_cached_token._token.stream_id == 0u) {
+      ++_cached_token._token.stream_id;
+    }
     log_debug("New stream:", _cached_token._token.stream_id);
+    token_type token = _cached_token;
+    token._token.protocol = protocol;
     std::shared_ptr<MultiStreamState> ptr;
-    auto search = _stream_map.find(_cached_token.get_stream_id());
+    auto search = _stream_map.find(token.get_stream_id());
     if (search == _stream_map.end()) {
       // creating new stream
-      ptr = std::make_shared<MultiStreamState>(_cached_token);
-      auto result = _stream_map.emplace(std::make_pair(_cached_token.get_stream_id(), ptr));
+      ptr = std::make_shared<MultiStreamState>(token);
+      auto result = _stream_map.emplace(std::make_pair(token.get_stream_id(), ptr));
       if (!result.second) {
         throw_exception(std::runtime_error("failed to create stream!"));
       }
@@ -35,6 +35,10 @@ namespace detail {
 
     carla::streaming::Stream MakeStream();
 
+    /// Like MakeStream, but the token of the stream asks the clients to
+    /// subscribe through UDP.
+    carla::streaming::Stream MakeUdpStream();
+
     void CloseStream(carla::streaming::detail::stream_id_type id);
 
     bool RegisterSession(std::shared_ptr<Session> session);
@@ -45,6 +49,8 @@ namespace detail {
 
   private:
 
+    carla::streaming::Stream MakeStream(decltype(token_data::protocol) protocol);
+
     // We use a mutex here, but we assume that sessions and streams won't be
     // created too often.
     std::mutex _mutex;
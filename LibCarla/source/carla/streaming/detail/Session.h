@@ -6,13 +6,48 @@
 
 #pragma once
 
-#include "carla/streaming/detail/tcp/ServerSession.h"
+#include "carla/NonCopyable.h"
+#include "carla/TypeTraits.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Message.h"
+
+#include <memory>
 
 namespace carla {
 namespace streaming {
 namespace detail {
 
-  using Session = tcp::ServerSession;
+  /// A server session subscribed to a single stream, regardless of the
+  /// protocol it uses to send the data to its client.
+  class Session : private NonCopyable {
+  public:
+
+    virtual ~Session() = default;
+
+    /// @warning This function should only be called after the session is
+    /// opened.
+    virtual stream_id_type get_stream_id() const = 0;
+
+    template <typename... Buffers>
+    static auto MakeMessage(Buffers &&... buffers) {
+      static_assert(
+          are_same<Buffer, Buffers...>::value,
+          "This function only accepts arguments of type Buffer.");
+      return std::make_shared<const tcp::Message>(std::move(buffers)...);
+    }
+
+    /// Writes some data to the client.
+    virtual void Write(std::shared_ptr<const tcp::Message> message) = 0;
+
+    /// Writes some data to the client.
+    template <typename... Buffers>
+    void Write(Buffers &&... buffers) {
+      Write(MakeMessage(std::move(buffers)...));
+    }
+
+    /// Post a job to close the session.
+    virtual void Close() = 0;
+  };
 
 } // namespace detail
 } // namespace streaming
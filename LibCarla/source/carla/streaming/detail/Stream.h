@@ -46,6 +46,11 @@ namespace detail {
       return _shared_state->MakeBuffer();
     }
 
+    /// Pull a buffer able to hold @a size bytes without allocating.
+    Buffer MakeBuffer(size_t size) {
+      return _shared_state->MakeBuffer(size);
+    }
+
     /// Flush @a buffers down the stream. No copies are made.
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
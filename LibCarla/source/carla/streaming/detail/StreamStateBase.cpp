@@ -22,6 +22,10 @@ namespace detail {
     return _buffer_pool->Pop();
   }
 
+  Buffer StreamStateBase::MakeBuffer(const size_t size) {
+    return _buffer_pool->Pop(size);
+  }
+
 } // namespace detail
 } // namespace streaming
 } // namespace carla
@@ -32,8 +32,11 @@ namespace detail {
       return _token;
     }
 
+    /// A buffer sized like the last one written to this stream.
     Buffer MakeBuffer();
 
+    Buffer MakeBuffer(size_t size);
+
     virtual void ConnectSession(std::shared_ptr<Session> session) = 0;
 
     virtual void DisconnectSession(std::shared_ptr<Session> session) = 0;
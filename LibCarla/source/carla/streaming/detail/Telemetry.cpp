@@ -0,0 +1,173 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/Telemetry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  // ===========================================================================
+  // -- LatencyHistogram -------------------------------------------------------
+  // ===========================================================================
+
+  constexpr size_t LatencyHistogram::SUB_BUCKET_BITS;
+  constexpr size_t LatencyHistogram::SUB_BUCKET_COUNT;
+  constexpr size_t LatencyHistogram::BUCKET_COUNT;
+
+  static size_t GetMostSignificantBit(uint64_t value) {
+    size_t bit = 0u;
+    while (value >>= 1u) {
+      ++bit;
+    }
+    return bit;
+  }
+
+  LatencyHistogram::LatencyHistogram() {
+    for (auto &bucket : _buckets) {
+      bucket.store(0u, std::memory_order_relaxed);
+    }
+  }
+
+  size_t LatencyHistogram::GetBucket(const uint64_t value) {
+    if (value < 2u * SUB_BUCKET_COUNT) {
+      return static_cast<size_t>(value);
+    }
+    // The bits after the most significant one select the sub-bucket.
+    const size_t magnitude = GetMostSignificantBit(value);
+    const size_t shift = magnitude - SUB_BUCKET_BITS;
+    const size_t sub_bucket = static_cast<size_t>(value >> shift) - SUB_BUCKET_COUNT;
+    return (shift + 1u) * SUB_BUCKET_COUNT + sub_bucket;
+  }
+
+  uint64_t LatencyHistogram::GetBucketUpperBound(const size_t index) {
+    if (index < 2u * SUB_BUCKET_COUNT) {
+      return index;
+    }
+    const size_t shift = index / SUB_BUCKET_COUNT - 1u;
+    const uint64_t lower = uint64_t(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+    return lower + ((uint64_t(1u) << shift) - 1u);
+  }
+
+  void LatencyHistogram::Record(const uint64_t microseconds) {
+    _buckets[GetBucket(microseconds)].fetch_add(1u, std::memory_order_relaxed);
+    _count.fetch_add(1u, std::memory_order_relaxed);
+    _sum.fetch_add(microseconds, std::memory_order_relaxed);
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while ((microseconds > max) &&
+           !_max.compare_exchange_weak(max, microseconds, std::memory_order_relaxed)) {}
+  }
+
+  LatencySnapshot LatencyHistogram::Snapshot() const {
+    // Buckets are read one by one while others may be recording, so the
+    // result is as consistent as the counters are at the time.
+    std::array<uint64_t, BUCKET_COUNT> buckets;
+    uint64_t count = 0u;
+    for (auto i = 0u; i < BUCKET_COUNT; ++i) {
+      buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+      count += buckets[i];
+    }
+
+    LatencySnapshot snapshot;
+    snapshot.count = count;
+    if (count == 0u) {
+      return snapshot;
+    }
+    snapshot.max = _max.load(std::memory_order_relaxed);
+    snapshot.mean = static_cast<double>(_sum.load(std::memory_order_relaxed)) /
+        static_cast<double>(std::max(count, _count.load(std::memory_order_relaxed)));
+
+    auto percentile = [&](const double fraction) {
+      const auto rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+      uint64_t seen = 0u;
+      for (auto i = 0u; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= std::max<uint64_t>(rank, 1u)) {
+          return std::min(GetBucketUpperBound(i), snapshot.max);
+        }
+      }
+      return snapshot.max;
+    };
+    snapshot.p50 = percentile(0.5);
+    snapshot.p90 = percentile(0.9);
+    snapshot.p99 = percentile(0.99);
+    snapshot.p999 = percentile(0.999);
+    return snapshot;
+  }
+
+  // ===========================================================================
+  // -- Telemetry --------------------------------------------------------------
+  // ===========================================================================
+
+  std::shared_ptr<StreamTelemetry> Telemetry::GetStream(const stream_id_type stream_id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto &stream = _streams[stream_id];
+    if (stream == nullptr) {
+      stream = std::make_shared<StreamTelemetry>();
+    }
+    return stream;
+  }
+
+  TelemetrySnapshot Telemetry::Snapshot() const {
+    TelemetrySnapshot snapshot;
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &item : _streams) {
+      const StreamTelemetry &stream = *item.second;
+      auto &result = snapshot.streams[item.first];
+      result.messages = stream.messages.load(std::memory_order_relaxed);
+      result.bytes = stream.bytes.load(std::memory_order_relaxed);
+      result.dropped_messages = stream.dropped_messages.load(std::memory_order_relaxed);
+      result.dropped_bytes = stream.dropped_bytes.load(std::memory_order_relaxed);
+      result.queued_bytes = stream.queued_bytes.load(std::memory_order_relaxed);
+      result.stalled_bytes = stream.stalled_bytes.load(std::memory_order_relaxed);
+      result.reconnects = stream.reconnects.load(std::memory_order_relaxed);
+      result.latency = stream.latency.Snapshot();
+    }
+    return snapshot;
+  }
+
+  // ===========================================================================
+  // -- TelemetrySnapshot ------------------------------------------------------
+  // ===========================================================================
+
+  std::string TelemetrySnapshot::ToJson() const {
+    std::ostringstream out;
+    out << "{\"streams\":{";
+    bool first = true;
+    for (auto &item : streams) {
+      const auto &stream = item.second;
+      const auto &latency = stream.latency;
+      out << (first ? "" : ",")
+          << '"' << item.first << "\":{"
+          << "\"messages\":" << stream.messages
+          << ",\"bytes\":" << stream.bytes
+          << ",\"dropped_messages\":" << stream.dropped_messages
+          << ",\"dropped_bytes\":" << stream.dropped_bytes
+          << ",\"queued_bytes\":" << stream.queued_bytes
+          << ",\"stalled_bytes\":" << stream.stalled_bytes
+          << ",\"reconnects\":" << stream.reconnects
+          << ",\"latency_us\":{"
+          << "\"count\":" << latency.count
+          << ",\"mean\":" << latency.mean
+          << ",\"max\":" << latency.max
+          << ",\"p50\":" << latency.p50
+          << ",\"p90\":" << latency.p90
+          << ",\"p99\":" << latency.p99
+          << ",\"p999\":" << latency.p999
+          << "}}";
+      first = false;
+    }
+    out << "}}";
+    return out.str();
+  }
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,165 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  using telemetry_clock = std::chrono::steady_clock;
+
+  /// Percentiles of a LatencyHistogram, in microseconds.
+  struct LatencySnapshot {
+    uint64_t count = 0u;
+    double mean = 0.0;
+    uint64_t max = 0u;
+    uint64_t p50 = 0u;
+    uint64_t p90 = 0u;
+    uint64_t p99 = 0u;
+    uint64_t p999 = 0u;
+  };
+
+  /// Histogram of latencies in microseconds. As in HDR histograms, buckets
+  /// are linear within each power of two, so every value is recorded with a
+  /// relative error below 1/SUB_BUCKET_COUNT whatever its magnitude.
+  /// Recording is lock-free and may be done from any thread.
+  class LatencyHistogram : private NonCopyable {
+  public:
+
+    static constexpr size_t SUB_BUCKET_BITS = 4u;
+
+    static constexpr size_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+
+    /// Values below 2 * SUB_BUCKET_COUNT are exact, the rest of the powers of
+    /// two of a 64-bit value take SUB_BUCKET_COUNT buckets each.
+    static constexpr size_t BUCKET_COUNT = (64u - SUB_BUCKET_BITS + 1u) * SUB_BUCKET_COUNT;
+
+    LatencyHistogram();
+
+    void Record(uint64_t microseconds);
+
+    void Record(telemetry_clock::time_point start, telemetry_clock::time_point end) {
+      const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+      Record(elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0u);
+    }
+
+    LatencySnapshot Snapshot() const;
+
+    static size_t GetBucket(uint64_t value);
+
+    /// Highest value that falls in the bucket @a index.
+    static uint64_t GetBucketUpperBound(size_t index);
+
+  private:
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> _buckets;
+
+    std::atomic<uint64_t> _count{0u};
+
+    std::atomic<uint64_t> _sum{0u};
+
+    std::atomic<uint64_t> _max{0u};
+  };
+
+  /// Counters of a stream, on either side of the connection.
+  ///
+  /// On the server @a latency is the time from a message being written to the
+  /// stream until it is sent. On the client, from the first byte of a message
+  /// arriving until it is handed to the callback.
+  struct StreamTelemetry : private NonCopyable {
+    std::atomic<uint64_t> messages{0u};
+
+    std::atomic<uint64_t> bytes{0u};
+
+    std::atomic<uint64_t> dropped_messages{0u};
+
+    std::atomic<uint64_t> dropped_bytes{0u};
+
+    /// Bytes that had to wait in a send queue (server only).
+    std::atomic<uint64_t> queued_bytes{0u};
+
+    /// Bytes whose writer blocked waiting for room in a send queue (server
+    /// only).
+    std::atomic<uint64_t> stalled_bytes{0u};
+
+    /// Times the connection had to be opened again (client only).
+    std::atomic<uint64_t> reconnects{0u};
+
+    LatencyHistogram latency;
+
+    static void Add(std::atomic<uint64_t> &counter, uint64_t value) {
+      counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void CountMessage(size_t size) {
+      Add(messages, 1u);
+      Add(bytes, size);
+    }
+
+    void CountDropped(size_t size) {
+      Add(dropped_messages, 1u);
+      Add(dropped_bytes, size);
+    }
+  };
+
+  struct StreamTelemetrySnapshot {
+    uint64_t messages = 0u;
+    uint64_t bytes = 0u;
+    uint64_t dropped_messages = 0u;
+    uint64_t dropped_bytes = 0u;
+    uint64_t queued_bytes = 0u;
+    uint64_t stalled_bytes = 0u;
+    uint64_t reconnects = 0u;
+    LatencySnapshot latency;
+  };
+
+  struct TelemetrySnapshot {
+    std::map<stream_id_type, StreamTelemetrySnapshot> streams;
+
+    /// Adds the streams of @a other, replacing the ones with the same id.
+    void Merge(const TelemetrySnapshot &other) {
+      for (auto &item : other.streams) {
+        streams[item.first] = item.second;
+      }
+    }
+
+    std::string ToJson() const;
+  };
+
+  /// The StreamTelemetry of every stream seen by a server or a client. Looking
+  /// a stream up takes a lock, so the users keep the pointer they get.
+  class Telemetry : private NonCopyable {
+  public:
+
+    /// Returns the counters of @a stream_id, created on first use.
+    std::shared_ptr<StreamTelemetry> GetStream(stream_id_type stream_id);
+
+    TelemetrySnapshot Snapshot() const;
+
+  private:
+
+    mutable std::mutex _mutex;
+
+    std::unordered_map<stream_id_type, std::shared_ptr<StreamTelemetry>> _streams;
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
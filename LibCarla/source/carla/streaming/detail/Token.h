@@ -29,7 +29,8 @@ namespace detail {
     enum class protocol : uint8_t {
       not_set,
       tcp,
-      udp
+      udp,
+      shm
     } protocol = protocol::not_set;
 
     enum class address : uint8_t {
@@ -0,0 +1,157 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Ring.h"
+
+#include "carla/Debug.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "Frame states must be lock-free to be shared between processes.");
+
+  static constexpr char RING_MAGIC[8u] = {'C', 'A', 'R', 'L', 'A', 'S', 'H', 'M'};
+
+  static constexpr uint32_t RING_VERSION = 1u;
+
+  /// Frames start at multiples of this, so payloads are aligned for any type.
+  static constexpr uint64_t FRAME_ALIGNMENT = 64u;
+
+  struct RingHeader {
+    char magic[8u];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t capacity;
+  };
+
+  struct FrameHeader {
+    enum State : uint32_t {
+      IN_USE,
+      RELEASED
+    };
+
+    std::atomic<uint32_t> state;
+
+    /// Bytes from this frame to the next one, header included.
+    uint64_t span;
+  };
+
+  static_assert(sizeof(RingHeader) <= FRAME_ALIGNMENT, "Ring header too big.");
+  static_assert(sizeof(FrameHeader) <= FRAME_ALIGNMENT, "Frame header too big.");
+
+  static constexpr uint64_t Align(const uint64_t size) {
+    return (size + FRAME_ALIGNMENT - 1u) & ~(FRAME_ALIGNMENT - 1u);
+  }
+
+  static FrameHeader &GetFrame(uint8_t *frames, const uint64_t offset) {
+    return *reinterpret_cast<FrameHeader *>(frames + offset);
+  }
+
+  std::unique_ptr<Ring> Ring::Create(const size_t capacity) {
+    const uint64_t aligned_capacity = capacity & ~(FRAME_ALIGNMENT - 1u);
+    auto segment = Segment::Create(FRAME_ALIGNMENT + aligned_capacity);
+    if (segment == nullptr) {
+      return nullptr;
+    }
+    RingHeader header;
+    std::memcpy(header.magic, RING_MAGIC, sizeof(RING_MAGIC));
+    header.version = RING_VERSION;
+    header.reserved = 0u;
+    header.capacity = aligned_capacity;
+    std::memcpy(segment->data(), &header, sizeof(header));
+    return std::unique_ptr<Ring>(new Ring(std::move(segment), aligned_capacity));
+  }
+
+  std::unique_ptr<Ring> Ring::Open(const std::string &name) {
+    auto segment = Segment::Open(name);
+    if ((segment == nullptr) || (segment->size() < FRAME_ALIGNMENT)) {
+      return nullptr;
+    }
+    RingHeader header;
+    std::memcpy(&header, segment->data(), sizeof(header));
+    if ((std::memcmp(header.magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0) ||
+        (header.version != RING_VERSION) ||
+        (header.capacity % FRAME_ALIGNMENT != 0u) ||
+        (header.capacity > segment->size() - FRAME_ALIGNMENT)) {
+      return nullptr;
+    }
+    return std::unique_ptr<Ring>(new Ring(std::move(segment), header.capacity));
+  }
+
+  Ring::Ring(std::shared_ptr<Segment> segment, const size_t capacity)
+    : _segment(std::move(segment)),
+      _frames(_segment->data() + FRAME_ALIGNMENT),
+      _capacity(capacity) {}
+
+  uint8_t *Ring::Allocate(const message_size_type size, Doorbell &doorbell) {
+    const uint64_t span = Align(FRAME_ALIGNMENT + size);
+    if (span > _capacity) {
+      return nullptr;
+    }
+    Reclaim();
+
+    // Frames never wrap around, a frame that does not fit before the end of
+    // the ring is placed at the beginning and the gap is left as released.
+    uint64_t offset = _head % _capacity;
+    const uint64_t padding = (offset + span > _capacity) ? _capacity - offset : 0u;
+    if ((_head - _tail) + padding + span > _capacity) {
+      return nullptr;
+    }
+    if (padding > 0u) {
+      FrameHeader *gap = new (_frames + offset) FrameHeader;
+      gap->span = padding;
+      gap->state.store(FrameHeader::RELEASED, std::memory_order_relaxed);
+      _head += padding;
+      offset = 0u;
+    }
+
+    FrameHeader *frame = new (_frames + offset) FrameHeader;
+    frame->span = span;
+    frame->state.store(FrameHeader::IN_USE, std::memory_order_relaxed);
+    _head += span;
+
+    doorbell.offset = offset;
+    doorbell.size = size;
+    return _frames + offset + FRAME_ALIGNMENT;
+  }
+
+  void Ring::Reclaim() {
+    while (_tail != _head) {
+      FrameHeader &frame = GetFrame(_frames, _tail % _capacity);
+      if (frame.state.load(std::memory_order_acquire) != FrameHeader::RELEASED) {
+        break;
+      }
+      _tail += frame.span;
+    }
+  }
+
+  Buffer Ring::View(const Doorbell &doorbell) const {
+    if ((doorbell.offset % FRAME_ALIGNMENT != 0u) ||
+        (doorbell.offset >= _capacity) ||
+        (_capacity - doorbell.offset < FRAME_ALIGNMENT + uint64_t(doorbell.size))) {
+      return Buffer();
+    }
+    FrameHeader &frame = GetFrame(_frames, doorbell.offset);
+
+    // The release is what hands the frame back to the server, and the lease
+    // keeps the segment mapped until then.
+    auto segment = _segment;
+    std::shared_ptr<const void> lease(&frame, [segment](FrameHeader *released) {
+      released->state.store(FrameHeader::RELEASED, std::memory_order_release);
+    });
+    return Buffer::MakeView(_frames + doorbell.offset + FRAME_ALIGNMENT, doorbell.size, std::move(lease));
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,94 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/shm/Segment.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+#pragma pack(push, 1)
+
+  /// Sent through the socket of a shared memory session for every message.
+  /// It points at the frame in the ring holding the message, or tells that
+  /// the message follows inline in the socket because the ring was full.
+  struct Doorbell {
+    static constexpr uint64_t INLINE_MESSAGE = (std::numeric_limits<uint64_t>::max)();
+
+    uint64_t offset = INLINE_MESSAGE;
+
+    message_size_type size = 0u;
+  };
+
+#pragma pack(pop)
+
+  /// Ring of variable size frames in a shared memory Segment, written by a
+  /// server session and read in place by its client.
+  ///
+  /// The server allocates frames in order. The client views every frame
+  /// without copying it, and releases it once the last Buffer viewing it is
+  /// destroyed. The server reuses the space of released frames oldest first,
+  /// so a frame that the client keeps alive holds back the ones after it.
+  class Ring : private NonCopyable {
+  public:
+
+    static constexpr size_t DEFAULT_CAPACITY = 32u << 20u;
+
+    /// Creates a segment holding an empty ring of @a capacity bytes. Returns
+    /// nullptr on failure.
+    static std::unique_ptr<Ring> Create(size_t capacity = DEFAULT_CAPACITY);
+
+    /// Maps the ring created by the other end of the session. Returns nullptr
+    /// if it cannot be mapped or is not a ring of this version.
+    static std::unique_ptr<Ring> Open(const std::string &name);
+
+    const std::string &name() const {
+      return _segment->name();
+    }
+
+    /// Reserves a frame for a message of @a size bytes and returns a pointer
+    /// to its payload, or nullptr if there is no room for it. The offset to
+    /// send in the doorbell is written to @a doorbell.
+    uint8_t *Allocate(message_size_type size, Doorbell &doorbell);
+
+    /// Returns a buffer viewing the frame pointed at by @a doorbell, which
+    /// releases the frame on destruction. Returns an empty buffer if the
+    /// doorbell does not point at a frame of this ring.
+    Buffer View(const Doorbell &doorbell) const;
+
+  private:
+
+    Ring(std::shared_ptr<Segment> segment, size_t capacity);
+
+    void Reclaim();
+
+    const std::shared_ptr<Segment> _segment;
+
+    uint8_t *const _frames;
+
+    const uint64_t _capacity;
+
+    /// Server side only, positions grow without wrapping around.
+    uint64_t _head = 0u;
+
+    uint64_t _tail = 0u;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
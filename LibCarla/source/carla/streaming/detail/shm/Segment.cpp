@@ -0,0 +1,121 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Segment.h"
+
+#include "carla/Logging.h"
+
+#include <atomic>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif // __linux__
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+#ifdef __linux__
+
+  // Files in the tmpfs mount are plain shared memory, and opening them does
+  // not need librt as shm_open does on older systems.
+  static const std::string SEGMENT_DIRECTORY = "/dev/shm/";
+
+  static std::atomic_size_t SEGMENT_COUNTER{0u};
+
+  bool Segment::IsSupported() {
+    return ::access(SEGMENT_DIRECTORY.c_str(), W_OK) == 0;
+  }
+
+  std::shared_ptr<Segment> Segment::Create(const size_t size) {
+    std::string name =
+        "carla-stream-" + std::to_string(::getpid()) + "-" + std::to_string(SEGMENT_COUNTER++);
+    const std::string path = SEGMENT_DIRECTORY + name;
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+      log_warning("shared memory: failed to create", path);
+      return nullptr;
+    }
+    void *data = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+      data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      log_warning("shared memory: failed to map", path);
+      ::unlink(path.c_str());
+      return nullptr;
+    }
+    return std::shared_ptr<Segment>(
+        new Segment(std::move(name), static_cast<uint8_t *>(data), size, true));
+  }
+
+  std::shared_ptr<Segment> Segment::Open(const std::string &name) {
+    // Only names made by Create are accepted, never a path.
+    if (name.empty() || name.find('/') != std::string::npos) {
+      return nullptr;
+    }
+    const std::string path = SEGMENT_DIRECTORY + name;
+
+    const int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+      log_warning("shared memory: failed to open", path);
+      return nullptr;
+    }
+    void *data = MAP_FAILED;
+    struct stat status;
+    if ((::fstat(fd, &status) == 0) && (status.st_size > 0)) {
+      data = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      log_warning("shared memory: failed to map", path);
+      return nullptr;
+    }
+    return std::shared_ptr<Segment>(
+        new Segment(name, static_cast<uint8_t *>(data), static_cast<size_t>(status.st_size), false));
+  }
+
+  Segment::~Segment() {
+    ::munmap(_data, _size);
+    if (_is_owner) {
+      ::unlink((SEGMENT_DIRECTORY + _name).c_str());
+    }
+  }
+
+#else
+
+  bool Segment::IsSupported() {
+    return false;
+  }
+
+  std::shared_ptr<Segment> Segment::Create(size_t) {
+    return nullptr;
+  }
+
+  std::shared_ptr<Segment> Segment::Open(const std::string &) {
+    return nullptr;
+  }
+
+  Segment::~Segment() = default;
+
+#endif // __linux__
+
+  Segment::Segment(std::string name, uint8_t *data, const size_t size, const bool is_owner)
+    : _name(std::move(name)),
+      _data(data),
+      _size(size),
+      _is_owner(is_owner) {}
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
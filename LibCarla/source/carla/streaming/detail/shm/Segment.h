@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// A named block of memory shared between processes on the same host,
+  /// mapped read-write. The process that creates the segment removes its
+  /// name on destruction, the memory itself lives until every process has
+  /// unmapped it.
+  class Segment : private NonCopyable {
+  public:
+
+    /// Whether shared memory segments are available on this platform.
+    static bool IsSupported();
+
+    /// Creates and maps a new segment of @a size bytes. Returns nullptr on
+    /// failure.
+    static std::shared_ptr<Segment> Create(size_t size);
+
+    /// Maps the existing segment named @a name. Returns nullptr on failure.
+    static std::shared_ptr<Segment> Open(const std::string &name);
+
+    ~Segment();
+
+    const std::string &name() const {
+      return _name;
+    }
+
+    uint8_t *data() const {
+      return _data;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+  private:
+
+    Segment(std::string name, uint8_t *data, size_t size, bool is_owner);
+
+    const std::string _name;
+
+    uint8_t *const _data;
+
+    const size_t _size;
+
+    const bool _is_owner;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,46 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// A multiplexed session sends a batch of coalesced messages as a single
+  /// message of the stream MULTIPLEXED_STREAM_ID. Its payload is a sequence of
+  /// entries, each one a BatchEntryHeader followed by the message and padded
+  /// to BATCH_ALIGNMENT, so every message starts aligned in the buffer the
+  /// client reads the batch into.
+  static constexpr size_t BATCH_ALIGNMENT = 8u;
+
+#pragma pack(push, 1)
+
+  struct BatchEntryHeader {
+    stream_id_type stream_id = 0u;
+
+    message_size_type size = 0u;
+  };
+
+#pragma pack(pop)
+
+  static_assert(sizeof(BatchEntryHeader) % BATCH_ALIGNMENT == 0u, "Misaligned batch entry.");
+
+  /// Bytes of padding after a message of @a size bytes in a batch.
+  static constexpr size_t GetBatchPadding(size_t size) {
+    return (BATCH_ALIGNMENT - (size % BATCH_ALIGNMENT)) % BATCH_ALIGNMENT;
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
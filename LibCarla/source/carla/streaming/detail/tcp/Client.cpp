@@ -11,6 +11,7 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/tcp/Batch.h"
 
 #include <boost/asio/connect.hpp>
 #include <boost/asio/read.hpp>
@@ -18,7 +19,12 @@
 #include <boost/asio/post.hpp>
 #include <boost/asio/bind_executor.hpp>
 
+#include <array>
+#include <cstring>
 #include <exception>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -30,18 +36,42 @@ namespace tcp {
   // ===========================================================================
 
   /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// a single buffer, taken from @a pool once its size is known.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    IncomingMessage(std::shared_ptr<BufferPool> pool, stream_id_type stream_id)
+      : _pool(std::move(pool)),
+        _stream_id(stream_id) {}
 
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
     }
 
+    /// The stream id, only sent by multiplexed sessions, and the size.
+    std::array<boost::asio::mutable_buffer, 2u> header(bool is_multiplexed) {
+      return {
+          boost::asio::buffer(&_stream_id, is_multiplexed ? sizeof(_stream_id) : 0u),
+          size_as_buffer()};
+    }
+
+    auto stream_id() const {
+      return _stream_id;
+    }
+
+    /// Marks the arrival of the header, where the latency of the message
+    /// starts counting.
+    void set_arrival(telemetry_clock::time_point arrival) {
+      _arrival = arrival;
+    }
+
+    auto arrival() const {
+      return _arrival;
+    }
+
     boost::asio::mutable_buffer buffer() {
       DEBUG_ASSERT(_size > 0u);
+      _message = _pool->Pop(_size);
       _message.reset(_size);
       return _message.buffer();
     }
@@ -56,6 +86,12 @@ namespace tcp {
 
   private:
 
+    const std::shared_ptr<BufferPool> _pool;
+
+    stream_id_type _stream_id;
+
+    telemetry_clock::time_point _arrival;
+
     message_size_type _size = 0u;
 
     Buffer _message;
@@ -65,14 +101,38 @@ namespace tcp {
   // -- Client -----------------------------------------------------------------
   // ===========================================================================
 
+  static token_type MakeMultiplexedToken(token_type token) {
+    token.set_stream_id(MULTIPLEXED_STREAM_ID);
+    return token;
+  }
+
   Client::Client(
       boost::asio::io_context &io_context,
       const token_type &token,
-      callback_function_type callback)
+      callback_function_type callback,
+      std::shared_ptr<Telemetry> telemetry)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp client ") + std::to_string(token.get_stream_id())),
       _token(token),
-      _callback(std::move(callback)),
+      _telemetry(telemetry != nullptr ? std::move(telemetry) : std::make_shared<Telemetry>()),
+      _socket(io_context),
+      _strand(io_context),
+      _connection_timer(io_context),
+      _buffer_pool(std::make_shared<BufferPool>()) {
+    if (!_token.protocol_is_tcp()) {
+      throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
+    }
+    _receivers.emplace(GetStreamId(), MakeReceiver(GetStreamId(), std::move(callback)));
+  }
+
+  Client::Client(
+      boost::asio::io_context &io_context,
+      const token_type &token,
+      std::shared_ptr<Telemetry> telemetry)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
+          std::string("tcp multiplexed client ") + token.get_address().to_string()),
+      _token(MakeMultiplexedToken(token)),
+      _telemetry(telemetry != nullptr ? std::move(telemetry) : std::make_shared<Telemetry>()),
       _socket(io_context),
       _strand(io_context),
       _connection_timer(io_context),
@@ -96,6 +156,14 @@ namespace tcp {
       if (_socket.is_open()) {
         _socket.close();
       }
+      _ring = nullptr;
+      _is_connected = false;
+      if (_has_connected) {
+        for (auto &item : _receivers) {
+          item.second->telemetry->Add(item.second->telemetry->reconnects, 1u);
+        }
+      }
+      _has_connected = true;
 
       DEBUG_ASSERT(_token.is_valid());
       DEBUG_ASSERT(_token.protocol_is_tcp());
@@ -110,21 +178,32 @@ namespace tcp {
           // Improves the sync mode velocity on Linux by a factor of ~3.
           _socket.set_option(boost::asio::ip::tcp::no_delay(true));
           log_debug("streaming client: connected to", ep);
-          // Send the stream id to subscribe to the stream.
+          // Send the stream id to subscribe to the stream, followed by the
+          // protocol we would like to receive the data with.
           const auto &stream_id = _token.get_stream_id();
+          _requested_protocol = (!_shm_failed && shm::Segment::IsSupported()) ?
+              token_data::protocol::shm :
+              token_data::protocol::tcp;
           log_debug("streaming client: sending stream id", stream_id);
+          const std::array<boost::asio::const_buffer, 2u> query = {
+              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              boost::asio::buffer(&_requested_protocol, sizeof(_requested_protocol))};
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              query,
               boost::asio::bind_executor(_strand, [=](error_code ec, size_t DEBUG_ONLY(bytes)) {
                 // Ensures to stop the execution once the connection has been stopped.
                 if (_done) {
                   return;
                 }
                 if (!ec) {
-                  DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
+                  DEBUG_ASSERT_EQ(bytes, sizeof(stream_id) + sizeof(_requested_protocol));
                   // If succeeded start reading data.
-                  ReadData();
+                  if (_requested_protocol == token_data::protocol::shm) {
+                    ReadSharedMemoryOffer();
+                  } else {
+                    StartReading();
+                  }
                 } else {
                   // Else try again.
                   log_debug("streaming client: failed to send stream id:", ec.message());
@@ -153,6 +232,28 @@ namespace tcp {
     });
   }
 
+  void Client::Subscribe(const stream_id_type stream_id, callback_function_type callback) {
+    DEBUG_ASSERT(IsMultiplexed());
+    auto self = shared_from_this();
+    auto receiver = MakeReceiver(stream_id, std::move(callback));
+    boost::asio::post(_strand, [this, self, stream_id, receiver]() {
+      _receivers[stream_id] = receiver;
+      if (_is_connected) {
+        SendSubscriptionRequest(SubscriptionRequest::Type::subscribe, stream_id);
+      }
+    });
+  }
+
+  void Client::UnSubscribe(const stream_id_type stream_id) {
+    DEBUG_ASSERT(IsMultiplexed());
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, stream_id]() {
+      if ((_receivers.erase(stream_id) > 0u) && _is_connected) {
+        SendSubscriptionRequest(SubscriptionRequest::Type::unsubscribe, stream_id);
+      }
+    });
+  }
+
   void Client::Reconnect() {
     auto self = shared_from_this();
     _connection_timer.expires_from_now(time_duration::seconds(1u));
@@ -172,7 +273,7 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(_buffer_pool, GetStreamId());
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
@@ -182,7 +283,11 @@ namespace tcp {
           // Move the buffer to the callback function and start reading the next
           // piece of data.
           // log_debug("streaming client: success reading data, calling the callback");
-          boost::asio::post(_strand, [self, message]() { self->_callback(message->pop()); });
+          if (IsMultiplexed() && (message->stream_id() == MULTIPLEXED_STREAM_ID)) {
+            DeliverBatch(message->pop(), message->arrival());
+          } else {
+            Deliver(message->stream_id(), message->pop(), message->arrival());
+          }
           ReadData();
         } else {
           // As usual, if anything fails start over from the very top.
@@ -196,10 +301,11 @@ namespace tcp {
           size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_header", bytes, "bytes"));
         if (!ec && (message->size() > 0u)) {
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type));
+          DEBUG_ASSERT_EQ(bytes, boost::asio::buffer_size(message->header(IsMultiplexed())));
           if (_done) {
             return;
           }
+          message->set_arrival(telemetry_clock::now());
           // Now that we know the size of the coming buffer, we can allocate our
           // buffer and start putting data into it.
           boost::asio::async_read(
@@ -217,11 +323,242 @@ namespace tcp {
       // Read the size of the buffer that is coming.
       boost::asio::async_read(
           _socket,
-          message->size_as_buffer(),
+          message->header(IsMultiplexed()),
+          boost::asio::bind_executor(_strand, handle_read_header));
+    });
+  }
+
+  void Client::ReadSharedMemoryOffer() {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      if (_done) {
+        return;
+      }
+
+      auto offer = std::make_shared<IncomingMessage>(_buffer_pool, GetStreamId());
+
+      auto open_ring = [this, self, offer]() {
+        if (offer->size() == 0u) {
+          log_debug("streaming client: shared memory declined, using TCP");
+          StartReading();
+          return;
+        }
+        const auto name = offer->pop();
+        _ring = shm::Ring::Open(std::string(name.begin(), name.end()));
+        if (_ring == nullptr) {
+          FallBackToTcp();
+        } else {
+          log_debug("streaming client: receiving stream", GetStreamId(), "through shared memory");
+          StartReading();
+        }
+      };
+
+      auto handle_read_header = [this, self, offer, open_ring](
+          boost::system::error_code ec,
+          size_t) {
+        if (ec) {
+          if (!_done) {
+            log_debug("streaming client: failed to read shared memory offer:", ec.message());
+            Connect();
+          }
+        } else if (offer->size() == 0u) {
+          open_ring();
+        } else {
+          boost::asio::async_read(
+              _socket,
+              offer->buffer(),
+              boost::asio::bind_executor(_strand, [this, self, open_ring](boost::system::error_code read_ec, size_t) {
+                if (!read_ec) {
+                  open_ring();
+                } else if (!_done) {
+                  log_debug("streaming client: failed to read shared memory offer:", read_ec.message());
+                  Connect();
+                }
+              }));
+        }
+      };
+
+      boost::asio::async_read(
+          _socket,
+          offer->size_as_buffer(),
           boost::asio::bind_executor(_strand, handle_read_header));
     });
   }
 
+  void Client::ReadDoorbell() {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      if (_done) {
+        return;
+      }
+
+      struct Header {
+        stream_id_type stream_id;
+        shm::Doorbell doorbell;
+        telemetry_clock::time_point arrival;
+      };
+      auto header = std::make_shared<Header>();
+      header->stream_id = GetStreamId();
+
+      auto deliver = [this, self, header](Buffer &&buffer) {
+        if (IsMultiplexed() && (header->stream_id == MULTIPLEXED_STREAM_ID)) {
+          DeliverBatch(std::move(buffer), header->arrival);
+        } else {
+          Deliver(header->stream_id, std::move(buffer), header->arrival);
+        }
+        ReadDoorbell();
+      };
+
+      auto handle_read_doorbell = [this, self, header, deliver](
+          boost::system::error_code ec,
+          size_t DEBUG_ONLY(bytes)) {
+        const auto &doorbell = header->doorbell;
+        header->arrival = telemetry_clock::now();
+        if (ec || (doorbell.size == 0u)) {
+          if (!_done) {
+            log_debug("streaming client: failed to read doorbell:", ec.message());
+            Connect();
+          }
+          return;
+        }
+        DEBUG_ASSERT_EQ(bytes, (IsMultiplexed() ? sizeof(stream_id_type) : 0u) + sizeof(shm::Doorbell));
+        if (doorbell.offset != shm::Doorbell::INLINE_MESSAGE) {
+          auto view = _ring->View(doorbell);
+          if (view.empty()) {
+            log_warning("streaming client: invalid shared memory doorbell");
+            FallBackToTcp();
+          } else {
+            deliver(std::move(view));
+          }
+          return;
+        }
+        // The ring was full and the message follows the doorbell.
+        auto message = std::make_shared<Buffer>(_buffer_pool->Pop(doorbell.size));
+        message->reset(doorbell.size);
+        boost::asio::async_read(
+            _socket,
+            message->buffer(),
+            boost::asio::bind_executor(_strand, [this, message, deliver](boost::system::error_code read_ec, size_t) {
+              if (!read_ec) {
+                deliver(std::move(*message));
+              } else if (!_done) {
+                log_debug("streaming client: failed to read data:", read_ec.message());
+                Connect();
+              }
+            }));
+      };
+
+      // The stream id is only sent by multiplexed sessions.
+      std::array<boost::asio::mutable_buffer, 2u> buffers = {
+          boost::asio::buffer(&header->stream_id, IsMultiplexed() ? sizeof(stream_id_type) : 0u),
+          boost::asio::buffer(&header->doorbell, sizeof(shm::Doorbell))};
+      boost::asio::async_read(
+          _socket,
+          buffers,
+          boost::asio::bind_executor(_strand, handle_read_doorbell));
+    });
+  }
+
+  void Client::StartReading() {
+    if (IsMultiplexed()) {
+      _is_connected = true;
+      for (auto &item : _receivers) {
+        SendSubscriptionRequest(SubscriptionRequest::Type::subscribe, item.first);
+      }
+    }
+    if (_ring != nullptr) {
+      ReadDoorbell();
+    } else {
+      ReadData();
+    }
+  }
+
+  void Client::SendSubscriptionRequest(const SubscriptionRequest::Type type, const stream_id_type stream_id) {
+    // Requests are a few bytes and rarely sent, if the write fails the read
+    // fails too and the subscriptions are sent again on reconnection.
+    const SubscriptionRequest request{type, stream_id};
+    boost::system::error_code ec;
+    boost::asio::write(_socket, boost::asio::buffer(&request, sizeof(request)), ec);
+    if (ec) {
+      log_debug("streaming client: failed to send subscription request:", ec.message());
+    }
+  }
+
+  std::shared_ptr<Client::Receiver> Client::MakeReceiver(
+      const stream_id_type stream_id,
+      callback_function_type callback) {
+    auto receiver = std::make_shared<Receiver>();
+    receiver->callback = std::move(callback);
+    receiver->telemetry = _telemetry->GetStream(stream_id);
+    return receiver;
+  }
+
+  void Client::Deliver(
+      const stream_id_type stream_id,
+      Buffer &&buffer,
+      const telemetry_clock::time_point arrival) {
+    auto search = _receivers.find(stream_id);
+    if (search == _receivers.end()) {
+      // Messages already on the way when the stream was unsubscribed.
+      return;
+    }
+    auto receiver = search->second;
+    auto message = std::make_shared<Buffer>(std::move(buffer));
+    boost::asio::post(_strand, [receiver, message, arrival]() {
+      auto &telemetry = *receiver->telemetry;
+      telemetry.CountMessage(message->size());
+      telemetry.latency.Record(arrival, telemetry_clock::now());
+      receiver->callback(std::move(*message));
+    });
+  }
+
+  void Client::DeliverBatch(Buffer &&batch, const telemetry_clock::time_point arrival) {
+    using Delivery = std::pair<std::shared_ptr<Receiver>, Buffer>;
+    auto deliveries = std::make_shared<std::vector<Delivery>>();
+    // The messages are views, they keep the batch alive until the last one is
+    // destroyed.
+    auto owner = std::make_shared<Buffer>(std::move(batch));
+    size_t offset = 0u;
+    while (offset < owner->size()) {
+      BatchEntryHeader header;
+      if (owner->size() - offset < sizeof(header)) {
+        log_warning("streaming client: malformed batch of messages");
+        break;
+      }
+      std::memcpy(&header, owner->data() + offset, sizeof(header));
+      offset += sizeof(header);
+      if (owner->size() - offset < header.size) {
+        log_warning("streaming client: malformed batch of messages");
+        break;
+      }
+      auto search = _receivers.find(header.stream_id);
+      if ((search != _receivers.end()) && (header.size > 0u)) {
+        deliveries->emplace_back(
+            search->second,
+            Buffer::MakeView(owner->data() + offset, header.size, owner));
+      }
+      offset += header.size + GetBatchPadding(header.size);
+    }
+    if (deliveries->empty()) {
+      return;
+    }
+    boost::asio::post(_strand, [deliveries, arrival]() {
+      const auto now = telemetry_clock::now();
+      for (auto &delivery : *deliveries) {
+        auto &telemetry = *delivery.first->telemetry;
+        telemetry.CountMessage(delivery.second.size());
+        telemetry.latency.Record(arrival, now);
+        delivery.first->callback(std::move(delivery.second));
+      }
+    });
+  }
+
+  void Client::FallBackToTcp() {
+    log_warning("streaming client: shared memory unavailable for stream", GetStreamId(), ", falling back to TCP");
+    _shm_failed = true;
+    Connect();
+  }
+
 } // namespace tcp
 } // namespace detail
 } // namespace streaming
@@ -9,8 +9,11 @@
 #include "carla/Buffer.h"
 #include "carla/NonCopyable.h"
 #include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Telemetry.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/shm/Ring.h"
+#include "carla/streaming/detail/tcp/SubscriptionRequest.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
@@ -20,6 +23,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <unordered_map>
 
 namespace carla {
 
@@ -29,7 +33,15 @@ namespace streaming {
 namespace detail {
 namespace tcp {
 
-  /// A client that connects to a single stream.
+  /// A client that connects to a single stream, or to every stream of a
+  /// server it subscribes to if constructed without a callback. In the
+  /// latter case the server multiplexes the streams over the connection and
+  /// prepends the stream id to each message. Batches of coalesced messages
+  /// are split back here, each message is a view into the batch.
+  ///
+  /// When possible, the client asks the server for a shared memory ring and
+  /// receives the messages as views into it. It falls back to plain TCP if
+  /// the server declines or the ring cannot be mapped.
   ///
   /// @warning This client should be stopped before releasing the shared pointer
   /// or won't be destroyed.
@@ -43,10 +55,20 @@ namespace tcp {
     using protocol_type = endpoint::protocol_type;
     using callback_function_type = std::function<void (Buffer)>;
 
+    /// The counters of the streams received are kept in @a telemetry, or in a
+    /// telemetry of its own if none is given.
+    Client(
+        boost::asio::io_context &io_context,
+        const token_type &token,
+        callback_function_type callback,
+        std::shared_ptr<Telemetry> telemetry = nullptr);
+
+    /// Multiplexed client, connects to the server of @a token and receives
+    /// the streams added with Subscribe.
     Client(
         boost::asio::io_context &io_context,
         const token_type &token,
-        callback_function_type callback);
+        std::shared_ptr<Telemetry> telemetry = nullptr);
 
     ~Client();
 
@@ -58,15 +80,52 @@ namespace tcp {
 
     void Stop();
 
+    /// Multiplexed clients only.
+    void Subscribe(stream_id_type stream_id, callback_function_type callback);
+
+    /// Multiplexed clients only.
+    void UnSubscribe(stream_id_type stream_id);
+
   private:
 
+    bool IsMultiplexed() const {
+      return GetStreamId() == MULTIPLEXED_STREAM_ID;
+    }
+
     void Reconnect();
 
     void ReadData();
 
+    void ReadSharedMemoryOffer();
+
+    void ReadDoorbell();
+
+    void FallBackToTcp();
+
+    void StartReading();
+
+    void SendSubscriptionRequest(SubscriptionRequest::Type type, stream_id_type stream_id);
+
+    /// A stream subscribed to.
+    struct Receiver {
+      callback_function_type callback;
+      std::shared_ptr<StreamTelemetry> telemetry;
+    };
+
+    std::shared_ptr<Receiver> MakeReceiver(stream_id_type stream_id, callback_function_type callback);
+
+    void Deliver(stream_id_type stream_id, Buffer &&buffer, telemetry_clock::time_point arrival);
+
+    /// Splits a batch of coalesced messages, see Batch.h, and delivers them
+    /// in a single job.
+    void DeliverBatch(Buffer &&batch, telemetry_clock::time_point arrival);
+
     const token_type _token;
 
-    callback_function_type _callback;
+    const std::shared_ptr<Telemetry> _telemetry;
+
+    /// Accessed only within the strand.
+    std::unordered_map<stream_id_type, std::shared_ptr<Receiver>> _receivers;
 
     boost::asio::ip::tcp::socket _socket;
 
@@ -76,6 +135,18 @@ namespace tcp {
 
     std::shared_ptr<BufferPool> _buffer_pool;
 
+    std::unique_ptr<shm::Ring> _ring;
+
+    decltype(token_data::protocol) _requested_protocol = token_data::protocol::tcp;
+
+    bool _shm_failed = false;
+
+    /// Whether the handshake is done and subscription requests can be sent.
+    bool _is_connected = false;
+
+    /// Whether any connection was attempted, the next ones count as reconnects.
+    bool _has_connected = false;
+
     std::atomic_bool _done{false};
   };
 
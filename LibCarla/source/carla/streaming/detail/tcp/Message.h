@@ -75,6 +75,12 @@ namespace tcp {
       return MakeListView(begin, begin + _number_of_buffers + 1u);
     }
 
+    /// Buffer sequence of the message without the size header.
+    auto GetPayloadSequence() const {
+      auto begin = _buffer_views.begin() + 1u;
+      return MakeListView(begin, begin + _number_of_buffers);
+    }
+
   private:
 
     message_size_type _number_of_buffers = 0u;
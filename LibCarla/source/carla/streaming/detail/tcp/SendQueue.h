@@ -0,0 +1,31 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// What a ServerSession does with a message written to a stream whose send
+  /// queue is full.
+  enum class SendQueuePolicy : uint8_t {
+    /// The writer waits until there is room in the queue. Used always in
+    /// synchronous mode.
+    Block,
+    /// The oldest message waiting in the queue is discarded.
+    DropOldest,
+    /// The new message is discarded.
+    DropNewest
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
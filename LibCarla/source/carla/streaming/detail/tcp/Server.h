@@ -8,6 +8,9 @@
 
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/Telemetry.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/SendQueue.h"
 #include "carla/streaming/detail/tcp/ServerSession.h"
 
 #include <boost/asio/io_context.hpp>
@@ -62,8 +65,50 @@ namespace tcp {
       return _synchronous;
     }
 
+    /// Set how many messages per stream each session keeps waiting for the
+    /// socket, and what to do with the messages that do not fit. Synchronous
+    /// mode always blocks. By default a single message waits and the newer
+    /// ones are dropped.
+    void SetSendQueue(size_t depth, SendQueuePolicy policy) {
+      _send_queue_depth = depth;
+      _send_queue_policy = policy;
+    }
+
+    size_t GetSendQueueDepth() const {
+      return _send_queue_depth;
+    }
+
+    SendQueuePolicy GetSendQueuePolicy() const {
+      return _synchronous ? SendQueuePolicy::Block : _send_queue_policy.load();
+    }
+
+    /// Gather the messages of up to @a max_message_size bytes that multiplexed
+    /// sessions have waiting into a single write, the client splits them
+    /// back. A small message written to an idle session waits @a window for
+    /// others to join it. Zero @a max_message_size disables coalescing, the
+    /// default.
+    void SetCoalescing(size_t max_message_size, time_duration window = time_duration()) {
+      _coalescing_max_message_size = max_message_size;
+      _coalescing_window = window;
+    }
+
+    size_t GetCoalescingMaxMessageSize() const {
+      return _coalescing_max_message_size;
+    }
+
+    time_duration GetCoalescingWindow() const {
+      return _coalescing_window;
+    }
+
+    /// Counters of every stream written to so far.
+    TelemetrySnapshot GetTelemetry() const {
+      return _telemetry.Snapshot();
+    }
+
   private:
 
+    friend class ServerSession;
+
     void OpenSession(
         time_duration timeout,
         ServerSession::callback_function_type on_session_opened,
@@ -76,6 +121,16 @@ namespace tcp {
     std::atomic<time_duration> _timeout;
 
     bool _synchronous;
+
+    std::atomic_size_t _send_queue_depth{1u};
+
+    std::atomic<SendQueuePolicy> _send_queue_policy{SendQueuePolicy::DropNewest};
+
+    std::atomic_size_t _coalescing_max_message_size{0u};
+
+    std::atomic<time_duration> _coalescing_window{time_duration()};
+
+    Telemetry _telemetry;
   };
 
 } // namespace tcp
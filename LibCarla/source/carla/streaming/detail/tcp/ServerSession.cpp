@@ -6,6 +6,7 @@
 
 #include "carla/streaming/detail/tcp/ServerSession.h"
 #include "carla/streaming/detail/tcp/Server.h"
+#include "carla/streaming/detail/tcp/Subscription.h"
 
 #include "carla/Debug.h"
 #include "carla/Logging.h"
@@ -15,8 +16,9 @@
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <thread>
 
 namespace carla {
 namespace streaming {
@@ -25,6 +27,9 @@ namespace tcp {
 
   static std::atomic_size_t SESSION_COUNTER{0u};
 
+  /// Batches stop growing once they reach this size.
+  static constexpr size_t MAX_BATCH_SIZE = 1u << 20u;
+
   ServerSession::ServerSession(
       boost::asio::io_context &io_context,
       const time_duration timeout,
@@ -36,7 +41,8 @@ namespace tcp {
       _socket(io_context),
       _timeout(timeout),
       _deadline(io_context),
-      _strand(io_context) {}
+      _strand(io_context),
+      _coalescing_timer(io_context) {}
 
   void ServerSession::Open(
       callback_function_type on_opened,
@@ -57,65 +63,404 @@ namespace tcp {
           const boost::system::error_code &ec,
           size_t DEBUG_ONLY(bytes_received)) {
         if (!ec) {
-          DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
+          DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id) + sizeof(_requested_protocol));
           log_debug("session", _session_id, "for stream", _stream_id, " started");
-          boost::asio::post(_strand.context(), [=]() { callback(self); });
+          if (IsMultiplexed()) {
+            _on_opened = callback;
+          }
+          if (_requested_protocol == token_data::protocol::shm) {
+            OfferSharedMemory(callback);
+          } else if (IsMultiplexed()) {
+            ReadSubscriptionRequest();
+          } else {
+            boost::asio::post(_strand.context(), [=]() { callback(self); });
+          }
         } else {
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
           CloseNow();
         }
       };
 
-      // Read the stream id.
+      // Read the stream id and the protocol requested by the client.
+      const std::array<boost::asio::mutable_buffer, 2u> query = {
+          boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
+          boost::asio::buffer(&_requested_protocol, sizeof(_requested_protocol))};
       _deadline.expires_from_now(_timeout);
       boost::asio::async_read(
           _socket,
-          boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
+          query,
           boost::asio::bind_executor(_strand, handle_query));
     });
   }
 
+  void ServerSession::OfferSharedMemory(callback_function_type on_opened) {
+    // Only clients on this host can map the ring.
+    boost::system::error_code ec;
+    const auto remote = _socket.remote_endpoint(ec).address();
+    const auto local = _socket.local_endpoint(ec).address();
+    if (!ec && (remote.is_loopback() || (remote == local))) {
+      _ring = shm::Ring::Create();
+    }
+
+    // An empty name declines the request, the client keeps using TCP.
+    auto offer = MakeMessage(Buffer(_ring != nullptr ? _ring->name() : std::string()));
+    log_debug("session", _session_id, (_ring != nullptr ? ": offering shared memory" : ": declining shared memory"));
+
+    auto self = shared_from_this();
+    auto handle_offer = [this, self, offer, callback=std::move(on_opened)](
+        const boost::system::error_code &ec,
+        size_t) {
+      if (ec) {
+        log_error("session", _session_id, ": error sending shared memory offer :", ec.message());
+        CloseNow();
+      } else if (IsMultiplexed()) {
+        ReadSubscriptionRequest();
+      } else {
+        boost::asio::post(_strand.context(), [=]() { callback(self); });
+      }
+    };
+
+    boost::asio::async_write(
+        _socket,
+        offer->GetBufferSequence(),
+        boost::asio::bind_executor(_strand, handle_offer));
+  }
+
+  void ServerSession::ReadSubscriptionRequest() {
+    auto handle_request = [this, self=shared_from_this()](
+        const boost::system::error_code &ec,
+        size_t) {
+      if (ec) {
+        // The client closing the connection ends here too.
+        if (ec != boost::asio::error::operation_aborted) {
+          log_debug("session", _session_id, ": subscriptions closed :", ec.message());
+          CloseNow();
+        }
+        return;
+      }
+      if (_request.type == SubscriptionRequest::Type::subscribe) {
+        Subscribe(_request.stream_id);
+      } else {
+        Unsubscribe(_request.stream_id);
+      }
+      ReadSubscriptionRequest();
+    };
+
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_request, sizeof(_request)),
+        boost::asio::bind_executor(_strand, handle_request));
+  }
+
+  void ServerSession::Subscribe(const stream_id_type stream_id) {
+    if ((stream_id == MULTIPLEXED_STREAM_ID) || (_subscriptions.count(stream_id) > 0u)) {
+      return;
+    }
+    log_debug("session", _session_id, ": subscribed to stream", stream_id);
+    auto subscription = std::make_shared<Subscription>(shared_from_this(), stream_id);
+    _subscriptions.emplace(stream_id, subscription);
+    boost::asio::post(_strand.context(), [callback=_on_opened, subscription]() {
+      callback(subscription);
+    });
+  }
+
+  void ServerSession::Unsubscribe(const stream_id_type stream_id) {
+    auto search = _subscriptions.find(stream_id);
+    if (search == _subscriptions.end()) {
+      return;
+    }
+    log_debug("session", _session_id, ": unsubscribed from stream", stream_id);
+    auto subscription = std::move(search->second);
+    _subscriptions.erase(search);
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _pending.erase(stream_id);
+      _telemetry.erase(stream_id);
+      _turns.erase(std::remove(_turns.begin(), _turns.end(), stream_id), _turns.end());
+    }
+    _queue_space.notify_all();
+    _on_closed(std::move(subscription));
+  }
+
   void ServerSession::Write(std::shared_ptr<const Message> message) {
+    Write(_stream_id, std::move(message));
+  }
+
+  void ServerSession::Write(const stream_id_type stream_id, std::shared_ptr<const Message> message) {
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-    boost::asio::post(_strand, [=]() {
-      if (!_socket.is_open()) {
+    const auto policy = _server.GetSendQueuePolicy();
+    const auto depth = _server.GetSendQueueDepth();
+    OutgoingMessage outgoing{std::move(message), nullptr, telemetry_clock::now()};
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    outgoing.telemetry = GetTelemetry(stream_id);
+    auto &telemetry = *outgoing.telemetry;
+    const auto size = outgoing.message->size();
+    if ((policy == SendQueuePolicy::Block) && _is_writing && (QueueSize(stream_id) >= depth)) {
+      // Wait for the completion handler to make room, the session is given up
+      // as unresponsive after the time-out.
+      telemetry.Add(telemetry.stalled_bytes, size);
+      const bool has_room = _queue_space.wait_for(lock, _timeout.to_chrono(), [&]() {
+        return _is_closed || !_is_writing || (QueueSize(stream_id) < depth);
+      });
+      if (!has_room) {
+        log_warning("session", _session_id, ": stream", stream_id, "stalled for too long, closing session");
+        telemetry.CountDropped(size);
+        lock.unlock();
+        Close();
         return;
       }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // wait until previous message has been sent
-          while (_is_writing) {
-            std::this_thread::yield();
-          }
-        } else {
-          // ignore this message
-          log_debug("session", _session_id, ": connection too slow: message discarded");
+    }
+    if (_is_closed) {
+      return;
+    }
+    if (!_is_writing) {
+      _is_writing = true;
+      const auto max_message_size = GetCoalescingMaxMessageSize();
+      if ((max_message_size == 0u) || (size > max_message_size)) {
+        lock.unlock();
+        boost::asio::post(_strand, [this, self=shared_from_this(), stream_id, outgoing]() {
+          WriteNow(stream_id, outgoing);
+        });
+        return;
+      }
+      // Queue it so the messages written meanwhile go out with it.
+      telemetry.Add(telemetry.queued_bytes, size);
+      _pending[stream_id].emplace_back(std::move(outgoing));
+      _turns.push_back(stream_id);
+      lock.unlock();
+      const auto window = _server.GetCoalescingWindow();
+      boost::asio::post(_strand, [this, self=shared_from_this(), window]() {
+        if (window.milliseconds() == 0u) {
+          WriteNext();
           return;
-        }      
+        }
+        _coalescing_timer.expires_from_now(window);
+        _coalescing_timer.async_wait(boost::asio::bind_executor(
+            _strand,
+            [this, self](boost::system::error_code) { WriteNext(); }));
+      });
+      return;
+    }
+    auto &pending = _pending[stream_id];
+    if (pending.size() >= depth) {
+      if ((policy == SendQueuePolicy::DropOldest) && !pending.empty()) {
+        telemetry.CountDropped(pending.front().message->size());
+        pending.pop_front();
+      } else {
+        log_debug("session", _session_id, ": connection too slow: message of stream", stream_id, "discarded");
+        telemetry.CountDropped(size);
+        if (pending.empty()) {
+          _pending.erase(stream_id);
+        }
+        return;
       }
-      _is_writing = true;
+    }
+    if (pending.empty()) {
+      _turns.push_back(stream_id);
+    }
+    telemetry.Add(telemetry.queued_bytes, size);
+    pending.emplace_back(std::move(outgoing));
+  }
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
-        _is_writing = false;
-        if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow();
-        } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+  size_t ServerSession::QueueSize(const stream_id_type stream_id) const {
+    auto search = _pending.find(stream_id);
+    return search != _pending.end() ? search->second.size() : 0u;
+  }
+
+  std::shared_ptr<StreamTelemetry> ServerSession::GetTelemetry(const stream_id_type stream_id) {
+    auto &telemetry = _telemetry[stream_id];
+    if (telemetry == nullptr) {
+      telemetry = _server._telemetry.GetStream(stream_id);
+    }
+    return telemetry;
+  }
+
+  void ServerSession::WriteNow(const stream_id_type stream_id, OutgoingMessage outgoing) {
+    if (!_socket.is_open()) {
+      return;
+    }
+    const auto &message = outgoing.message;
+    log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+
+    // Stream id if multiplexed, then the size or the doorbell, then the payload
+    // unless it goes through shared memory.
+    std::array<boost::asio::const_buffer, Message::max_size() + 2u> buffers;
+    size_t count = 0u;
+    if (IsMultiplexed()) {
+      _outgoing_stream_id = stream_id;
+      buffers[count++] = boost::asio::buffer(&_outgoing_stream_id, sizeof(_outgoing_stream_id));
+    }
+    if (_ring == nullptr) {
+      for (auto &&buffer : message->GetBufferSequence()) {
+        buffers[count++] = buffer;
+      }
+    } else {
+      // With shared memory the socket only carries the doorbell, unless the
+      // ring is full and the message has to follow it inline.
+      _doorbell = shm::Doorbell();
+      uint8_t *frame = _ring->Allocate(message->size(), _doorbell);
+      if (frame != nullptr) {
+        boost::asio::buffer_copy(
+            boost::asio::buffer(frame, message->size()),
+            message->GetPayloadSequence());
+      } else {
+        log_debug("session", _session_id, ": shared memory ring full, sending inline");
+        _doorbell.size = message->size();
+      }
+      buffers[count++] = boost::asio::buffer(&_doorbell, sizeof(_doorbell));
+      if (frame == nullptr) {
+        for (auto &&buffer : message->GetPayloadSequence()) {
+          buffers[count++] = buffer;
         }
-      };
+      }
+    }
 
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+    auto self = shared_from_this();
+    auto handle_sent = [this, self, outgoing](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        CloseNow();
+      } else {
+        DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+        outgoing.telemetry->CountMessage(outgoing.message->size());
+        outgoing.telemetry->latency.Record(outgoing.enqueued, telemetry_clock::now());
+        WriteNext();
+      }
+    };
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(
-          _socket,
-          message->GetBufferSequence(),
-          handle_sent);
-    });
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(_socket, buffers, boost::asio::bind_executor(_strand, handle_sent));
+  }
+
+  void ServerSession::WriteBatch() {
+    if (!_socket.is_open()) {
+      return;
+    }
+    DEBUG_ASSERT(_batch.size() == _batch_entries.size());
+    log_debug("session", _session_id, ": sending a batch of", _batch.size(), "messages");
+
+    size_t size = 0u;
+    for (auto &outgoing : _batch) {
+      const auto message_size = outgoing.message->size();
+      size += sizeof(BatchEntryHeader) + message_size + GetBatchPadding(message_size);
+    }
+
+    // The batch is a message of the stream MULTIPLEXED_STREAM_ID. With shared
+    // memory it follows its doorbell inline.
+    _batch_buffers.clear();
+    if (_ring == nullptr) {
+      _batch_header.stream_id = MULTIPLEXED_STREAM_ID;
+      _batch_header.size = static_cast<message_size_type>(size);
+      _batch_buffers.emplace_back(boost::asio::buffer(&_batch_header, sizeof(_batch_header)));
+    } else {
+      _outgoing_stream_id = MULTIPLEXED_STREAM_ID;
+      _doorbell = shm::Doorbell();
+      _doorbell.size = static_cast<message_size_type>(size);
+      _batch_buffers.emplace_back(boost::asio::buffer(&_outgoing_stream_id, sizeof(_outgoing_stream_id)));
+      _batch_buffers.emplace_back(boost::asio::buffer(&_doorbell, sizeof(_doorbell)));
+    }
+    static const std::array<uint8_t, BATCH_ALIGNMENT> padding{};
+    for (auto i = 0u; i < _batch.size(); ++i) {
+      const auto &message = *_batch[i].message;
+      _batch_buffers.emplace_back(boost::asio::buffer(&_batch_entries[i], sizeof(BatchEntryHeader)));
+      for (auto &&buffer : message.GetPayloadSequence()) {
+        _batch_buffers.emplace_back(buffer);
+      }
+      const auto pad = GetBatchPadding(message.size());
+      if (pad > 0u) {
+        _batch_buffers.emplace_back(boost::asio::buffer(padding.data(), pad));
+      }
+    }
+
+    auto self = shared_from_this();
+    auto handle_sent = [this, self](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        CloseNow();
+      } else {
+        DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+        const auto now = telemetry_clock::now();
+        for (auto &outgoing : _batch) {
+          outgoing.telemetry->CountMessage(outgoing.message->size());
+          outgoing.telemetry->latency.Record(outgoing.enqueued, now);
+        }
+        _batch.clear();
+        WriteNext();
+      }
+    };
+
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(_socket, _batch_buffers, boost::asio::bind_executor(_strand, handle_sent));
+  }
+
+  void ServerSession::WriteNext() {
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    if (_turns.empty() || _is_closed) {
+      _is_writing = false;
+      lock.unlock();
+      _queue_space.notify_all();
+      return;
+    }
+    stream_id_type stream_id;
+    auto outgoing = PopNextInTurn(stream_id);
+    const auto max_message_size = GetCoalescingMaxMessageSize();
+    if ((max_message_size == 0u) || (outgoing.message->size() > max_message_size)) {
+      lock.unlock();
+      _queue_space.notify_all();
+      WriteNow(stream_id, std::move(outgoing));
+      return;
+    }
+    // Gather small messages, still taking turns, until a big one comes next.
+    _batch.clear();
+    _batch_entries.clear();
+    size_t size = 0u;
+    for (;;) {
+      const auto message_size = outgoing.message->size();
+      _batch_entries.push_back(BatchEntryHeader{stream_id, message_size});
+      _batch.emplace_back(std::move(outgoing));
+      size += sizeof(BatchEntryHeader) + message_size + GetBatchPadding(message_size);
+      if (_turns.empty()) {
+        break;
+      }
+      const auto &next = *_pending[_turns.front()].front().message;
+      if ((next.size() > max_message_size) ||
+          (size + sizeof(BatchEntryHeader) + next.size() + BATCH_ALIGNMENT > MAX_BATCH_SIZE)) {
+        break;
+      }
+      outgoing = PopNextInTurn(stream_id);
+    }
+    lock.unlock();
+    _queue_space.notify_all();
+    if (_batch.size() == 1u) {
+      stream_id = _batch_entries.front().stream_id;
+      WriteNow(stream_id, std::move(_batch.front()));
+      _batch.clear();
+    } else {
+      WriteBatch();
+    }
+  }
+
+  ServerSession::OutgoingMessage ServerSession::PopNextInTurn(stream_id_type &stream_id) {
+    DEBUG_ASSERT(!_turns.empty());
+    stream_id = _turns.front();
+    _turns.pop_front();
+    auto search = _pending.find(stream_id);
+    DEBUG_ASSERT(search != _pending.end());
+    auto &pending = search->second;
+    auto outgoing = std::move(pending.front());
+    pending.pop_front();
+    if (pending.empty()) {
+      _pending.erase(search);
+    } else {
+      // Back of the line until every other stream has had its turn.
+      _turns.push_back(stream_id);
+    }
+    return outgoing;
+  }
+
+  size_t ServerSession::GetCoalescingMaxMessageSize() const {
+    return IsMultiplexed() ? _server.GetCoalescingMaxMessageSize() : 0u;
   }
 
   void ServerSession::Close() {
@@ -139,12 +484,29 @@ namespace tcp {
 
   void ServerSession::CloseNow() {
     _deadline.cancel();
+    _coalescing_timer.cancel();
     if (_socket.is_open()) {
       boost::system::error_code ec;
       _socket.shutdown(boost::asio::socket_base::shutdown_both, ec);
       _socket.close();
     }
-    _on_closed(shared_from_this());
+    {
+      // Wakes up the writers waiting for room, the messages are discarded.
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _is_closed = true;
+      _pending.clear();
+      _turns.clear();
+    }
+    _queue_space.notify_all();
+    if (IsMultiplexed()) {
+      auto subscriptions = std::move(_subscriptions);
+      _subscriptions.clear();
+      for (auto &pair : subscriptions) {
+        _on_closed(pair.second);
+      }
+    } else {
+      _on_closed(shared_from_this());
+    }
     log_debug("session", _session_id, "closed");
   }
 
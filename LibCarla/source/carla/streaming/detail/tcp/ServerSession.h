@@ -6,20 +6,29 @@
 
 #pragma once
 
-#include "carla/NonCopyable.h"
 #include "carla/Time.h"
-#include "carla/TypeTraits.h"
 #include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Session.h"
+#include "carla/streaming/detail/Telemetry.h"
+#include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/shm/Ring.h"
+#include "carla/streaming/detail/tcp/Batch.h"
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/SubscriptionRequest.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -27,18 +36,40 @@ namespace detail {
 namespace tcp {
 
   class Server;
+  class Subscription;
 
   /// A TCP server session. When a session opens, it reads from the socket a
   /// stream id object and passes itself to the callback functor. The session
   /// closes itself after @a timeout of inactivity is met.
+  ///
+  /// If the stream id is MULTIPLEXED_STREAM_ID, the session carries instead
+  /// every stream its client subscribes to through SubscriptionRequests. Each
+  /// of these streams gets a Subscription that is passed to the callback, and
+  /// every message written is preceded by its stream id. Streams take turns to
+  /// write, one message each.
+  ///
+  /// Messages written while the socket is busy wait in a queue per stream. The
+  /// server sets the depth of the queues and what happens to the messages
+  /// that do not fit, see SendQueuePolicy. Each write completion starts the
+  /// next one.
+  ///
+  /// If the server enables coalescing, a multiplexed session gathers the
+  /// small messages waiting in the queues into a single write, a batch, see
+  /// Batch.h. A small message written while the session is idle waits for
+  /// the coalescing window so the rest of its frame can join it. With shared
+  /// memory, batches go inline through the socket.
+  ///
+  /// If the client asks for shared memory and runs on the same host, the
+  /// session writes the messages to a shm::Ring instead and only sends through
+  /// the socket the doorbell pointing at them.
   class ServerSession
-    : public std::enable_shared_from_this<ServerSession>,
-      private profiler::LifetimeProfiled,
-      private NonCopyable {
+    : public Session,
+      public std::enable_shared_from_this<ServerSession>,
+      private profiler::LifetimeProfiled {
   public:
 
     using socket_type = boost::asio::ip::tcp::socket;
-    using callback_function_type = std::function<void(std::shared_ptr<ServerSession>)>;
+    using callback_function_type = std::function<void(std::shared_ptr<Session>)>;
 
     explicit ServerSession(
         boost::asio::io_context &io_context,
@@ -53,20 +84,15 @@ namespace tcp {
 
     /// @warning This function should only be called after the session is
     /// opened. It is safe to call this function from within the @a callback.
-    stream_id_type get_stream_id() const {
+    stream_id_type get_stream_id() const final {
       return _stream_id;
     }
 
-    template <typename... Buffers>
-    static auto MakeMessage(Buffers &&... buffers) {
-      static_assert(
-          are_same<Buffer, Buffers...>::value,
-          "This function only accepts arguments of type Buffer.");
-      return std::make_shared<const Message>(std::move(buffers)...);
-    }
-
     /// Writes some data to the socket.
-    void Write(std::shared_ptr<const Message> message);
+    void Write(std::shared_ptr<const Message> message) final;
+
+    /// Writes a message of the stream @a stream_id to the socket.
+    void Write(stream_id_type stream_id, std::shared_ptr<const Message> message);
 
     /// Writes some data to the socket.
     template <typename... Buffers>
@@ -75,22 +101,72 @@ namespace tcp {
     }
 
     /// Post a job to close the session.
-    void Close();
+    void Close() final;
 
   private:
 
+    bool IsMultiplexed() const {
+      return _stream_id == MULTIPLEXED_STREAM_ID;
+    }
+
+    void OfferSharedMemory(callback_function_type on_opened);
+
+    void ReadSubscriptionRequest();
+
+    void Subscribe(stream_id_type stream_id);
+
+    void Unsubscribe(stream_id_type stream_id);
+
+    /// A message waiting in a send queue.
+    struct OutgoingMessage {
+      std::shared_ptr<const Message> message;
+      std::shared_ptr<StreamTelemetry> telemetry;
+      telemetry_clock::time_point enqueued;
+    };
+
+    /// Starts writing @a outgoing, the session must not be writing already.
+    void WriteNow(stream_id_type stream_id, OutgoingMessage outgoing);
+
+    /// Starts writing the batch of messages gathered, the session must not be
+    /// writing already.
+    void WriteBatch();
+
+    /// Writes the message of the next stream in turn, if any, or a batch
+    /// with the next small messages if coalescing.
+    void WriteNext();
+
+    /// Takes the message of the next stream in turn, requires holding the
+    /// queue mutex.
+    OutgoingMessage PopNextInTurn(stream_id_type &stream_id);
+
+    /// Maximum size of the messages to coalesce, zero if this session does
+    /// not coalesce.
+    size_t GetCoalescingMaxMessageSize() const;
+
+    /// Messages waiting of @a stream_id, requires holding the queue mutex.
+    size_t QueueSize(stream_id_type stream_id) const;
+
+    /// Counters of @a stream_id, requires holding the queue mutex.
+    std::shared_ptr<StreamTelemetry> GetTelemetry(stream_id_type stream_id);
+
     void StartTimer();
 
     void CloseNow();
 
     friend class Server;
 
+    friend class Subscription;
+
     Server &_server;
 
     const size_t _session_id;
 
     stream_id_type _stream_id = 0u;
 
+    decltype(token_data::protocol) _requested_protocol = token_data::protocol::tcp;
+
+    std::unique_ptr<shm::Ring> _ring;
+
     socket_type _socket;
 
     time_duration _timeout;
@@ -99,9 +175,65 @@ namespace tcp {
 
     boost::asio::io_context::strand _strand;
 
+    callback_function_type _on_opened;
+
     callback_function_type _on_closed;
 
+    /// Headers of the message being written.
+    /// @{
+
+    stream_id_type _outgoing_stream_id = 0u;
+
+    shm::Doorbell _doorbell;
+
+    /// @}
+
+    /// @name Coalescing, only used within the strand
+    /// @{
+
+    boost::asio::deadline_timer _coalescing_timer;
+
+    BatchEntryHeader _batch_header;
+
+    std::vector<BatchEntryHeader> _batch_entries;
+
+    std::vector<OutgoingMessage> _batch;
+
+    std::vector<boost::asio::const_buffer> _batch_buffers;
+
+    /// @}
+
+    /// @name Multiplexed sessions
+    /// @{
+
+    SubscriptionRequest _request;
+
+    std::unordered_map<stream_id_type, std::shared_ptr<Subscription>> _subscriptions;
+
+    /// @}
+
+    /// @name Send queues, guarded by the queue mutex
+    /// @{
+
+    std::mutex _queue_mutex;
+
+    /// Notified whenever a message leaves the queues.
+    std::condition_variable _queue_space;
+
     bool _is_writing = false;
+
+    bool _is_closed = false;
+
+    /// Messages waiting for the socket, by stream.
+    std::unordered_map<stream_id_type, std::deque<OutgoingMessage>> _pending;
+
+    /// Streams with pending messages, in the order they write next.
+    std::deque<stream_id_type> _turns;
+
+    /// Counters of the streams written to, cached from the server.
+    std::unordered_map<stream_id_type, std::shared_ptr<StreamTelemetry>> _telemetry;
+
+    /// @}
   };
 
 } // namespace tcp
@@ -0,0 +1,67 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Session.h"
+#include "carla/streaming/detail/tcp/ServerSession.h"
+
+#include <boost/asio/post.hpp>
+
+#include <memory>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// A stream carried by a multiplexed ServerSession. Writing to it writes to
+  /// the session, tagged with the stream id.
+  ///
+  /// Only a weak reference to the session is kept, the session owns its
+  /// subscriptions and lives as long as its connection.
+  class Subscription final : public Session {
+  public:
+
+    Subscription(std::weak_ptr<ServerSession> session, stream_id_type stream_id)
+      : _session(std::move(session)),
+        _stream_id(stream_id) {}
+
+    stream_id_type get_stream_id() const override {
+      return _stream_id;
+    }
+
+    using Session::Write;
+
+    void Write(std::shared_ptr<const Message> message) override {
+      auto session = _session.lock();
+      if (session != nullptr) {
+        session->Write(_stream_id, std::move(message));
+      }
+    }
+
+    /// Post a job to remove this stream from the session, the session stays
+    /// open.
+    void Close() override {
+      auto session = _session.lock();
+      if (session != nullptr) {
+        boost::asio::post(session->_strand, [session, stream_id=_stream_id]() {
+          session->Unsubscribe(stream_id);
+        });
+      }
+    }
+
+  private:
+
+    const std::weak_ptr<ServerSession> _session;
+
+    const stream_id_type _stream_id;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
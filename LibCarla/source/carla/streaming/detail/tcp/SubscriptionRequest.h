@@ -0,0 +1,40 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// Stream id sent by a client on connection to open a multiplexed session,
+  /// that carries every stream the client subscribes to afterwards. Streams
+  /// never get this id.
+  static constexpr stream_id_type MULTIPLEXED_STREAM_ID = 0u;
+
+#pragma pack(push, 1)
+
+  /// Sent by the client of a multiplexed session to add or remove a stream.
+  struct SubscriptionRequest {
+    enum class Type : uint8_t {
+      subscribe,
+      unsubscribe
+    } type = Type::subscribe;
+
+    stream_id_type stream_id = 0u;
+  };
+
+#pragma pack(pop)
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
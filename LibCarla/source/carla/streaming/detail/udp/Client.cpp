@@ -0,0 +1,231 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/Client.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/Time.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// Interval between subscription requests, well below the session time-out
+  /// of the server.
+  static const auto KEEP_ALIVE_INTERVAL = time_duration::seconds(1u);
+
+  /// A burst of datagrams that does not fit in the socket buffer is lost, so
+  /// ask for a buffer big enough for a few large messages.
+  static constexpr int RECEIVE_BUFFER_SIZE = 4 << 20;
+
+  Client::Client(
+      boost::asio::io_context &io_context,
+      const token_type &token,
+      callback_function_type callback,
+      std::shared_ptr<Telemetry> telemetry)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
+          std::string("udp client ") + std::to_string(token.get_stream_id())),
+      _token(token),
+      _callback(std::move(callback)),
+      _telemetry((telemetry != nullptr ? telemetry : std::make_shared<Telemetry>())->GetStream(token.get_stream_id())),
+      _socket(io_context),
+      _strand(io_context),
+      _timer(io_context),
+      _buffer_pool(std::make_shared<BufferPool>()) {
+    if (!_token.protocol_is_udp()) {
+      throw_exception(std::invalid_argument("invalid token, only UDP tokens supported"));
+    }
+  }
+
+  Client::~Client() = default;
+
+  void Client::Connect() {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      if (_done) {
+        return;
+      }
+
+      if (_socket.is_open()) {
+        _socket.close();
+      }
+      _has_sequence = false;
+      _is_reassembling = false;
+      if (_has_connected) {
+        _telemetry->Add(_telemetry->reconnects, 1u);
+      }
+      _has_connected = true;
+
+      DEBUG_ASSERT(_token.is_valid());
+      DEBUG_ASSERT(_token.protocol_is_udp());
+      const auto ep = _token.to_udp_endpoint();
+
+      // Connecting the socket filters out datagrams not sent by the server.
+      boost::system::error_code ec;
+      _socket.open(ep.protocol(), ec);
+      if (!ec) {
+        _socket.connect(ep, ec);
+      }
+      if (ec) {
+        log_info("streaming client: failed to open udp socket:", ec.message());
+        Reconnect();
+        return;
+      }
+      _socket.set_option(boost::asio::socket_base::receive_buffer_size(RECEIVE_BUFFER_SIZE), ec);
+
+      log_debug("streaming client: subscribing to stream", GetStreamId(), "at", ep);
+      ReadDatagram();
+      KeepAlive();
+    });
+  }
+
+  void Client::Stop() {
+    _timer.cancel();
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      _done = true;
+      if (_socket.is_open()) {
+        SendRequest(Request::Type::unsubscribe);
+        _socket.close();
+      }
+    });
+  }
+
+  void Client::Reconnect() {
+    auto self = shared_from_this();
+    _timer.expires_from_now(time_duration::seconds(1u));
+    _timer.async_wait([this, self](boost::system::error_code ec) {
+      if (!ec) {
+        Connect();
+      }
+    });
+  }
+
+  void Client::KeepAlive() {
+    if (_done) {
+      return;
+    }
+    SendRequest(Request::Type::subscribe);
+    _timer.expires_from_now(KEEP_ALIVE_INTERVAL);
+    _timer.async_wait(boost::asio::bind_executor(_strand, [this, self=shared_from_this()](
+        boost::system::error_code ec) {
+      if (!ec) {
+        KeepAlive();
+      }
+    }));
+  }
+
+  void Client::SendRequest(const Request::Type type) {
+    Request request;
+    request.type = type;
+    request.stream_id = GetStreamId();
+    boost::system::error_code ec;
+    _socket.send(boost::asio::buffer(&request, sizeof(request)), 0, ec);
+    if (ec) {
+      log_debug("streaming client: failed to send udp request:", ec.message());
+    }
+  }
+
+  void Client::ReadDatagram() {
+    _socket.async_receive(
+        boost::asio::buffer(_datagram),
+        boost::asio::bind_executor(_strand, [this, self=shared_from_this()](
+            boost::system::error_code ec,
+            size_t bytes) {
+          if (_done || (ec == boost::asio::error::operation_aborted) || !_socket.is_open()) {
+            return;
+          }
+          if (!ec) {
+            HandleDatagram(bytes);
+          } else {
+            // Errors such as the server being unreachable are transient, the
+            // subscription is renewed when it comes back.
+            log_debug("streaming client: failed to read datagram:", ec.message());
+          }
+          ReadDatagram();
+        }));
+  }
+
+  void Client::HandleDatagram(const size_t bytes) {
+    if (bytes < sizeof(FragmentHeader)) {
+      return;
+    }
+    FragmentHeader header;
+    std::memcpy(&header, _datagram.data(), sizeof(header));
+    const size_t payload_size = bytes - sizeof(header);
+    const size_t offset = size_t(header.fragment_index) * FRAGMENT_SIZE;
+    if ((header.fragment_count == 0u) ||
+        (header.fragment_count != GetFragmentCount(header.message_size)) ||
+        (header.fragment_index >= header.fragment_count) ||
+        (payload_size != std::min<size_t>(FRAGMENT_SIZE, header.message_size - offset))) {
+      log_debug("streaming client: invalid datagram discarded");
+      return;
+    }
+
+    if (!_has_sequence || (header.session_tag != _session_tag)) {
+      // First message of a new session.
+      _session_tag = header.session_tag;
+      StartMessage(header);
+    } else if (IsNewer(header.sequence, _sequence)) {
+      if (_is_reassembling) {
+        log_debug("streaming client: message", _sequence, "incomplete, discarded");
+        _telemetry->CountDropped(_message.size());
+      }
+      StartMessage(header);
+    } else if ((header.sequence != _sequence) || !_is_reassembling) {
+      // Stale, this message was already delivered or dropped.
+      return;
+    } else if ((header.message_size != _message.size()) ||
+               (header.fragment_count != _received_fragments.size())) {
+      // A fragment of the message being reassembled must agree with the
+      // fragment that started it, or it would write out of bounds.
+      log_debug("streaming client: mismatched fragment discarded");
+      return;
+    }
+
+    if (_received_fragments[header.fragment_index]) {
+      return;
+    }
+    _received_fragments[header.fragment_index] = true;
+    std::memcpy(_message.data() + offset, _datagram.data() + sizeof(header), payload_size);
+
+    if (--_missing_fragments == 0u) {
+      _is_reassembling = false;
+      auto message = std::make_shared<Buffer>(std::move(_message));
+      boost::asio::post(_strand, [self=shared_from_this(), message, arrival=_arrival]() {
+        self->_telemetry->CountMessage(message->size());
+        self->_telemetry->latency.Record(arrival, telemetry_clock::now());
+        self->_callback(std::move(*message));
+      });
+    }
+  }
+
+  void Client::StartMessage(const FragmentHeader &header) {
+    _has_sequence = true;
+    _is_reassembling = true;
+    _sequence = header.sequence;
+    _arrival = telemetry_clock::now();
+    _message = _buffer_pool->Pop(header.message_size);
+    _message.reset(header.message_size);
+    _received_fragments.assign(header.fragment_count, false);
+    _missing_fragments = header.fragment_count;
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,138 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Telemetry.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/udp/Datagram.h"
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// A client that subscribes to a single stream through UDP.
+  ///
+  /// Messages are reassembled from their fragments and delivered in order.
+  /// Lost datagrams are never retransmitted: a message that is still missing
+  /// fragments when a newer one arrives is dropped, and so is any datagram of
+  /// a message older than the last one delivered.
+  ///
+  /// @warning This client should be stopped before releasing the shared pointer
+  /// or won't be destroyed.
+  class Client
+    : public std::enable_shared_from_this<Client>,
+      private profiler::LifetimeProfiled,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+    using protocol_type = endpoint::protocol_type;
+    using callback_function_type = std::function<void (Buffer)>;
+
+    /// The counters of the stream are kept in @a telemetry, or in a telemetry
+    /// of its own if none is given.
+    Client(
+        boost::asio::io_context &io_context,
+        const token_type &token,
+        callback_function_type callback,
+        std::shared_ptr<Telemetry> telemetry = nullptr);
+
+    ~Client();
+
+    void Connect();
+
+    stream_id_type GetStreamId() const {
+      return _token.get_stream_id();
+    }
+
+    void Stop();
+
+  private:
+
+    void Reconnect();
+
+    /// Sends the subscription again and schedules the next one, so the server
+    /// keeps the session open and reopens it if it restarts.
+    void KeepAlive();
+
+    void SendRequest(Request::Type type);
+
+    void ReadDatagram();
+
+    void HandleDatagram(size_t bytes);
+
+    void StartMessage(const FragmentHeader &header);
+
+    const token_type _token;
+
+    callback_function_type _callback;
+
+    const std::shared_ptr<StreamTelemetry> _telemetry;
+
+    boost::asio::ip::udp::socket _socket;
+
+    boost::asio::io_context::strand _strand;
+
+    boost::asio::deadline_timer _timer;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    std::array<unsigned char, MAX_DATAGRAM_SIZE> _datagram;
+
+    /// @name Message being reassembled
+    /// @{
+
+    Buffer _message;
+
+    std::vector<bool> _received_fragments;
+
+    uint16_t _missing_fragments = 0u;
+
+    uint32_t _session_tag = 0u;
+
+    /// Sequence number of the message being reassembled, or of the last one
+    /// delivered if none is.
+    uint32_t _sequence = 0u;
+
+    bool _has_sequence = false;
+
+    bool _is_reassembling = false;
+
+    /// Arrival of the first datagram of the message.
+    telemetry_clock::time_point _arrival;
+
+    /// @}
+
+    /// Whether any connection was attempted, the next ones count as reconnects.
+    bool _has_connected = false;
+
+    std::atomic_bool _done{false};
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
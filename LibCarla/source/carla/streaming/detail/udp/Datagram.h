@@ -0,0 +1,74 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+#pragma pack(push, 1)
+
+  /// Sent by a client to subscribe to a stream. The client repeats it
+  /// periodically to keep its session alive.
+  struct Request {
+    enum class Type : uint8_t {
+      subscribe,
+      unsubscribe
+    } type = Type::subscribe;
+
+    stream_id_type stream_id = 0u;
+  };
+
+  /// Header of every datagram sent by a server session. Messages that do not
+  /// fit in a single datagram are split in fragments of FRAGMENT_SIZE bytes,
+  /// all with the same message header.
+  struct FragmentHeader {
+    /// Identifies the session, so a client notices when the server has
+    /// restarted the session and its sequence numbers.
+    uint32_t session_tag = 0u;
+
+    /// Increases by one with every message sent by the session.
+    uint32_t sequence = 0u;
+
+    message_size_type message_size = 0u;
+
+    uint16_t fragment_index = 0u;
+
+    uint16_t fragment_count = 0u;
+  };
+
+#pragma pack(pop)
+
+  /// Payload bytes per datagram. Together with the headers it stays below the
+  /// usual Ethernet MTU, so datagrams are never fragmented by IP on the way.
+  static constexpr message_size_type FRAGMENT_SIZE = 1400u;
+
+  static constexpr size_t MAX_DATAGRAM_SIZE = sizeof(FragmentHeader) + FRAGMENT_SIZE;
+
+  static constexpr message_size_type MAX_MESSAGE_SIZE =
+      FRAGMENT_SIZE * (std::numeric_limits<uint16_t>::max)();
+
+  static constexpr uint16_t GetFragmentCount(const message_size_type message_size) {
+    return static_cast<uint16_t>((message_size + FRAGMENT_SIZE - 1u) / FRAGMENT_SIZE);
+  }
+
+  /// Whether sequence number @a lhs comes after @a rhs, taking into account
+  /// that sequence numbers wrap around.
+  static constexpr bool IsNewer(const uint32_t lhs, const uint32_t rhs) {
+    return static_cast<int32_t>(lhs - rhs) > 0;
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
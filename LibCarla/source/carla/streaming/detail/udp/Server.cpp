@@ -0,0 +1,155 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/Server.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <boost/asio/bind_executor.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  Server::Server(boost::asio::io_context &io_context, endpoint ep)
+    : _io_context(io_context),
+      _socket(_io_context, std::move(ep)),
+      _strand(_io_context),
+      _timeout(time_duration::seconds(10u)),
+      _synchronous(false),
+      _session_tags(std::random_device{}()) {
+    // Sending never blocks the io threads, a message that does not fit in the
+    // socket buffer is dropped (unless in synchronous mode).
+    _socket.non_blocking(true);
+  }
+
+  void Server::ReadRequest() {
+    _socket.async_receive_from(
+        boost::asio::buffer(&_request, sizeof(_request)),
+        _request_endpoint,
+        boost::asio::bind_executor(_strand, [this](
+            const boost::system::error_code &ec,
+            size_t bytes) {
+          if (ec == boost::asio::error::operation_aborted) {
+            return;
+          }
+          if (ec) {
+            log_debug("udp server: error reading request:", ec.message());
+          } else if (bytes == sizeof(_request)) {
+            HandleRequest();
+          }
+          ReadRequest();
+        }));
+  }
+
+  void Server::HandleRequest() {
+    auto search = _sessions.find(_request_endpoint);
+    if (search != _sessions.end()) {
+      auto session = search->second;
+      if ((_request.type == Request::Type::subscribe) &&
+          (session->get_stream_id() == _request.stream_id)) {
+        session->KeepAlive();
+        return;
+      }
+      session->CloseNow();
+    }
+    if (_request.type != Request::Type::subscribe) {
+      return;
+    }
+
+    auto session = std::make_shared<ServerSession>(
+        _io_context,
+        _timeout,
+        *this,
+        _request.stream_id,
+        _request_endpoint,
+        static_cast<uint32_t>(_session_tags()));
+    _sessions.emplace(_request_endpoint, session);
+    session->Open(_on_session_opened, _on_session_closed);
+  }
+
+  template <typename BufferSequence>
+  static bool SendDatagram(
+      boost::asio::ip::udp::socket &socket,
+      const BufferSequence &datagram,
+      const boost::asio::ip::udp::endpoint &remote_endpoint,
+      const bool wait_for_room) {
+    boost::system::error_code ec;
+    socket.send_to(datagram, remote_endpoint, 0, ec);
+    while ((ec == boost::asio::error::would_block) && wait_for_room) {
+      socket.wait(boost::asio::ip::udp::socket::wait_write, ec);
+      if (!ec) {
+        socket.send_to(datagram, remote_endpoint, 0, ec);
+      }
+    }
+    return !ec;
+  }
+
+  bool Server::Send(ServerSession &session, const tcp::Message &message) {
+    if (message.size() > MAX_MESSAGE_SIZE) {
+      log_warning("udp session: message of", message.size(), "bytes is too big, discarded");
+      return false;
+    }
+
+    FragmentHeader header;
+    header.session_tag = session._session_tag;
+    header.sequence = session._sequence++;
+    header.message_size = message.size();
+    header.fragment_count = GetFragmentCount(message.size());
+
+    // A fragment may take pieces of several buffers of the message, but never
+    // more than the message has.
+    std::array<boost::asio::const_buffer, tcp::Message::max_size() + 1u> datagram;
+    auto payload = message.GetPayloadSequence();
+    auto buffer = payload.begin();
+    size_t offset = 0u;
+
+    for (auto i = 0u; i < header.fragment_count; ++i) {
+      header.fragment_index = static_cast<uint16_t>(i);
+      datagram.fill(boost::asio::const_buffer());
+      datagram[0u] = boost::asio::buffer(&header, sizeof(header));
+      size_t remaining = std::min<size_t>(FRAGMENT_SIZE, message.size() - i * FRAGMENT_SIZE);
+      size_t piece = 1u;
+      while (remaining > 0u) {
+        DEBUG_ASSERT(buffer != payload.end());
+        const size_t size = std::min(remaining, buffer->size() - offset);
+        if (size > 0u) {
+          DEBUG_ASSERT(piece < datagram.size());
+          datagram[piece++] = boost::asio::buffer(*buffer + offset, size);
+          remaining -= size;
+          offset += size;
+        }
+        if (offset == buffer->size()) {
+          ++buffer;
+          offset = 0u;
+        }
+      }
+      if (!SendDatagram(_socket, datagram, session._remote_endpoint, _synchronous)) {
+        // The client drops the fragments it got of this message as soon as
+        // the next message arrives.
+        log_debug("udp session: failed to send message", header.sequence, ": message discarded");
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void Server::RemoveSession(const ServerSession &session) {
+    auto search = _sessions.find(session._remote_endpoint);
+    if ((search != _sessions.end()) && (search->second.get() == &session)) {
+      _sessions.erase(search);
+    }
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
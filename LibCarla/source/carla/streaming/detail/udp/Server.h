@@ -0,0 +1,125 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/streaming/detail/Telemetry.h"
+#include "carla/streaming/detail/udp/Datagram.h"
+#include "carla/streaming/detail/udp/ServerSession.h"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <random>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  /// A server that sends each stream to its subscribers as UDP datagrams.
+  /// Clients subscribe by sending a Request with the stream id to the server
+  /// endpoint, which opens a session for the client endpoint.
+  ///
+  /// @warning This server cannot be destructed before its @a io_context is
+  /// stopped.
+  class Server : private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+    using protocol_type = endpoint::protocol_type;
+
+    explicit Server(boost::asio::io_context &io_context, endpoint ep);
+
+    endpoint GetLocalEndpoint() const {
+      return _socket.local_endpoint();
+    }
+
+    /// Set session time-out. Applies only to newly created sessions. By default
+    /// the time-out is set to 10 seconds.
+    void SetTimeout(time_duration timeout) {
+      _timeout = timeout;
+    }
+
+    /// Start listening for requests. On each new subscription, @a
+    /// on_session_opened is called, and @a on_session_closed when the session
+    /// is closed.
+    template <typename FunctorT1, typename FunctorT2>
+    void Listen(FunctorT1 on_session_opened, FunctorT2 on_session_closed) {
+      boost::asio::post(_strand, [=]() {
+        _on_session_opened = std::move(on_session_opened);
+        _on_session_closed = std::move(on_session_closed);
+        ReadRequest();
+      });
+    }
+
+    /// In synchronous mode the sessions wait for room in the socket buffer
+    /// instead of dropping the message.
+    void SetSynchronousMode(bool is_synchro) {
+      _synchronous = is_synchro;
+    }
+
+    bool IsSynchronousMode() const {
+      return _synchronous;
+    }
+
+    /// Counters of every stream with a session opened so far.
+    TelemetrySnapshot GetTelemetry() const {
+      return _telemetry.Snapshot();
+    }
+
+  private:
+
+    friend class ServerSession;
+
+    void ReadRequest();
+
+    void HandleRequest();
+
+    /// Sends @a message to @a session as a sequence of datagrams. Must be
+    /// called from within the strand. Returns false if the message had to be
+    /// discarded.
+    bool Send(ServerSession &session, const tcp::Message &message);
+
+    void RemoveSession(const ServerSession &session);
+
+    boost::asio::io_context &_io_context;
+
+    boost::asio::ip::udp::socket _socket;
+
+    /// Serializes every operation on the socket and the session map.
+    boost::asio::io_context::strand _strand;
+
+    std::atomic<time_duration> _timeout;
+
+    std::atomic_bool _synchronous;
+
+    ServerSession::callback_function_type _on_session_opened;
+
+    ServerSession::callback_function_type _on_session_closed;
+
+    std::map<endpoint, std::shared_ptr<ServerSession>> _sessions;
+
+    std::mt19937 _session_tags;
+
+    endpoint _request_endpoint;
+
+    Request _request;
+
+    Telemetry _telemetry;
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,115 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/udp/ServerSession.h"
+#include "carla/streaming/detail/udp/Server.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+
+#include <atomic>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  static std::atomic_size_t SESSION_COUNTER{0u};
+
+  ServerSession::ServerSession(
+      boost::asio::io_context &io_context,
+      const time_duration timeout,
+      Server &server,
+      const stream_id_type stream_id,
+      endpoint remote_endpoint,
+      const uint32_t session_tag)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
+          std::string("udp server session ") + std::to_string(SESSION_COUNTER)),
+      _server(server),
+      _session_id(SESSION_COUNTER++),
+      _stream_id(stream_id),
+      _remote_endpoint(std::move(remote_endpoint)),
+      _session_tag(session_tag),
+      _telemetry(server._telemetry.GetStream(stream_id)),
+      _timeout(timeout),
+      _deadline(io_context) {}
+
+  void ServerSession::Open(
+      callback_function_type on_opened,
+      callback_function_type on_closed) {
+    DEBUG_ASSERT(on_opened && on_closed);
+    _on_closed = std::move(on_closed);
+    _is_open = true;
+    log_debug("udp session", _session_id, "for stream", _stream_id, "started");
+    StartTimer();
+    boost::asio::post(_server._io_context, [self=shared_from_this(), callback=std::move(on_opened)]() {
+      callback(self);
+    });
+  }
+
+  void ServerSession::Write(std::shared_ptr<const tcp::Message> message) {
+    DEBUG_ASSERT(message != nullptr);
+    DEBUG_ASSERT(!message->empty());
+    auto self = shared_from_this();
+    const auto enqueued = telemetry_clock::now();
+    boost::asio::post(_server._strand, [this, self, message, enqueued]() {
+      if (!_is_open) {
+        return;
+      }
+      if (_server.Send(*this, *message)) {
+        _telemetry->CountMessage(message->size());
+        _telemetry->latency.Record(enqueued, telemetry_clock::now());
+      } else {
+        _telemetry->CountDropped(message->size());
+      }
+    });
+  }
+
+  void ServerSession::Close() {
+    boost::asio::post(_server._strand, [self=shared_from_this()]() { self->CloseNow(); });
+  }
+
+  void ServerSession::KeepAlive() {
+    _is_alive = true;
+  }
+
+  void ServerSession::StartTimer() {
+    _deadline.expires_from_now(_timeout);
+    _deadline.async_wait(boost::asio::bind_executor(
+        _server._strand,
+        [this, self=shared_from_this()](boost::system::error_code ec) {
+          if (ec || !_is_open) {
+            return;
+          }
+          if (_is_alive) {
+            _is_alive = false;
+            StartTimer();
+          } else {
+            log_debug("udp session", _session_id, "timed out");
+            CloseNow();
+          }
+        }));
+  }
+
+  void ServerSession::CloseNow() {
+    if (!_is_open) {
+      return;
+    }
+    auto self = shared_from_this(); // The server may hold the last reference.
+    _is_open = false;
+    _deadline.cancel();
+    _server.RemoveSession(*this);
+    _on_closed(self);
+    log_debug("udp session", _session_id, "closed");
+  }
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,110 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Time.h"
+#include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Session.h"
+#include "carla/streaming/detail/Telemetry.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <functional>
+#include <memory>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace udp {
+
+  class Server;
+
+  /// A UDP server session, one per client endpoint subscribed to a stream.
+  /// Every message is sent as one or more datagrams, and nothing is ever
+  /// retransmitted. The session closes itself after @a timeout without
+  /// receiving a request from its client.
+  class ServerSession
+    : public Session,
+      public std::enable_shared_from_this<ServerSession>,
+      private profiler::LifetimeProfiled {
+  public:
+
+    using endpoint = boost::asio::ip::udp::endpoint;
+    using callback_function_type = std::function<void(std::shared_ptr<ServerSession>)>;
+
+    explicit ServerSession(
+        boost::asio::io_context &io_context,
+        time_duration timeout,
+        Server &server,
+        stream_id_type stream_id,
+        endpoint remote_endpoint,
+        uint32_t session_tag);
+
+    /// Starts the session and calls @a on_opened, and @a on_closed once the
+    /// session is closed.
+    void Open(
+        callback_function_type on_opened,
+        callback_function_type on_closed);
+
+    stream_id_type get_stream_id() const final {
+      return _stream_id;
+    }
+
+    const endpoint &get_remote_endpoint() const {
+      return _remote_endpoint;
+    }
+
+    /// Writes some data to the client.
+    void Write(std::shared_ptr<const tcp::Message> message) final;
+
+    /// Post a job to close the session.
+    void Close() final;
+
+  private:
+
+    friend class Server;
+
+    /// Called by the server on every request of the client.
+    void KeepAlive();
+
+    void StartTimer();
+
+    void CloseNow();
+
+    Server &_server;
+
+    const size_t _session_id;
+
+    const stream_id_type _stream_id;
+
+    const endpoint _remote_endpoint;
+
+    const uint32_t _session_tag;
+
+    const std::shared_ptr<StreamTelemetry> _telemetry;
+
+    uint32_t _sequence = 0u;
+
+    time_duration _timeout;
+
+    boost::asio::deadline_timer _deadline;
+
+    callback_function_type _on_closed;
+
+    bool _is_open = false;
+
+    /// Whether the client sent a request since the timer last expired.
+    bool _is_alive = true;
+  };
+
+} // namespace udp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/streaming/detail/Telemetry.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/tcp/Client.h"
 
@@ -60,7 +61,8 @@ namespace low_level {
       auto client = std::make_shared<underlying_client>(
           io_context,
           token,
-          std::forward<Functor>(callback));
+          std::forward<Functor>(callback),
+          _telemetry);
       client->Connect();
       _clients.emplace(token.get_stream_id(), std::move(client));
     }
@@ -74,10 +76,17 @@ namespace low_level {
       }
     }
 
+    /// Counters of every stream subscribed to so far.
+    detail::TelemetrySnapshot GetTelemetry() const {
+      return _telemetry->Snapshot();
+    }
+
   private:
 
     boost::asio::ip::address _fallback_address;
 
+    const std::shared_ptr<detail::Telemetry> _telemetry = std::make_shared<detail::Telemetry>();
+
     std::unordered_map<
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
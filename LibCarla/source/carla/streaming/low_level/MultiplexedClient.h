@@ -0,0 +1,115 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/streaming/detail/Telemetry.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/tcp/Client.h"
+
+#include <boost/asio/io_context.hpp>
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+namespace carla {
+namespace streaming {
+namespace low_level {
+
+  /// A client able to subscribe to multiple streams, that opens a single
+  /// multiplexed connection per server regardless of the number of streams.
+  /// Accepts an external io_context.
+  ///
+  /// @warning The client should not be destroyed before the @a io_context is
+  /// stopped.
+  class MultiplexedClient {
+  public:
+
+    using underlying_client = detail::tcp::Client;
+    using endpoint = underlying_client::endpoint;
+    using token_type = carla::streaming::detail::token_type;
+
+    explicit MultiplexedClient(boost::asio::ip::address fallback_address)
+      : _fallback_address(std::move(fallback_address)) {}
+
+    explicit MultiplexedClient(const std::string &fallback_address)
+      : MultiplexedClient(carla::streaming::make_address(fallback_address)) {}
+
+    explicit MultiplexedClient()
+      : MultiplexedClient(carla::streaming::make_localhost_address()) {}
+
+    ~MultiplexedClient() {
+      for (auto &pair : _clients) {
+        pair.second->Stop();
+      }
+    }
+
+    /// @warning cannot subscribe twice to the same stream (even if it's a
+    /// MultiStream).
+    template <typename Functor>
+    void Subscribe(
+        boost::asio::io_context &io_context,
+        token_type token,
+        Functor &&callback) {
+      DEBUG_ASSERT_EQ(_streams.find(token.get_stream_id()), _streams.end());
+      if (!token.has_address()) {
+        token.set_address(_fallback_address);
+      }
+      const auto server = token.to_tcp_endpoint();
+      auto it = _clients.find(server);
+      if (it == _clients.end()) {
+        auto client = std::make_shared<underlying_client>(io_context, token, _telemetry);
+        client->Connect();
+        it = _clients.emplace(server, std::move(client)).first;
+      }
+      it->second->Subscribe(token.get_stream_id(), std::forward<Functor>(callback));
+      _streams.emplace(token.get_stream_id(), server);
+    }
+
+    void UnSubscribe(token_type token) {
+      log_debug("calling sensor UnSubscribe()");
+      auto stream = _streams.find(token.get_stream_id());
+      if (stream == _streams.end()) {
+        return;
+      }
+      const auto server = stream->second;
+      _streams.erase(stream);
+      auto it = _clients.find(server);
+      DEBUG_ASSERT(it != _clients.end());
+      it->second->UnSubscribe(token.get_stream_id());
+      // Close the connection with its last stream.
+      for (auto &pair : _streams) {
+        if (pair.second == server) {
+          return;
+        }
+      }
+      it->second->Stop();
+      _clients.erase(it);
+    }
+
+    /// Counters of every stream subscribed to so far.
+    detail::TelemetrySnapshot GetTelemetry() const {
+      return _telemetry->Snapshot();
+    }
+
+  private:
+
+    boost::asio::ip::address _fallback_address;
+
+    const std::shared_ptr<detail::Telemetry> _telemetry = std::make_shared<detail::Telemetry>();
+
+    std::map<endpoint, std::shared_ptr<underlying_client>> _clients;
+
+    /// Server of each stream subscribed.
+    std::unordered_map<detail::stream_id_type, endpoint> _streams;
+  };
+
+} // namespace low_level
+} // namespace streaming
+} // namespace carla
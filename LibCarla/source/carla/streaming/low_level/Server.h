@@ -65,6 +65,10 @@ namespace low_level {
       return _dispatcher.MakeStream();
     }
 
+    Stream MakeUdpStream() {
+      return _dispatcher.MakeUdpStream();
+    }
+
     void CloseStream(carla::streaming::detail::stream_id_type id) {
       return _dispatcher.CloseStream(id);
     }
@@ -73,13 +77,41 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    template <typename PolicyT>
+    void SetSendQueue(size_t depth, PolicyT policy) {
+      _server.SetSendQueue(depth, policy);
+    }
+
+    template <typename DurationT>
+    void SetCoalescing(size_t max_message_size, DurationT window) {
+      _server.SetCoalescing(max_message_size, window);
+    }
+
+    auto GetTelemetry() const {
+      return _server.GetTelemetry();
+    }
+
     carla::streaming::detail::token_type GetToken(carla::streaming::detail::stream_id_type sensor_id) {
       return _dispatcher.GetToken(sensor_id);
     }
 
+    /// Connects the sessions opened by @a server, a server of another protocol
+    /// listening on the same port, to the streams of this server.
+    ///
+    /// @warning @a server cannot be destructed before this server.
+    template <typename OtherServerT>
+    void Attach(OtherServerT &server) {
+      Listen(server);
+    }
+
   private:
 
     void StartServer() {
+      Listen(_server);
+    }
+
+    template <typename ServerT>
+    void Listen(ServerT &server) {
       auto on_session_opened = [this](auto session) {
         if (!_dispatcher.RegisterSession(session)) {
           session->Close();
@@ -89,7 +121,7 @@ namespace low_level {
         log_debug("on_session_closed called");
         _dispatcher.DeregisterSession(session);
       };
-      _server.Listen(on_session_opened, on_session_closed);
+      server.Listen(on_session_opened, on_session_closed);
     }
 
     underlying_server _server;
@@ -46,15 +46,16 @@ void ALSM::Update() {
 
   bool hybrid_physics_mode = parameters.GetHybridPhysicsMode();
 
-  std::set<ActorId> world_vehicle_ids;
-  std::set<ActorId> world_pedestrian_ids;
-  std::vector<ActorId> unregistered_list_to_be_deleted;
+  const cc::WorldSnapshot world_snapshot = world.GetSnapshot();
+  current_timestamp = world_snapshot.GetTimestamp();
 
-  current_timestamp = world.GetSnapshot().GetTimestamp();
-  ActorList world_actors = world.GetActors();
+  // Compare with the previous snapshot, so that the rest of the update only
+  // touches the actors that were spawned, destroyed or changed since then.
+  snapshot_delta.Update(world_snapshot);
+  std::vector<ActorId> new_actor_ids = snapshot_delta.GetAddedActors();
 
   // Find destroyed actors and perform clean up.
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
+  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_snapshot, new_actor_ids);
 
   const ActorIdSet &destroyed_registered = destroyed_actors.first;
   for (const auto &deletion_id: destroyed_registered) {
@@ -84,7 +85,7 @@ void ALSM::Update() {
   }
 
   // Scan for new unregistered actors.
-  IdentifyNewActors(world_actors);
+  IdentifyNewActors(new_actor_ids);
 
   // Update dynamic state and static attributes for all registered vehicles.
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
@@ -109,23 +110,28 @@ void ALSM::Update() {
   }
 
   // Update dynamic state and static attributes for unregistered actors.
-  UpdateUnregisteredActorsData();
+  UpdateUnregisteredActorsData(world_snapshot, new_actor_ids);
 }
 
-void ALSM::IdentifyNewActors(const ActorList &actor_list) {
+void ALSM::IdentifyNewActors(const std::vector<ActorId> &new_actor_ids) {
+  if (new_actor_ids.empty()) {
+    return;
+  }
+
+  ActorList actor_list = world.GetActors(new_actor_ids);
   for (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
     ActorPtr actor = *iter;
     ActorId actor_id = actor->GetId();
     // Identify any new hero vehicle
     if (actor->GetTypeId().front() == 'v') {
-     if (hero_actors.size() == 0u || hero_actors.find(actor_id) == hero_actors.end()) {
-      for (auto&& attribute: actor->GetAttributes()) {
-        if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
-          hero_actors.insert({actor_id, actor});
+      if (hero_actors.size() == 0u || hero_actors.find(actor_id) == hero_actors.end()) {
+        for (auto&& attribute: actor->GetAttributes()) {
+          if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
+            hero_actors.insert({actor_id, actor});
+          }
         }
       }
     }
-  }
     if (!registered_vehicles.Contains(actor_id)
         && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
 
@@ -134,31 +140,30 @@ void ALSM::IdentifyNewActors(const ActorList &actor_list) {
   }
 }
 
-ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list) {
+ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const cc::WorldSnapshot &world_snapshot,
+                                                     std::vector<ActorId> &new_actor_ids) {
 
   ALSM::DestroyeddActors destroyed_actors;
   ActorIdSet &deleted_registered = destroyed_actors.first;
   ActorIdSet &deleted_unregistered = destroyed_actors.second;
 
-  // Building hash set of actors present in current frame.
-  ActorIdSet current_actors;
-  for  (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    current_actors.insert((*iter)->GetId());
-  }
-
-  // Searching for destroyed registered actors.
+  // Searching for destroyed registered actors, and for unregistered actors
+  // that have been registered since the last frame.
   std::vector<ActorId> registered_ids = registered_vehicles.GetIDList();
   for (const ActorId &actor_id : registered_ids) {
-    if (current_actors.find(actor_id) == current_actors.end()) {
+    if (!world_snapshot.Contains(actor_id)) {
       deleted_registered.insert(actor_id);
+    } else if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
+      deleted_unregistered.insert(actor_id);
+      // Removing the unregistered entry also drops the actor from the hero
+      // actors, so it has to go through the hero detection again.
+      new_actor_ids.push_back(actor_id);
     }
   }
 
   // Searching for destroyed unregistered actors.
-  for (const auto &actor_info: unregistered_actors) {
-    const ActorId &actor_id = actor_info.first;
-     if (current_actors.find(actor_id) == current_actors.end()
-         || registered_vehicles.Contains(actor_id)) {
+  for (const ActorId &actor_id : snapshot_delta.GetRemovedActors()) {
+    if (unregistered_actors.find(actor_id) != unregistered_actors.end()) {
       deleted_unregistered.insert(actor_id);
     }
   }
@@ -201,7 +206,8 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
   cg::Location vehicle_location = vehicle_transform.location;
   cg::Rotation vehicle_rotation = vehicle_transform.rotation;
   cg::Vector3D vehicle_velocity = vehicle->GetVelocity();
-  bool state_entry_present = simulation_state.ContainsActor(actor_id);
+  const ActorSlot actor_slot = simulation_state.FindSlot(actor_id);
+  bool state_entry_present = actor_slot.IsValid();
 
   // Initializing idle times.
   if (idle_time.find(actor_id) == idle_time.end() && current_timestamp.elapsed_seconds != 0.0) {
@@ -229,7 +235,7 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
       vehicle->SetSimulatePhysics(enable_physics);
       has_physics_enabled[actor_id] = enable_physics;
       if (enable_physics == true && state_entry_present) {
-        vehicle->SetTargetVelocity(simulation_state.GetVelocity(actor_id));
+        vehicle->SetTargetVelocity(simulation_state.GetVelocity(actor_slot));
       }
     }
   }
@@ -237,9 +243,9 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
   // If physics are disabled, calculate velocity based on change in position.
   // Do not use 'enable_physics' as turning off the physics in this tick doesn't remove the velocity.
   // To avoid issues with other clients teleporting the actors, use the previous outpout location.
-  if (state_entry_present && !simulation_state.IsPhysicsEnabled(actor_id)){
-    cg::Location previous_location = simulation_state.GetLocation(actor_id);
-    cg::Location previous_end_location = simulation_state.GetHybridEndLocation(actor_id);
+  if (state_entry_present && !simulation_state.IsPhysicsEnabled(actor_slot)){
+    cg::Location previous_location = simulation_state.GetLocation(actor_slot);
+    cg::Location previous_end_location = simulation_state.GetHybridEndLocation(actor_slot);
     cg::Vector3D displacement = (previous_end_location - previous_location);
     vehicle_velocity = displacement * INV_HYBRID_DT;
   }
@@ -255,8 +261,8 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
 
   // Update simulation state.
   if (state_entry_present) {
-    simulation_state.UpdateKinematicState(actor_id, kinematic_state);
-    simulation_state.UpdateTrafficLightState(actor_id, tl_state);
+    simulation_state.UpdateKinematicState(actor_slot, kinematic_state);
+    simulation_state.UpdateTrafficLightState(actor_slot, tl_state);
   }
   else {
     cg::Vector3D dimensions = vehicle_ptr->GetBoundingBox().extent;
@@ -270,74 +276,87 @@ void ALSM::UpdateData(const bool hybrid_physics_mode,
 }
 
 
-void ALSM::UpdateUnregisteredActorsData() {
-  for (auto &actor_info: unregistered_actors) {
+void ALSM::UpdateUnregisteredActorsData(const cc::WorldSnapshot &world_snapshot,
+                                        const std::vector<ActorId> &new_actor_ids) {
+  for (const ActorId &actor_id : new_actor_ids) {
+    UpdateUnregisteredActorData(world_snapshot, actor_id);
+  }
+  for (const ActorId &actor_id : snapshot_delta.GetChangedActors()) {
+    UpdateUnregisteredActorData(world_snapshot, actor_id);
+  }
+}
 
-    const ActorId actor_id = actor_info.first;
-    const ActorPtr actor_ptr = actor_info.second;
-    const std::string type_id = actor_ptr->GetTypeId();
+void ALSM::UpdateUnregisteredActorData(const cc::WorldSnapshot &world_snapshot, const ActorId actor_id) {
 
-    const cg::Transform actor_transform = actor_ptr->GetTransform();
-    const cg::Location actor_location = actor_transform.location;
-    const cg::Rotation actor_rotation = actor_transform.rotation;
-    const cg::Vector3D actor_velocity = actor_ptr->GetVelocity();
-    const bool actor_is_dormant = actor_ptr->IsDormant();
-    KinematicState kinematic_state {actor_location, actor_rotation, actor_velocity, -1.0f, true, actor_is_dormant, cg::Location()};
+  auto actor_info = unregistered_actors.find(actor_id);
+  const boost::optional<cc::ActorSnapshot> actor_snapshot = world_snapshot.Find(actor_id);
+  if (actor_info == unregistered_actors.end() || !actor_snapshot) {
+    return;
+  }
 
-    TrafficLightState tl_state;
-    ActorType actor_type = ActorType::Any;
-    cg::Vector3D dimensions;
-    std::vector<SimpleWaypointPtr> nearest_waypoints;
+  const ActorPtr actor_ptr = actor_info->second;
+  const std::string &type_id = actor_ptr->GetTypeId();
 
-    bool state_entry_not_present = !simulation_state.ContainsActor(actor_id);
-    if (type_id.front() == 'v') {
-      auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(actor_ptr);
-      kinematic_state.speed_limit = vehicle_ptr->GetSpeedLimit();
+  const cg::Transform &actor_transform = actor_snapshot->transform;
+  const cg::Location actor_location = actor_transform.location;
+  const cg::Rotation actor_rotation = actor_transform.rotation;
+  const cg::Vector3D actor_velocity = actor_snapshot->velocity;
+  const bool actor_is_dormant = actor_snapshot->actor_state == rpc::ActorState::Dormant;
+  KinematicState kinematic_state {actor_location, actor_rotation, actor_velocity, -1.0f, true, actor_is_dormant, cg::Location()};
 
-      tl_state = {vehicle_ptr->GetTrafficLightState(), vehicle_ptr->IsAtTrafficLight()};
+  TrafficLightState tl_state;
+  ActorType actor_type = ActorType::Any;
+  cg::Vector3D dimensions;
+  std::vector<NodeIndex> nearest_waypoints;
 
-      if (state_entry_not_present) {
-        dimensions = vehicle_ptr->GetBoundingBox().extent;
-        actor_type = ActorType::Vehicle;
-        StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
+  const ActorSlot actor_slot = simulation_state.FindSlot(actor_id);
+  bool state_entry_not_present = !actor_slot.IsValid();
+  if (type_id.front() == 'v') {
+    const auto &vehicle_data = actor_snapshot->state.vehicle_data;
+    kinematic_state.speed_limit = vehicle_data.speed_limit;
 
-        simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
-      } else {
-        simulation_state.UpdateKinematicState(actor_id, kinematic_state);
-        simulation_state.UpdateTrafficLightState(actor_id, tl_state);
-      }
+    tl_state = {vehicle_data.traffic_light_state, vehicle_data.has_traffic_light};
 
-      // Identify occupied waypoints.
-      cg::Vector3D extent = vehicle_ptr->GetBoundingBox().extent;
-      cg::Vector3D heading_vector = vehicle_ptr->GetTransform().GetForwardVector();
-      std::vector<cg::Location> corners = {actor_location + cg::Location(extent.x * heading_vector),
-                                           actor_location,
-                                           actor_location + cg::Location(-extent.x * heading_vector)};
-      for (cg::Location &vertex: corners) {
-        SimpleWaypointPtr nearest_waypoint = local_map->GetWaypoint(vertex);
-        nearest_waypoints.push_back(nearest_waypoint);
-      }
+    if (state_entry_not_present) {
+      auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(actor_ptr);
+      dimensions = vehicle_ptr->GetBoundingBox().extent;
+      actor_type = ActorType::Vehicle;
+      StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
+
+      simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
+    } else {
+      dimensions = simulation_state.GetDimensions(actor_slot);
+      simulation_state.UpdateKinematicState(actor_slot, kinematic_state);
+      simulation_state.UpdateTrafficLightState(actor_slot, tl_state);
     }
-    else if (type_id.front() == 'w') {
-      auto walker_ptr = boost::static_pointer_cast<cc::Walker>(actor_ptr);
 
-      if (state_entry_not_present) {
-        dimensions = walker_ptr->GetBoundingBox().extent;
-        actor_type = ActorType::Pedestrian;
-        StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
+    // Identify occupied waypoints.
+    cg::Vector3D heading_vector = actor_transform.GetForwardVector();
+    std::vector<cg::Location> corners = {actor_location + cg::Location(dimensions.x * heading_vector),
+                                         actor_location,
+                                         actor_location + cg::Location(-dimensions.x * heading_vector)};
+    for (cg::Location &vertex: corners) {
+      nearest_waypoints.push_back(local_map->GetWaypointIndex(vertex));
+    }
+  }
+  else if (type_id.front() == 'w') {
+    auto walker_ptr = boost::static_pointer_cast<cc::Walker>(actor_ptr);
 
-        simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
-      } else {
-        simulation_state.UpdateKinematicState(actor_id, kinematic_state);
-      }
+    if (state_entry_not_present) {
+      dimensions = walker_ptr->GetBoundingBox().extent;
+      actor_type = ActorType::Pedestrian;
+      StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
 
-      // Identify occupied waypoints.
-      SimpleWaypointPtr nearest_waypoint = local_map->GetWaypoint(actor_location);
-      nearest_waypoints.push_back(nearest_waypoint);
+      simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
+    } else {
+      simulation_state.UpdateKinematicState(actor_slot, kinematic_state);
     }
 
-    track_traffic.UpdateUnregisteredGridPosition(actor_id, nearest_waypoints);
+    // Identify occupied waypoints.
+    nearest_waypoints.push_back(local_map->GetWaypointIndex(actor_location));
   }
+
+  track_traffic.UpdateUnregisteredGridPosition(actor_id, nearest_waypoints, local_map->GetGraph());
 }
 
 void ALSM::UpdateIdleTime(std::pair<ActorId, double>& max_idle_time, const ActorId& actor_id) {
@@ -369,13 +388,16 @@ bool ALSM::IsVehicleStuck(const ActorId& actor_id) {
 void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
   if (registered_actor) {
     registered_vehicles.Remove({actor_id});
-    buffer_map.erase(actor_id);
+    buffer_map.Remove(actor_id);
     idle_time.erase(actor_id);
     localization_stage.RemoveActor(actor_id);
     collision_stage.RemoveActor(actor_id);
     traffic_light_stage.RemoveActor(actor_id);
     motion_plan_stage.RemoveActor(actor_id);
     vehicle_light_stage.RemoveActor(actor_id);
+    // Report the actor as new in the next update, so that it is picked up as
+    // an unregistered actor if it is still alive.
+    snapshot_delta.Forget(actor_id);
   }
   else {
     unregistered_actors.erase(actor_id);
@@ -390,6 +412,7 @@ void ALSM::Reset() {
   unregistered_actors.clear();
   idle_time.clear();
   hero_actors.clear();
+  snapshot_delta.Reset();
   elapsed_last_actor_destruction = 0.0;
   current_timestamp = world.GetSnapshot().GetTimestamp();
 }
@@ -6,6 +6,7 @@
 #include "carla/client/ActorList.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
 #include "carla/Memory.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
@@ -17,6 +18,7 @@
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
+#include "carla/trafficmanager/SnapshotDelta.h"
 #include "carla/trafficmanager/TrafficLightStage.h"
 #include "carla/trafficmanager/VehicleLightStage.h"
 
@@ -65,6 +67,8 @@ private:
   double elapsed_last_actor_destruction {0.0};
   cc::Timestamp current_timestamp;
   std::unordered_map<ActorId, bool> has_physics_enabled;
+  // Actors added, removed and changed since the previous world snapshot.
+  SnapshotDelta snapshot_delta;
 
   // Updates the duration for which a registered vehicle is stuck at a location.
   void UpdateIdleTime(std::pair<ActorId, double>& max_idle_time, const ActorId& actor_id);
@@ -73,12 +77,16 @@ private:
   bool IsVehicleStuck(const ActorId& actor_id);
 
   // Method to identify actors newly spawned in the simulation since last tick.
-  void IdentifyNewActors(const ActorList &actor_list);
+  // Only the actors in the list are fetched from the client.
+  void IdentifyNewActors(const std::vector<ActorId> &new_actor_ids);
 
   using DestroyeddActors = std::pair<ActorIdSet, ActorIdSet>;
   // Method to identify actors deleted in the last frame.
   // Arrays of registered and unregistered actors are returned separately.
-  DestroyeddActors IdentifyDestroyedActors(const ActorList &actor_list);
+  // Unregistered actors that have been registered since the last frame are
+  // reported as destroyed unregistered actors and appended to new_actor_ids.
+  DestroyeddActors IdentifyDestroyedActors(const cc::WorldSnapshot &world_snapshot,
+                                           std::vector<ActorId> &new_actor_ids);
 
   using IdleInfo = std::pair<ActorId, double>;
   void UpdateRegisteredActorsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
@@ -87,7 +95,12 @@ private:
                   ALSM::IdleInfo &max_idle_time, const Actor &vehicle,
                   const bool hero_actor_present, const float physics_radius_square);
 
-  void UpdateUnregisteredActorsData();
+  // Updates the unregistered actors that were added or changed since the last
+  // frame. Unchanged actors keep their state and occupied waypoints.
+  void UpdateUnregisteredActorsData(const cc::WorldSnapshot &world_snapshot,
+                                    const std::vector<ActorId> &new_actor_ids);
+
+  void UpdateUnregisteredActorData(const cc::WorldSnapshot &world_snapshot, const ActorId actor_id);
 
 public:
   ALSM(AtomicActorSet &registered_vehicles,
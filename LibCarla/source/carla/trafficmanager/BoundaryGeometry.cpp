@@ -0,0 +1,296 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "carla/Debug.h"
+
+#include "carla/trafficmanager/BoundaryGeometry.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  // ===========================================================================
+  // -- Packs of doubles -------------------------------------------------------
+  // ===========================================================================
+
+  // The edge loops below are written once against these packs, every pack
+  // evaluates the same operations in the same order so all of them produce
+  // bit-identical results.
+
+  struct ScalarPack {
+    using Value = double;
+    using Mask = bool;
+    static constexpr size_t WIDTH = 1u;
+
+    static Value Load(const double *data) { return *data; }
+    static Value Set(const double value) { return value; }
+    static Value Add(const Value a, const Value b) { return a + b; }
+    static Value Sub(const Value a, const Value b) { return a - b; }
+    static Value Mul(const Value a, const Value b) { return a * b; }
+    static Value Div(const Value a, const Value b) { return a / b; }
+    static Value Min(const Value a, const Value b) { return b < a ? b : a; }
+    static Mask LessEqual(const Value a, const Value b) { return a <= b; }
+    static Mask And(const Mask a, const Mask b) { return a && b; }
+    /// Lanes of @a a where @a mask is set and lanes of @a b elsewhere.
+    static Value Select(const Mask mask, const Value a, const Value b) { return mask ? a : b; }
+    static double ReduceMin(const Value value) { return value; }
+    static unsigned MaskBits(const Mask mask) { return mask ? 1u : 0u; }
+  };
+
+#if defined(__AVX__)
+
+  struct SimdPack {
+    using Value = __m256d;
+    using Mask = __m256d;
+    static constexpr size_t WIDTH = 4u;
+
+    static Value Load(const double *data) { return _mm256_loadu_pd(data); }
+    static Value Set(const double value) { return _mm256_set1_pd(value); }
+    static Value Add(const Value a, const Value b) { return _mm256_add_pd(a, b); }
+    static Value Sub(const Value a, const Value b) { return _mm256_sub_pd(a, b); }
+    static Value Mul(const Value a, const Value b) { return _mm256_mul_pd(a, b); }
+    static Value Div(const Value a, const Value b) { return _mm256_div_pd(a, b); }
+    static Value Min(const Value a, const Value b) { return _mm256_min_pd(a, b); }
+    static Mask LessEqual(const Value a, const Value b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static Mask And(const Mask a, const Mask b) { return _mm256_and_pd(a, b); }
+    static Value Select(const Mask mask, const Value a, const Value b) { return _mm256_blendv_pd(b, a, mask); }
+    static double ReduceMin(const Value value) {
+      const __m128d half = _mm_min_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+      return _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+    static unsigned MaskBits(const Mask mask) { return static_cast<unsigned>(_mm256_movemask_pd(mask)); }
+  };
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+  struct SimdPack {
+    using Value = __m128d;
+    using Mask = __m128d;
+    static constexpr size_t WIDTH = 2u;
+
+    static Value Load(const double *data) { return _mm_loadu_pd(data); }
+    static Value Set(const double value) { return _mm_set1_pd(value); }
+    static Value Add(const Value a, const Value b) { return _mm_add_pd(a, b); }
+    static Value Sub(const Value a, const Value b) { return _mm_sub_pd(a, b); }
+    static Value Mul(const Value a, const Value b) { return _mm_mul_pd(a, b); }
+    static Value Div(const Value a, const Value b) { return _mm_div_pd(a, b); }
+    static Value Min(const Value a, const Value b) { return _mm_min_pd(a, b); }
+    static Mask LessEqual(const Value a, const Value b) { return _mm_cmple_pd(a, b); }
+    static Mask And(const Mask a, const Mask b) { return _mm_and_pd(a, b); }
+    static Value Select(const Mask mask, const Value a, const Value b) {
+      return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+    static double ReduceMin(const Value value) {
+      return _mm_cvtsd_f64(_mm_min_sd(value, _mm_unpackhi_pd(value, value)));
+    }
+    static unsigned MaskBits(const Mask mask) { return static_cast<unsigned>(_mm_movemask_pd(mask)); }
+  };
+
+#else
+
+  using SimdPack = ScalarPack;
+
+#endif
+
+  // ===========================================================================
+  // -- Edge kernels -----------------------------------------------------------
+  // ===========================================================================
+
+  /// Squared distance from (px, py) to the edges starting at @a x, @a y.
+  /// Mirrors boost::geometry's projected point strategy: the distance to the
+  /// first vertex if the projection falls before it, to the second vertex if
+  /// it falls after it, and to the projected point otherwise.
+  template <typename P>
+  static typename P::Value EdgeComparableDistance(
+      const typename P::Value px,
+      const typename P::Value py,
+      const double *x,
+      const double *y) {
+    const auto x1 = P::Load(x);
+    const auto y1 = P::Load(y);
+    const auto x2 = P::Load(x + 1u);
+    const auto y2 = P::Load(y + 1u);
+
+    const auto vx = P::Sub(x2, x1);
+    const auto vy = P::Sub(y2, y1);
+    const auto wx = P::Sub(px, x1);
+    const auto wy = P::Sub(py, y1);
+    const auto c1 = P::Add(P::Mul(wx, vx), P::Mul(wy, vy));
+    const auto c2 = P::Add(P::Mul(vx, vx), P::Mul(vy, vy));
+
+    const auto to_start = P::Add(P::Mul(wx, wx), P::Mul(wy, wy));
+    const auto ex = P::Sub(px, x2);
+    const auto ey = P::Sub(py, y2);
+    const auto to_end = P::Add(P::Mul(ex, ex), P::Mul(ey, ey));
+    // Lanes where c2 is zero divide by zero here, but they always take the
+    // first branch below.
+    const auto b = P::Div(c1, c2);
+    const auto fx = P::Sub(px, P::Add(x1, P::Mul(vx, b)));
+    const auto fy = P::Sub(py, P::Add(y1, P::Mul(vy, b)));
+    const auto to_projection = P::Add(P::Mul(fx, fx), P::Mul(fy, fy));
+
+    return P::Select(P::LessEqual(c1, P::Set(0.0)), to_start,
+                     P::Select(P::LessEqual(c2, c1), to_end, to_projection));
+  }
+
+  template <typename P>
+  static double MinComparableDistance(const double px, const double py, const BoundaryView &boundary) {
+    const size_t edges = boundary.size - 1u;
+    double result = std::numeric_limits<double>::infinity();
+    size_t i = 0u;
+    if (edges >= P::WIDTH) {
+      const auto ppx = P::Set(px);
+      const auto ppy = P::Set(py);
+      auto minimum = P::Set(result);
+      for (; i + P::WIDTH <= edges; i += P::WIDTH) {
+        minimum = P::Min(minimum, EdgeComparableDistance<P>(ppx, ppy, boundary.x + i, boundary.y + i));
+      }
+      result = P::ReduceMin(minimum);
+    }
+    for (; i < edges; ++i) {
+      result = std::min(result, EdgeComparableDistance<ScalarPack>(px, py, boundary.x + i, boundary.y + i));
+    }
+    return result;
+  }
+
+  /// Exact segment intersection test, touching segments intersect.
+  static bool SegmentsIntersect(
+      const double ax1, const double ay1, const double ax2, const double ay2,
+      const double bx1, const double by1, const double bx2, const double by2) {
+    const double d1 = (ax2 - ax1) * (by1 - ay1) - (ay2 - ay1) * (bx1 - ax1);
+    const double d2 = (ax2 - ax1) * (by2 - ay1) - (ay2 - ay1) * (bx2 - ax1);
+    const double d3 = (bx2 - bx1) * (ay1 - by1) - (by2 - by1) * (ax1 - bx1);
+    const double d4 = (bx2 - bx1) * (ay2 - by1) - (by2 - by1) * (ax2 - bx1);
+    if (d1 == 0.0 && d2 == 0.0 && d3 == 0.0 && d4 == 0.0) {
+      // Collinear, they intersect if their extents overlap.
+      return std::max(ax1, ax2) >= std::min(bx1, bx2) && std::max(bx1, bx2) >= std::min(ax1, ax2)
+          && std::max(ay1, ay2) >= std::min(by1, by2) && std::max(by1, by2) >= std::min(ay1, ay2);
+    }
+    return d1 * d2 <= 0.0 && d3 * d4 <= 0.0;
+  }
+
+  /// Whether the segment (ax1, ay1)-(ax2, ay2) intersects any edge of
+  /// @a boundary. The packed test lets collinear, disjoint segments through,
+  /// those lanes are confirmed with the exact scalar test.
+  template <typename P>
+  static bool AnyEdgeIntersects(
+      const double ax1, const double ay1, const double ax2, const double ay2,
+      const BoundaryView &boundary) {
+    const size_t edges = boundary.size - 1u;
+    const double *x = boundary.x;
+    const double *y = boundary.y;
+    size_t i = 0u;
+    if (edges >= P::WIDTH) {
+      const auto pax1 = P::Set(ax1);
+      const auto pay1 = P::Set(ay1);
+      const auto pax2 = P::Set(ax2);
+      const auto pay2 = P::Set(ay2);
+      const auto avx = P::Set(ax2 - ax1);
+      const auto avy = P::Set(ay2 - ay1);
+      const auto zero = P::Set(0.0);
+      for (; i + P::WIDTH <= edges; i += P::WIDTH) {
+        const auto bx1 = P::Load(x + i);
+        const auto by1 = P::Load(y + i);
+        const auto bx2 = P::Load(x + i + 1u);
+        const auto by2 = P::Load(y + i + 1u);
+        const auto bvx = P::Sub(bx2, bx1);
+        const auto bvy = P::Sub(by2, by1);
+        const auto d1 = P::Sub(P::Mul(avx, P::Sub(by1, pay1)), P::Mul(avy, P::Sub(bx1, pax1)));
+        const auto d2 = P::Sub(P::Mul(avx, P::Sub(by2, pay1)), P::Mul(avy, P::Sub(bx2, pax1)));
+        const auto d3 = P::Sub(P::Mul(bvx, P::Sub(pay1, by1)), P::Mul(bvy, P::Sub(pax1, bx1)));
+        const auto d4 = P::Sub(P::Mul(bvx, P::Sub(pay2, by1)), P::Mul(bvy, P::Sub(pax2, bx1)));
+        const unsigned candidates = P::MaskBits(P::And(P::LessEqual(P::Mul(d1, d2), zero),
+                                                       P::LessEqual(P::Mul(d3, d4), zero)));
+        for (unsigned lane = 0u; candidates != 0u && lane < P::WIDTH; ++lane) {
+          const size_t j = i + lane;
+          if (((candidates >> lane) & 1u) != 0u
+              && SegmentsIntersect(ax1, ay1, ax2, ay2, x[j], y[j], x[j + 1u], y[j + 1u])) {
+            return true;
+          }
+        }
+      }
+    }
+    for (; i < edges; ++i) {
+      if (SegmentsIntersect(ax1, ay1, ax2, ay2, x[i], y[i], x[i + 1u], y[i + 1u])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Crossing number test, only used once no edges intersect so points on
+  /// the boundary never reach it.
+  static bool PointInside(const double px, const double py, const BoundaryView &boundary) {
+    bool inside = false;
+    for (size_t i = 0u; i + 1u < boundary.size; ++i) {
+      const double x1 = boundary.x[i];
+      const double y1 = boundary.y[i];
+      const double x2 = boundary.x[i + 1u];
+      const double y2 = boundary.y[i + 1u];
+      if ((y1 > py) != (y2 > py) && px < x1 + (py - y1) * (x2 - x1) / (y2 - y1)) {
+        inside = !inside;
+      }
+    }
+    return inside;
+  }
+
+  // ===========================================================================
+  // -- BoundaryStore ----------------------------------------------------------
+  // ===========================================================================
+
+  BoundaryHandle BoundaryStore::Add(const LocationVector &boundary) {
+    DEBUG_ASSERT(!boundary.empty());
+    const BoundaryHandle handle{static_cast<uint32_t>(xs.size()),
+                                static_cast<uint32_t>(boundary.size() + 1u)};
+    for (const cg::Location &location : boundary) {
+      xs.push_back(static_cast<double>(location.x));
+      ys.push_back(static_cast<double>(location.y));
+    }
+    xs.push_back(static_cast<double>(boundary.front().x));
+    ys.push_back(static_cast<double>(boundary.front().y));
+    return handle;
+  }
+
+  // ===========================================================================
+  // -- Polygon tests ----------------------------------------------------------
+  // ===========================================================================
+
+  bool BoundariesIntersect(const BoundaryView &a, const BoundaryView &b) {
+    for (size_t i = 0u; i + 1u < a.size; ++i) {
+      if (AnyEdgeIntersects<SimdPack>(a.x[i], a.y[i], a.x[i + 1u], a.y[i + 1u], b)) {
+        return true;
+      }
+    }
+    // No edges cross, so either one polygon contains the other or they are
+    // disjoint.
+    return PointInside(a.x[0], a.y[0], b) || PointInside(b.x[0], b.y[0], a);
+  }
+
+  double BoundaryDistance(const BoundaryView &a, const BoundaryView &b) {
+    if (BoundariesIntersect(a, b)) {
+      return 0.0;
+    }
+    double comparable_distance = std::numeric_limits<double>::infinity();
+    for (size_t i = 0u; i + 1u < a.size; ++i) {
+      comparable_distance = std::min(comparable_distance, MinComparableDistance<SimdPack>(a.x[i], a.y[i], b));
+    }
+    for (size_t i = 0u; i + 1u < b.size; ++i) {
+      comparable_distance = std::min(comparable_distance, MinComparableDistance<SimdPack>(b.x[i], b.y[i], a));
+    }
+    return std::sqrt(comparable_distance);
+  }
+
+} // namespace traffic_manager
+} // namespace carla
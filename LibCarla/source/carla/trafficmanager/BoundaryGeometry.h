@@ -0,0 +1,70 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "carla/geom/Location.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  using LocationVector = std::vector<cg::Location>;
+
+  /// Read-only view of a closed polygon in top view. The first vertex is
+  /// repeated at the end, so edge i goes from vertex i to vertex i + 1 and
+  /// there are size - 1 edges.
+  struct BoundaryView {
+    const double *x;
+    const double *y;
+    size_t size;
+  };
+
+  /// Position of a boundary inside a BoundaryStore.
+  struct BoundaryHandle {
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  /// Flat storage for the boundaries of all actors of an update cycle. The
+  /// coordinates of every boundary are stored back to back in two arrays
+  /// that keep their capacity across cycles.
+  class BoundaryStore {
+
+  public:
+
+    void Clear() {
+      xs.clear();
+      ys.clear();
+    }
+
+    /// Appends a closed copy of @a boundary, which must not be empty.
+    BoundaryHandle Add(const LocationVector &boundary);
+
+    BoundaryView Get(const BoundaryHandle handle) const {
+      return {xs.data() + handle.offset, ys.data() + handle.offset, handle.size};
+    }
+
+  private:
+
+    std::vector<double> xs;
+    std::vector<double> ys;
+  };
+
+  /// Whether the two polygons overlap or touch.
+  bool BoundariesIntersect(const BoundaryView &a, const BoundaryView &b);
+
+  /// Distance between two polygons, zero if they intersect. Computes the same
+  /// value as boost::geometry::distance on the equivalent polygons, with the
+  /// edge loops vectorized with AVX or SSE2 when the compiler targets them.
+  double BoundaryDistance(const BoundaryView &a, const BoundaryView &b);
+
+} // namespace traffic_manager
+} // namespace carla
@@ -1,3 +1,4 @@
+#include <algorithm>
 
 #include "carla/geom/Math.h"
 
@@ -9,7 +10,6 @@
 namespace carla {
 namespace traffic_manager {
 
-using Point2D = bg::model::point<double, 2, bg::cs::cartesian>;
 using TLS = carla::rpc::TrafficLightState;
 
 using namespace constants::Collision;
@@ -20,6 +20,7 @@ CollisionStage::CollisionStage(
   const SimulationState &simulation_state,
   const BufferMap &buffer_map,
   const TrackTraffic &track_traffic,
+  const LocalMapPtr &local_map,
   const Parameters &parameters,
   CollisionFrame &output_array,
   RandomGenerator &random_device)
@@ -27,9 +28,35 @@ CollisionStage::CollisionStage(
     simulation_state(simulation_state),
     buffer_map(buffer_map),
     track_traffic(track_traffic),
+    local_map(local_map),
     parameters(parameters),
     output_array(output_array),
-    random_device(random_device) {}
+    random_device(random_device),
+    broadphase(BROADPHASE_CELL_SIZE) {}
+
+void CollisionStage::PrepareCycle() {
+  broadphase.Build(simulation_state);
+  if (candidate_buffers.size() < vehicle_id_list.size()) {
+    candidate_buffers.resize(vehicle_id_list.size());
+  }
+
+  // The boundaries only depend on state that is constant during the cycle,
+  // collision locks included, so they are computed here once per actor
+  // instead of once per comparison.
+  boundary_store.Clear();
+  actor_boundaries.resize(simulation_state.Size());
+  for (uint32_t index = 0u; index < simulation_state.Size(); ++index) {
+    const ActorSlot slot{index};
+    const LocationVector bbox = GetBoundary(slot);
+    const BoundaryHandle bbox_handle = boundary_store.Add(bbox);
+    const Buffer *buffer = buffer_map.Find(simulation_state.GetActorId(slot));
+    if (buffer != nullptr && !buffer->empty()) {
+      actor_boundaries[index] = {bbox_handle, boundary_store.Add(GetGeodesicBoundary(slot, bbox))};
+    } else {
+      actor_boundaries[index] = {bbox_handle, bbox_handle};
+    }
+  }
+}
 
 void CollisionStage::Update(const unsigned long index) {
   ActorId obstacle_id = 0u;
@@ -37,19 +64,23 @@ void CollisionStage::Update(const unsigned long index) {
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (simulation_state.ContainsActor(ego_actor_id)) {
-    const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id);
-    const Buffer &ego_buffer = buffer_map.at(ego_actor_id);
-    const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second;
-    const float velocity = simulation_state.GetVelocity(ego_actor_id).Length();
-
-    ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
-    std::vector<ActorId> collision_candidate_ids;
-    // Run through vehicles with overlapping paths and filter them;
+  const ActorSlot ego_slot = simulation_state.FindSlot(ego_actor_id);
+  if (ego_slot.IsValid()) {
+    const cg::Location ego_location = simulation_state.GetLocation(ego_slot);
+    const Buffer &ego_buffer = buffer_map.Get(ego_actor_id);
+    const unsigned long look_ahead_index = GetTargetWaypoint(local_map->GetGraph(), ego_buffer, JUNCTION_LOOK_AHEAD).second;
+    const float velocity = simulation_state.GetVelocity(ego_slot).Length();
+
+    boost::optional<CollisionLock> ego_lock;
+    if (collision_locks.find(ego_actor_id) != collision_locks.end()) {
+      ego_lock = collision_locks.at(ego_actor_id);
+    }
+
+    // Run through nearby actors and keep the ones with overlapping paths;
     const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id);
     float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN);
     if (velocity < 2.0f) {
-      const float length = simulation_state.GetDimensions(ego_actor_id).x;
+      const float length = simulation_state.GetDimensions(ego_slot).x;
       const float collision_radius_stop = COLLISION_RADIUS_STOP + length;
       collision_radius_square = SQUARE(collision_radius_stop);
     }
@@ -57,43 +88,47 @@ void CollisionStage::Update(const unsigned long index) {
         collision_radius_square = SQUARE(distance_to_leading);
     }
 
-    for (ActorId overlapping_actor_id : overlapping_actors) {
-      // If actor is within maximum collision avoidance and vertical overlap range.
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id);
-      if (overlapping_actor_id != ego_actor_id
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square
-          && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) {
-        collision_candidate_ids.push_back(overlapping_actor_id);
-      }
-    }
+    // The broadphase only returns actors within the collision radius.
+    std::vector<SpatialHashHit> &collision_candidates = candidate_buffers.at(index);
+    broadphase.Query(ego_location, collision_radius_square, collision_candidates);
+    collision_candidates.erase(
+        std::remove_if(collision_candidates.begin(), collision_candidates.end(),
+                       [this, ego_actor_id, &ego_location](const SpatialHashHit &hit) {
+                         // Discard actors out of the vertical overlap range or
+                         // whose path does not overlap with ours.
+                         return hit.actor_id == ego_actor_id
+                             || std::abs(ego_location.z - hit.location.z) >= VERTICAL_OVERLAP_THRESHOLD
+                             || !track_traffic.IsOverlapping(ego_actor_id, hit.actor_id);
+                       }),
+        collision_candidates.end());
 
     // Sorting collision candidates in accending order of distance to current vehicle.
-    std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
-              [this, &ego_location](const ActorId &a_id_1, const ActorId &a_id_2) {
-                const cg::Location &e_loc = ego_location;
-                const cg::Location &loc_1 = simulation_state.GetLocation(a_id_1);
-                const cg::Location &loc_2 = simulation_state.GetLocation(a_id_2);
-                return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
+    // Ties are broken by id so the order does not depend on the grid layout.
+    std::sort(collision_candidates.begin(), collision_candidates.end(),
+              [](const SpatialHashHit &hit_1, const SpatialHashHit &hit_2) {
+                return hit_1.distance_squared < hit_2.distance_squared
+                    || (hit_1.distance_squared == hit_2.distance_squared && hit_1.actor_id < hit_2.actor_id);
               });
 
     // Check every actor in the vicinity if it poses a collision hazard.
-    for (auto iter = collision_candidate_ids.begin();
-         iter != collision_candidate_ids.end() && !collision_hazard;
+    for (auto iter = collision_candidates.begin();
+         iter != collision_candidates.end() && !collision_hazard;
          ++iter) {
-      const ActorId other_actor_id = *iter;
-      const ActorType other_actor_type = simulation_state.GetType(other_actor_id);
+      const ActorId other_actor_id = iter->actor_id;
+      const ActorType other_actor_type = simulation_state.GetType(iter->slot);
 
+      // Candidates come from the simulation state, so they are always present in it.
       if (parameters.GetCollisionDetection(ego_actor_id, other_actor_id)
-          && buffer_map.find(ego_actor_id) != buffer_map.end()
-          && simulation_state.ContainsActor(other_actor_id)) {
-        std::pair<bool, float> negotiation_result = NegotiateCollision(ego_actor_id,
-                                                                       other_actor_id,
-                                                                       look_ahead_index);
+          && buffer_map.Contains(ego_actor_id)) {
+        std::pair<bool, float> negotiation_result = NegotiateCollision(ego_slot,
+                                                                       iter->slot,
+                                                                       look_ahead_index,
+                                                                       ego_lock);
         if (negotiation_result.first) {
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_device.next())
+               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= NextRandom(ego_actor_id))
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_device.next())) {
+                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= NextRandom(ego_actor_id))) {
             collision_hazard = true;
             obstacle_id = other_actor_id;
             available_distance_margin = negotiation_result.second;
@@ -101,6 +136,9 @@ void CollisionStage::Update(const unsigned long index) {
         }
       }
     }
+
+    std::lock_guard<std::mutex> lock(collision_lock_updates_mutex);
+    collision_lock_updates[ego_actor_id] = ego_lock;
   }
 
   CollisionHazardData &output_element = output_array.at(index);
@@ -111,15 +149,30 @@ void CollisionStage::Update(const unsigned long index) {
 
 void CollisionStage::RemoveActor(const ActorId actor_id) {
   collision_locks.erase(actor_id);
+  collision_lock_updates.erase(actor_id);
 }
 
 void CollisionStage::Reset() {
   collision_locks.clear();
+  collision_lock_updates.clear();
+  broadphase.Clear();
+  candidate_buffers.clear();
+  boundary_store.Clear();
+  actor_boundaries.clear();
 }
 
-float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
+void CollisionStage::SetUseActorRandomStreams(const bool use) {
+  use_actor_random_streams = use;
+}
 
-  const float velocity = cg::Math::Dot(simulation_state.GetVelocity(actor_id), simulation_state.GetHeading(actor_id));
+double CollisionStage::NextRandom(const ActorId actor_id) {
+  return use_actor_random_streams ? random_device.next(actor_id) : random_device.next();
+}
+
+float CollisionStage::GetBoundingBoxExtention(const ActorSlot slot) {
+
+  const ActorId actor_id = simulation_state.GetActorId(slot);
+  const float velocity = cg::Math::Dot(simulation_state.GetVelocity(slot), simulation_state.GetHeading(slot));
   float bbox_extension;
   // Using a function to calculate boundary length.
   float velocity_extension = VEL_EXT_FACTOR * velocity;
@@ -138,17 +191,17 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   return bbox_extension;
 }
 
-LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
-  const ActorType actor_type = simulation_state.GetType(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
+LocationVector CollisionStage::GetBoundary(const ActorSlot slot) {
+  const ActorType actor_type = simulation_state.GetType(slot);
+  const cg::Vector3D heading_vector = simulation_state.GetHeading(slot);
 
   float forward_extension = 0.0f;
   if (actor_type == ActorType::Pedestrian) {
     // Extend the pedestrians bbox to "predict" where they'll be and avoid collisions.
-    forward_extension = simulation_state.GetVelocity(actor_id).Length() * WALKER_TIME_EXTENSION;
+    forward_extension = simulation_state.GetVelocity(slot).Length() * WALKER_TIME_EXTENSION;
   }
 
-  cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id);
+  cg::Vector3D dimensions = simulation_state.GetDimensions(slot);
 
   float bbox_x = dimensions.x;
   float bbox_y = dimensions.y;
@@ -158,7 +211,7 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   const cg::Vector3D y_boundary_vector = perpendicular_vector * (bbox_y + forward_extension);
 
   // Four corners of the vehicle in top view clockwise order (left-handed system).
-  const cg::Location location = simulation_state.GetLocation(actor_id);
+  const cg::Location location = simulation_state.GetLocation(slot);
   LocationVector bbox_boundary = {
       location + cg::Location(x_boundary_vector - y_boundary_vector),
       location + cg::Location(-1.0f * x_boundary_vector - y_boundary_vector),
@@ -169,93 +222,73 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   return bbox_boundary;
 }
 
-LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
+LocationVector CollisionStage::GetGeodesicBoundary(const ActorSlot slot, const LocationVector &bbox) {
   LocationVector geodesic_boundary;
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
-  } else {
-    const LocationVector bbox = GetBoundary(actor_id);
-
-    if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id);
-      const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id);
-      bbox_extension = std::max(specific_lead_distance, bbox_extension);
-      const float bbox_extension_square = SQUARE(bbox_extension);
-
-      LocationVector left_boundary;
-      LocationVector right_boundary;
-      cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id);
-      const float width = dimensions.y;
-      const float length = dimensions.x;
-
-      const Buffer &waypoint_buffer = buffer_map.at(actor_id);
-      const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length);
-      const SimpleWaypointPtr boundary_start = target_wp_info.first;
-      const uint64_t boundary_start_index = target_wp_info.second;
-
-      // At non-signalized junctions, we extend the boundary across the junction
-      // and in all other situations, boundary length is velocity-dependent.
-      SimpleWaypointPtr boundary_end = nullptr;
-      SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
-      bool reached_distance = false;
-      for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
-        if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
-          reached_distance = true;
-        }
-        if (boundary_end == nullptr
-            || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
-            || reached_distance) {
-
-          const cg::Vector3D heading_vector = current_point->GetForwardVector();
-          const cg::Location location = current_point->GetLocation();
-          cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
-          perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
-          // Direction determined for the left-handed system.
-          const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
-          left_boundary.push_back(location + cg::Location(scaled_perpendicular));
-          right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
-
-          boundary_end = current_point;
-        }
-
-        current_point = waypoint_buffer.at(j);
-      }
-
-      // Reversing right boundary to construct clockwise (left-hand system)
-      // boundary. This is so because both left and right boundary vectors have
-      // the closest point to the vehicle at their starting index for the right
-      // boundary,
-      // we want to begin at the farthest point to have a clockwise trace.
-      std::reverse(right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
-    } else {
-
-      geodesic_boundary = bbox;
+  const ActorId actor_id = simulation_state.GetActorId(slot);
+  float bbox_extension = GetBoundingBoxExtention(slot);
+  const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id);
+  bbox_extension = std::max(specific_lead_distance, bbox_extension);
+  const float bbox_extension_square = SQUARE(bbox_extension);
+
+  LocationVector left_boundary;
+  LocationVector right_boundary;
+  cg::Vector3D dimensions = simulation_state.GetDimensions(slot);
+  const float width = dimensions.y;
+  const float length = dimensions.x;
+
+  const WaypointGraph &graph = local_map->GetGraph();
+  const Buffer &waypoint_buffer = buffer_map.Get(actor_id);
+  const TargetWPInfo target_wp_info = GetTargetWaypoint(graph, waypoint_buffer, length);
+  const NodeIndex boundary_start = target_wp_info.first;
+  const uint64_t boundary_start_index = target_wp_info.second;
+
+  // At non-signalized junctions, we extend the boundary across the junction
+  // and in all other situations, boundary length is velocity-dependent.
+  NodeIndex boundary_end = INVALID_NODE;
+  NodeIndex current_point = waypoint_buffer.at(boundary_start_index);
+  bool reached_distance = false;
+  for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
+    if (graph.DistanceSquared(boundary_start, current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
+      reached_distance = true;
+    }
+    if (boundary_end == INVALID_NODE
+        || cg::Math::Dot(graph.GetForwardVector(boundary_end), graph.GetForwardVector(current_point)) < COS_10_DEGREES
+        || reached_distance) {
+
+      const cg::Vector3D heading_vector = graph.GetForwardVector(current_point);
+      const cg::Location location = graph.GetLocation(current_point);
+      cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
+      perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
+      // Direction determined for the left-handed system.
+      const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
+      left_boundary.push_back(location + cg::Location(scaled_perpendicular));
+      right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
+
+      boundary_end = current_point;
     }
 
-    geodesic_boundary_map.insert({actor_id, geodesic_boundary});
+    current_point = waypoint_buffer.at(j);
   }
 
-  return geodesic_boundary;
-}
-
-Polygon CollisionStage::GetPolygon(const LocationVector &boundary) {
-
-  traffic_manager::Polygon boundary_polygon;
-  for (const cg::Location &location : boundary) {
-    bg::append(boundary_polygon.outer(), Point2D(location.x, location.y));
-  }
-  bg::append(boundary_polygon.outer(), Point2D(boundary.front().x, boundary.front().y));
+  // Reversing right boundary to construct clockwise (left-hand system)
+  // boundary. This is so because both left and right boundary vectors have
+  // the closest point to the vehicle at their starting index for the right
+  // boundary,
+  // we want to begin at the farthest point to have a clockwise trace.
+  std::reverse(right_boundary.begin(), right_boundary.end());
+  geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
+  geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
+  geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
 
-  return boundary_polygon;
+  return geodesic_boundary;
 }
 
-GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId reference_vehicle_id,
-                                                            const ActorId other_actor_id) {
+GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorSlot reference_slot,
+                                                            const ActorSlot other_slot) {
 
+  const ActorId reference_vehicle_id = simulation_state.GetActorId(reference_slot);
+  const ActorId other_actor_id = simulation_state.GetActorId(other_slot);
 
   std::pair<ActorId, ActorId> key_parts;
   if (reference_vehicle_id < other_actor_id) {
@@ -271,65 +304,72 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0};
 
+  std::unique_lock<std::mutex> cache_lock(cycle_cache_mutex);
   if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
 
     comparision_result = geometry_cache.at(actor_id_key);
+    cache_lock.unlock();
     double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
     comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
     comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
   } else {
+    cache_lock.unlock();
 
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
-
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
+    const ActorBoundaries &reference_boundaries = actor_boundaries.at(reference_slot.index);
+    const ActorBoundaries &other_boundaries = actor_boundaries.at(other_slot.index);
+    const BoundaryView reference_polygon = boundary_store.Get(reference_boundaries.bbox);
+    const BoundaryView other_polygon = boundary_store.Get(other_boundaries.bbox);
+    const BoundaryView reference_geodesic_polygon = boundary_store.Get(reference_boundaries.geodesic);
+    const BoundaryView other_geodesic_polygon = boundary_store.Get(other_boundaries.geodesic);
 
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
-
-    const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
-    const double other_vehicle_to_reference_geodesic = bg::distance(other_polygon, reference_geodesic_polygon);
-    const auto inter_geodesic_distance = bg::distance(reference_geodesic_polygon, other_geodesic_polygon);
-    const auto inter_bbox_distance = bg::distance(reference_polygon, other_polygon);
+    const double reference_vehicle_to_other_geodesic = BoundaryDistance(reference_polygon, other_geodesic_polygon);
+    const double other_vehicle_to_reference_geodesic = BoundaryDistance(other_polygon, reference_geodesic_polygon);
+    const auto inter_geodesic_distance = BoundaryDistance(reference_geodesic_polygon, other_geodesic_polygon);
+    const auto inter_bbox_distance = BoundaryDistance(reference_polygon, other_polygon);
 
     comparision_result = {reference_vehicle_to_other_geodesic,
               other_vehicle_to_reference_geodesic,
               inter_geodesic_distance,
               inter_bbox_distance};
 
+    cache_lock.lock();
     geometry_cache.insert({actor_id_key, comparision_result});
   }
 
   return comparision_result;
 }
 
-std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId reference_vehicle_id,
-                                                          const ActorId other_actor_id,
-                                                          const uint64_t reference_junction_look_ahead_index) {
+std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorSlot reference_slot,
+                                                          const ActorSlot other_slot,
+                                                          const uint64_t reference_junction_look_ahead_index,
+                                                          boost::optional<CollisionLock> &reference_lock) {
   // Output variables for the method.
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
-  const cg::Location reference_location = simulation_state.GetLocation(reference_vehicle_id);
-  const cg::Location other_location = simulation_state.GetLocation(other_actor_id);
+  const ActorId reference_vehicle_id = simulation_state.GetActorId(reference_slot);
+  const ActorId other_actor_id = simulation_state.GetActorId(other_slot);
+  const cg::Location reference_location = simulation_state.GetLocation(reference_slot);
+  const cg::Location other_location = simulation_state.GetLocation(other_slot);
 
   // Ego and other vehicle heading.
-  const cg::Vector3D reference_heading = simulation_state.GetHeading(reference_vehicle_id);
+  const cg::Vector3D reference_heading = simulation_state.GetHeading(reference_slot);
   // Vector from ego position to position of the other vehicle.
   cg::Vector3D reference_to_other = other_location - reference_location;
   reference_to_other = reference_to_other.MakeSafeUnitVector(EPSILON);
 
   // Other vehicle heading.
-  const cg::Vector3D other_heading = simulation_state.GetHeading(other_actor_id);
+  const cg::Vector3D other_heading = simulation_state.GetHeading(other_slot);
   // Vector from other vehicle position to ego position.
   cg::Vector3D other_to_reference = reference_location - other_location;
   other_to_reference = other_to_reference.MakeSafeUnitVector(EPSILON);
 
-  float reference_vehicle_length = simulation_state.GetDimensions(reference_vehicle_id).x * SQUARE_ROOT_OF_TWO;
-  float other_vehicle_length = simulation_state.GetDimensions(other_actor_id).x * SQUARE_ROOT_OF_TWO;
+  float reference_vehicle_length = simulation_state.GetDimensions(reference_slot).x * SQUARE_ROOT_OF_TWO;
+  float other_vehicle_length = simulation_state.GetDimensions(other_slot).x * SQUARE_ROOT_OF_TWO;
 
   float inter_vehicle_distance = cg::Math::DistanceSquared(reference_location, other_location);
-  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id);
-  float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id);
+  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_slot);
+  float other_bounding_box_extension = GetBoundingBoxExtention(other_slot);
   // Calculate minimum distance between vehicle to consider collision negotiation.
   float inter_vehicle_length = reference_vehicle_length + other_vehicle_length;
   float ego_detection_range = SQUARE(ego_bounding_box_extension + inter_vehicle_length);
@@ -340,20 +380,21 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   bool other_vehicles_in_cross_detection_range = inter_vehicle_distance < cross_detection_range;
   float reference_heading_to_other_dot = cg::Math::Dot(reference_heading, reference_to_other);
   bool other_vehicle_in_front = reference_heading_to_other_dot > 0;
-  const Buffer &reference_vehicle_buffer = buffer_map.at(reference_vehicle_id);
-  SimpleWaypointPtr closest_point = reference_vehicle_buffer.front();
-  bool ego_inside_junction = closest_point->CheckJunction();
-  TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_vehicle_id);
+  const WaypointGraph &graph = local_map->GetGraph();
+  const Buffer &reference_vehicle_buffer = buffer_map.Get(reference_vehicle_id);
+  NodeIndex closest_point = reference_vehicle_buffer.front();
+  bool ego_inside_junction = graph.CheckJunction(closest_point);
+  TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_slot);
   bool ego_at_traffic_light = reference_tl_state.at_traffic_light;
   bool ego_stopped_by_light = reference_tl_state.tl_state != TLS::Green && reference_tl_state.tl_state != TLS::Off;
-  SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
-  bool ego_at_junction_entrance = !closest_point->CheckJunction() && look_ahead_point->CheckJunction();
+  NodeIndex look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
+  bool ego_at_junction_entrance = !graph.CheckJunction(closest_point) && graph.CheckJunction(look_ahead_point);
 
   // Conditions to consider collision negotiation.
   if (!(ego_at_junction_entrance && ego_at_traffic_light && ego_stopped_by_light)
       && ((ego_inside_junction && other_vehicles_in_cross_detection_range)
           || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))) {
-    GeometryComparison geometry_comparison = GetGeometryBetweenActors(reference_vehicle_id, other_actor_id);
+    GeometryComparison geometry_comparison = GetGeometryBetweenActors(reference_slot, other_slot);
 
     // Conditions for collision negotiation.
     bool geodesic_path_bbox_touching = geometry_comparison.inter_geodesic_distance < OVERLAP_THRESHOLD;
@@ -385,8 +426,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // This enables us to smoothly approach the lead vehicle.
 
       // When possible collision found, check if an entry for collision lock present.
-      if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-        CollisionLock &lock = collision_locks.at(reference_vehicle_id);
+      if (reference_lock) {
+        CollisionLock &lock = *reference_lock;
         // Check if the same vehicle is under lock.
         if (other_actor_id == lock.lead_vehicle_id) {
           // If the body of the lead vehicle is touching the reference vehicle bounding box.
@@ -403,24 +444,30 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
         }
       } else {
         // Insert and initialize lock entry if not present.
-        collision_locks.insert({reference_vehicle_id,
-                                {geometry_comparison.inter_bbox_distance,
-                                 geometry_comparison.inter_bbox_distance,
-                                 other_actor_id}});
+        reference_lock = CollisionLock{geometry_comparison.inter_bbox_distance,
+                                       geometry_comparison.inter_bbox_distance,
+                                       other_actor_id};
       }
     }
   }
 
   // If no collision hazard detected, then flush collision lock held by the vehicle.
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-    collision_locks.erase(reference_vehicle_id);
+  if (!hazard) {
+    reference_lock = boost::none;
   }
 
   return {hazard, available_distance_margin};
 }
 
 void CollisionStage::ClearCycleCache() {
-  geodesic_boundary_map.clear();
+  for (auto &update : collision_lock_updates) {
+    if (update.second) {
+      collision_locks[update.first] = *update.second;
+    } else {
+      collision_locks.erase(update.first);
+    }
+  }
+  collision_lock_updates.clear();
   geometry_cache.clear();
 }
 
@@ -2,16 +2,17 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
-#include "boost/geometry.hpp"
-#include "boost/geometry/geometries/geometries.hpp"
-#include "boost/geometry/geometries/point_xy.hpp"
-#include "boost/geometry/geometries/polygon.hpp"
+#include "boost/optional.hpp"
 
+#include "carla/trafficmanager/BoundaryGeometry.h"
 #include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
+#include "carla/trafficmanager/SpatialHash.h"
 #include "carla/trafficmanager/Stage.h"
 
 namespace carla {
@@ -30,16 +31,18 @@ struct CollisionLock {
   ActorId lead_vehicle_id;
 };
 using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>;
+using CollisionLockUpdateMap = std::unordered_map<ActorId, boost::optional<CollisionLock>>;
+
+// Boundaries of an actor inside the BoundaryStore of the collision stage.
+struct ActorBoundaries {
+  BoundaryHandle bbox;
+  BoundaryHandle geodesic;
+};
 
 namespace cc = carla::client;
-namespace bg = boost::geometry;
 
-using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>;
-using BufferMap = std::unordered_map<carla::ActorId, Buffer>;
-using LocationVector = std::vector<cg::Location>;
-using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>;
+using LocalMapPtr = std::shared_ptr<InMemoryMap>;
 using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>;
-using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
 
 /// This class has functionality to detect potential collision with a nearby actor.
 class CollisionStage : Stage {
@@ -48,37 +51,61 @@ private:
   const SimulationState &simulation_state;
   const BufferMap &buffer_map;
   const TrackTraffic &track_traffic;
+  const LocalMapPtr &local_map;
   const Parameters &parameters;
   CollisionFrame &output_array;
   // Structure keeping track of blocking lead vehicles.
   CollisionLockMap collision_locks;
-  // Structures to cache geodesic boundaries of vehicle and
-  // comparision between vehicle boundaries
+  // Lock changes produced in the current cycle. They are committed by
+  // ClearCycleCache so that every vehicle reads the same lock state
+  // independently of the order in which vehicles are updated.
+  CollisionLockUpdateMap collision_lock_updates;
+  std::mutex collision_lock_updates_mutex;
+  // Bounding box and geodesic boundary of every actor, computed once per
+  // cycle by PrepareCycle and stored back to back in a flat array.
+  BoundaryStore boundary_store;
+  // Boundaries of every actor, indexed by simulation state slot.
+  std::vector<ActorBoundaries> actor_boundaries;
+  // Structure to cache comparision between vehicle boundaries
   // to avoid repeated computation within a cycle.
   GeometryComparisonMap geometry_cache;
-  GeodesicBoundaryMap geodesic_boundary_map;
+  // Guards the cycle cache, Update may run concurrently for different vehicles.
+  std::mutex cycle_cache_mutex;
   RandomGenerator &random_device;
+  // Whether Update draws from the random stream of each vehicle instead of
+  // the shared one of the traffic manager.
+  bool use_actor_random_streams = false;
+  // Grid over all actor locations, rebuilt once per cycle by PrepareCycle.
+  SpatialHash broadphase;
+  // Candidate buffers, one per vehicle index so that concurrent updates never
+  // share one. They keep their capacity across cycles.
+  std::vector<std::vector<SpatialHashHit>> candidate_buffers;
 
   // Method to determine if a vehicle is on a collision path to another.
-  std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
-                                            const ActorId other_actor_id,
-                                            const uint64_t reference_junction_look_ahead_index);
+  // The collision lock held by the reference vehicle is updated in @a reference_lock.
+  std::pair<bool, float> NegotiateCollision(const ActorSlot reference_slot,
+                                            const ActorSlot other_slot,
+                                            const uint64_t reference_junction_look_ahead_index,
+                                            boost::optional<CollisionLock> &reference_lock);
 
   // Method to calculate bounding box extention length ahead of the vehicle.
-  float GetBoundingBoxExtention(const ActorId actor_id);
+  float GetBoundingBoxExtention(const ActorSlot slot);
 
   // Method to calculate polygon points around the vehicle's bounding box.
-  LocationVector GetBoundary(const ActorId actor_id);
-
-  // Method to construct polygon points around the path boundary of the vehicle.
-  LocationVector GetGeodesicBoundary(const ActorId actor_id);
+  LocationVector GetBoundary(const ActorSlot slot);
 
-  Polygon GetPolygon(const LocationVector &boundary);
+  // Method to construct polygon points around the path boundary of the vehicle
+  // from its bounding box boundary.
+  LocationVector GetGeodesicBoundary(const ActorSlot slot, const LocationVector &bbox);
 
   // Method to compare path boundaries, bounding boxes of vehicles
   // and cache the results for reuse in current update cycle.
-  GeometryComparison GetGeometryBetweenActors(const ActorId reference_vehicle_id,
-                                              const ActorId other_actor_id);
+  GeometryComparison GetGeometryBetweenActors(const ActorSlot reference_slot,
+                                              const ActorSlot other_slot);
+
+  // Method to draw a random number for the vehicle from the stream selected
+  // by SetUseActorRandomStreams.
+  double NextRandom(const ActorId actor_id);
 
   // Method to draw path boundary.
   void DrawBoundary(const LocationVector &boundary);
@@ -88,6 +115,7 @@ public:
                  const SimulationState &simulation_state,
                  const BufferMap &buffer_map,
                  const TrackTraffic &track_traffic,
+                 const LocalMapPtr &local_map,
                  const Parameters &parameters,
                  CollisionFrame &output_array,
                  RandomGenerator &random_device);
@@ -98,7 +126,18 @@ public:
 
   void Reset() override;
 
-  // Method to flush cache for current update cycle.
+  // Makes Update draw from the random stream of each vehicle, required while
+  // it runs concurrently for several vehicles. Otherwise it draws from the
+  // shared stream in vehicle order, as the other stages do.
+  void SetUseActorRandomStreams(const bool use);
+
+  // Method to rebuild the broadphase and the boundaries of all actors with
+  // the current simulation state. Must be called before the vehicles are
+  // updated in every cycle.
+  void PrepareCycle();
+
+  // Method to commit the collision locks of the current update cycle
+  // and flush its cache.
   void ClearCycleCache();
 };
 
@@ -43,11 +43,39 @@ static const float AFTER_JUNCTION_MIN_SPEED = 5.0f / 3.6f;
 static const float INITIAL_PERCENTAGE_SPEED_DIFFERENCE = 0.0f;
 } // namespace SpeedThreshold
 
+namespace Map {
+static const float INFINITE_DISTANCE = std::numeric_limits<float>::max();
+static const float MAX_GEODESIC_GRID_LENGTH = 20.0f;
+static constexpr float MAP_RESOLUTION = 5.0f;
+static const float INV_MAP_RESOLUTION = 1.0f / MAP_RESOLUTION;
+static const double MAX_WPT_DISTANCE = MAP_RESOLUTION/2.0 + SQUARE(MAP_RESOLUTION);
+static const float MAX_WPT_RADIANS = 0.087f;  // 5º
+static float const DELTA = 25.0f;
+static float const Z_DELTA = 500.0f;
+static float const STRAIGHT_DEG = 19.0f;
+static const unsigned long SETUP_NODES_PER_TASK = 256u;
+} // namespace Map
+
 namespace PathBufferUpdate {
 static const float MAX_START_DISTANCE = 20.0f;
-static const float MINIMUM_HORIZON_LENGTH = 15.0f;
+static constexpr float MINIMUM_HORIZON_LENGTH = 15.0f;
 static const float HORIZON_RATE = 2.0f;
-static const float HIGH_SPEED_HORIZON_RATE = 4.0f;
+static constexpr float HIGH_SPEED_HORIZON_RATE = 4.0f;
+// Fastest speed the path buffers are sized for, and its horizon.
+static constexpr float MAX_PLANNED_SPEED = 200.0f / 3.6f;
+static constexpr float MAX_HORIZON_LENGTH = MAX_PLANNED_SPEED * HIGH_SPEED_HORIZON_RATE;
+static_assert(MAX_HORIZON_LENGTH >= MINIMUM_HORIZON_LENGTH, "Invalid horizon length");
+// A path is purged beyond sqrt(2) times the horizon. The map is sampled every
+// MAP_RESOLUTION and curves are split further, so leave room for waypoints
+// sixteen times denser than that.
+static constexpr float MAX_PATH_LENGTH = 1.4143f * MAX_HORIZON_LENGTH;
+static constexpr float MIN_WAYPOINT_SPACING = Map::MAP_RESOLUTION / 16.0f;
+static constexpr uint32_t NextPowerOfTwo(const uint32_t value, const uint32_t power = 1u) {
+  return power >= value ? power : NextPowerOfTwo(value, 2u * power);
+}
+// Waypoints a path buffer holds, a power of two.
+static constexpr uint32_t PATH_BUFFER_CAPACITY =
+    NextPowerOfTwo(static_cast<uint32_t>(MAX_PATH_LENGTH / MIN_WAYPOINT_SPACING) + 1u);
 } // namespace PathBufferUpdate
 
 namespace WaypointSelection {
@@ -87,6 +115,8 @@ static const float EPSILON = 2.0f * std::numeric_limits<float>::epsilon();
 static const float MIN_REFERENCE_DISTANCE = 0.5f;
 static const float MIN_VELOCITY_COLL_RADIUS = 2.0f;
 static const float VEL_EXT_FACTOR = 0.36f;
+// Side of the cells of the broadphase grid used to find collision candidates.
+static const float BROADPHASE_CELL_SIZE = 20.0f;
 } // namespace Collision
 
 namespace FrameMemory {
@@ -95,17 +125,9 @@ static const uint64_t GROWTH_STEP_SIZE = 50u;
 static const float INV_GROWTH_STEP_SIZE = 1.0f / static_cast<float>(GROWTH_STEP_SIZE);
 } // namespace FrameMemory
 
-namespace Map {
-static const float INFINITE_DISTANCE = std::numeric_limits<float>::max();
-static const float MAX_GEODESIC_GRID_LENGTH = 20.0f;
-static const float MAP_RESOLUTION = 5.0f;
-static const float INV_MAP_RESOLUTION = 1.0f / MAP_RESOLUTION;
-static const double MAX_WPT_DISTANCE = MAP_RESOLUTION/2.0 + SQUARE(MAP_RESOLUTION);
-static const float MAX_WPT_RADIANS = 0.087f;  // 5º
-static float const DELTA = 25.0f;
-static float const Z_DELTA = 500.0f;
-static float const STRAIGHT_DEG = 19.0f;
-} // namespace Map
+namespace StageWorkers {
+static const unsigned long MIN_VEHICLES_PER_WORKER = 16u;
+} // namespace StageWorkers
 
 namespace TrafficLight {
 static const double MINIMUM_STOP_TIME = 2.0;
@@ -0,0 +1,80 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace carla {
+namespace traffic_manager {
+
+  /// Read-only contiguous array that either owns its elements or views
+  /// memory owned by someone else, such as a memory-mapped InMemoryMap image.
+  template <typename T>
+  class FlatArray {
+
+  public:
+
+    FlatArray() = default;
+
+    FlatArray(const FlatArray &) = delete;
+    FlatArray &operator=(const FlatArray &) = delete;
+
+    /// Takes ownership of @a values.
+    void Assign(std::vector<T> &&values) {
+      owned = std::move(values);
+      view = owned.data();
+      count = owned.size();
+    }
+
+    /// Views @a size elements starting at @a data, which must outlive this
+    /// array or the next call to Assign, View or Clear.
+    void View(const T *data, size_t size) {
+      std::vector<T>().swap(owned);
+      view = data;
+      count = size;
+    }
+
+    void Clear() {
+      std::vector<T>().swap(owned);
+      view = nullptr;
+      count = 0u;
+    }
+
+    const T &operator[](size_t index) const {
+      return view[index];
+    }
+
+    const T *data() const {
+      return view;
+    }
+
+    size_t size() const {
+      return count;
+    }
+
+    bool empty() const {
+      return count == 0u;
+    }
+
+    const T *begin() const {
+      return view;
+    }
+
+    const T *end() const {
+      return view + count;
+    }
+
+  private:
+
+    std::vector<T> owned;
+    const T *view = nullptr;
+    size_t count = 0u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -4,11 +4,19 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "carla/FileSystem.h"
 #include "carla/Logging.h"
+#include "carla/ParallelFor.h"
+#include "carla/ThreadPool.h"
 
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/InMemoryMap.h"
-#include <boost/geometry/geometries/box.hpp>
 
 namespace carla {
 namespace traffic_manager {
@@ -74,42 +82,81 @@ namespace traffic_manager {
     local_map.Save(path);
   }
 
-  void InMemoryMap::Save(const std::string& path) {
+  bool InMemoryMap::Save(const std::string& path) {
     std::string filename;
     if (path.empty()) {
       filename = this->GetMapName() + ".bin";
     } else {
       filename = path;
     }
+    carla::FileSystem::ValidateFilePath(filename);
+
+    return InMemoryMapImage::Write(filename, GetMapHash(), graph, spatial_index);
+  }
+
+  bool InMemoryMap::Open(const std::string& path) {
+    return image.Open(path) && AttachImage();
+  }
+
+  bool InMemoryMap::AttachImage() {
+    if (!image.Attach(GetMapHash(), graph, spatial_index)) {
+      image.Close();
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(node_mutex);
+    dense_topology.assign(graph.Size(), nullptr);
+    is_topology_complete = false;
+    return true;
+  }
 
-    std::ofstream out_file;
-    out_file.open(filename, std::ios::binary);
-    if (!out_file.is_open()) {
-      log_error("Could not open binary file");
-      return;
+  void InMemoryMap::ReleaseDenseTopology() {
+    std::lock_guard<std::mutex> lock(node_mutex);
+    for (auto &node : dense_topology) {
+      node->ClearLinks();
     }
+    dense_topology.assign(graph.Size(), nullptr);
+    is_topology_complete = false;
+  }
 
-    // write total records
-    uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
+  uint64_t InMemoryMap::GetMapHash() const {
+    assert(_world_map != nullptr && "No map reference found.");
 
-    // write simple waypoints
-    std::unordered_set<uint64_t> used_ids;
-    for (auto& wp: dense_topology) {
-      if (used_ids.find(wp->GetId()) != used_ids.end()) {
-        log_error("Could not generate the binary file. There are repeated waypoints");
+    // 64-bit FNV-1a over the OpenDRIVE content and everything else that
+    // changes the result of SetUp or the layout of the image.
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size) {
+      const auto *bytes = static_cast<const uint8_t *>(data);
+      for (size_t i = 0u; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
       }
-      CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
+    };
+    const std::string &open_drive = _world_map->GetOpenDrive();
+    mix(open_drive.data(), open_drive.size());
+    const uint32_t version = InMemoryMapImage::VERSION;
+    mix(&version, sizeof(version));
+    const float parameters[] = {MAP_RESOLUTION, MAX_GEODESIC_GRID_LENGTH, MAX_WPT_RADIANS,
+                                static_cast<float>(MAX_WPT_DISTANCE), STRAIGHT_DEG};
+    mix(parameters, sizeof(parameters));
+    return hash;
+  }
 
-      used_ids.insert(wp->GetId());
-    }
+  std::string InMemoryMap::GetImageFileName() const {
+    assert(_world_map != nullptr && "No map reference found.");
+    const std::string &map_name = _world_map->GetName();
+    const size_t separator = map_name.find_last_of("/\\");
+    const std::string base_name = separator == std::string::npos ? map_name : map_name.substr(separator + 1u);
 
-    out_file.close();
-    return;
+    char hash[17u];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(GetMapHash()));
+    return "TM/" + base_name + "." + hash + ".bin";
   }
 
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
+    if (InMemoryMapImage::IsImage(content)) {
+      image.Assign(content);
+      return AttachImage();
+    }
+
     unsigned long pos = 0;
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
@@ -160,6 +207,9 @@ namespace traffic_manager {
     // create spatial tree
     SetUpSpatialTree();
 
+    SetUpWaypointGraph();
+
+    ReleaseDenseTopology();
     return true;
   }
 
@@ -221,12 +271,27 @@ namespace traffic_manager {
       }
     }
 
-    // 2. Consuming the raw dense topology from cc::Map into SimpleWaypoints.
+    // Segments and lane change links are processed by a pool of workers,
+    // the calling thread included.
+    const size_t number_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::unique_ptr<ThreadPool> setup_worker_pool;
+    if (number_of_threads > 1u) {
+      setup_worker_pool = std::make_unique<ThreadPool>();
+      setup_worker_pool->AsyncRun(number_of_threads - 1u);
+    }
+
+    // 2. Consuming the raw dense topology from cc::Map, grouped by segment.
     SegmentMap segment_map;
+    std::map<SegmentId, RawNodeList> raw_segment_map;
     assert(_world_map != nullptr && "No map reference found.");
     auto raw_dense_topology = _world_map->GenerateWaypoints(MAP_RESOLUTION);
     for (auto &waypoint_ptr: raw_dense_topology) {
-      segment_map[GetSegmentId(waypoint_ptr)].emplace_back(std::make_shared<SimpleWaypoint>(waypoint_ptr));
+      raw_segment_map[GetSegmentId(waypoint_ptr)].push_back(waypoint_ptr);
+    }
+    std::vector<std::pair<const RawNodeList *, NodeList *>> segments;
+    segments.reserve(raw_segment_map.size());
+    for (auto &raw_segment : raw_segment_map) {
+      segments.emplace_back(&raw_segment.second, &segment_map[raw_segment.first]);
     }
 
     // 3. Processing waypoints.
@@ -244,12 +309,20 @@ namespace traffic_manager {
       return x ^ ((x ^ y) & -(x < y));
     };
 
-    GeoGridId geodesic_grid_id_counter = -1;
-    for (auto &segment: segment_map) {
-      auto &segment_waypoints = segment.second;
+    // Every segment only touches its own waypoints. Geodesic grid ids are
+    // numbered from zero within the segment and offset once all are done.
+    std::vector<GeoGridId> segment_grid_counts(segments.size());
+    ParallelFor(setup_worker_pool.get(), segments.size(), number_of_threads, [&](const size_t index) {
+      const RawNodeList &raw_segment_waypoints = *segments[index].first;
+      auto &segment_waypoints = *segments[index].second;
+
+      segment_waypoints.reserve(raw_segment_waypoints.size());
+      for (auto &waypoint_ptr : raw_segment_waypoints) {
+        segment_waypoints.emplace_back(std::make_shared<SimpleWaypoint>(waypoint_ptr));
+      }
 
       // Generating geodesic grid ids.
-      ++geodesic_grid_id_counter;
+      GeoGridId geodesic_grid_id_counter = 0;
 
       // Ordering waypoints according to road direction.
       std::sort(segment_waypoints.begin(), segment_waypoints.end(), compare_s);
@@ -299,10 +372,10 @@ namespace traffic_manager {
 
       }
       segment_waypoints.back()->SetGeodesicGridId(geodesic_grid_id_counter);
+      segment_grid_counts[index] = geodesic_grid_id_counter + 1;
 
-      // Adding simple waypoints to processed dense topology.
-      for (auto swp: segment_waypoints) {
-        // Checking whether the waypoint is in a real junction.
+      // Checking whether the waypoints are in a real junction.
+      for (auto &swp: segment_waypoints) {
         auto wpt = swp->GetWaypoint();
         auto road_id = wpt->GetRoadId();
         if (wpt->IsJunction() && !is_real_junction.count(road_id)) {
@@ -310,9 +383,18 @@ namespace traffic_manager {
         } else {
           swp->SetIsJunction(swp->GetWaypoint()->IsJunction());
         }
-
+      }
+    });
+
+    // Adding simple waypoints to processed dense topology, in segment order
+    // so the result does not depend on the number of threads.
+    GeoGridId first_geodesic_grid_id = 0;
+    for (size_t index = 0u; index < segments.size(); ++index) {
+      for (auto &swp : *segments[index].second) {
+        swp->SetGeodesicGridId(first_geodesic_grid_id + swp->GetGeodesicGridId());
         dense_topology.push_back(swp);
       }
+      first_geodesic_grid_id += segment_grid_counts[index];
     }
 
     SetUpSpatialTree();
@@ -329,12 +411,19 @@ namespace traffic_manager {
       segment_waypoints.back()->SetNextWaypoint(successors);
     }
 
-    // Linking lane change connections.
-    for (auto &swp : dense_topology) {
-      if (!swp->CheckJunction()) {
-        FindAndLinkLaneChange(swp);
+    // Linking lane change connections. Each waypoint only sets its own links
+    // and the spatial index is read-only by now.
+    const size_t number_of_tasks = (dense_topology.size() + SETUP_NODES_PER_TASK - 1u) / SETUP_NODES_PER_TASK;
+    ParallelFor(setup_worker_pool.get(), number_of_tasks, number_of_threads, [this](const size_t task) {
+      const size_t end = std::min(dense_topology.size(), (task + 1u) * SETUP_NODES_PER_TASK);
+      for (size_t index = task * SETUP_NODES_PER_TASK; index < end; ++index) {
+        SimpleWaypointPtr &swp = dense_topology[index];
+        if (!swp->CheckJunction()) {
+          FindAndLinkLaneChange(swp);
+        }
       }
-    }
+    });
+    setup_worker_pool.reset();
 
     // Linking any unconnected segments.
     for (auto &swp : dense_topology) {
@@ -355,16 +444,26 @@ namespace traffic_manager {
 
     // Specifying a RoadOption for each SimpleWaypoint
     SetUpRoadOption();
+
+    SetUpWaypointGraph();
+
+    ReleaseDenseTopology();
   }
 
   void InMemoryMap::SetUpSpatialTree() {
-    for (auto &simple_waypoint: dense_topology) {
-      if (simple_waypoint != nullptr) {
-        const cg::Location loc = simple_waypoint->GetLocation();
-        Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
-      }
+    // The index stores graph indices, so this is where they are assigned.
+    std::vector<cg::Location> locations;
+    locations.reserve(dense_topology.size());
+    for (NodeIndex index = 0u; index < dense_topology.size(); ++index) {
+      SimpleWaypointPtr &simple_waypoint = dense_topology.at(index);
+      simple_waypoint->SetIndex(index);
+      locations.push_back(simple_waypoint->GetLocation());
     }
+    spatial_index.Build(locations.data(), locations.size());
+  }
+
+  void InMemoryMap::SetUpWaypointGraph() {
+    graph.Build(dense_topology);
   }
 
   void InMemoryMap::SetUpRoadOption() {
@@ -457,47 +556,105 @@ namespace traffic_manager {
   }
 
   SimpleWaypointPtr InMemoryMap::GetWaypoint(const cg::Location loc) const {
+    return GetNode(GetWaypointIndex(loc));
+  }
 
-    Point3D query_point(loc.x, loc.y, loc.z);
-    std::vector<SpatialTreeEntry> result_1;
+  NodeIndex InMemoryMap::GetWaypointIndex(const cg::Location loc) const {
+    return spatial_index.Nearest(loc);
+  }
 
-    rtree.query(bgi::nearest(query_point, 1), std::back_inserter(result_1));
+  SimpleWaypointPtr InMemoryMap::GetNode(const NodeIndex index) const {
+    SimpleWaypointPtr node = std::atomic_load(&dense_topology.at(index));
+    if (node == nullptr) {
+      std::lock_guard<std::mutex> lock(node_mutex);
+      node = dense_topology.at(index);
+      if (node == nullptr) {
+        node = MakeNode(index);
+        std::atomic_store(&dense_topology.at(index), node);
+      }
+    }
+    return node;
+  }
 
-    SpatialTreeEntry &closest_entry = result_1.front();
-    SimpleWaypointPtr &closest_point = closest_entry.second;
+  SimpleWaypointPtr InMemoryMap::MakeNode(const NodeIndex index) const {
+    // The exact road, section, lane and s of the waypoint the node was made
+    // from, so the node matches the graph.
+    WaypointPtr waypoint = _world_map->GetWaypointInSection(
+        graph.GetRoadId(index), graph.GetSectionId(index), graph.GetLaneId(index), graph.GetDistance(index));
+    if (waypoint == nullptr) {
+      waypoint = _world_map->GetWaypoint(graph.GetLocation(index));
+    }
 
-    return closest_point;
+    SimpleWaypointPtr node = std::make_shared<SimpleWaypoint>(waypoint);
+    node->SetIndex(index);
+    node->SetGeodesicGridId(graph.GetGeodesicGridId(index));
+    node->SetIsJunction(graph.CheckJunction(index));
+    node->SetRoadOption(graph.GetRoadOption(index));
+    return node;
   }
 
-  NodeList InMemoryMap::GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const {
-    Point3D query_point(loc.x, loc.y, loc.z);
-
-    Point3D lower_p1(loc.x + random_sample, loc.y + random_sample, loc.z + Z_DELTA);
-    Point3D lower_p2(loc.x - random_sample, loc.y - random_sample, loc.z - Z_DELTA);
-    Point3D upper_p1(loc.x + random_sample + DELTA, loc.y + random_sample + DELTA, loc.z + Z_DELTA);
-    Point3D upper_p2(loc.x - random_sample - DELTA, loc.y - random_sample - DELTA, loc.z - Z_DELTA);
+  const WaypointGraph &InMemoryMap::GetGraph() const {
+    return graph;
+  }
 
-    Box lower_query_box(lower_p2, lower_p1);
-    Box upper_query_box(upper_p2, upper_p1);
+  NodeList InMemoryMap::GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const {
+    const cg::Location lower_min(loc.x - random_sample, loc.y - random_sample, loc.z - Z_DELTA);
+    const cg::Location lower_max(loc.x + random_sample, loc.y + random_sample, loc.z + Z_DELTA);
+    const cg::Location upper_min(loc.x - random_sample - DELTA, loc.y - random_sample - DELTA, loc.z - Z_DELTA);
+    const cg::Location upper_max(loc.x + random_sample + DELTA, loc.y + random_sample + DELTA, loc.z + Z_DELTA);
+
+    auto within_lower_box = [&](const cg::Location &point) {
+      return point.x > lower_min.x && point.x < lower_max.x &&
+             point.y > lower_min.y && point.y < lower_max.y &&
+             point.z > lower_min.z && point.z < lower_max.z;
+    };
 
     NodeList result;
-    uint8_t x = 0;
-    for (Rtree::const_query_iterator
-        it = rtree.qbegin(bgi::within(upper_query_box)
-        && !bgi::within(lower_query_box)
-        && bgi::satisfies([&](SpatialTreeEntry const& v) { return !v.second->CheckJunction();}));
-        it != rtree.qend();
-        ++it) {
-    x++;
-    result.push_back(it->second);
-    if (x >= n_points)
-        break;
-    }
+    spatial_index.Query(upper_min, upper_max, [&](const NodeIndex node) {
+      if (!within_lower_box(graph.GetLocation(node)) && !graph.CheckJunction(node)) {
+        result.push_back(GetNode(node));
+      }
+      return result.size() < n_points;
+    });
 
     return result;
   }
 
   NodeList InMemoryMap::GetDenseTopology() const {
+    std::lock_guard<std::mutex> lock(node_mutex);
+    if (!is_topology_complete) {
+      for (NodeIndex index = 0u; index < dense_topology.size(); ++index) {
+        if (dense_topology[index] == nullptr) {
+          std::atomic_store(&dense_topology[index], MakeNode(index));
+        }
+      }
+
+      auto node_at = [this](const NodeIndex index) {
+        return index != INVALID_NODE ? dense_topology[index] : nullptr;
+      };
+      for (NodeIndex index = 0u; index < dense_topology.size(); ++index) {
+        const SimpleWaypointPtr &node = dense_topology[index];
+        NodeList successors;
+        for (const NodeIndex successor : graph.GetSuccessors(index)) {
+          successors.push_back(dense_topology[successor]);
+        }
+        NodeList predecessors;
+        for (const NodeIndex predecessor : graph.GetPredecessors(index)) {
+          predecessors.push_back(dense_topology[predecessor]);
+        }
+        node->SetNextWaypoint(successors);
+        node->SetPreviousWaypoint(predecessors);
+        SimpleWaypointPtr left = node_at(graph.GetLeftNode(index));
+        if (left != nullptr) {
+          node->SetLeftWaypoint(left);
+        }
+        SimpleWaypointPtr right = node_at(graph.GetRightNode(index));
+        if (right != nullptr) {
+          node->SetRightWaypoint(right);
+        }
+      }
+      is_topology_complete = true;
+    }
     return dense_topology;
   }
 
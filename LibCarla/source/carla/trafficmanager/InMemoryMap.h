@@ -7,14 +7,14 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 
-#include "boost/geometry.hpp"
-#include "boost/geometry/geometries/point.hpp"
-#include "boost/geometry/index/rtree.hpp"
-
 #include "carla/client/Map.h"
 #include "carla/client/Waypoint.h"
 #include "carla/geom/Location.h"
@@ -25,6 +25,9 @@
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 #include "carla/trafficmanager/CachedSimpleWaypoint.h"
+#include "carla/trafficmanager/InMemoryMapImage.h"
+#include "carla/trafficmanager/PackedSpatialIndex.h"
+#include "carla/trafficmanager/WaypointGraph.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -32,8 +35,6 @@ namespace traffic_manager {
 namespace cg = carla::geom;
 namespace cc = carla::client;
 namespace crd = carla::road;
-namespace bg = boost::geometry;
-namespace bgi = boost::geometry::index;
 
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
   using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
@@ -41,14 +42,9 @@ namespace bgi = boost::geometry::index;
   using GeoGridId = crd::JuncId;
   using WorldMap = carla::SharedPtr<const cc::Map>;
 
-  using Point3D = bg::model::point<float, 3, bg::cs::cartesian>;
-  using Box = bg::model::box<Point3D>;
-  using SpatialTreeEntry = std::pair<Point3D, SimpleWaypointPtr>;
-
   using SegmentId = std::tuple<crd::RoadId, crd::LaneId, crd::SectionId>;
   using SegmentTopology = std::map<SegmentId, std::pair<std::vector<SegmentId>, std::vector<SegmentId>>>;
   using SegmentMap = std::map<SegmentId, std::vector<SimpleWaypointPtr>>;
-  using Rtree = bgi::rtree<SpatialTreeEntry, bgi::rstar<16>>;
 
   /// This class builds a discretized local map-cache.
   /// Instantiate the class with the world and run SetUp() to construct the
@@ -60,31 +56,66 @@ namespace bgi = boost::geometry::index;
     /// Object to hold the world map received by the constructor.
     WorldMap _world_map;
     /// Structure to hold all custom waypoint objects after interpolation of
-    /// sparse topology.
-    NodeList dense_topology;
-    /// Spatial quadratic R-tree for indexing and querying waypoints.
-    Rtree rtree;
+    /// sparse topology. Once the graph is built the entries are released, and
+    /// created again on first access by GetNode.
+    mutable NodeList dense_topology;
+    /// Protects the creation of dense topology entries from an image.
+    mutable std::mutex node_mutex;
+    /// Whether every entry of the dense topology exists and is linked.
+    mutable bool is_topology_complete = false;
+    /// Image the graph and the spatial index point into, if any.
+    InMemoryMapImage image;
+    /// Packed R-tree for indexing and querying waypoints.
+    PackedSpatialIndex spatial_index;
+    /// Flat copy of the dense topology used by the stages.
+    WaypointGraph graph;
 
   public:
 
     InMemoryMap(WorldMap world_map);
     ~InMemoryMap();
 
+    /// Sets up the local map of @a world_map and writes its image to @a path,
+    /// or to the map name with a .bin extension if @a path is empty.
     static void Cook(WorldMap world_map, const std::string& path);
 
-    //bool Load(const std::string& filename);
+    /// Loads the map from a cache file, either an image written by Cook or
+    /// the older per-waypoint format.
     bool Load(const std::vector<uint8_t>& content);
 
+    /// Maps the image at @a path and uses it in place. Returns false if the
+    /// file does not exist or is not a valid image of this map and version.
+    bool Open(const std::string& path);
+
+    /// Writes the image of the local map to @a path.
+    bool Save(const std::string& path);
+
+    /// Name under which the image of this map is cached, unique to its
+    /// OpenDRIVE content and the image version.
+    std::string GetImageFileName() const;
+
     /// This method constructs the local map with a resolution of sampling_resolution.
     void SetUp();
 
     /// This method returns the closest waypoint to a given location on the map.
     SimpleWaypointPtr GetWaypoint(const cg::Location loc) const;
 
+    /// This method returns the graph index of the closest waypoint to a given location on the map.
+    NodeIndex GetWaypointIndex(const cg::Location loc) const;
+
+    /// Returns the waypoint stored at the given graph index. Waypoints are
+    /// created on first access and are not linked to their neighbours, use
+    /// the graph for connectivity.
+    SimpleWaypointPtr GetNode(const NodeIndex index) const;
+
+    /// Returns the flat, index based representation of the local map.
+    const WaypointGraph &GetGraph() const;
+
     /// This method returns n waypoints in an delta area with a certain distance from the ego vehicle.
     NodeList GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const;
 
     /// This method returns the full list of discrete samples of the map in the local cache.
+    /// This creates and links every waypoint.
     NodeList GetDenseTopology() const;
 
     std::string GetMapName();
@@ -92,11 +123,22 @@ namespace bgi = boost::geometry::index;
     const cc::Map& GetMap() const;
 
   private:
-    void Save(const std::string& path);
+    /// Points the graph and the spatial index at the image, if it matches this map.
+    bool AttachImage();
+
+    /// Creates the dense topology entry at @a index from the graph.
+    SimpleWaypointPtr MakeNode(const NodeIndex index) const;
+
+    /// Releases the dense topology used to build the graph, so only the
+    /// graph stays in memory.
+    void ReleaseDenseTopology();
+
+    uint64_t GetMapHash() const;
 
     void SetUpDenseTopology();
     void SetUpSpatialTree();
     void SetUpRoadOption();
+    void SetUpWaypointGraph();
 
     /// This method is used to find and place lane change links.
     void FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint);
@@ -0,0 +1,367 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/InMemoryMapImage.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include "boost/interprocess/file_mapping.hpp"
+
+#include "carla/Logging.h"
+
+namespace carla {
+namespace traffic_manager {
+
+namespace bip = boost::interprocess;
+
+namespace image {
+
+  static constexpr char MAGIC[8u] = {'C', 'A', 'R', 'L', 'A', 'T', 'M', 'I'};
+  static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+  static constexpr uint64_t TABLE_ALIGNMENT = 16u;
+
+  enum Table : uint32_t {
+    Locations,
+    Rotations,
+    ForwardVectors,
+    RightVectors,
+    WaypointIds,
+    RoadIds,
+    SectionIds,
+    LaneIds,
+    Distances,
+    LaneWidths,
+    JunctionFlags,
+    JunctionIds,
+    GeodesicGridIds,
+    RoadOptions,
+    LeftNodes,
+    RightNodes,
+    SuccessorOffsets,
+    SuccessorNodes,
+    PredecessorOffsets,
+    PredecessorNodes,
+    IndexEntries,
+    IndexNodes,
+    TableCount
+  };
+
+  struct TableInfo {
+    uint64_t offset;
+    uint64_t count;
+    uint64_t element_size;
+  };
+
+  struct Header {
+    char magic[8u];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t map_hash;
+    uint64_t file_size;
+    uint32_t node_count;
+    uint32_t index_leaf_node_count;
+    uint32_t table_count;
+    uint32_t reserved;
+    TableInfo tables[TableCount];
+  };
+
+  struct TableSource {
+    const void *data;
+    uint64_t count;
+    uint64_t element_size;
+  };
+
+  template <typename T>
+  static TableSource Source(const FlatArray<T> &array) {
+    static_assert(std::is_trivially_copyable<T>::value, "Image tables must be trivially copyable.");
+    return TableSource{array.data(), array.size(), sizeof(T)};
+  }
+
+  static uint64_t Align(const uint64_t offset) {
+    return (offset + TABLE_ALIGNMENT - 1u) & ~(TABLE_ALIGNMENT - 1u);
+  }
+
+  /// Returns a pointer to the elements of @a table if its location, size
+  /// and element type are consistent with an image of @a size bytes.
+  template <typename T>
+  static const T *GetTable(const uint8_t *data, const size_t size, const Header &header,
+                           const Table table, const uint64_t expected_count) {
+    const TableInfo &info = header.tables[table];
+    if (info.element_size != sizeof(T) || info.count != expected_count ||
+        info.offset % TABLE_ALIGNMENT != 0u || info.offset > size ||
+        info.count > (size - info.offset) / sizeof(T)) {
+      return nullptr;
+    }
+    return reinterpret_cast<const T *>(data + info.offset);
+  }
+
+  /// Checks that a compressed sparse row adjacency table is well formed and
+  /// only refers to existing nodes.
+  static bool CheckAdjacency(const uint32_t *offsets, const NodeIndex *nodes,
+                             const uint32_t node_count, const uint64_t edge_count) {
+    if (offsets[0u] != 0u || offsets[node_count] != edge_count) {
+      return false;
+    }
+    for (uint32_t i = 0u; i < node_count; ++i) {
+      if (offsets[i] > offsets[i + 1u]) {
+        return false;
+      }
+    }
+    for (uint64_t i = 0u; i < edge_count; ++i) {
+      if (nodes[i] >= node_count) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool CheckLinks(const NodeIndex *links, const uint32_t node_count) {
+    for (uint32_t i = 0u; i < node_count; ++i) {
+      if (links[i] >= node_count && links[i] != INVALID_NODE) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool CheckIndex(const PackedSpatialIndex::Entry *entries, const uint32_t entry_count,
+                         const PackedSpatialIndex::Node *nodes, const uint64_t node_count,
+                         const uint32_t leaf_node_count) {
+    if ((entry_count == 0u) != (node_count == 0u) || leaf_node_count > node_count ||
+        (node_count > 0u && leaf_node_count == 0u)) {
+      return false;
+    }
+    for (uint32_t i = 0u; i < entry_count; ++i) {
+      if (entries[i].node >= entry_count) {
+        return false;
+      }
+    }
+    // Leaves span entries, the rest span nodes stored before themselves,
+    // which also rules out cycles.
+    for (uint64_t i = 0u; i < node_count; ++i) {
+      const uint64_t end = static_cast<uint64_t>(nodes[i].first) + nodes[i].count;
+      if (nodes[i].count == 0u || end > (i < leaf_node_count ? entry_count : i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+} // namespace image
+
+  bool InMemoryMapImage::Write(const std::string &path, const uint64_t map_hash,
+                               const WaypointGraph &graph, const PackedSpatialIndex &index) {
+    using namespace image;
+
+    const TableSource sources[TableCount] = {
+      Source(graph.locations),
+      Source(graph.rotations),
+      Source(graph.forward_vectors),
+      Source(graph.right_vectors),
+      Source(graph.waypoint_ids),
+      Source(graph.road_ids),
+      Source(graph.section_ids),
+      Source(graph.lane_ids),
+      Source(graph.distances),
+      Source(graph.lane_widths),
+      Source(graph.junction_flags),
+      Source(graph.junction_ids),
+      Source(graph.geodesic_grid_ids),
+      Source(graph.road_options),
+      Source(graph.left_nodes),
+      Source(graph.right_nodes),
+      Source(graph.successor_offsets),
+      Source(graph.successor_nodes),
+      Source(graph.predecessor_offsets),
+      Source(graph.predecessor_nodes),
+      Source(index.GetEntries()),
+      Source(index.GetNodes())
+    };
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.map_hash = map_hash;
+    header.node_count = static_cast<uint32_t>(graph.Size());
+    header.index_leaf_node_count = index.GetLeafNodeCount();
+    header.table_count = TableCount;
+
+    uint64_t offset = Align(sizeof(Header));
+    for (uint32_t table = 0u; table < TableCount; ++table) {
+      header.tables[table] = TableInfo{offset, sources[table].count, sources[table].element_size};
+      offset = Align(offset + sources[table].count * sources[table].element_size);
+    }
+    header.file_size = offset;
+
+    const std::string temporary_path = path + ".tmp";
+    {
+      std::ofstream out_file(temporary_path, std::ios::binary | std::ios::trunc);
+      if (!out_file.is_open()) {
+        log_error("Could not open", temporary_path, "to write the InMemoryMap image");
+        return false;
+      }
+
+      static const char padding[TABLE_ALIGNMENT] = {};
+      out_file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+      out_file.write(padding, static_cast<std::streamsize>(header.tables[0u].offset - sizeof(Header)));
+      for (uint32_t table = 0u; table < TableCount; ++table) {
+        const uint64_t table_size = sources[table].count * sources[table].element_size;
+        if (table_size > 0u) {
+          out_file.write(reinterpret_cast<const char *>(sources[table].data), static_cast<std::streamsize>(table_size));
+        }
+        const uint64_t end = header.tables[table].offset + table_size;
+        out_file.write(padding, static_cast<std::streamsize>(Align(end) - end));
+      }
+
+      if (!out_file.good()) {
+        log_error("Could not write the InMemoryMap image to", temporary_path);
+        out_file.close();
+        std::remove(temporary_path.c_str());
+        return false;
+      }
+    }
+
+    // Replacing an existing file fails on Windows, where it has to be removed first.
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+      std::remove(path.c_str());
+      if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        log_error("Could not move the InMemoryMap image to", path);
+        std::remove(temporary_path.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool InMemoryMapImage::IsImage(const std::vector<uint8_t> &content) {
+    return content.size() >= sizeof(image::MAGIC) &&
+           std::memcmp(content.data(), image::MAGIC, sizeof(image::MAGIC)) == 0;
+  }
+
+  bool InMemoryMapImage::Open(const std::string &path) {
+    Close();
+    try {
+      bip::file_mapping file(path.c_str(), bip::read_only);
+      bip::mapped_region mapped(file, bip::read_only);
+      region.swap(mapped);
+    } catch (const bip::interprocess_exception &) {
+      return false;
+    }
+    data = static_cast<const uint8_t *>(region.get_address());
+    size = region.get_size();
+    return true;
+  }
+
+  void InMemoryMapImage::Assign(std::vector<uint8_t> content) {
+    Close();
+    buffer = std::move(content);
+    data = buffer.data();
+    size = buffer.size();
+  }
+
+  void InMemoryMapImage::Close() {
+    bip::mapped_region().swap(region);
+    std::vector<uint8_t>().swap(buffer);
+    data = nullptr;
+    size = 0u;
+  }
+
+  bool InMemoryMapImage::Attach(const uint64_t map_hash, WaypointGraph &graph, PackedSpatialIndex &index) const {
+    using namespace image;
+
+    if (data == nullptr || size < sizeof(Header)) {
+      return false;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION ||
+        header.byte_order != BYTE_ORDER_MARK ||
+        header.table_count != TableCount ||
+        header.file_size != size ||
+        header.map_hash != map_hash ||
+        header.node_count == INVALID_NODE) {
+      return false;
+    }
+
+    const uint32_t n = header.node_count;
+    const auto *locations = GetTable<cg::Location>(data, size, header, Locations, n);
+    const auto *rotations = GetTable<cg::Rotation>(data, size, header, Rotations, n);
+    const auto *forward_vectors = GetTable<cg::Vector3D>(data, size, header, ForwardVectors, n);
+    const auto *right_vectors = GetTable<cg::Vector3D>(data, size, header, RightVectors, n);
+    const auto *waypoint_ids = GetTable<uint64_t>(data, size, header, WaypointIds, n);
+    const auto *road_ids = GetTable<crd::RoadId>(data, size, header, RoadIds, n);
+    const auto *section_ids = GetTable<crd::SectionId>(data, size, header, SectionIds, n);
+    const auto *lane_ids = GetTable<crd::LaneId>(data, size, header, LaneIds, n);
+    const auto *distances = GetTable<double>(data, size, header, Distances, n);
+    const auto *lane_widths = GetTable<float>(data, size, header, LaneWidths, n);
+    const auto *junction_flags = GetTable<uint8_t>(data, size, header, JunctionFlags, n);
+    const auto *junction_ids = GetTable<GeoGridId>(data, size, header, JunctionIds, n);
+    const auto *geodesic_grid_ids = GetTable<GeoGridId>(data, size, header, GeodesicGridIds, n);
+    const auto *road_options = GetTable<RoadOption>(data, size, header, RoadOptions, n);
+    const auto *left_nodes = GetTable<NodeIndex>(data, size, header, LeftNodes, n);
+    const auto *right_nodes = GetTable<NodeIndex>(data, size, header, RightNodes, n);
+    const auto *successor_offsets = GetTable<uint32_t>(data, size, header, SuccessorOffsets, n + 1u);
+    const uint64_t successor_count = header.tables[SuccessorNodes].count;
+    const auto *successor_nodes = GetTable<NodeIndex>(data, size, header, SuccessorNodes, successor_count);
+    const auto *predecessor_offsets = GetTable<uint32_t>(data, size, header, PredecessorOffsets, n + 1u);
+    const uint64_t predecessor_count = header.tables[PredecessorNodes].count;
+    const auto *predecessor_nodes = GetTable<NodeIndex>(data, size, header, PredecessorNodes, predecessor_count);
+    const auto *index_entries = GetTable<PackedSpatialIndex::Entry>(data, size, header, IndexEntries, n);
+    const uint64_t index_node_count = header.tables[IndexNodes].count;
+    const auto *index_nodes = GetTable<PackedSpatialIndex::Node>(data, size, header, IndexNodes, index_node_count);
+
+    if (locations == nullptr || rotations == nullptr || forward_vectors == nullptr ||
+        right_vectors == nullptr || waypoint_ids == nullptr || road_ids == nullptr ||
+        section_ids == nullptr || lane_ids == nullptr || distances == nullptr ||
+        lane_widths == nullptr || junction_flags == nullptr || junction_ids == nullptr ||
+        geodesic_grid_ids == nullptr || road_options == nullptr || left_nodes == nullptr ||
+        right_nodes == nullptr || successor_offsets == nullptr || successor_nodes == nullptr ||
+        predecessor_offsets == nullptr || predecessor_nodes == nullptr ||
+        index_entries == nullptr || index_nodes == nullptr) {
+      return false;
+    }
+
+    // The stages index these tables without bounds checks, so the links
+    // are validated once here.
+    if (!CheckAdjacency(successor_offsets, successor_nodes, n, successor_count) ||
+        !CheckAdjacency(predecessor_offsets, predecessor_nodes, n, predecessor_count) ||
+        !CheckLinks(left_nodes, n) || !CheckLinks(right_nodes, n) ||
+        !CheckIndex(index_entries, n, index_nodes, index_node_count, header.index_leaf_node_count)) {
+      return false;
+    }
+
+    graph.locations.View(locations, n);
+    graph.rotations.View(rotations, n);
+    graph.forward_vectors.View(forward_vectors, n);
+    graph.right_vectors.View(right_vectors, n);
+    graph.waypoint_ids.View(waypoint_ids, n);
+    graph.road_ids.View(road_ids, n);
+    graph.section_ids.View(section_ids, n);
+    graph.lane_ids.View(lane_ids, n);
+    graph.distances.View(distances, n);
+    graph.lane_widths.View(lane_widths, n);
+    graph.junction_flags.View(junction_flags, n);
+    graph.junction_ids.View(junction_ids, n);
+    graph.geodesic_grid_ids.View(geodesic_grid_ids, n);
+    graph.road_options.View(road_options, n);
+    graph.left_nodes.View(left_nodes, n);
+    graph.right_nodes.View(right_nodes, n);
+    graph.successor_offsets.View(successor_offsets, n + 1u);
+    graph.successor_nodes.View(successor_nodes, successor_count);
+    graph.predecessor_offsets.View(predecessor_offsets, n + 1u);
+    graph.predecessor_nodes.View(predecessor_nodes, predecessor_count);
+    index.View(index_entries, n, index_nodes, index_node_count, header.index_leaf_node_count);
+    return true;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
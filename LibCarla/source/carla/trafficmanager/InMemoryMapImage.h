@@ -0,0 +1,73 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "boost/interprocess/mapped_region.hpp"
+
+#include "carla/NonCopyable.h"
+
+#include "carla/trafficmanager/PackedSpatialIndex.h"
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// Versioned binary image of an InMemoryMap. It holds the WaypointGraph
+  /// columns, the adjacency tables and the PackedSpatialIndex. Each one is
+  /// stored as a raw table at an aligned offset from the start of the file.
+  /// Nothing in the image depends on where it is loaded, so the graph and
+  /// the index view it in place, straight from a memory-mapped file.
+  ///
+  /// The image uses the byte order of the machine that wrote it. A reader
+  /// with a different byte order rejects it.
+  class InMemoryMapImage : private NonCopyable {
+
+  public:
+
+    static constexpr uint32_t VERSION = 1u;
+
+    /// Writes an image of @a graph and @a index to @a path. The image is
+    /// written to a temporary file first and then renamed over @a path, so
+    /// concurrent readers never see a partial image.
+    static bool Write(const std::string &path, uint64_t map_hash,
+                      const WaypointGraph &graph, const PackedSpatialIndex &index);
+
+    /// Whether @a content starts with an image header of any version.
+    static bool IsImage(const std::vector<uint8_t> &content);
+
+    /// Maps the file at @a path read-only. Returns false if the file cannot
+    /// be opened.
+    bool Open(const std::string &path);
+
+    /// Keeps an image that has already been read into memory.
+    void Assign(std::vector<uint8_t> content);
+
+    /// Validates the image and makes @a graph and @a index view its tables.
+    /// If the image is malformed, of another version or built for a map
+    /// other than @a map_hash, it returns false and leaves both untouched.
+    bool Attach(uint64_t map_hash, WaypointGraph &graph, PackedSpatialIndex &index) const;
+
+    void Close();
+
+    bool IsOpen() const {
+      return data != nullptr;
+    }
+
+  private:
+
+    boost::interprocess::mapped_region region;
+    std::vector<uint8_t> buffer;
+    const uint8_t *data = nullptr;
+    size_t size = 0u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
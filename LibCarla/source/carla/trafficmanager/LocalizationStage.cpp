@@ -36,9 +36,10 @@ LocalizationStage::LocalizationStage(
 void LocalizationStage::Update(const unsigned long index) {
 
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_id);
+  const ActorSlot actor_slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocation(actor_slot);
+  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_slot);
+  const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_slot);
   const float vehicle_speed = vehicle_velocity_vector.Length();
 
   // Speed dependent waypoint horizon length.
@@ -47,44 +48,41 @@ void LocalizationStage::Update(const unsigned long index) {
     horizon_length = std::max(vehicle_speed * HIGH_SPEED_HORIZON_RATE, MINIMUM_HORIZON_LENGTH);
   }
   const float horizon_square = SQUARE(horizon_length);
+  const WaypointGraph &graph = local_map->GetGraph();
 
-  if (buffer_map.find(actor_id) == buffer_map.end()) {
-    buffer_map.insert({actor_id, Buffer()});
-  }
-  Buffer &waypoint_buffer = buffer_map.at(actor_id);
+  Buffer &waypoint_buffer = buffer_map.Acquire(actor_id);
 
   // Clear buffer if vehicle is too far from the first waypoint in the buffer.
   if (!waypoint_buffer.empty() &&
-      cg::Math::DistanceSquared(waypoint_buffer.front()->GetLocation(),
-                                vehicle_location) > SQUARE(MAX_START_DISTANCE)) {
+      graph.DistanceSquared(waypoint_buffer.front(), vehicle_location) > SQUARE(MAX_START_DISTANCE)) {
 
     auto number_of_pops = waypoint_buffer.size();
     for (uint64_t j = 0u; j < number_of_pops; ++j) {
-      PopWaypoint(actor_id, track_traffic, waypoint_buffer);
+      PopWaypoint(actor_id, track_traffic, graph, waypoint_buffer);
     }
   }
 
   bool is_at_junction_entrance = false;
   if (!waypoint_buffer.empty()) {
     // Purge passed waypoints.
-    float dot_product = DeviationDotProduct(vehicle_location, heading_vector, waypoint_buffer.front()->GetLocation());
+    float dot_product = DeviationDotProduct(vehicle_location, heading_vector, graph.GetLocation(waypoint_buffer.front()));
     while (dot_product <= 0.0f && !waypoint_buffer.empty()) {
-      PopWaypoint(actor_id, track_traffic, waypoint_buffer);
+      PopWaypoint(actor_id, track_traffic, graph, waypoint_buffer);
       if (!waypoint_buffer.empty()) {
-        dot_product = DeviationDotProduct(vehicle_location, heading_vector, waypoint_buffer.front()->GetLocation());
+        dot_product = DeviationDotProduct(vehicle_location, heading_vector, graph.GetLocation(waypoint_buffer.front()));
       }
     }
 
     if (!waypoint_buffer.empty()) {
       // Determine if the vehicle is at the entrance of a junction.
-      SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
-      SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
-      bool front_waypoint_junction = front_waypoint->CheckJunction();
-      is_at_junction_entrance = !front_waypoint_junction && look_ahead_point->CheckJunction();
+      NodeIndex look_ahead_point = GetTargetWaypoint(graph, waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
+      NodeIndex front_waypoint = waypoint_buffer.front();
+      bool front_waypoint_junction = graph.CheckJunction(front_waypoint);
+      is_at_junction_entrance = !front_waypoint_junction && graph.CheckJunction(look_ahead_point);
       if (!is_at_junction_entrance) {
-        std::vector<SimpleWaypointPtr> last_passed_waypoints = front_waypoint->GetPreviousWaypoint();
+        const NodeRange last_passed_waypoints = graph.GetPredecessors(front_waypoint);
         if (last_passed_waypoints.size() == 1) {
-          is_at_junction_entrance = !last_passed_waypoints.front()->CheckJunction() && front_waypoint_junction;
+          is_at_junction_entrance = !graph.CheckJunction(*last_passed_waypoints.begin()) && front_waypoint_junction;
         }
       }
       if (is_at_junction_entrance
@@ -98,16 +96,16 @@ void LocalizationStage::Update(const unsigned long index) {
     // Purge waypoints too far from the front of the buffer, but not if it has reached a junction.
     while (!is_at_junction_entrance
            && !waypoint_buffer.empty()
-           && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) > horizon_square + horizon_square
-           && !waypoint_buffer.back()->CheckJunction()) {
-      PopWaypoint(actor_id, track_traffic, waypoint_buffer, false);
+           && graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) > horizon_square + horizon_square
+           && !graph.CheckJunction(waypoint_buffer.back())) {
+      PopWaypoint(actor_id, track_traffic, graph, waypoint_buffer, false);
     }
   }
 
   // Initializing buffer if it is empty.
   if (waypoint_buffer.empty()) {
-    SimpleWaypointPtr closest_waypoint = local_map->GetWaypoint(vehicle_location);
-    PushWaypoint(actor_id, track_traffic, waypoint_buffer, closest_waypoint);
+    NodeIndex closest_waypoint = local_map->GetWaypointIndex(vehicle_location);
+    PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, closest_waypoint);
   }
 
   // Assign a lane change.
@@ -140,27 +138,27 @@ void LocalizationStage::Update(const unsigned long index) {
     }
   }
 
-  const SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
+  const NodeIndex front_waypoint = waypoint_buffer.front();
   const float lane_change_distance = SQUARE(std::max(10.0f * vehicle_speed, INTER_LANE_CHANGE_DISTANCE));
 
   bool recently_not_executed_lane_change = last_lane_change_swpt.find(actor_id) == last_lane_change_swpt.end();
   bool done_with_previous_lane_change = true;
   if (!recently_not_executed_lane_change) {
-    float distance_frm_previous = cg::Math::DistanceSquared(last_lane_change_swpt.at(actor_id)->GetLocation(), vehicle_location);
+    float distance_frm_previous = graph.DistanceSquared(last_lane_change_swpt.at(actor_id), vehicle_location);
     done_with_previous_lane_change = distance_frm_previous > lane_change_distance;
     if (done_with_previous_lane_change) last_lane_change_swpt.erase(actor_id);
   }
   bool auto_or_force_lane_change = parameters.GetAutoLaneChange(actor_id) || force_lane_change;
-  bool front_waypoint_not_junction = !front_waypoint->CheckJunction();
+  bool front_waypoint_not_junction = !graph.CheckJunction(front_waypoint);
 
   if (auto_or_force_lane_change
       && front_waypoint_not_junction
       && (recently_not_executed_lane_change || done_with_previous_lane_change)) {
 
-    SimpleWaypointPtr change_over_point = AssignLaneChange(actor_id, vehicle_location, vehicle_speed,
-                                                           force_lane_change, lane_change_direction);
+    NodeIndex change_over_point = AssignLaneChange(actor_id, vehicle_location, vehicle_speed,
+                                                   force_lane_change, lane_change_direction);
 
-    if (change_over_point != nullptr) {
+    if (change_over_point != INVALID_NODE) {
       if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
         last_lane_change_swpt.at(actor_id) = change_over_point;
       } else {
@@ -168,9 +166,9 @@ void LocalizationStage::Update(const unsigned long index) {
       }
       auto number_of_pops = waypoint_buffer.size();
       for (uint64_t j = 0u; j < number_of_pops; ++j) {
-        PopWaypoint(actor_id, track_traffic, waypoint_buffer);
+        PopWaypoint(actor_id, track_traffic, graph, waypoint_buffer);
       }
-      PushWaypoint(actor_id, track_traffic, waypoint_buffer, change_over_point);
+      PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, change_over_point);
     }
   }
 
@@ -189,9 +187,10 @@ void LocalizationStage::Update(const unsigned long index) {
 
   // Populating the buffer through randomly chosen waypoints.
   else {
-    while (waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
-      SimpleWaypointPtr furthest_waypoint = waypoint_buffer.back();
-      std::vector<SimpleWaypointPtr> next_waypoints = furthest_waypoint->GetNextWaypoint();
+    while (!waypoint_buffer.full()
+           && graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) <= horizon_square) {
+      NodeIndex furthest_waypoint = waypoint_buffer.back();
+      const NodeRange next_waypoints = graph.GetSuccessors(furthest_waypoint);
       uint64_t selection_index = 0u;
       // Pseudo-randomized path selection if found more than one choice.
       if (next_waypoints.size() > 1) {
@@ -204,9 +203,9 @@ void LocalizationStage::Update(const unsigned long index) {
         marked_for_removal.push_back(actor_id);
         break;
       }
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
-      PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
-      if (next_wp_selection->GetId() == waypoint_buffer.front()->GetId()){
+      NodeIndex next_wp_selection = next_waypoints.begin()[selection_index];
+      PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, next_wp_selection);
+      if (graph.GetWaypointId(next_wp_selection) == graph.GetWaypointId(waypoint_buffer.front())){
         // Found a loop, stop. Don't use zero distance as there can be two waypoints at the same location
         break;
       }
@@ -219,24 +218,25 @@ void LocalizationStage::Update(const unsigned long index) {
   output.is_at_junction_entrance = is_at_junction_entrance;
 
   if (is_at_junction_entrance) {
-    const SimpleWaypointPair &safe_space_end_points = vehicles_at_junction_entrance.at(actor_id);
+    const NodePair &safe_space_end_points = vehicles_at_junction_entrance.at(actor_id);
     output.junction_end_point = safe_space_end_points.first;
     output.safe_point = safe_space_end_points.second;
   } else {
-    output.junction_end_point = nullptr;
-    output.safe_point = nullptr;
+    output.junction_end_point = INVALID_NODE;
+    output.safe_point = INVALID_NODE;
   }
 
   // Updating geodesic grid position for actor.
-  track_traffic.UpdateGridPosition(actor_id, waypoint_buffer);
+  track_traffic.UpdateGridPosition(actor_id, waypoint_buffer, graph);
 }
 
 void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
                                                const bool is_at_junction_entrance,
                                                Buffer &waypoint_buffer) {
 
-  SimpleWaypointPtr junction_end_point = nullptr;
-  SimpleWaypointPtr safe_point_after_junction = nullptr;
+  const WaypointGraph &graph = local_map->GetGraph();
+  NodeIndex junction_end_point = INVALID_NODE;
+  NodeIndex safe_point_after_junction = INVALID_NODE;
 
   if (is_at_junction_entrance
       && vehicles_at_junction_entrance.find(actor_id) == vehicles_at_junction_entrance.end()) {
@@ -244,22 +244,22 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
     bool entered_junction = false;
     bool past_junction = false;
     bool safe_point_found = false;
-    SimpleWaypointPtr current_waypoint = nullptr;
-    SimpleWaypointPtr junction_begin_point = nullptr;
+    NodeIndex current_waypoint = INVALID_NODE;
+    NodeIndex junction_begin_point = INVALID_NODE;
     float safe_distance_squared = SQUARE(SAFE_DISTANCE_AFTER_JUNCTION);
 
     // Scanning existing buffer points.
     for (unsigned long i = 0u; i < waypoint_buffer.size() && !safe_point_found; ++i) {
       current_waypoint = waypoint_buffer.at(i);
-      if (!entered_junction && current_waypoint->CheckJunction()) {
+      if (!entered_junction && graph.CheckJunction(current_waypoint)) {
         entered_junction = true;
         junction_begin_point = current_waypoint;
       }
-      if (entered_junction && !past_junction && !current_waypoint->CheckJunction()) {
+      if (entered_junction && !past_junction && !graph.CheckJunction(current_waypoint)) {
         past_junction = true;
         junction_end_point = current_waypoint;
       }
-      if (past_junction && junction_end_point->DistanceSquared(current_waypoint) > safe_distance_squared) {
+      if (past_junction && graph.DistanceSquared(junction_end_point, current_waypoint) > safe_distance_squared) {
         safe_point_found = true;
         safe_point_after_junction = current_waypoint;
       }
@@ -270,11 +270,11 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       bool abort = false;
 
       while (!past_junction && !abort) {
-        NodeList next_waypoints = current_waypoint->GetNextWaypoint();
-        if (!next_waypoints.empty()) {
-          current_waypoint = next_waypoints.front();
-          PushWaypoint(actor_id, track_traffic, waypoint_buffer, current_waypoint);
-          if (!current_waypoint->CheckJunction()) {
+        const NodeRange next_waypoints = graph.GetSuccessors(current_waypoint);
+        if (!next_waypoints.empty() && !waypoint_buffer.full()) {
+          current_waypoint = *next_waypoints.begin();
+          PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, current_waypoint);
+          if (!graph.CheckJunction(current_waypoint)) {
             past_junction = true;
             junction_end_point = current_waypoint;
           }
@@ -284,17 +284,17 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       }
 
       while (!safe_point_found && !abort) {
-        std::vector<SimpleWaypointPtr> next_waypoints = current_waypoint->GetNextWaypoint();
-        if ((junction_end_point->DistanceSquared(current_waypoint) > safe_distance_squared)
+        const NodeRange next_waypoints = graph.GetSuccessors(current_waypoint);
+        if ((graph.DistanceSquared(junction_end_point, current_waypoint) > safe_distance_squared)
             || next_waypoints.size() > 1
-            || current_waypoint->CheckJunction()) {
+            || graph.CheckJunction(current_waypoint)) {
 
           safe_point_found = true;
           safe_point_after_junction = current_waypoint;
         } else {
-          if (!next_waypoints.empty()) {
-            current_waypoint = next_waypoints.front();
-            PushWaypoint(actor_id, track_traffic, waypoint_buffer, current_waypoint);
+          if (!next_waypoints.empty() && !waypoint_buffer.full()) {
+            current_waypoint = *next_waypoints.begin();
+            PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, current_waypoint);
           } else {
             abort = true;
           }
@@ -302,12 +302,12 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       }
     }
 
-    if (junction_end_point != nullptr &&
-        safe_point_after_junction != nullptr &&
-        junction_begin_point->DistanceSquared(junction_end_point) < SQUARE(MIN_JUNCTION_LENGTH)) {
+    if (junction_end_point != INVALID_NODE &&
+        safe_point_after_junction != INVALID_NODE &&
+        graph.DistanceSquared(junction_begin_point, junction_end_point) < SQUARE(MIN_JUNCTION_LENGTH)) {
 
-      junction_end_point = nullptr;
-      safe_point_after_junction = nullptr;
+      junction_end_point = INVALID_NODE;
+      safe_point_after_junction = INVALID_NODE;
     }
 
     vehicles_at_junction_entrance.insert({actor_id, {junction_end_point, safe_point_after_junction}});
@@ -329,24 +329,26 @@ void LocalizationStage::Reset() {
   vehicles_at_junction.clear();
 }
 
-SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
-                                                      const cg::Location vehicle_location,
-                                                      const float vehicle_speed,
-                                                      bool force, bool direction) {
+NodeIndex LocalizationStage::AssignLaneChange(const ActorId actor_id,
+                                             const cg::Location vehicle_location,
+                                             const float vehicle_speed,
+                                             bool force, bool direction) {
+
+  const WaypointGraph &graph = local_map->GetGraph();
 
   // Waypoint representing the new starting point for the waypoint buffer
-  // due to lane change. Remains nullptr if lane change not viable.
-  SimpleWaypointPtr change_over_point = nullptr;
+  // due to lane change. Remains INVALID_NODE if lane change not viable.
+  NodeIndex change_over_point = INVALID_NODE;
 
   // Retrieve waypoint buffer for current vehicle.
-  const Buffer &waypoint_buffer = buffer_map.at(actor_id);
+  const Buffer &waypoint_buffer = buffer_map.Get(actor_id);
 
   // Check buffer is not empty.
   if (!waypoint_buffer.empty()) {
     // Get the left and right waypoints for the current closest waypoint.
-    const SimpleWaypointPtr &current_waypoint = waypoint_buffer.front();
-    const SimpleWaypointPtr left_waypoint = current_waypoint->GetLeftWaypoint();
-    const SimpleWaypointPtr right_waypoint = current_waypoint->GetRightWaypoint();
+    const NodeIndex current_waypoint = waypoint_buffer.front();
+    const NodeIndex left_waypoint = graph.GetLeftNode(current_waypoint);
+    const NodeIndex right_waypoint = graph.GetRightNode(current_waypoint);
 
     // Retrieve vehicles with overlapping waypoint buffers with current vehicle.
     const auto blocking_vehicles = track_traffic.GetOverlappingVehicles(actor_id);
@@ -360,24 +362,22 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
          ++i) {
       const ActorId &other_actor_id = *i;
       // Find vehicle in buffer map and check if it's buffer is not empty.
-      if (buffer_map.find(other_actor_id) != buffer_map.end() && !buffer_map.at(other_actor_id).empty()) {
-        const Buffer &other_buffer = buffer_map.at(other_actor_id);
-        const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
-        const cg::Location other_location = other_current_waypoint->GetLocation();
+      const Buffer *other_buffer = buffer_map.Find(other_actor_id);
+      if (other_buffer != nullptr && !other_buffer->empty()) {
+        const NodeIndex other_current_waypoint = other_buffer->front();
+        const cg::Location other_location = graph.GetLocation(other_current_waypoint);
 
-        const cg::Vector3D reference_heading = current_waypoint->GetForwardVector();
-        cg::Vector3D reference_to_other = other_location - current_waypoint->GetLocation();
-        const cg::Vector3D other_heading = other_current_waypoint->GetForwardVector();
+        const cg::Vector3D reference_heading = graph.GetForwardVector(current_waypoint);
+        cg::Vector3D reference_to_other = other_location - graph.GetLocation(current_waypoint);
+        const cg::Vector3D other_heading = graph.GetForwardVector(other_current_waypoint);
 
-        WaypointPtr current_raw_waypoint = current_waypoint->GetWaypoint();
-        WaypointPtr other_current_raw_waypoint = other_current_waypoint->GetWaypoint();
         // Check both vehicles are not in junction,
         // Check if the other vehicle is in front of the current vehicle,
         // Check if the two vehicles have acceptable angular deviation between their headings.
-        if (!current_waypoint->CheckJunction()
-            && !other_current_waypoint->CheckJunction()
-            && other_current_raw_waypoint->GetRoadId() == current_raw_waypoint->GetRoadId()
-            && other_current_raw_waypoint->GetLaneId() == current_raw_waypoint->GetLaneId()
+        if (!graph.CheckJunction(current_waypoint)
+            && !graph.CheckJunction(other_current_waypoint)
+            && graph.GetRoadId(other_current_waypoint) == graph.GetRoadId(current_waypoint)
+            && graph.GetLaneId(other_current_waypoint) == graph.GetLaneId(current_waypoint)
             && cg::Math::Dot(reference_heading, reference_to_other) > 0.0f
             && cg::Math::Dot(reference_heading, other_heading) > MAXIMUM_LANE_OBSTACLE_CURVATURE) {
           float squared_distance = cg::Math::DistanceSquared(vehicle_location, other_location);
@@ -397,10 +397,10 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 
     // If a valid immediate obstacle found.
     if (!obstacle_too_close && obstacle_actor_id != 0u && !force) {
-      const Buffer &other_buffer = buffer_map.at(obstacle_actor_id);
-      const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
-      const auto other_neighbouring_lanes = {other_current_waypoint->GetLeftWaypoint(),
-                                             other_current_waypoint->GetRightWaypoint()};
+      const Buffer &other_buffer = buffer_map.Get(obstacle_actor_id);
+      const NodeIndex other_current_waypoint = other_buffer.front();
+      const auto other_neighbouring_lanes = {graph.GetLeftNode(other_current_waypoint),
+                                             graph.GetRightNode(other_current_waypoint)};
 
       // Flags reflecting whether adjacent lanes are free near the obstacle.
       bool distant_left_lane_free = false;
@@ -408,9 +408,9 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 
       // Check if the neighbouring lanes near the obstructing vehicle are free of other vehicles.
       bool left_right = true;
-      for (auto &candidate_lane_wp : other_neighbouring_lanes) {
-        if (candidate_lane_wp != nullptr &&
-            track_traffic.GetPassingVehicles(candidate_lane_wp->GetId()).size() == 0) {
+      for (const NodeIndex candidate_lane_wp : other_neighbouring_lanes) {
+        if (candidate_lane_wp != INVALID_NODE &&
+            track_traffic.GetPassingVehicles(graph.GetWaypointId(candidate_lane_wp)).size() == 0) {
 
           if (left_right)
             distant_left_lane_free = true;
@@ -422,27 +422,27 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 
       // Based on what lanes are free near the obstacle,
       // find the change over point with no vehicles passing through them.
-      if (distant_right_lane_free && right_waypoint != nullptr
-          && track_traffic.GetPassingVehicles(right_waypoint->GetId()).size() == 0) {
+      if (distant_right_lane_free && right_waypoint != INVALID_NODE
+          && track_traffic.GetPassingVehicles(graph.GetWaypointId(right_waypoint)).size() == 0) {
         change_over_point = right_waypoint;
-      } else if (distant_left_lane_free && left_waypoint != nullptr
-               && track_traffic.GetPassingVehicles(left_waypoint->GetId()).size() == 0) {
+      } else if (distant_left_lane_free && left_waypoint != INVALID_NODE
+               && track_traffic.GetPassingVehicles(graph.GetWaypointId(left_waypoint)).size() == 0) {
         change_over_point = left_waypoint;
       }
     } else if (force) {
-      if (direction && right_waypoint != nullptr) {
+      if (direction && right_waypoint != INVALID_NODE) {
         change_over_point = right_waypoint;
-      } else if (!direction && left_waypoint != nullptr) {
+      } else if (!direction && left_waypoint != INVALID_NODE) {
         change_over_point = left_waypoint;
       }
     }
 
-    if (change_over_point != nullptr) {
+    if (change_over_point != INVALID_NODE) {
       const float change_over_distance = cg::Math::Clamp(1.5f * vehicle_speed, MIN_WPT_DISTANCE, MAX_WPT_DISTANCE);
-      const SimpleWaypointPtr starting_point = change_over_point;
-      while (change_over_point->DistanceSquared(starting_point) < SQUARE(change_over_distance) &&
-             !change_over_point->CheckJunction()) {
-        change_over_point = change_over_point->GetNextWaypoint().front();
+      const NodeIndex starting_point = change_over_point;
+      while (graph.DistanceSquared(change_over_point, starting_point) < SQUARE(change_over_distance) &&
+             !graph.CheckJunction(change_over_point)) {
+        change_over_point = *graph.GetSuccessors(change_over_point).begin();
       }
     }
   }
@@ -451,11 +451,13 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 }
 
 void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer, const ActorId actor_id, const float horizon_square) {
+    const WaypointGraph &graph = local_map->GetGraph();
+
     // Remove the waypoints already added to the path, except for the first.
     if (parameters.GetUploadPath(actor_id)) {
       auto number_of_pops = waypoint_buffer.size();
       for (uint64_t j = 0u; j < number_of_pops - 1; ++j) {
-        PopWaypoint(actor_id, track_traffic, waypoint_buffer, false);
+        PopWaypoint(actor_id, track_traffic, graph, waypoint_buffer, false);
       }
       // We have successfully imported the path. Remove it from the list of paths to be imported.
       parameters.RemoveUploadPath(actor_id, false);
@@ -463,38 +465,38 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
 
     // Get the latest imported waypoint. and find its closest waypoint in TM's InMemoryMap.
     cg::Location latest_imported = imported_path.front();
-    SimpleWaypointPtr imported = local_map->GetWaypoint(latest_imported);
+    NodeIndex imported = local_map->GetWaypointIndex(latest_imported);
 
     // We need to generate a path compatible with TM's waypoints.
-    while (!imported_path.empty() && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
+    while (!imported_path.empty() && !waypoint_buffer.full() && graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) <= horizon_square) {
       // Get the latest point we added to the list. If starting, this will be the one referred to the vehicle's location.
-      SimpleWaypointPtr latest_waypoint = waypoint_buffer.back();
+      NodeIndex latest_waypoint = waypoint_buffer.back();
 
       // Try to link the latest_waypoint to the imported waypoint.
-      std::vector<SimpleWaypointPtr> next_waypoints = latest_waypoint->GetNextWaypoint();
+      const NodeRange next_waypoints = graph.GetSuccessors(latest_waypoint);
       uint64_t selection_index = 0u;
 
       // Choose correct path.
       if (next_waypoints.size() > 1) {
-        const float imported_road_id = imported->GetWaypoint()->GetRoadId();
+        const float imported_road_id = graph.GetRoadId(imported);
         float min_distance = std::numeric_limits<float>::infinity();
         for (uint64_t k = 0u; k < next_waypoints.size(); ++k) {
-          SimpleWaypointPtr junction_end_point = next_waypoints.at(k);
-          while (!junction_end_point->CheckJunction()) {
-            junction_end_point = junction_end_point->GetNextWaypoint().front();
+          NodeIndex junction_end_point = next_waypoints.begin()[k];
+          while (!graph.CheckJunction(junction_end_point)) {
+            junction_end_point = *graph.GetSuccessors(junction_end_point).begin();
           }
-          while (junction_end_point->CheckJunction()) {
-            junction_end_point = junction_end_point->GetNextWaypoint().front();
+          while (graph.CheckJunction(junction_end_point)) {
+            junction_end_point = *graph.GetSuccessors(junction_end_point).begin();
           }
-          while (next_waypoints.at(k)->DistanceSquared(junction_end_point) < 50.0f) {
-            junction_end_point = junction_end_point->GetNextWaypoint().front();
+          while (graph.DistanceSquared(next_waypoints.begin()[k], junction_end_point) < 50.0f) {
+            junction_end_point = *graph.GetSuccessors(junction_end_point).begin();
           }
-          float jep_road_id = junction_end_point->GetWaypoint()->GetRoadId();
+          float jep_road_id = graph.GetRoadId(junction_end_point);
           if (jep_road_id == imported_road_id) {
             selection_index = k;
             break;
           }
-          float distance = junction_end_point->DistanceSquared(imported);
+          float distance = graph.DistanceSquared(junction_end_point, imported);
           if (distance < min_distance) {
             min_distance = distance;
             selection_index = k;
@@ -507,21 +509,21 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
         marked_for_removal.push_back(actor_id);
         break;
       }
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
+      NodeIndex next_wp_selection = next_waypoints.begin()[selection_index];
 
       // Remove the imported waypoint from the path if it's close to the last one.
-      if (next_wp_selection->DistanceSquared(imported) < 30.0f) {
+      if (graph.DistanceSquared(next_wp_selection, imported) < 30.0f) {
         imported_path.erase(imported_path.begin());
-        std::vector<SimpleWaypointPtr> possible_waypoints = next_wp_selection->GetNextWaypoint();
+        const NodeRange possible_waypoints = graph.GetSuccessors(next_wp_selection);
         if (std::find(possible_waypoints.begin(), possible_waypoints.end(), imported) != possible_waypoints.end()) {
           // If the lane is changing, only push the new waypoint
-          PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
+          PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, next_wp_selection);
         }
-        PushWaypoint(actor_id, track_traffic, waypoint_buffer, imported);
+        PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, imported);
         latest_imported = imported_path.front();
-        imported = local_map->GetWaypoint(latest_imported);
+        imported = local_map->GetWaypointIndex(latest_imported);
       } else {
-        PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
+        PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, next_wp_selection);
       }
     }
     if (imported_path.empty()) {
@@ -534,27 +536,28 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
 }
 
 void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_buffer, const ActorId actor_id, const float horizon_square) {
+    const WaypointGraph &graph = local_map->GetGraph();
 
     if (parameters.GetUploadRoute(actor_id)) {
       auto number_of_pops = waypoint_buffer.size();
       for (uint64_t j = 0u; j < number_of_pops - 1; ++j) {
-        PopWaypoint(actor_id, track_traffic, waypoint_buffer, false);
+        PopWaypoint(actor_id, track_traffic, graph, waypoint_buffer, false);
       }
       // We have successfully imported the route. Remove it from the list of routes to be imported.
       parameters.RemoveImportedRoute(actor_id, false);
     }
 
     RoadOption next_road_option = static_cast<RoadOption>(imported_actions.front());
-    while (!imported_actions.empty() && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
+    while (!imported_actions.empty() && !waypoint_buffer.full() && graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) <= horizon_square) {
       // Get the latest point we added to the list. If starting, this will be the one referred to the vehicle's location.
-      SimpleWaypointPtr latest_waypoint = waypoint_buffer.back();
-      RoadOption latest_road_option = latest_waypoint->GetRoadOption();
+      NodeIndex latest_waypoint = waypoint_buffer.back();
+      RoadOption latest_road_option = graph.GetRoadOption(latest_waypoint);
       // Try to link the latest_waypoint to the correct next RouteOption.
-      std::vector<SimpleWaypointPtr> next_waypoints = latest_waypoint->GetNextWaypoint();
+      const NodeRange next_waypoints = graph.GetSuccessors(latest_waypoint);
       uint16_t selection_index = 0u;
       if (next_waypoints.size() > 1) {
         for (uint16_t i=0; i<next_waypoints.size(); ++i) {
-          if (next_waypoints.at(i)->GetRoadOption() == next_road_option) {
+          if (graph.GetRoadOption(next_waypoints.begin()[i]) == next_road_option) {
             selection_index = i;
             break;
           } else {
@@ -571,11 +574,11 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
         break;
       }
 
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
-      PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
+      NodeIndex next_wp_selection = next_waypoints.begin()[selection_index];
+      PushWaypoint(actor_id, track_traffic, graph, waypoint_buffer, next_wp_selection);
 
       // If we are switching to a new RoadOption, it means the current one is already fully imported.
-      if (latest_road_option != next_wp_selection->GetRoadOption() && next_road_option == next_wp_selection->GetRoadOption()) {
+      if (latest_road_option != graph.GetRoadOption(next_wp_selection) && next_road_option == graph.GetRoadOption(next_wp_selection)) {
         imported_actions.erase(imported_actions.begin());
         next_road_option = static_cast<RoadOption>(imported_actions.front());
       }
@@ -590,32 +593,34 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
 }
 
 Action LocalizationStage::ComputeNextAction(const ActorId& actor_id) {
-  auto waypoint_buffer = buffer_map.at(actor_id);
-  auto next_action = std::make_pair(RoadOption::LaneFollow, waypoint_buffer.back()->GetWaypoint());
+  const WaypointGraph &graph = local_map->GetGraph();
+  const Buffer &waypoint_buffer = buffer_map.Get(actor_id);
+  auto next_action = std::make_pair(RoadOption::LaneFollow, local_map->GetNode(waypoint_buffer.back())->GetWaypoint());
   bool is_lane_change = false;
   if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
     // A lane change is happening.
     is_lane_change = true;
     const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - last_lane_change_swpt.at(actor_id)->GetLocation();
+    const NodeIndex lane_change_node = last_lane_change_swpt.at(actor_id);
+    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - graph.GetLocation(lane_change_node);
     bool left_heading = (heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f;
-    if (left_heading) next_action = std::make_pair(RoadOption::ChangeLaneLeft, last_lane_change_swpt.at(actor_id)->GetWaypoint());
-    else next_action = std::make_pair(RoadOption::ChangeLaneRight, last_lane_change_swpt.at(actor_id)->GetWaypoint());
+    if (left_heading) next_action = std::make_pair(RoadOption::ChangeLaneLeft, local_map->GetNode(lane_change_node)->GetWaypoint());
+    else next_action = std::make_pair(RoadOption::ChangeLaneRight, local_map->GetNode(lane_change_node)->GetWaypoint());
   }
-  for (auto &swpt : waypoint_buffer) {
-    RoadOption road_opt = swpt->GetRoadOption();
+  for (const NodeIndex node : waypoint_buffer) {
+    RoadOption road_opt = graph.GetRoadOption(node);
     if (road_opt != RoadOption::LaneFollow) {
       if (!is_lane_change) {
         // No lane change in sight, we can assume this will be the next action.
-        return std::make_pair(road_opt, swpt->GetWaypoint());
+        return std::make_pair(road_opt, local_map->GetNode(node)->GetWaypoint());
       } else {
         // A lane change will happen as well as another action, we need to figure out which one will happen first.
-        cg::Location lane_change = last_lane_change_swpt.at(actor_id)->GetLocation();
+        cg::Location lane_change = graph.GetLocation(last_lane_change_swpt.at(actor_id));
         cg::Location actual_location = simulation_state.GetLocation(actor_id);
         auto distance_lane_change = cg::Math::DistanceSquared(actual_location, lane_change);
-        auto distance_other_action = cg::Math::DistanceSquared(actual_location, swpt->GetLocation());
+        auto distance_other_action = cg::Math::DistanceSquared(actual_location, graph.GetLocation(node));
         if (distance_lane_change < distance_other_action) return next_action;
-        else return std::make_pair(road_opt, swpt->GetWaypoint());
+        else return std::make_pair(road_opt, local_map->GetNode(node)->GetWaypoint());
       }
     }
   }
@@ -624,34 +629,36 @@ Action LocalizationStage::ComputeNextAction(const ActorId& actor_id) {
 
 ActionBuffer LocalizationStage::ComputeActionBuffer(const ActorId& actor_id) {
 
-  auto waypoint_buffer = buffer_map.at(actor_id);
+  const WaypointGraph &graph = local_map->GetGraph();
+  const Buffer &waypoint_buffer = buffer_map.Get(actor_id);
   ActionBuffer action_buffer;
   Action lane_change;
   bool is_lane_change = false;
-  SimpleWaypointPtr buffer_front = waypoint_buffer.front();
-  RoadOption last_road_opt = buffer_front->GetRoadOption();
-  action_buffer.push_back(std::make_pair(last_road_opt, buffer_front->GetWaypoint()));
+  NodeIndex buffer_front = waypoint_buffer.front();
+  RoadOption last_road_opt = graph.GetRoadOption(buffer_front);
+  action_buffer.push_back(std::make_pair(last_road_opt, local_map->GetNode(buffer_front)->GetWaypoint()));
   if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
     // A lane change is happening.
     is_lane_change = true;
     const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - last_lane_change_swpt.at(actor_id)->GetLocation();
+    const NodeIndex lane_change_node = last_lane_change_swpt.at(actor_id);
+    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - graph.GetLocation(lane_change_node);
     bool left_heading = (heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f;
-    if (left_heading) lane_change = std::make_pair(RoadOption::ChangeLaneLeft, last_lane_change_swpt.at(actor_id)->GetWaypoint());
-    else lane_change = std::make_pair(RoadOption::ChangeLaneRight, last_lane_change_swpt.at(actor_id)->GetWaypoint());
+    if (left_heading) lane_change = std::make_pair(RoadOption::ChangeLaneLeft, local_map->GetNode(lane_change_node)->GetWaypoint());
+    else lane_change = std::make_pair(RoadOption::ChangeLaneRight, local_map->GetNode(lane_change_node)->GetWaypoint());
   }
-  for (auto &wpt : waypoint_buffer) {
-    RoadOption current_road_opt = wpt->GetRoadOption();
+  for (const NodeIndex node : waypoint_buffer) {
+    RoadOption current_road_opt = graph.GetRoadOption(node);
     if (current_road_opt != last_road_opt) {
-      action_buffer.push_back(std::make_pair(current_road_opt, wpt->GetWaypoint()));
+      action_buffer.push_back(std::make_pair(current_road_opt, local_map->GetNode(node)->GetWaypoint()));
       last_road_opt = current_road_opt;
     }
   }
   if (is_lane_change) {
     // Insert the lane change action in the appropriate part of the action buffer.
-    auto distance_lane_change = cg::Math::DistanceSquared(waypoint_buffer.front()->GetLocation(), lane_change.second->GetTransform().location);
+    auto distance_lane_change = cg::Math::DistanceSquared(graph.GetLocation(waypoint_buffer.front()), lane_change.second->GetTransform().location);
     for (uint16_t i = 0; i < action_buffer.size(); ++i) {
-      auto distance_action = cg::Math::DistanceSquared(waypoint_buffer.front()->GetLocation(), waypoint_buffer.at(i)->GetLocation());
+      auto distance_action = graph.DistanceSquared(waypoint_buffer.front(), waypoint_buffer.at(i));
       // If the waypoint related to the next action is further away from the one of the lane change, insert lane change action here.
       // If we reached the end of the buffer, place the action at the end.
       if (i == action_buffer.size()-1) {
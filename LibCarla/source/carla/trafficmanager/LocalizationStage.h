@@ -18,7 +18,7 @@ namespace traffic_manager {
 namespace cc = carla::client;
 
 using LocalMapPtr = std::shared_ptr<InMemoryMap>;
-using LaneChangeSWptMap = std::unordered_map<ActorId, SimpleWaypointPtr>;
+using LaneChangeSWptMap = std::unordered_map<ActorId, NodeIndex>;
 using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
 using Action = std::pair<RoadOption, WaypointPtr>;
 using ActionBuffer = std::vector<Action>;
@@ -42,14 +42,14 @@ private:
   LocalizationFrame &output_array;
   LaneChangeSWptMap last_lane_change_swpt;
   ActorIdSet vehicles_at_junction;
-  using SimpleWaypointPair = std::pair<SimpleWaypointPtr, SimpleWaypointPtr>;
-  std::unordered_map<ActorId, SimpleWaypointPair> vehicles_at_junction_entrance;
+  using NodePair = std::pair<NodeIndex, NodeIndex>;
+  std::unordered_map<ActorId, NodePair> vehicles_at_junction_entrance;
   RandomGenerator &random_device;
 
-  SimpleWaypointPtr AssignLaneChange(const ActorId actor_id,
-                                     const cg::Location vehicle_location,
-                                     const float vehicle_speed,
-                                     bool force, bool direction);
+  NodeIndex AssignLaneChange(const ActorId actor_id,
+                             const cg::Location vehicle_location,
+                             const float vehicle_speed,
+                             bool force, bool direction);
 
   void ExtendAndFindSafeSpace(const ActorId actor_id,
                               const bool is_at_junction_entrance,
@@ -82,6 +82,9 @@ public:
 
   void Reset() override;
 
+  // The following are called from the client thread. The caller must hold the
+  // lock under which the TM thread acquires and removes the path buffers.
+
   Action ComputeNextAction(const ActorId &actor_id);
 
   ActionBuffer ComputeActionBuffer(const ActorId& actor_id);
@@ -27,7 +27,6 @@ namespace traffic_manager {
   using ActorId = carla::ActorId;
   using ActorIdSet = std::unordered_set<ActorId>;
   using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-  using Buffer = std::deque<SimpleWaypointPtr>;
   using GeoGridId = carla::road::JuncId;
   using constants::Map::MAP_RESOLUTION;
   using constants::Map::INV_MAP_RESOLUTION;
@@ -45,16 +44,18 @@ namespace traffic_manager {
                             const cg::Location &target_location);
 
   // Function to add a waypoint to a path buffer and update waypoint tracking.
-  void PushWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
-                    Buffer& buffer, SimpleWaypointPtr& waypoint);
+  // Does nothing if the buffer is full.
+  void PushWaypoint(ActorId actor_id, TrackTraffic& track_traffic, const WaypointGraph& graph,
+                    Buffer& buffer, NodeIndex node);
 
   // Function to remove a waypoint from a path buffer and update waypoint tracking.
-  void PopWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
+  void PopWaypoint(ActorId actor_id, TrackTraffic& track_traffic, const WaypointGraph& graph,
                    Buffer& buffer, bool front_or_back=true);
 
   /// Method to return the wayPoints from the waypoint Buffer by using target point distance
-  using TargetWPInfo = std::pair<SimpleWaypointPtr,uint64_t>;
-  TargetWPInfo GetTargetWaypoint(const Buffer& waypoint_buffer, const float& target_point_distance);
+  using TargetWPInfo = std::pair<NodeIndex,uint64_t>;
+  TargetWPInfo GetTargetWaypoint(const WaypointGraph& graph, const Buffer& waypoint_buffer,
+                                 const float& target_point_distance);
 
 } // namespace traffic_manager
 } // namespace carla
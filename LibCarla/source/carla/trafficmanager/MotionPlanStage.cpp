@@ -4,6 +4,7 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <algorithm>
 #include <limits>
 
 #include "carla/client/TrafficSign.h"
@@ -62,18 +63,20 @@ MotionPlanStage::MotionPlanStage(
 
 void MotionPlanStage::Update(const unsigned long index) {
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id);
-  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);
+  const ActorSlot actor_slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocation(actor_slot);
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_slot);
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_slot);
   const float vehicle_speed = vehicle_velocity.Length();
-  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);
-  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id);
-  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);
-  const Buffer &waypoint_buffer = buffer_map.at(actor_id);
+  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_slot);
+  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_slot);
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_slot);
+  const WaypointGraph &graph = local_map->GetGraph();
+  const Buffer &waypoint_buffer = buffer_map.Get(actor_id);
   const LocalizationData &localization = localization_frame.at(index);
   const CollisionHazardData &collision_hazard = collision_frame.at(index);
   const bool &tl_hazard = tl_frame.at(index);
-  current_timestamp = world.GetSnapshot().GetTimestamp();
+  const cc::Timestamp current_timestamp = world.GetSnapshot().GetTimestamp();
   StateEntry current_state;
 
   // Instanciating teleportation transform as current vehicle transform.
@@ -83,49 +86,14 @@ void MotionPlanStage::Update(const unsigned long index) {
   cg::Location hero_location = track_traffic.GetHeroLocation();
   bool is_hero_alive = hero_location != cg::Location(0, 0, 0);
 
-  if (simulation_state.IsDormant(actor_id) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
-    // Flushing controller state for vehicle.
-    current_state = {current_timestamp,
-                    0.0f, 0.0f,
-                    0.0f};
-
-    // Add entry to teleportation duration clock table if not present.
-    if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-      teleportation_instance.insert({actor_id, current_timestamp});
-    }
-
-    // Get lower and upper bound for teleporting vehicle.
-    float lower_bound = parameters.GetLowerBoundaryRespawnDormantVehicles();
-    float upper_bound = parameters.GetUpperBoundaryRespawnDormantVehicles();
-    float dilate_factor = (upper_bound-lower_bound)/100.0f;
-
-    // Measuring time elapsed since last teleportation for the vehicle.
-    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
-
-    if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
-      float random_sample = (static_cast<float>(random_device.next())*dilate_factor) + lower_bound;
-      NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
-      if (!teleport_waypoint_list.empty()) {
-        for (auto &teleport_waypoint : teleport_waypoint_list) {
-          GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
-          if (track_traffic.IsGeoGridFree(geogrid_id)) {
-            teleportation_transform = teleport_waypoint->GetTransform();
-            teleportation_transform.location.z += 0.5f;
-            track_traffic.AddTakenGrid(geogrid_id, actor_id);
-            break;
-          }
-        }
-      }
+  if (simulation_state.IsDormant(actor_slot) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
+    if (defer_dormant_respawns) {
+      // Respawned by RespawnDormantVehicles once all vehicles are updated.
+      std::lock_guard<std::mutex> lock(dormant_respawn_mutex);
+      dormant_respawn_indices.push_back(index);
+    } else {
+      RespawnDormantVehicle(index, current_timestamp);
     }
-    output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
-
-    // Update the simulation state with the new transform of the vehicle after teleporting it.
-    KinematicState kinematic_state{teleportation_transform.location,
-                                   teleportation_transform.rotation,
-                                   vehicle_velocity, vehicle_speed_limit,
-                                   vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
-                                   teleportation_transform.location};
-    simulation_state.UpdateKinematicState(actor_id, kinematic_state);
   }
 
   else {
@@ -134,7 +102,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     float max_target_velocity = parameters.GetVehicleTargetVelocity(actor_id, vehicle_speed_limit) / 3.6f;
 
     // Algorithm to reduce speed near landmarks
-    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*(waypoint_buffer.at(0)), vehicle_location, actor_id, max_target_velocity);
+    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*local_map->GetNode(waypoint_buffer.at(0)), vehicle_location, actor_id, max_target_velocity);
 
     // Algorithm to reduce speed near turns
     float max_turn_target_velocity = GetTurnTargetVelocity(waypoint_buffer, max_target_velocity);
@@ -152,16 +120,16 @@ void MotionPlanStage::Update(const unsigned long index) {
     // In case of collision or traffic light hazard.
     bool emergency_stop = tl_hazard || collision_emergency_stop || !safe_after_junction;
 
-    if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_id)) {
+    if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_slot)) {
       ActuationSignal actuation_signal{0.0f, 0.0f, 0.0f};
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
                                                   MIN_TARGET_WAYPOINT_DISTANCE);
-      const SimpleWaypointPtr &target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;
-      cg::Location target_location = target_waypoint->GetLocation();
+      const NodeIndex target_waypoint = GetTargetWaypoint(graph, waypoint_buffer, target_point_distance).first;
+      cg::Location target_location = graph.GetLocation(target_waypoint);
 
       float offset = parameters.GetLaneOffset(actor_id);
-      auto right_vector = target_waypoint->GetTransform().GetRightVector();
+      const cg::Vector3D &right_vector = graph.GetRightVector(target_waypoint);
       auto offset_location = cg::Location(cg::Vector3D(offset*right_vector.x, offset*right_vector.y, 0.0f));
       target_location = target_location + offset_location;
 
@@ -173,15 +141,11 @@ void MotionPlanStage::Update(const unsigned long index) {
       }
       const float angular_deviation = dot_product;
       const float velocity_deviation = (dynamic_target_velocity - vehicle_speed) / dynamic_target_velocity;
-      // If previous state for vehicle not found, initialize state entry.
-      if (pid_state_map.find(actor_id) == pid_state_map.end()) {
-        const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
-        pid_state_map.insert({actor_id, initial_state});
-      }
-
-      // Retrieving the previous state.
+      // Retrieving the previous state, initializing the entry if not found.
+      StateEntry &state = GetOrInsertEntry(pid_state_map, actor_id,
+                                           StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f});
       traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_map.at(actor_id);
+      previous_state = state;
 
       // Select PID parameters.
       std::vector<float> longitudinal_parameters;
@@ -218,7 +182,6 @@ void MotionPlanStage::Update(const unsigned long index) {
 
       // Updating PID state.
       current_state.steer = actuation_signal.steer;
-      StateEntry &state = pid_state_map.at(actor_id);
       state = current_state;
     }
     // For physics-less vehicles, determine position and orientation for teleportation.
@@ -229,20 +192,18 @@ void MotionPlanStage::Update(const unsigned long index) {
                       0.0f};
 
       // Add entry to teleportation duration clock table if not present.
-      if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-        teleportation_instance.insert({actor_id, current_timestamp});
-      }
+      const cc::Timestamp &last_teleportation = GetOrInsertEntry(teleportation_instance, actor_id, current_timestamp);
 
       // Measuring time elapsed since last teleportation for the vehicle.
-      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+      double elapsed_time = current_timestamp.elapsed_seconds - last_teleportation.elapsed_seconds;
 
       // Find a location ahead of the vehicle for teleportation to achieve intended velocity.
       if (!emergency_stop && (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT)) {
 
         // Target displacement magnitude to achieve target velocity.
         const float target_displacement = dynamic_target_velocity * HYBRID_MODE_DT_FL;
-        SimpleWaypointPtr teleport_target = waypoint_buffer.front();
-        cg::Transform target_base_transform = teleport_target->GetTransform();
+        NodeIndex teleport_target = waypoint_buffer.front();
+        cg::Transform target_base_transform = graph.GetTransform(teleport_target);
         cg::Location target_base_location = target_base_transform.location;
         cg::Vector3D target_heading = target_base_transform.GetForwardVector();
         cg::Vector3D correct_heading = (target_base_location - vehicle_location).MakeSafeUnitVector(EPSILON);
@@ -258,31 +219,108 @@ void MotionPlanStage::Update(const unsigned long index) {
       // In case of an emergency stop, stay in the same location.
       // Also, teleport only once every dt in asynchronous mode.
       } else {
-        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_id));
+        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_slot));
       }
       // Constructing the actuation signal.
       output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
-      simulation_state.UpdateKinematicHybridEndLocation(actor_id, teleportation_transform.location);
+      simulation_state.UpdateKinematicHybridEndLocation(actor_slot, teleportation_transform.location);
+    }
+  }
+}
+
+template <typename T>
+T &MotionPlanStage::GetOrInsertEntry(std::unordered_map<ActorId, T> &map,
+                                     const ActorId actor_id,
+                                     const T &initial_value) {
+  std::lock_guard<std::mutex> lock(state_map_mutex);
+  return map.insert({actor_id, initial_value}).first->second;
+}
+
+void MotionPlanStage::SetDeferDormantRespawns(const bool defer) {
+  defer_dormant_respawns = defer;
+}
+
+void MotionPlanStage::RespawnDormantVehicles() {
+  if (dormant_respawn_indices.empty()) {
+    return;
+  }
+  const cc::Timestamp current_timestamp = world.GetSnapshot().GetTimestamp();
+  std::sort(dormant_respawn_indices.begin(), dormant_respawn_indices.end());
+  for (const unsigned long index : dormant_respawn_indices) {
+    RespawnDormantVehicle(index, current_timestamp);
+  }
+  dormant_respawn_indices.clear();
+}
+
+void MotionPlanStage::RespawnDormantVehicle(const unsigned long index, const cc::Timestamp &current_timestamp) {
+  const ActorId actor_id = vehicle_id_list.at(index);
+  const ActorSlot actor_slot = simulation_state.GetSlot(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocation(actor_slot);
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_slot);
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_slot);
+  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_slot);
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_slot);
+  const cg::Location hero_location = track_traffic.GetHeroLocation();
+
+  // Instanciating teleportation transform as current vehicle transform.
+  cg::Transform teleportation_transform = cg::Transform(vehicle_location, vehicle_rotation);
+
+  // Add entry to teleportation duration clock table if not present.
+  if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
+    teleportation_instance.insert({actor_id, current_timestamp});
+  }
+
+  // Get lower and upper bound for teleporting vehicle.
+  float lower_bound = parameters.GetLowerBoundaryRespawnDormantVehicles();
+  float upper_bound = parameters.GetUpperBoundaryRespawnDormantVehicles();
+  float dilate_factor = (upper_bound-lower_bound)/100.0f;
+
+  // Measuring time elapsed since last teleportation for the vehicle.
+  double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+
+  if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
+    float random_sample = (static_cast<float>(random_device.next())*dilate_factor) + lower_bound;
+    NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
+    if (!teleport_waypoint_list.empty()) {
+      for (auto &teleport_waypoint : teleport_waypoint_list) {
+        GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
+        if (track_traffic.IsGeoGridFree(geogrid_id)) {
+          teleportation_transform = teleport_waypoint->GetTransform();
+          teleportation_transform.location.z += 0.5f;
+          track_traffic.AddTakenGrid(geogrid_id, actor_id);
+          break;
+        }
+      }
     }
   }
+  output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
+
+  // Update the simulation state with the new transform of the vehicle after teleporting it.
+  KinematicState kinematic_state{teleportation_transform.location,
+                                 teleportation_transform.rotation,
+                                 vehicle_velocity, vehicle_speed_limit,
+                                 vehicle_physics_enabled, simulation_state.IsDormant(actor_slot),
+                                 teleportation_transform.location};
+  simulation_state.UpdateKinematicState(actor_slot, kinematic_state);
 }
 
 bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                                         const bool tl_hazard,
                                         const bool collision_emergency_stop) {
 
-  SimpleWaypointPtr junction_end_point = localization.junction_end_point;
-  SimpleWaypointPtr safe_point = localization.safe_point;
+  const WaypointGraph &graph = local_map->GetGraph();
+  const NodeIndex junction_end_point = localization.junction_end_point;
+  const NodeIndex safe_point = localization.safe_point;
 
   bool safe_after_junction = true;
   if (!tl_hazard && !collision_emergency_stop
       && localization.is_at_junction_entrance
-      && junction_end_point != nullptr && safe_point != nullptr
-      && junction_end_point->DistanceSquared(safe_point) > SQUARE(MIN_SAFE_INTERVAL_LENGTH)) {
+      && junction_end_point != INVALID_NODE && safe_point != INVALID_NODE
+      && graph.DistanceSquared(junction_end_point, safe_point) > SQUARE(MIN_SAFE_INTERVAL_LENGTH)) {
 
-    ActorIdSet passing_safe_point = track_traffic.GetPassingVehicles(safe_point->GetId());
-    ActorIdSet passing_junction_end_point = track_traffic.GetPassingVehicles(junction_end_point->GetId());
-    cg::Location mid_point = (junction_end_point->GetLocation() + safe_point->GetLocation())/2.0f;
+    ActorIdSet passing_safe_point = track_traffic.GetPassingVehicles(graph.GetWaypointId(safe_point));
+    ActorIdSet passing_junction_end_point = track_traffic.GetPassingVehicles(graph.GetWaypointId(junction_end_point));
+    cg::Location mid_point = (graph.GetLocation(junction_end_point) + graph.GetLocation(safe_point))/2.0f;
 
     // Only check for vehicles that have the safe point in their passing waypoint, but not
     // the junction end point.
@@ -292,9 +330,10 @@ bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                         std::inserter(difference, difference.begin()));
     if (difference.size() > 0) {
       for (const ActorId &blocking_id: difference) {
-        cg::Location blocking_actor_location = simulation_state.GetLocation(blocking_id);
+        const ActorSlot blocking_slot = simulation_state.GetSlot(blocking_id);
+        cg::Location blocking_actor_location = simulation_state.GetLocation(blocking_slot);
         if (cg::Math::DistanceSquared(blocking_actor_location, mid_point) < SQUARE(MAX_JUNCTION_BLOCK_DISTANCE)
-            && simulation_state.GetVelocity(blocking_id).SquaredLength() < SQUARE(AFTER_JUNCTION_MIN_SPEED)) {
+            && simulation_state.GetVelocity(blocking_slot).SquaredLength() < SQUARE(AFTER_JUNCTION_MIN_SPEED)) {
           safe_after_junction = false;
           break;
         }
@@ -408,13 +447,14 @@ float MotionPlanStage::GetTurnTargetVelocity(const Buffer &waypoint_buffer,
     return max_target_velocity;
   }
   else {
-    const SimpleWaypointPtr first_waypoint = waypoint_buffer.front();
-    const SimpleWaypointPtr last_waypoint = waypoint_buffer.back();
-    const SimpleWaypointPtr middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2));
+    const WaypointGraph &graph = local_map->GetGraph();
+    const NodeIndex first_waypoint = waypoint_buffer.front();
+    const NodeIndex last_waypoint = waypoint_buffer.back();
+    const NodeIndex middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2));
 
-    float radius = GetThreePointCircleRadius(first_waypoint->GetLocation(),
-                                             middle_waypoint->GetLocation(),
-                                             last_waypoint->GetLocation());
+    float radius = GetThreePointCircleRadius(graph.GetLocation(first_waypoint),
+                                             graph.GetLocation(middle_waypoint),
+                                             graph.GetLocation(last_waypoint));
 
     // Return the max velocity at the turn
     return std::sqrt(radius * FRICTION * GRAVITY);
@@ -473,6 +513,7 @@ void MotionPlanStage::RemoveActor(const ActorId actor_id) {
 void MotionPlanStage::Reset() {
   pid_state_map.clear();
   teleportation_instance.clear();
+  dormant_respawn_indices.clear();
 }
 
 } // namespace traffic_manager
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/LocalizationUtils.h"
@@ -40,11 +42,29 @@ private:
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
+  // Guards insertions into the per vehicle maps above, Update may run
+  // concurrently for different vehicles.
+  std::mutex state_map_mutex;
+  // Whether Update leaves dormant vehicles to RespawnDormantVehicles instead
+  // of respawning them right away.
+  bool defer_dormant_respawns = false;
+  // Indices of dormant vehicles to be respawned once all vehicles are updated.
+  std::vector<unsigned long> dormant_respawn_indices;
+  std::mutex dormant_respawn_mutex;
   ControlFrame &output_array;
-  cc::Timestamp current_timestamp;
   RandomGenerator &random_device;
   const LocalMapPtr &local_map;
 
+  // Returns the entry of @a actor_id in @a map, inserting @a initial_value if
+  // not present. References to map elements stay valid across insertions.
+  template <typename T>
+  T &GetOrInsertEntry(std::unordered_map<ActorId, T> &map,
+                      const ActorId actor_id,
+                      const T &initial_value);
+
+  // Teleports a dormant vehicle close to the hero vehicle.
+  void RespawnDormantVehicle(const unsigned long index, const cc::Timestamp &current_timestamp);
+
   std::pair<bool, float> CollisionHandling(const CollisionHazardData &collision_hazard,
                                            const bool tl_hazard,
                                            const cg::Vector3D ego_velocity,
@@ -87,6 +107,16 @@ public:
 
   void Update(const unsigned long index);
 
+  // Makes Update defer the respawn of dormant vehicles to
+  // RespawnDormantVehicles, required while it runs concurrently for several
+  // vehicles. Otherwise each dormant vehicle respawns as it is updated.
+  void SetDeferDormantRespawns(const bool defer);
+
+  // Respawns the dormant vehicles deferred by Update in the current cycle.
+  // Respawning claims geodesic grids and moves vehicles, so it runs
+  // in vehicle order after every vehicle has been updated.
+  void RespawnDormantVehicles();
+
   void RemoveActor(const ActorId actor_id);
 
   void Reset();
@@ -0,0 +1,186 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/PackedSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace carla {
+namespace traffic_manager {
+
+  static float NodeCenterX(const PackedSpatialIndex::Node &node) {
+    return 0.5f * (node.min_x + node.max_x);
+  }
+
+  static float NodeCenterY(const PackedSpatialIndex::Node &node) {
+    return 0.5f * (node.min_y + node.max_y);
+  }
+
+  static float SquaredDistanceToNode(const PackedSpatialIndex::Node &node, const cg::Location &location) {
+    const float dx = std::max(std::max(node.min_x - location.x, 0.0f), location.x - node.max_x);
+    const float dy = std::max(std::max(node.min_y - location.y, 0.0f), location.y - node.max_y);
+    const float dz = std::max(std::max(node.min_z - location.z, 0.0f), location.z - node.max_z);
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  /// Sort-Tile-Recursive ordering: sorts @a items by x, cuts them into
+  /// vertical slices of whole nodes and sorts every slice by y, so that runs
+  /// of NODE_CAPACITY consecutive items are spatially compact.
+  template <typename T, typename GetX, typename GetY, typename Tie>
+  static void SortTileRecursive(std::vector<T> &items, GetX &&get_x, GetY &&get_y, Tie &&tie) {
+    const size_t capacity = PackedSpatialIndex::NODE_CAPACITY;
+    const size_t node_count = (items.size() + capacity - 1u) / capacity;
+    const size_t slice_count = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(node_count))));
+    const size_t slice_size = std::max<size_t>(slice_count, 1u) * capacity;
+
+    // Ties are broken explicitly so the packing is identical on every platform.
+    std::sort(items.begin(), items.end(), [&](const T &lhs, const T &rhs) {
+      return get_x(lhs) != get_x(rhs) ? get_x(lhs) < get_x(rhs) : tie(lhs, rhs);
+    });
+    for (size_t begin = 0u; begin < items.size(); begin += slice_size) {
+      const size_t end = std::min(begin + slice_size, items.size());
+      std::sort(items.begin() + static_cast<int64_t>(begin), items.begin() + static_cast<int64_t>(end),
+          [&](const T &lhs, const T &rhs) {
+        return get_y(lhs) != get_y(rhs) ? get_y(lhs) < get_y(rhs) : tie(lhs, rhs);
+      });
+    }
+  }
+
+  static void ExpandNode(PackedSpatialIndex::Node &node, float x, float y, float z) {
+    node.min_x = std::min(node.min_x, x);
+    node.min_y = std::min(node.min_y, y);
+    node.min_z = std::min(node.min_z, z);
+    node.max_x = std::max(node.max_x, x);
+    node.max_y = std::max(node.max_y, y);
+    node.max_z = std::max(node.max_z, z);
+  }
+
+  static PackedSpatialIndex::Node EmptyNode(uint32_t first, uint32_t count) {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    return PackedSpatialIndex::Node{inf, inf, inf, -inf, -inf, -inf, first, count};
+  }
+
+  void PackedSpatialIndex::Build(const cg::Location *locations, const size_t size) {
+    Clear();
+    if (size == 0u) {
+      return;
+    }
+
+    std::vector<Entry> packed_entries;
+    packed_entries.reserve(size);
+    for (size_t i = 0u; i < size; ++i) {
+      const cg::Location &location = locations[i];
+      packed_entries.push_back(Entry{location.x, location.y, location.z, static_cast<NodeIndex>(i)});
+    }
+    SortTileRecursive(packed_entries,
+        [](const Entry &entry) { return entry.x; },
+        [](const Entry &entry) { return entry.y; },
+        [](const Entry &lhs, const Entry &rhs) { return lhs.node < rhs.node; });
+
+    // Leaf level.
+    std::vector<Node> level;
+    for (size_t first = 0u; first < packed_entries.size(); first += NODE_CAPACITY) {
+      const size_t count = std::min<size_t>(NODE_CAPACITY, packed_entries.size() - first);
+      Node leaf = EmptyNode(static_cast<uint32_t>(first), static_cast<uint32_t>(count));
+      for (size_t i = first; i < first + count; ++i) {
+        ExpandNode(leaf, packed_entries[i].x, packed_entries[i].y, packed_entries[i].z);
+      }
+      level.push_back(leaf);
+    }
+
+    std::vector<Node> packed_nodes;
+    const uint32_t number_of_leaves = static_cast<uint32_t>(level.size());
+    while (true) {
+      const size_t level_begin = packed_nodes.size();
+      packed_nodes.insert(packed_nodes.end(), level.begin(), level.end());
+      if (level.size() == 1u) {
+        break;
+      }
+
+      std::vector<Node> parents;
+      for (size_t first = 0u; first < level.size(); first += NODE_CAPACITY) {
+        const size_t count = std::min<size_t>(NODE_CAPACITY, level.size() - first);
+        Node parent = EmptyNode(static_cast<uint32_t>(level_begin + first), static_cast<uint32_t>(count));
+        for (size_t i = first; i < first + count; ++i) {
+          ExpandNode(parent, level[i].min_x, level[i].min_y, level[i].min_z);
+          ExpandNode(parent, level[i].max_x, level[i].max_y, level[i].max_z);
+        }
+        parents.push_back(parent);
+      }
+      // Parents keep pointing at their children, only their own order changes.
+      SortTileRecursive(parents, NodeCenterX, NodeCenterY,
+          [](const Node &lhs, const Node &rhs) { return lhs.first < rhs.first; });
+      level = std::move(parents);
+    }
+
+    entries.Assign(std::move(packed_entries));
+    nodes.Assign(std::move(packed_nodes));
+    leaf_node_count = number_of_leaves;
+  }
+
+  void PackedSpatialIndex::View(const Entry *entry_data, const size_t entry_count,
+                                const Node *node_data, const size_t node_count,
+                                const uint32_t number_of_leaves) {
+    entries.View(entry_data, entry_count);
+    nodes.View(node_data, node_count);
+    leaf_node_count = number_of_leaves;
+  }
+
+  void PackedSpatialIndex::Clear() {
+    entries.Clear();
+    nodes.Clear();
+    leaf_node_count = 0u;
+  }
+
+  NodeIndex PackedSpatialIndex::Nearest(const cg::Location &location) const {
+    float best_distance = std::numeric_limits<float>::infinity();
+    NodeIndex best_node = INVALID_NODE;
+    if (!nodes.empty()) {
+      Nearest(static_cast<uint32_t>(nodes.size() - 1u), location, best_distance, best_node);
+    }
+    return best_node;
+  }
+
+  void PackedSpatialIndex::Nearest(const uint32_t node_index, const cg::Location &location,
+                                   float &best_distance, NodeIndex &best_node) const {
+    const Node &node = nodes[node_index];
+
+    if (node_index < leaf_node_count) {
+      for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+        const Entry &entry = entries[i];
+        const float dx = entry.x - location.x;
+        const float dy = entry.y - location.y;
+        const float dz = entry.z - location.z;
+        const float distance = dx * dx + dy * dy + dz * dz;
+        if (distance < best_distance || (distance == best_distance && entry.node < best_node)) {
+          best_distance = distance;
+          best_node = entry.node;
+        }
+      }
+      return;
+    }
+
+    // Visit the closest children first so the rest are mostly pruned.
+    std::array<std::pair<float, uint32_t>, NODE_CAPACITY> children;
+    for (uint32_t i = 0u; i < node.count; ++i) {
+      const uint32_t child = node.first + i;
+      children[i] = std::make_pair(SquaredDistanceToNode(nodes[child], location), child);
+    }
+    std::sort(children.begin(), children.begin() + node.count);
+
+    for (uint32_t i = 0u; i < node.count; ++i) {
+      // Equal distances are still visited so ties resolve to the lowest index.
+      if (children[i].first > best_distance) {
+        break;
+      }
+      Nearest(children[i].second, location, best_distance, best_node);
+    }
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,142 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "carla/geom/Location.h"
+
+#include "carla/trafficmanager/FlatArray.h"
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  /// Static R-tree over the locations of the InMemoryMap waypoints. It is
+  /// packed bottom-up with the Sort-Tile-Recursive algorithm into two flat
+  /// arrays, entries and tree nodes, so it can be stored in an InMemoryMap
+  /// image and queried straight from the mapped file.
+  class PackedSpatialIndex {
+
+  public:
+
+    static constexpr uint32_t NODE_CAPACITY = 16u;
+
+    struct Entry {
+      float x;
+      float y;
+      float z;
+      NodeIndex node;
+    };
+
+    /// Bounding box of a tree node. Leaf nodes are stored first and span
+    /// entries[first, first + count), the rest span nodes[first, first + count).
+    /// The root is the last node.
+    struct Node {
+      float min_x;
+      float min_y;
+      float min_z;
+      float max_x;
+      float max_y;
+      float max_z;
+      uint32_t first;
+      uint32_t count;
+    };
+
+    /// Packs an index over @a size locations, location i being the waypoint
+    /// with NodeIndex i.
+    void Build(const cg::Location *locations, size_t size);
+
+    /// Views an index previously packed by Build. The arrays must outlive
+    /// the index.
+    void View(const Entry *entries, size_t entry_count,
+              const Node *nodes, size_t node_count,
+              uint32_t leaf_node_count);
+
+    void Clear();
+
+    bool Empty() const {
+      return nodes.empty();
+    }
+
+    /// Returns the waypoint closest to @a location, or INVALID_NODE if the
+    /// index is empty. Ties are resolved in favour of the lowest index.
+    NodeIndex Nearest(const cg::Location &location) const;
+
+    /// Calls @a visitor with the index of every waypoint strictly inside the
+    /// box [@a min, @a max], until the visitor returns false.
+    template <typename Visitor>
+    void Query(const cg::Location &min, const cg::Location &max, Visitor &&visitor) const;
+
+    const FlatArray<Entry> &GetEntries() const {
+      return entries;
+    }
+
+    const FlatArray<Node> &GetNodes() const {
+      return nodes;
+    }
+
+    uint32_t GetLeafNodeCount() const {
+      return leaf_node_count;
+    }
+
+  private:
+
+    void Nearest(uint32_t node_index, const cg::Location &location,
+                 float &best_distance, NodeIndex &best_node) const;
+
+    FlatArray<Entry> entries;
+    FlatArray<Node> nodes;
+    uint32_t leaf_node_count = 0u;
+  };
+
+  template <typename Visitor>
+  void PackedSpatialIndex::Query(const cg::Location &min, const cg::Location &max, Visitor &&visitor) const {
+    if (nodes.empty()) {
+      return;
+    }
+
+    // Every level pushes at most NODE_CAPACITY nodes and pops one, so this
+    // covers trees far deeper than 32-bit indices allow.
+    std::array<uint32_t, 16u * NODE_CAPACITY> stack;
+    size_t stack_size = 0u;
+    stack[stack_size++] = static_cast<uint32_t>(nodes.size() - 1u);
+
+    while (stack_size > 0u) {
+      const Node &node = nodes[stack[--stack_size]];
+      if (node.max_x < min.x || node.min_x > max.x ||
+          node.max_y < min.y || node.min_y > max.y ||
+          node.max_z < min.z || node.min_z > max.z) {
+        continue;
+      }
+
+      const bool is_leaf = static_cast<size_t>(&node - nodes.data()) < leaf_node_count;
+      if (is_leaf) {
+        for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+          const Entry &entry = entries[i];
+          if (entry.x > min.x && entry.x < max.x &&
+              entry.y > min.y && entry.y < max.y &&
+              entry.z > min.z && entry.z < max.z &&
+              !visitor(entry.node)) {
+            return;
+          }
+        }
+      } else {
+        // Pushed in reverse so children are visited in storage order.
+        for (uint32_t i = node.first + node.count; i > node.first; --i) {
+          stack[stack_size++] = i - 1u;
+        }
+      }
+    }
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -193,6 +193,10 @@ void Parameters::SetOSMMode(const bool mode_switch) {
   osm_mode.store(mode_switch);
 }
 
+void Parameters::SetWorkerThreads(const uint64_t number_of_threads) {
+  worker_threads.store(number_of_threads);
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   const auto entry = std::make_pair(actor->GetId(), path);
   custom_path.AddEntry(entry);
@@ -434,6 +438,11 @@ bool Parameters::GetOSMMode() const {
   return osm_mode.load();
 }
 
+uint64_t Parameters::GetWorkerThreads() const {
+
+  return worker_threads.load();
+}
+
 bool Parameters::GetUploadPath(const ActorId &actor_id) const {
 
   bool custom_path_bool = false;
@@ -0,0 +1,71 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/PathBuffer.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using constants::FrameMemory::GROWTH_STEP_SIZE;
+
+  PathBuffer &PathBufferMap::Acquire(const ActorId actor_id) {
+    auto slot = slots.find(actor_id);
+    if (slot != slots.end()) {
+      return buffers[slot->second];
+    }
+
+    if (free_slots.empty()) {
+      Grow();
+    }
+    const uint32_t new_slot = free_slots.back();
+    free_slots.pop_back();
+    slots.emplace(actor_id, new_slot);
+    return buffers[new_slot];
+  }
+
+  const PathBuffer *PathBufferMap::Find(const ActorId actor_id) const {
+    auto slot = slots.find(actor_id);
+    return slot != slots.end() ? &buffers[slot->second] : nullptr;
+  }
+
+  void PathBufferMap::Remove(const ActorId actor_id) {
+    auto slot = slots.find(actor_id);
+    if (slot != slots.end()) {
+      buffers[slot->second].clear();
+      free_slots.push_back(slot->second);
+      slots.erase(slot);
+    }
+  }
+
+  void PathBufferMap::Clear() {
+    slots.clear();
+    free_slots.clear();
+    for (size_t i = buffers.size(); i > 0u; --i) {
+      buffers[i - 1u].clear();
+      free_slots.push_back(static_cast<uint32_t>(i - 1u));
+    }
+  }
+
+  void PathBufferMap::Grow() {
+    const size_t old_slot_count = buffers.size();
+    const size_t new_slot_count = old_slot_count + GROWTH_STEP_SIZE;
+
+    // Slot i always starts at i * PATH_BUFFER_CAPACITY, so the existing paths
+    // keep their positions and only need to point at the new arena.
+    arena.resize(new_slot_count * PATH_BUFFER_CAPACITY);
+    buffers.resize(new_slot_count);
+    for (size_t i = 0u; i < new_slot_count; ++i) {
+      buffers[i].data = arena.data() + i * PATH_BUFFER_CAPACITY;
+    }
+
+    // Handed out from the back, lowest slot first.
+    for (size_t i = new_slot_count; i > old_slot_count; --i) {
+      free_slots.push_back(static_cast<uint32_t>(i - 1u));
+    }
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,200 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/Debug.h"
+#include "carla/rpc/ActorId.h"
+
+#include "carla/trafficmanager/Constants.h"
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using constants::PathBufferUpdate::PATH_BUFFER_CAPACITY;
+
+  static_assert((PATH_BUFFER_CAPACITY & (PATH_BUFFER_CAPACITY - 1u)) == 0u,
+                "The path buffer capacity must be a power of two");
+
+  /// Path of a vehicle, a ring of at most PATH_BUFFER_CAPACITY waypoint
+  /// indices. Its storage is a slot of the PathBufferMap arena, so pushing
+  /// and popping never allocate. Callers check full() before pushing.
+  class PathBuffer {
+
+  public:
+
+    class const_iterator {
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = NodeIndex;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const NodeIndex *;
+      using reference = NodeIndex;
+
+      const_iterator(const PathBuffer &buffer, uint32_t position)
+        : _buffer(&buffer),
+          _position(position) {}
+
+      NodeIndex operator*() const {
+        return (*_buffer)[_position];
+      }
+
+      const_iterator &operator++() {
+        ++_position;
+        return *this;
+      }
+
+      bool operator==(const const_iterator &rhs) const {
+        return _position == rhs._position;
+      }
+
+      bool operator!=(const const_iterator &rhs) const {
+        return _position != rhs._position;
+      }
+
+    private:
+
+      const PathBuffer *_buffer;
+      uint32_t _position;
+    };
+
+    PathBuffer() = default;
+
+    PathBuffer(const PathBuffer &) = delete;
+    PathBuffer &operator=(const PathBuffer &) = delete;
+
+    PathBuffer(PathBuffer &&) = default;
+    PathBuffer &operator=(PathBuffer &&) = default;
+
+    static constexpr size_t capacity() {
+      return PATH_BUFFER_CAPACITY;
+    }
+
+    size_t size() const {
+      return count;
+    }
+
+    bool empty() const {
+      return count == 0u;
+    }
+
+    bool full() const {
+      return count == PATH_BUFFER_CAPACITY;
+    }
+
+    NodeIndex operator[](size_t position) const {
+      return data[(head + position) & MASK];
+    }
+
+    NodeIndex at(size_t position) const {
+      DEBUG_ASSERT(position < count);
+      return (*this)[position];
+    }
+
+    NodeIndex front() const {
+      DEBUG_ASSERT(!empty());
+      return data[head];
+    }
+
+    NodeIndex back() const {
+      DEBUG_ASSERT(!empty());
+      return data[(head + count - 1u) & MASK];
+    }
+
+    void push_back(NodeIndex node) {
+      DEBUG_ASSERT(!full());
+      data[(head + count) & MASK] = node;
+      ++count;
+    }
+
+    void pop_front() {
+      DEBUG_ASSERT(!empty());
+      head = (head + 1u) & MASK;
+      --count;
+    }
+
+    void pop_back() {
+      DEBUG_ASSERT(!empty());
+      --count;
+    }
+
+    void clear() {
+      head = 0u;
+      count = 0u;
+    }
+
+    const_iterator begin() const {
+      return const_iterator(*this, 0u);
+    }
+
+    const_iterator end() const {
+      return const_iterator(*this, count);
+    }
+
+  private:
+
+    friend class PathBufferMap;
+
+    static constexpr uint32_t MASK = PATH_BUFFER_CAPACITY - 1u;
+
+    NodeIndex *data = nullptr;
+    uint32_t head = 0u;
+    uint32_t count = 0u;
+  };
+
+  /// Path buffers of the registered vehicles. All of them live in a single
+  /// arena of PATH_BUFFER_CAPACITY waypoints per vehicle, and the slots of
+  /// removed vehicles are reused by the next ones.
+  class PathBufferMap {
+
+  public:
+
+    /// Returns the buffer of @a actor_id, adding an empty one if there is
+    /// none. Adding a buffer may grow the arena, which invalidates the
+    /// references to every other buffer.
+    PathBuffer &Acquire(ActorId actor_id);
+
+    bool Contains(ActorId actor_id) const {
+      return slots.find(actor_id) != slots.end();
+    }
+
+    /// Returns nullptr if @a actor_id has no buffer.
+    const PathBuffer *Find(ActorId actor_id) const;
+
+    /// Throws std::out_of_range if @a actor_id has no buffer.
+    PathBuffer &Get(ActorId actor_id) {
+      return buffers[slots.at(actor_id)];
+    }
+
+    const PathBuffer &Get(ActorId actor_id) const {
+      return buffers[slots.at(actor_id)];
+    }
+
+    void Remove(ActorId actor_id);
+
+    /// Removes every buffer but keeps the arena.
+    void Clear();
+
+  private:
+
+    void Grow();
+
+    std::vector<NodeIndex> arena;
+    std::vector<PathBuffer> buffers;
+    std::vector<uint32_t> free_slots;
+    std::unordered_map<ActorId, uint32_t> slots;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -3,19 +3,54 @@
 
 #include <random>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "carla/rpc/ActorId.h"
 
 namespace carla {
 namespace traffic_manager {
 
+using ActorId = carla::rpc::ActorId;
+
 class RandomGenerator {
 public:
-    RandomGenerator(const uint64_t seed): mt(std::mt19937(seed)), dist(0.0, 100.0) {}
+    RandomGenerator(const uint64_t seed): seed(seed), mt(std::mt19937(seed)), dist(0.0, 100.0) {}
     double next() { return dist(mt); }
+
+    /// Draws from the stream owned by @a actor_id. Streams of different actors
+    /// are independent, so stages running in parallel can use them
+    /// concurrently as long as every actor is handled by a single worker.
+    double next(const ActorId actor_id) {
+      return std::uniform_real_distribution<double>(0.0, 100.0)(actor_streams.at(actor_id));
+    }
+
+    /// Creates the streams of newly registered actors and drops the ones of
+    /// actors no longer in @a actor_ids. Must not run concurrently with next().
+    void UpdateActorStreams(const std::vector<ActorId> &actor_ids) {
+      for (const ActorId actor_id : actor_ids) {
+        if (actor_streams.find(actor_id) == actor_streams.end()) {
+          std::seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32u), actor_id};
+          actor_streams.emplace(actor_id, std::mt19937(sequence));
+        }
+      }
+      if (actor_streams.size() > actor_ids.size()) {
+        const std::unordered_set<ActorId> current_ids(actor_ids.begin(), actor_ids.end());
+        for (auto iter = actor_streams.begin(); iter != actor_streams.end();) {
+          if (current_ids.find(iter->first) == current_ids.end()) {
+            iter = actor_streams.erase(iter);
+          } else {
+            ++iter;
+          }
+        }
+      }
+    }
+
 private:
+    uint64_t seed;
     std::mt19937 mt;
     std::uniform_real_distribution<double> dist;
+    std::unordered_map<ActorId, std::mt19937> actor_streams;
 };
 
 } // namespace traffic_manager
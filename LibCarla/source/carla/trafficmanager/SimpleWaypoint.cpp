@@ -17,6 +17,12 @@ namespace traffic_manager {
     waypoint = _waypoint;
     next_left_waypoint = nullptr;
     next_right_waypoint = nullptr;
+
+    transform = waypoint->GetTransform();
+    forward_vector = transform.GetForwardVector();
+    lane_width = static_cast<float>(waypoint->GetLaneWidth());
+    junction_id = waypoint->GetJunctionId();
+    road_is_junction = waypoint->IsJunction();
   }
   SimpleWaypoint::~SimpleWaypoint() {}
 
@@ -36,6 +42,14 @@ namespace traffic_manager {
     return waypoint->GetId();
   }
 
+  void SimpleWaypoint::SetIndex(uint32_t _index) {
+    index = _index;
+  }
+
+  uint32_t SimpleWaypoint::GetIndex() const {
+    return index;
+  }
+
   SimpleWaypointPtr SimpleWaypoint::GetLeftWaypoint() {
     return next_left_waypoint;
   }
@@ -45,11 +59,15 @@ namespace traffic_manager {
   }
 
   cg::Location SimpleWaypoint::GetLocation() const {
-    return waypoint->GetTransform().location;
+    return transform.location;
   }
 
   cg::Vector3D SimpleWaypoint::GetForwardVector() const {
-    return waypoint->GetTransform().rotation.GetForwardVector();
+    return forward_vector;
+  }
+
+  float SimpleWaypoint::GetLaneWidth() const {
+    return lane_width;
   }
 
   uint64_t SimpleWaypoint::SetNextWaypoint(const std::vector<SimpleWaypointPtr> &waypoints) {
@@ -68,7 +86,7 @@ namespace traffic_manager {
 
   void SimpleWaypoint::SetLeftWaypoint(SimpleWaypointPtr &_waypoint) {
 
-    const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector();
+    const cg::Vector3D heading_vector = forward_vector;
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation();
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f) {
       next_left_waypoint = _waypoint;
@@ -77,13 +95,20 @@ namespace traffic_manager {
 
   void SimpleWaypoint::SetRightWaypoint(SimpleWaypointPtr &_waypoint) {
 
-    const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector();
+    const cg::Vector3D heading_vector = forward_vector;
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation();
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) < 0.0f) {
       next_right_waypoint = _waypoint;
     }
   }
 
+  void SimpleWaypoint::ClearLinks() {
+    next_waypoints.clear();
+    previous_waypoints.clear();
+    next_left_waypoint.reset();
+    next_right_waypoint.reset();
+  }
+
   float SimpleWaypoint::Distance(const cg::Location &location) const {
     return GetLocation().Distance(location);
   }
@@ -118,8 +143,8 @@ namespace traffic_manager {
 
   GeoGridId SimpleWaypoint::GetGeodesicGridId() {
     GeoGridId grid_id;
-    if (waypoint->IsJunction()) {
-      grid_id = waypoint->GetJunctionId();
+    if (road_is_junction) {
+      grid_id = junction_id;
     } else {
       grid_id = geodesic_grid_id;
     }
@@ -127,11 +152,11 @@ namespace traffic_manager {
   }
 
   GeoGridId SimpleWaypoint::GetJunctionId() const {
-    return waypoint->GetJunctionId();
+    return junction_id;
   }
 
   cg::Transform SimpleWaypoint::GetTransform() const {
-    return waypoint->GetTransform();
+    return transform;
   }
 
   void SimpleWaypoint::SetRoadOption(RoadOption _road_option) {
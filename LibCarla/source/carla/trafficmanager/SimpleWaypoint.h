@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <limits>
 #include <memory.h>
 
 #include "carla/client/Waypoint.h"
@@ -43,6 +44,13 @@ namespace traffic_manager {
 
     /// Pointer to Carla's waypoint object around which this class wraps around.
     WaypointPtr waypoint;
+    /// Values of the wrapped waypoint cached on construction, so that reading
+    /// them does not go through the road::Map on every call.
+    cg::Transform transform;
+    cg::Vector3D forward_vector;
+    float lane_width = 0.0f;
+    GeoGridId junction_id = -1;
+    bool road_is_junction = false;
     /// List of pointers to next connecting waypoints.
     std::vector<SimpleWaypointPtr> next_waypoints;
     /// List of pointers to previous connecting waypoints.
@@ -57,6 +65,8 @@ namespace traffic_manager {
     GeoGridId geodesic_grid_id = 0;
     // Boolean to hold if the waypoint belongs to a junction
     bool _is_junction = false;
+    /// Position of the waypoint in the InMemoryMap dense topology.
+    uint32_t index = std::numeric_limits<uint32_t>::max();
 
   public:
 
@@ -81,6 +91,13 @@ namespace traffic_manager {
     /// Returns the unique id for the waypoint.
     uint64_t GetId() const;
 
+    /// Returns the width of the lane at the waypoint.
+    float GetLaneWidth() const;
+
+    /// Accessor methods for the position of the waypoint in the dense topology.
+    void SetIndex(uint32_t _index);
+    uint32_t GetIndex() const;
+
     /// This method is used to set the next waypoints.
     uint64_t SetNextWaypoint(const std::vector<SimpleWaypointPtr> &next_waypoints);
 
@@ -93,6 +110,10 @@ namespace traffic_manager {
     /// This method is used to set the closest right waypoint for a lane change.
     void SetRightWaypoint(SimpleWaypointPtr &waypoint);
 
+    /// Drops the links to every neighbouring waypoint, which otherwise keep
+    /// each other alive.
+    void ClearLinks();
+
     /// This method is used to get the closest left waypoint for a lane change.
     SimpleWaypointPtr GetLeftWaypoint();
 
@@ -6,97 +6,123 @@ namespace traffic_manager {
 
 SimulationState::SimulationState() {}
 
-void SimulationState::AddActor(ActorId actor_id,
-                               KinematicState kinematic_state,
-                               StaticAttributes attributes,
-                               TrafficLightState tl_state) {
-  actor_set.insert(actor_id);
-  kinematic_state_map.insert({actor_id, kinematic_state});
-  static_attribute_map.insert({actor_id, attributes});
-  tl_state_map.insert({actor_id, tl_state});
+void SimulationState::SetKinematicState(const uint32_t index, const KinematicState &state) {
+  locations[index] = state.location;
+  rotations[index] = state.rotation;
+  headings[index] = state.rotation.GetForwardVector();
+  velocities[index] = state.velocity;
+  speed_limits[index] = state.speed_limit;
+  physics_enabled[index] = state.physics_enabled ? 1u : 0u;
+  dormant[index] = state.is_dormant ? 1u : 0u;
+  hybrid_end_locations[index] = state.hybrid_end_location;
+}
+
+ActorSlot SimulationState::AddActor(ActorId actor_id,
+                                    KinematicState kinematic_state,
+                                    StaticAttributes attributes,
+                                    TrafficLightState tl_state) {
+  const auto existing_slot = slot_map.find(actor_id);
+  if (existing_slot != slot_map.end()) {
+    // Keep the previous state, as inserting into the former maps did.
+    return ActorSlot{existing_slot->second};
+  }
+
+  const uint32_t index = static_cast<uint32_t>(actor_ids.size());
+  slot_map.insert({actor_id, index});
+  actor_ids.push_back(actor_id);
+  locations.emplace_back();
+  rotations.emplace_back();
+  headings.emplace_back();
+  velocities.emplace_back();
+  speed_limits.emplace_back();
+  physics_enabled.emplace_back();
+  dormant.emplace_back();
+  hybrid_end_locations.emplace_back();
+  SetKinematicState(index, kinematic_state);
+  actor_types.push_back(attributes.actor_type);
+  dimensions.emplace_back(attributes.half_length, attributes.half_width, attributes.half_height);
+  tl_states.push_back(tl_state);
+
+  return ActorSlot{index};
 }
 
 bool SimulationState::ContainsActor(ActorId actor_id) const {
-  return actor_set.find(actor_id) != actor_set.end();
+  return slot_map.find(actor_id) != slot_map.end();
 }
 
 void SimulationState::RemoveActor(ActorId actor_id) {
-  actor_set.erase(actor_id);
-  kinematic_state_map.erase(actor_id);
-  static_attribute_map.erase(actor_id);
-  tl_state_map.erase(actor_id);
+  const auto removed_slot = slot_map.find(actor_id);
+  if (removed_slot == slot_map.end()) {
+    return;
+  }
+  const uint32_t index = removed_slot->second;
+  slot_map.erase(removed_slot);
+
+  const uint32_t last = static_cast<uint32_t>(actor_ids.size() - 1u);
+  if (index != last) {
+    actor_ids[index] = actor_ids[last];
+    locations[index] = locations[last];
+    rotations[index] = rotations[last];
+    headings[index] = headings[last];
+    velocities[index] = velocities[last];
+    speed_limits[index] = speed_limits[last];
+    physics_enabled[index] = physics_enabled[last];
+    dormant[index] = dormant[last];
+    hybrid_end_locations[index] = hybrid_end_locations[last];
+    actor_types[index] = actor_types[last];
+    dimensions[index] = dimensions[last];
+    tl_states[index] = tl_states[last];
+    slot_map[actor_ids[index]] = index;
+  }
+
+  actor_ids.pop_back();
+  locations.pop_back();
+  rotations.pop_back();
+  headings.pop_back();
+  velocities.pop_back();
+  speed_limits.pop_back();
+  physics_enabled.pop_back();
+  dormant.pop_back();
+  hybrid_end_locations.pop_back();
+  actor_types.pop_back();
+  dimensions.pop_back();
+  tl_states.pop_back();
 }
 
 void SimulationState::Reset() {
-  actor_set.clear();
-  kinematic_state_map.clear();
-  static_attribute_map.clear();
-  tl_state_map.clear();
+  slot_map.clear();
+  actor_ids.clear();
+  locations.clear();
+  rotations.clear();
+  headings.clear();
+  velocities.clear();
+  speed_limits.clear();
+  physics_enabled.clear();
+  dormant.clear();
+  hybrid_end_locations.clear();
+  actor_types.clear();
+  dimensions.clear();
+  tl_states.clear();
 }
 
-void SimulationState::UpdateKinematicState(ActorId actor_id, KinematicState state) {
-  kinematic_state_map.at(actor_id) = state;
+void SimulationState::UpdateKinematicState(ActorSlot slot, KinematicState state) {
+  SetKinematicState(slot.index, state);
 }
 
-void SimulationState::UpdateKinematicHybridEndLocation(ActorId actor_id, cg::Location location) {
-  kinematic_state_map.at(actor_id).hybrid_end_location = location;
+void SimulationState::UpdateKinematicHybridEndLocation(ActorSlot slot, cg::Location location) {
+  hybrid_end_locations[slot.index] = location;
 }
 
-void SimulationState::UpdateTrafficLightState(ActorId actor_id, TrafficLightState state) {
+void SimulationState::UpdateTrafficLightState(ActorSlot slot, TrafficLightState state) {
   // The green-yellow state transition is not notified to the vehicle. This is done to avoid
   // having vehicles stopped very near the intersection when only the rear part of the vehicle
   // is colliding with the trigger volume of the traffic light.
-  auto previous_tl_state = GetTLS(actor_id);
+  const TrafficLightState &previous_tl_state = GetTLS(slot);
   if (previous_tl_state.at_traffic_light && previous_tl_state.tl_state == TLS::Green) {
     state.tl_state = TLS::Green;
   }
 
-  tl_state_map.at(actor_id) = state;
-}
-
-cg::Location SimulationState::GetLocation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).location;
-}
-
-cg::Location SimulationState::GetHybridEndLocation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).hybrid_end_location;
-}
-
-cg::Rotation SimulationState::GetRotation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation;
-}
-
-cg::Vector3D SimulationState::GetHeading(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation.GetForwardVector();
-}
-
-cg::Vector3D SimulationState::GetVelocity(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).velocity;
-}
-
-float SimulationState::GetSpeedLimit(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).speed_limit;
-}
-
-bool SimulationState::IsPhysicsEnabled(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).physics_enabled;
-}
-
-bool SimulationState::IsDormant(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).is_dormant;
-}
-
-TrafficLightState SimulationState::GetTLS(ActorId actor_id) const {
-  return tl_state_map.at(actor_id);
-}
-
-ActorType SimulationState::GetType(ActorId actor_id) const {
-  return static_attribute_map.at(actor_id).actor_type;
-}
-
-cg::Vector3D SimulationState::GetDimensions(ActorId actor_id) const {
-  const StaticAttributes &attributes = static_attribute_map.at(actor_id);
-  return cg::Vector3D(attributes.half_length, attributes.half_width, attributes.half_height);
+  tl_states[slot.index] = state;
 }
 
 } // namespace  traffic_manager
@@ -1,7 +1,10 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
 #include "carla/trafficmanager/DataStructures.h"
 
@@ -23,13 +26,11 @@ struct KinematicState {
   bool is_dormant;
   cg::Location hybrid_end_location;
 };
-using KinematicStateMap = std::unordered_map<ActorId, KinematicState>;
 
 struct TrafficLightState {
   TLS tl_state;
   bool at_traffic_light;
 };
-using TrafficLightStateMap = std::unordered_map<ActorId, TrafficLightState>;
 
 struct StaticAttributes {
   ActorType actor_type;
@@ -37,68 +38,207 @@ struct StaticAttributes {
   float half_width;
   float half_height;
 };
-using StaticAttributeMap = std::unordered_map<ActorId, StaticAttributes>;
+
+/// Dense position of an actor inside the SimulationState arrays. Slots stay
+/// valid until an actor is added to or removed from the simulation state, so
+/// they can be kept for the whole run of the stages.
+struct ActorSlot {
+  static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = INVALID_INDEX;
+
+  bool IsValid() const {
+    return index != INVALID_INDEX;
+  }
+};
 
 /// This class holds the state of all the vehicles in the simlation.
+/// Every attribute is stored in its own contiguous array indexed by the actor
+/// slot, and a single table maps actor ids to slots. Stages look up the slot
+/// of an actor once and then read its attributes without further hashing.
 class SimulationState {
 
 private:
-  // Structure to hold ids of all actors in the simulation.
-  std::unordered_set<ActorId> actor_set;
-  // Structure containing dynamic motion related state of actors.
-  KinematicStateMap kinematic_state_map;
-  // Structure containing static attributes of actors.
-  StaticAttributeMap static_attribute_map;
-  // Structure containing dynamic traffic light related state of actors.
-  TrafficLightStateMap tl_state_map;
+  // Structure mapping the ids of all actors in the simulation to their slot.
+  std::unordered_map<ActorId, uint32_t> slot_map;
+  // Actor id stored in every slot.
+  std::vector<ActorId> actor_ids;
+  // Dynamic motion related state of actors.
+  std::vector<cg::Location> locations;
+  std::vector<cg::Rotation> rotations;
+  std::vector<cg::Vector3D> headings;
+  std::vector<cg::Vector3D> velocities;
+  std::vector<float> speed_limits;
+  // Stored as bytes instead of std::vector<bool> so that different slots can
+  // be written concurrently.
+  std::vector<uint8_t> physics_enabled;
+  std::vector<uint8_t> dormant;
+  std::vector<cg::Location> hybrid_end_locations;
+  // Static attributes of actors.
+  std::vector<ActorType> actor_types;
+  std::vector<cg::Vector3D> dimensions;
+  // Dynamic traffic light related state of actors.
+  std::vector<TrafficLightState> tl_states;
+
+  void SetKinematicState(uint32_t index, const KinematicState &state);
 
 public :
   SimulationState();
 
   // Method to add an actor to the simulation state.
-  void AddActor(ActorId actor_id,
-                KinematicState kinematic_state,
-                StaticAttributes attributes,
-                TrafficLightState tl_state);
+  ActorSlot AddActor(ActorId actor_id,
+                     KinematicState kinematic_state,
+                     StaticAttributes attributes,
+                     TrafficLightState tl_state);
 
   // Method to verify if an actor is present currently present in the simulation state.
   bool ContainsActor(ActorId actor_id) const;
 
-  // Method to remove an actor from simulation state.
+  // Method to remove an actor from simulation state. The last actor is moved
+  // to the freed slot to keep the arrays dense.
   void RemoveActor(ActorId actor_id);
 
   // Method to flush all states and actors.
   void Reset();
 
-  void UpdateKinematicState(ActorId actor_id, KinematicState state);
+  // Number of actors, slots go from 0 to Size() - 1.
+  size_t Size() const {
+    return actor_ids.size();
+  }
+
+  // Slot of an actor present in the simulation state.
+  ActorSlot GetSlot(const ActorId actor_id) const {
+    return ActorSlot{slot_map.at(actor_id)};
+  }
+
+  // Slot of an actor, invalid if the actor is not present.
+  ActorSlot FindSlot(const ActorId actor_id) const {
+    const auto slot = slot_map.find(actor_id);
+    return slot != slot_map.end() ? ActorSlot{slot->second} : ActorSlot{};
+  }
+
+  // Ids and locations of all actors, indexed by slot.
+  const std::vector<ActorId> &GetActorIds() const {
+    return actor_ids;
+  }
+
+  const std::vector<cg::Location> &GetLocations() const {
+    return locations;
+  }
+
+  void UpdateKinematicState(ActorSlot slot, KinematicState state);
+
+  void UpdateKinematicHybridEndLocation(ActorSlot slot, cg::Location location);
+
+  void UpdateTrafficLightState(ActorSlot slot, TrafficLightState state);
+
+  void UpdateKinematicState(ActorId actor_id, KinematicState state) {
+    UpdateKinematicState(GetSlot(actor_id), state);
+  }
+
+  void UpdateKinematicHybridEndLocation(ActorId actor_id, cg::Location location) {
+    UpdateKinematicHybridEndLocation(GetSlot(actor_id), location);
+  }
+
+  void UpdateTrafficLightState(ActorId actor_id, TrafficLightState state) {
+    UpdateTrafficLightState(GetSlot(actor_id), state);
+  }
+
+  // Accessors by slot.
+
+  ActorId GetActorId(const ActorSlot slot) const {
+    return actor_ids[slot.index];
+  }
+
+  const cg::Location &GetLocation(const ActorSlot slot) const {
+    return locations[slot.index];
+  }
+
+  const cg::Location &GetHybridEndLocation(const ActorSlot slot) const {
+    return hybrid_end_locations[slot.index];
+  }
+
+  const cg::Rotation &GetRotation(const ActorSlot slot) const {
+    return rotations[slot.index];
+  }
+
+  const cg::Vector3D &GetHeading(const ActorSlot slot) const {
+    return headings[slot.index];
+  }
+
+  const cg::Vector3D &GetVelocity(const ActorSlot slot) const {
+    return velocities[slot.index];
+  }
+
+  float GetSpeedLimit(const ActorSlot slot) const {
+    return speed_limits[slot.index];
+  }
+
+  bool IsPhysicsEnabled(const ActorSlot slot) const {
+    return physics_enabled[slot.index] != 0u;
+  }
+
+  bool IsDormant(const ActorSlot slot) const {
+    return dormant[slot.index] != 0u;
+  }
+
+  const TrafficLightState &GetTLS(const ActorSlot slot) const {
+    return tl_states[slot.index];
+  }
 
-  void UpdateKinematicHybridEndLocation(ActorId actor_id, cg::Location location);
+  ActorType GetType(const ActorSlot slot) const {
+    return actor_types[slot.index];
+  }
 
-  void UpdateTrafficLightState(ActorId actor_id, TrafficLightState state);
+  const cg::Vector3D &GetDimensions(const ActorSlot slot) const {
+    return dimensions[slot.index];
+  }
 
-  cg::Location GetLocation(const ActorId actor_id) const;
+  // Accessors by actor id, each one looks up the slot of the actor.
 
-  cg::Location GetHybridEndLocation(const ActorId actor_id) const;
+  cg::Location GetLocation(const ActorId actor_id) const {
+    return GetLocation(GetSlot(actor_id));
+  }
 
-  cg::Rotation GetRotation(const ActorId actor_id) const;
+  cg::Location GetHybridEndLocation(const ActorId actor_id) const {
+    return GetHybridEndLocation(GetSlot(actor_id));
+  }
 
-  cg::Vector3D GetHeading(const ActorId actor_id) const;
+  cg::Rotation GetRotation(const ActorId actor_id) const {
+    return GetRotation(GetSlot(actor_id));
+  }
 
-  cg::Vector3D GetVelocity(const ActorId actor_id) const;
+  cg::Vector3D GetHeading(const ActorId actor_id) const {
+    return GetHeading(GetSlot(actor_id));
+  }
 
-  float GetSpeedLimit(const ActorId actor_id) const;
+  cg::Vector3D GetVelocity(const ActorId actor_id) const {
+    return GetVelocity(GetSlot(actor_id));
+  }
 
-  bool IsPhysicsEnabled(const ActorId actor_id) const;
+  float GetSpeedLimit(const ActorId actor_id) const {
+    return GetSpeedLimit(GetSlot(actor_id));
+  }
 
-  bool IsDormant(const ActorId actor_id) const;
+  bool IsPhysicsEnabled(const ActorId actor_id) const {
+    return IsPhysicsEnabled(GetSlot(actor_id));
+  }
 
-  cg::Location GetHeroLocation(const ActorId actor_id) const;
+  bool IsDormant(const ActorId actor_id) const {
+    return IsDormant(GetSlot(actor_id));
+  }
 
-  TrafficLightState GetTLS(const ActorId actor_id) const;
+  TrafficLightState GetTLS(const ActorId actor_id) const {
+    return GetTLS(GetSlot(actor_id));
+  }
 
-  ActorType GetType(const ActorId actor_id) const;
+  ActorType GetType(const ActorId actor_id) const {
+    return GetType(GetSlot(actor_id));
+  }
 
-  cg::Vector3D GetDimensions(const ActorId actor_id) const;
+  cg::Vector3D GetDimensions(const ActorId actor_id) const {
+    return GetDimensions(GetSlot(actor_id));
+  }
 
 };
 
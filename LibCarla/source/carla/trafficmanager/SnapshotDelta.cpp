@@ -0,0 +1,80 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/SnapshotDelta.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  bool SnapshotDelta::HasChanged(const TrackedState &tracked, const cc::ActorSnapshot &actor) {
+    // The vehicle fields alias constant data (the sign id) in the state of
+    // traffic lights and signs, so reading them for every actor type never
+    // reports a static actor as changed.
+    const auto &vehicle_data = actor.state.vehicle_data;
+    return tracked.transform != actor.transform
+        || tracked.velocity != actor.velocity
+        || tracked.actor_state != actor.actor_state
+        || tracked.speed_limit != vehicle_data.speed_limit
+        || tracked.traffic_light_state != vehicle_data.traffic_light_state
+        || tracked.has_traffic_light != vehicle_data.has_traffic_light;
+  }
+
+  void SnapshotDelta::Store(TrackedState &tracked, const cc::ActorSnapshot &actor) {
+    const auto &vehicle_data = actor.state.vehicle_data;
+    tracked.transform = actor.transform;
+    tracked.velocity = actor.velocity;
+    tracked.actor_state = actor.actor_state;
+    tracked.speed_limit = vehicle_data.speed_limit;
+    tracked.traffic_light_state = vehicle_data.traffic_light_state;
+    tracked.has_traffic_light = vehicle_data.has_traffic_light;
+  }
+
+  void SnapshotDelta::Update(const cc::WorldSnapshot &snapshot) {
+    added_actors.clear();
+    removed_actors.clear();
+    changed_actors.clear();
+    ++update_count;
+
+    for (const cc::ActorSnapshot &actor : snapshot) {
+      auto result = tracked_actors.emplace(actor.id, TrackedState{});
+      TrackedState &tracked = result.first->second;
+      if (result.second) {
+        added_actors.push_back(actor.id);
+      } else if (HasChanged(tracked, actor)) {
+        changed_actors.push_back(actor.id);
+      }
+      Store(tracked, actor);
+      tracked.last_update = update_count;
+    }
+
+    // Every actor of the snapshot is tracked at this point, so the tracked
+    // set only needs to be swept when actors have disappeared.
+    if (tracked_actors.size() != snapshot.size()) {
+      for (auto it = tracked_actors.begin(); it != tracked_actors.end();) {
+        if (it->second.last_update != update_count) {
+          removed_actors.push_back(it->first);
+          it = tracked_actors.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+  }
+
+  void SnapshotDelta::Forget(const ActorId actor_id) {
+    tracked_actors.erase(actor_id);
+  }
+
+  void SnapshotDelta::Reset() {
+    tracked_actors.clear();
+    update_count = 0u;
+    added_actors.clear();
+    removed_actors.clear();
+    changed_actors.clear();
+  }
+
+} // namespace traffic_manager
+} // namespace carla
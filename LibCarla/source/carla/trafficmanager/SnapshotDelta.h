@@ -0,0 +1,86 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/client/ActorSnapshot.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/geom/Transform.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/ActorState.h"
+#include "carla/rpc/TrafficLightState.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cc = carla::client;
+  namespace cg = carla::geom;
+
+  using ActorId = carla::ActorId;
+
+  /// Difference between two consecutive world snapshots: actors that
+  /// appeared, actors that disappeared and actors whose kinematic or vehicle
+  /// state changed. Only the fields read by the traffic manager are compared,
+  /// so parked vehicles, props and traffic lights do not show up as changed.
+  class SnapshotDelta {
+
+  public:
+
+    /// Compares @a snapshot with the one given in the previous call and
+    /// refills the added, removed and changed lists. After a Reset, every
+    /// actor in @a snapshot is reported as added.
+    void Update(const cc::WorldSnapshot &snapshot);
+
+    /// Stops tracking @a actor_id, so it is reported as added by the next
+    /// Update if it is still present in the simulation.
+    void Forget(ActorId actor_id);
+
+    void Reset();
+
+    const std::vector<ActorId> &GetAddedActors() const {
+      return added_actors;
+    }
+
+    const std::vector<ActorId> &GetRemovedActors() const {
+      return removed_actors;
+    }
+
+    const std::vector<ActorId> &GetChangedActors() const {
+      return changed_actors;
+    }
+
+  private:
+
+    struct TrackedState {
+      cg::Transform transform;
+      cg::Vector3D velocity;
+      rpc::ActorState actor_state;
+      float speed_limit;
+      rpc::TrafficLightState traffic_light_state;
+      bool has_traffic_light;
+      /// Value of update_count the last time the actor was in a snapshot.
+      uint64_t last_update;
+    };
+
+    static bool HasChanged(const TrackedState &tracked, const cc::ActorSnapshot &actor);
+
+    static void Store(TrackedState &tracked, const cc::ActorSnapshot &actor);
+
+    std::unordered_map<ActorId, TrackedState> tracked_actors;
+    uint64_t update_count = 0u;
+
+    std::vector<ActorId> added_actors;
+    std::vector<ActorId> removed_actors;
+    std::vector<ActorId> changed_actors;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
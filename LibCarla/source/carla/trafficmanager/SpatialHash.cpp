@@ -0,0 +1,130 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <cmath>
+
+#include "carla/Debug.h"
+#include "carla/geom/Math.h"
+
+#include "carla/trafficmanager/SpatialHash.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  static constexpr uint32_t MIN_BUCKET_COUNT = 16u;
+
+  SpatialHash::SpatialHash(const float cell_size)
+    : cell_size(cell_size),
+      inv_cell_size(1.0f / cell_size) {
+    DEBUG_ASSERT(cell_size > 0.0f);
+  }
+
+  int32_t SpatialHash::GetCellCoordinate(const float value) const {
+    return static_cast<int32_t>(std::floor(value * inv_cell_size));
+  }
+
+  uint32_t SpatialHash::GetBucket(const int32_t cell_x, const int32_t cell_y) const {
+    const uint32_t hash = (static_cast<uint32_t>(cell_x) * 73856093u) ^
+                          (static_cast<uint32_t>(cell_y) * 19349663u);
+    return hash & bucket_mask;
+  }
+
+  void SpatialHash::Clear() {
+    bucket_mask = 0u;
+    bucket_offsets.clear();
+    entries.clear();
+    unsorted_entries.clear();
+    entry_buckets.clear();
+  }
+
+  void SpatialHash::Build(const SimulationState &simulation_state) {
+    const std::vector<ActorId> &actor_ids = simulation_state.GetActorIds();
+    const std::vector<cg::Location> &locations = simulation_state.GetLocations();
+    const size_t number_of_actors = actor_ids.size();
+
+    // Twice as many buckets as actors keeps collisions between cells low.
+    uint32_t bucket_count = MIN_BUCKET_COUNT;
+    while (bucket_count < 2u * number_of_actors) {
+      bucket_count <<= 1u;
+    }
+    bucket_mask = bucket_count - 1u;
+    bucket_offsets.assign(bucket_count + 1u, 0u);
+
+    unsorted_entries.clear();
+    entry_buckets.clear();
+    for (uint32_t index = 0u; index < number_of_actors; ++index) {
+      const cg::Location &location = locations[index];
+      const int32_t cell_x = GetCellCoordinate(location.x);
+      const int32_t cell_y = GetCellCoordinate(location.y);
+      const uint32_t bucket = GetBucket(cell_x, cell_y);
+      unsorted_entries.push_back({actor_ids[index], ActorSlot{index}, location, cell_x, cell_y});
+      entry_buckets.push_back(bucket);
+      ++bucket_offsets[bucket];
+    }
+
+    // Inclusive prefix sum, bucket_offsets[i] is now the end of bucket i.
+    for (uint32_t i = 1u; i <= bucket_count; ++i) {
+      bucket_offsets[i] += bucket_offsets[i - 1u];
+    }
+
+    // Scatter the entries backwards using the end of each bucket as cursor,
+    // which leaves bucket_offsets[i] pointing to the beginning of bucket i.
+    entries.resize(number_of_actors);
+    for (size_t i = unsorted_entries.size(); i > 0u; --i) {
+      const uint32_t position = --bucket_offsets[entry_buckets[i - 1u]];
+      entries[position] = unsorted_entries[i - 1u];
+    }
+  }
+
+  void SpatialHash::Query(const cg::Location &location,
+                          const float radius_squared,
+                          std::vector<SpatialHashHit> &hits) const {
+    hits.clear();
+    if (entries.empty()) {
+      return;
+    }
+
+    auto test_entry = [&](const Entry &entry) {
+      const float distance_squared = cg::Math::DistanceSquared(entry.location, location);
+      if (distance_squared < radius_squared) {
+        hits.push_back({entry.actor_id, entry.slot, entry.location, distance_squared});
+      }
+    };
+
+    const float radius = std::sqrt(radius_squared);
+    const int32_t min_x = GetCellCoordinate(location.x - radius);
+    const int32_t max_x = GetCellCoordinate(location.x + radius);
+    const int32_t min_y = GetCellCoordinate(location.y - radius);
+    const int32_t max_y = GetCellCoordinate(location.y + radius);
+    const uint64_t number_of_cells = static_cast<uint64_t>(max_x - min_x + 1) *
+                                     static_cast<uint64_t>(max_y - min_y + 1);
+
+    // When the query covers more cells than there are buckets, scanning every
+    // entry is cheaper and visits each actor once.
+    if (number_of_cells > bucket_mask) {
+      for (const Entry &entry : entries) {
+        test_entry(entry);
+      }
+      return;
+    }
+
+    for (int32_t cell_x = min_x; cell_x <= max_x; ++cell_x) {
+      for (int32_t cell_y = min_y; cell_y <= max_y; ++cell_y) {
+        const uint32_t bucket = GetBucket(cell_x, cell_y);
+        for (uint32_t i = bucket_offsets[bucket]; i < bucket_offsets[bucket + 1u]; ++i) {
+          const Entry &entry = entries[i];
+          // Different cells may share a bucket, only take the entries of this
+          // cell so that no actor is reported twice.
+          if (entry.cell_x == cell_x && entry.cell_y == cell_y) {
+            test_entry(entry);
+          }
+        }
+      }
+    }
+  }
+
+} // namespace traffic_manager
+} // namespace carla
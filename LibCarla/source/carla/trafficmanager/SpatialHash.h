@@ -0,0 +1,87 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/rpc/ActorId.h"
+
+#include "carla/trafficmanager/SimulationState.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  using ActorId = carla::ActorId;
+
+  /// Actor found by SpatialHash::Query.
+  struct SpatialHashHit {
+    ActorId actor_id;
+    ActorSlot slot;
+    cg::Location location;
+    float distance_squared;
+  };
+
+  /// Uniform grid over the positions of every actor in the SimulationState,
+  /// hashed into a fixed number of buckets. It is rebuilt once per tick with
+  /// a counting sort into flat arrays, so queries only touch the buckets of
+  /// the cells around the query point and never allocate once the caller's
+  /// hit buffer has grown to its working size.
+  class SpatialHash {
+
+  public:
+
+    explicit SpatialHash(float cell_size);
+
+    /// Rebuilds the grid with the current location of every actor. Memory
+    /// from previous builds is reused.
+    void Build(const SimulationState &simulation_state);
+
+    void Clear();
+
+    size_t Size() const {
+      return entries.size();
+    }
+
+    /// Replaces the contents of @a hits with the actors whose distance to
+    /// @a location is strictly lower than sqrt(@a radius_squared). Hits are
+    /// not sorted.
+    void Query(const cg::Location &location,
+               float radius_squared,
+               std::vector<SpatialHashHit> &hits) const;
+
+  private:
+
+    struct Entry {
+      ActorId actor_id;
+      ActorSlot slot;
+      cg::Location location;
+      int32_t cell_x;
+      int32_t cell_y;
+    };
+
+    int32_t GetCellCoordinate(float value) const;
+
+    uint32_t GetBucket(int32_t cell_x, int32_t cell_y) const;
+
+    const float cell_size;
+    const float inv_cell_size;
+    uint32_t bucket_mask = 0u;
+
+    /// Entries of bucket i are entries[bucket_offsets[i], bucket_offsets[i+1]).
+    std::vector<uint32_t> bucket_offsets;
+    std::vector<Entry> entries;
+    /// Scratch storage used while building.
+    std::vector<Entry> unsorted_entries;
+    std::vector<uint32_t> entry_buckets;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -12,16 +12,17 @@ using constants::TrackTraffic::INV_BUFFER_STEP_THROUGH;
 TrackTraffic::TrackTraffic() {}
 
 void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
-                                                  const std::vector<SimpleWaypointPtr> waypoints) {
+                                                  const std::vector<NodeIndex> &nodes,
+                                                  const WaypointGraph &graph) {
 
     DeleteActor(actor_id);
 
     std::unordered_set<GeoGridId> current_grids;
     // Step through waypoints and update grid list for actor and actor list for grids.
-    for (auto &waypoint : waypoints) {
-        UpdatePassingVehicle(waypoint->GetId(), actor_id);
+    for (const NodeIndex node : nodes) {
+        UpdatePassingVehicle(graph.GetWaypointId(node), actor_id);
 
-        GeoGridId ggid = waypoint->GetGeodesicGridId();
+        GeoGridId ggid = graph.GetGeodesicGridId(node);
         current_grids.insert(ggid);
 
         if (grid_to_actors.find(ggid) != grid_to_actors.end()) {
@@ -37,7 +38,8 @@ void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
     actor_to_grids.insert({actor_id, current_grids});
 }
 
-void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
+void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer,
+                                      const WaypointGraph &graph) {
     if (!buffer.empty()) {
 
         // Clear current actor from all grids containing itself.
@@ -57,8 +59,7 @@ void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buff
         std::unordered_set<GeoGridId> current_grids;
         uint64_t buffer_size = buffer.size();
         for (uint64_t i = 0u; i <= buffer_size - 1u; ++i) {
-            auto waypoint = buffer.at(i);
-            GeoGridId ggid = waypoint->GetGeodesicGridId();
+            GeoGridId ggid = graph.GetGeodesicGridId(buffer.at(i));
             current_grids.insert(ggid);
             // Add grid entry if not present.
             if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
@@ -114,6 +115,21 @@ ActorIdSet TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
     return actor_id_set;
 }
 
+bool TrackTraffic::IsOverlapping(ActorId actor_id, ActorId other_id) const {
+    const auto actor_grids = actor_to_grids.find(actor_id);
+    if (actor_grids != actor_to_grids.end()) {
+        for (auto &grid_id : actor_grids->second) {
+            const auto grid_actors = grid_to_actors.find(grid_id);
+            if (grid_actors != grid_to_actors.end()
+                && grid_actors->second.find(other_id) != grid_actors->second.end()) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 void TrackTraffic::DeleteActor(ActorId actor_id) {
     if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
         std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
@@ -4,7 +4,9 @@
 #include "carla/road/RoadTypes.h"
 #include "carla/rpc/ActorId.h"
 
+#include "carla/trafficmanager/PathBuffer.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/WaypointGraph.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -12,7 +14,7 @@ namespace traffic_manager {
 using ActorId = carla::ActorId;
 using ActorIdSet = std::unordered_set<ActorId>;
 using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-using Buffer = std::deque<SimpleWaypointPtr>;
+using Buffer = PathBuffer;
 using GeoGridId = carla::road::JuncId;
 
 // This class is used to track the waypoint occupancy of all the actors.
@@ -44,11 +46,16 @@ public:
     void RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
     ActorIdSet GetPassingVehicles(uint64_t waypoint_id) const;
 
-    void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer);
+    void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer,
+                            const WaypointGraph &graph);
     void UpdateUnregisteredGridPosition(const ActorId actor_id,
-                                        const std::vector<SimpleWaypointPtr> waypoints);
+                                        const std::vector<NodeIndex> &nodes,
+                                        const WaypointGraph &graph);
 
     ActorIdSet GetOverlappingVehicles(ActorId actor_id) const;
+    /// Whether @a other_id is among GetOverlappingVehicles(@a actor_id),
+    /// without building the set.
+    bool IsOverlapping(ActorId actor_id, ActorId other_id) const;
     bool IsGeoGridFree(const GeoGridId geogrid_id) const;
     void AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id);
 
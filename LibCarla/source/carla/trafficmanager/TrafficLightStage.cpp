@@ -16,6 +16,7 @@ TrafficLightStage::TrafficLightStage(
   const std::vector<ActorId> &vehicle_id_list,
   const SimulationState &simulation_state,
   const BufferMap &buffer_map,
+  const LocalMapPtr &local_map,
   const Parameters &parameters,
   const cc::World &world,
   TLFrame &output_array,
@@ -23,6 +24,7 @@ TrafficLightStage::TrafficLightStage(
   : vehicle_id_list(vehicle_id_list),
     simulation_state(simulation_state),
     buffer_map(buffer_map),
+    local_map(local_map),
     parameters(parameters),
     world(world),
     output_array(output_array),
@@ -32,7 +34,8 @@ void TrafficLightStage::Update(const unsigned long index) {
   bool traffic_light_hazard = false;
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (!simulation_state.IsDormant(ego_actor_id)) {
+  const ActorSlot ego_slot = simulation_state.GetSlot(ego_actor_id);
+  if (!simulation_state.IsDormant(ego_slot)) {
 
     JunctionID current_junction_id = -1;
     if (vehicle_last_junction.find(ego_actor_id) != vehicle_last_junction.end()) {
@@ -42,7 +45,7 @@ void TrafficLightStage::Update(const unsigned long index) {
 
     current_timestamp = world.GetSnapshot().GetTimestamp();
 
-    const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id);
+    const TrafficLightState tl_state = simulation_state.GetTLS(ego_slot);
     const TLS traffic_light_state = tl_state.tl_state;
     const bool is_at_traffic_light = tl_state.at_traffic_light;
 
@@ -130,12 +133,13 @@ bool TrafficLightStage::HandleNonSignalisedJunction(const ActorId ego_actor_id,
 }
 
 JunctionID TrafficLightStage::GetAffectedJunctionId(const ActorId ego_actor_id) {
-    const Buffer &waypoint_buffer = buffer_map.at(ego_actor_id);
-    const SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
-    const auto front_point = waypoint_buffer.front();
+    const WaypointGraph &graph = local_map->GetGraph();
+    const Buffer &waypoint_buffer = buffer_map.Get(ego_actor_id);
+    const NodeIndex look_ahead_point = GetTargetWaypoint(graph, waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
+    const NodeIndex front_point = waypoint_buffer.front();
 
-    auto look_ahead_junction_id = look_ahead_point->GetJunctionId();
-    auto front_junction_id = front_point->GetJunctionId();
+    auto look_ahead_junction_id = graph.GetJunctionId(look_ahead_point);
+    auto front_junction_id = graph.GetJunctionId(front_point);
 
     // Check if the vehicle is currently at a non-signalized junction
     JunctionID current_junction_id = -1;
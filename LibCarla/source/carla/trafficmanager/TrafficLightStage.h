@@ -2,6 +2,7 @@
 #pragma once
 
 #include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
@@ -10,6 +11,8 @@
 namespace carla {
 namespace traffic_manager {
 
+using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+
 /// This class has functionality for responding to traffic lights
 /// and managing entry into non-signalized junctions.
 class TrafficLightStage: Stage {
@@ -17,6 +20,7 @@ private:
   const std::vector<ActorId> &vehicle_id_list;
   const SimulationState &simulation_state;
   const BufferMap &buffer_map;
+  const LocalMapPtr &local_map;
   const Parameters &parameters;
   const cc::World &world;
 
@@ -48,6 +52,7 @@ public:
   TrafficLightStage(const std::vector<ActorId> &vehicle_id_list,
                     const SimulationState &Simulation_state,
                     const BufferMap &buffer_map,
+                    const LocalMapPtr &local_map,
                     const Parameters &parameters,
                     const cc::World &world,
                     TLFrame &output_array,
@@ -65,6 +65,15 @@ public:
     }
   }
 
+  /// Method to set the number of threads running the per vehicle stage loops.
+  /// A value of 1 keeps the sequential execution, 0 uses all hardware threads.
+  void SetWorkerThreads(const uint64_t number_of_threads) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetWorkerThreads(number_of_threads);
+    }
+  }
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     TrafficManagerBase* tm_ptr = GetTM(_port);
@@ -8,6 +8,7 @@
 
 #include "carla/Logging.h"
 
+#include "carla/client/FileTransfer.h"
 #include "carla/client/detail/Simulator.h"
 
 #include "carla/trafficmanager/TrafficManagerLocal.h"
@@ -16,6 +17,7 @@ namespace carla {
 namespace traffic_manager {
 
 using namespace constants::FrameMemory;
+using constants::StageWorkers::MIN_VEHICLES_PER_WORKER;
 
 TrafficManagerLocal::TrafficManagerLocal(
   std::vector<float> longitudinal_PID_parameters,
@@ -44,41 +46,44 @@ TrafficManagerLocal::TrafficManagerLocal(
                                          localization_frame,
                                          random_device)),
 
-    collision_stage(CollisionStage(vehicle_id_list,
-                                   simulation_state,
-                                   buffer_map,
-                                   track_traffic,
-                                   parameters,
-                                   collision_frame,
-                                   random_device)),
+    collision_stage(vehicle_id_list,
+                    simulation_state,
+                    buffer_map,
+                    track_traffic,
+                    local_map,
+                    parameters,
+                    collision_frame,
+                    random_device),
 
     traffic_light_stage(TrafficLightStage(vehicle_id_list,
                                           simulation_state,
                                           buffer_map,
+                                          local_map,
                                           parameters,
                                           world,
                                           tl_frame,
                                           random_device)),
 
-    motion_plan_stage(MotionPlanStage(vehicle_id_list,
-                                      simulation_state,
-                                      parameters,
-                                      buffer_map,
-                                      track_traffic,
-                                      longitudinal_PID_parameters,
-                                      longitudinal_highway_PID_parameters,
-                                      lateral_PID_parameters,
-                                      lateral_highway_PID_parameters,
-                                      localization_frame,
-                                      collision_frame,
-                                      tl_frame,
-                                      world,
-                                      control_frame,
-                                      random_device,
-                                      local_map)),
+    motion_plan_stage(vehicle_id_list,
+                      simulation_state,
+                      parameters,
+                      buffer_map,
+                      track_traffic,
+                      longitudinal_PID_parameters,
+                      longitudinal_highway_PID_parameters,
+                      lateral_PID_parameters,
+                      lateral_highway_PID_parameters,
+                      localization_frame,
+                      collision_frame,
+                      tl_frame,
+                      world,
+                      control_frame,
+                      random_device,
+                      local_map),
 
     vehicle_light_stage(VehicleLightStage(vehicle_id_list,
                                           buffer_map,
+                                          local_map,
                                           parameters,
                                           world,
                                           control_frame)),
@@ -117,18 +122,102 @@ void TrafficManagerLocal::SetupLocalMap() {
   const carla::SharedPtr<const cc::Map> world_map = world.GetMap();
   local_map = std::make_shared<InMemoryMap>(world_map);
 
+  // An image cooked by a previous run on this map is used in place.
+  const std::string image_path = cc::FileTransfer::GetFullPath(local_map->GetImageFileName());
+  if (local_map->Open(image_path)) {
+    return;
+  }
+
+  bool is_loaded = false;
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
   if (!files.empty()) {
     auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
-    if (content.size() != 0) {
-      local_map->Load(content);
-    } else {
-      log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-      local_map->SetUp();
-    }
-  } else {
+    is_loaded = content.size() != 0 && local_map->Load(content);
+  }
+  if (!is_loaded) {
     log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
     local_map->SetUp();
+    // Cook the image so the next traffic manager attaching to this map skips
+    // the set up.
+    local_map->Save(image_path);
+  }
+}
+
+void TrafficManagerLocal::UpdateStageWorkers() {
+  uint64_t requested_threads = parameters.GetWorkerThreads();
+  if (requested_threads == 0u) {
+    requested_threads = std::max(static_cast<uint64_t>(std::thread::hardware_concurrency()), uint64_t{1u});
+  }
+  if (requested_threads == stage_worker_threads) {
+    return;
+  }
+  stage_worker_pool.reset();
+  if (requested_threads > 1u) {
+    // The TM worker thread takes one share of the work itself.
+    stage_worker_pool = std::make_unique<ThreadPool>();
+    stage_worker_pool->AsyncRun(requested_threads - 1u);
+  }
+  stage_worker_threads = requested_threads;
+}
+
+unsigned long TrafficManagerLocal::GetNumberOfStageChunks() const {
+  if (stage_worker_pool == nullptr) {
+    return 1u;
+  }
+  return std::max(std::min(static_cast<unsigned long>(stage_worker_threads),
+                           vehicle_id_list.size() / MIN_VEHICLES_PER_WORKER),
+                  1ul);
+}
+
+template <typename Functor>
+void TrafficManagerLocal::ParallelStageUpdate(Functor &&update) {
+  const unsigned long number_of_vehicles = vehicle_id_list.size();
+  const unsigned long number_of_chunks = GetNumberOfStageChunks();
+
+  if (number_of_chunks < 2u) {
+    for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+      update(index);
+    }
+    return;
+  }
+
+  // Contiguous index ranges, each vehicle is handled by exactly one thread.
+  const unsigned long chunk_size = (number_of_vehicles + number_of_chunks - 1u) / number_of_chunks;
+  std::vector<std::future<void>> pending_chunks;
+  pending_chunks.reserve(number_of_chunks - 1u);
+  for (unsigned long begin = chunk_size; begin < number_of_vehicles; begin += chunk_size) {
+    const unsigned long end = std::min(begin + chunk_size, number_of_vehicles);
+    pending_chunks.emplace_back(stage_worker_pool->Post([&update, begin, end]() {
+      for (unsigned long index = begin; index < end; ++index) {
+        update(index);
+      }
+    }));
+  }
+  for (unsigned long index = 0u; index < chunk_size; ++index) {
+    update(index);
+  }
+  // Wait for every chunk, re-throwing the exceptions raised by the workers.
+  for (auto &chunk : pending_chunks) {
+    chunk.get();
+  }
+}
+
+void TrafficManagerLocal::SendControlFrame(const bool synchronous_mode) {
+  control_batch.clear();
+  control_batch.reserve(control_frame.size());
+  other_commands.clear();
+  for (const carla::rpc::Command &command : control_frame) {
+    const auto *control = boost::variant2::get_if<carla::rpc::Command::ApplyVehicleControl>(&command.command);
+    if (control != nullptr) {
+      control_batch.Add(control->actor, control->control);
+    } else {
+      other_commands.push_back(command);
+    }
+  }
+
+  // In synchronous mode the call also tells the simulator the TM is done.
+  if (synchronous_mode || !control_batch.empty() || !other_commands.empty()) {
+    episode_proxy.Lock()->ApplyVehicleControlBatchSync(control_batch, other_commands, false);
   }
 }
 
@@ -218,18 +307,35 @@ void TrafficManagerLocal::Run() {
     // that will be inserted by the motion_plan_stage stage.
     control_frame.resize(number_of_vehicles);
 
+    UpdateStageWorkers();
+    random_device.UpdateActorStreams(vehicle_id_list);
+
     // Run core operation stages.
+    // Localization and traffic light response depend on the order in which
+    // vehicles claim lanes and junctions, so they run sequentially. Collision
+    // avoidance and motion planning only write to the vehicle's own frame slot
+    // and are split among the stage workers.
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
       localization_stage.Update(index);
     }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+    collision_stage.PrepareCycle();
+    // Run serially, vehicles draw from the shared random stream in order.
+    collision_stage.SetUseActorRandomStreams(GetNumberOfStageChunks() > 1u);
+    ParallelStageUpdate([this](const unsigned long index) {
       collision_stage.Update(index);
-    }
+    });
     collision_stage.ClearCycleCache();
     vehicle_light_stage.UpdateWorldInfo();
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
       traffic_light_stage.Update(index);
+    }
+    // Run serially, dormant vehicles respawn in order as they are updated.
+    motion_plan_stage.SetDeferDormantRespawns(GetNumberOfStageChunks() > 1u);
+    ParallelStageUpdate([this](const unsigned long index) {
       motion_plan_stage.Update(index);
+    });
+    motion_plan_stage.RespawnDormantVehicles();
+    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
       vehicle_light_stage.Update(index);
     }
 
@@ -237,12 +343,12 @@ void TrafficManagerLocal::Run() {
 
     // Sending the current cycle's batch command to the simulator.
     if (synchronous_mode) {
-      episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+      SendControlFrame(true);
       step_end.store(true);
       step_end_trigger.notify_one();
     } else {
       if (control_frame.size() > 0){
-        episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+        SendControlFrame(false);
       }
     }
   }
@@ -273,6 +379,8 @@ void TrafficManagerLocal::Stop() {
     }
     worker_thread.release();
   }
+  stage_worker_pool.reset();
+  stage_worker_threads = 1u;
 
   vehicle_id_list.clear();
   registered_vehicles.Clear();
@@ -287,7 +395,7 @@ void TrafficManagerLocal::Stop() {
   traffic_light_stage.Reset();
   motion_plan_stage.Reset();
 
-  buffer_map.clear();
+  buffer_map.Clear();
   localization_frame.clear();
   collision_frame.clear();
   tl_frame.clear();
@@ -411,6 +519,10 @@ void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerLocal::SetWorkerThreads(const uint64_t number_of_threads) {
+  parameters.SetWorkerThreads(number_of_threads);
+}
+
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
 }
@@ -448,10 +560,14 @@ void TrafficManagerLocal::SetMaxBoundaries(const float lower, const float upper)
 }
 
 Action TrafficManagerLocal::GetNextAction(const ActorId &actor_id) {
+  // The path buffers live in an arena that the TM thread grows while it holds
+  // the registration lock, so they are only read under the same lock.
+  std::lock_guard<std::mutex> registration_lock(registration_mutex);
   return localization_stage.ComputeNextAction(actor_id);
 }
 
 ActionBuffer TrafficManagerLocal::GetActionBuffer(const ActorId &actor_id) {
+  std::lock_guard<std::mutex> registration_lock(registration_mutex);
   return localization_stage.ComputeActionBuffer(actor_id);
 }
 
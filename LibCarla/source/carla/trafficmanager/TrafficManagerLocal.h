@@ -16,7 +16,9 @@
 #include "carla/client/TrafficLight.h"
 #include "carla/client/World.h"
 #include "carla/Memory.h"
+#include "carla/ThreadPool.h"
 #include "carla/rpc/Command.h"
+#include "carla/rpc/VehicleControlBatch.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/InMemoryMap.h"
@@ -86,6 +88,10 @@ private:
   TLFrame tl_frame;
   /// Array to hold output data of motion planning.
   ControlFrame control_frame;
+  /// Vehicle controls of the control frame, sent to the simulator columnar.
+  carla::rpc::VehicleControlBatch control_batch;
+  /// Commands of the control frame other than vehicle controls.
+  ControlFrame other_commands;
   /// Variable to keep track of currently reserved array space for frames.
   uint64_t current_reserved_capacity {0u};
   /// Various stages representing core operations of traffic manager.
@@ -109,6 +115,11 @@ private:
   std::condition_variable step_end_trigger;
   /// Single worker thread for sequential execution of sub-components.
   std::unique_ptr<std::thread> worker_thread;
+  /// Pool of threads sharing the per vehicle loops of the stages with the
+  /// worker thread. Null when the stages run sequentially.
+  std::unique_ptr<ThreadPool> stage_worker_pool;
+  /// Number of threads, including the worker thread, running the stage loops.
+  uint64_t stage_worker_threads {1u};
   /// Randomization seed.
   uint64_t seed {static_cast<uint64_t>(time(NULL))};
   /// Structure holding random devices per vehicle.
@@ -120,6 +131,25 @@ private:
   /// Method to check if all traffic lights are frozen in a group.
   bool CheckAllFrozen(TLGroup tl_to_freeze);
 
+  /// Method to (re)create the stage worker pool if the number of worker
+  /// threads requested through the parameters has changed.
+  void UpdateStageWorkers();
+
+  /// Method to get the number of threads the stage loops are split among in
+  /// the current cycle; one means they run serially.
+  unsigned long GetNumberOfStageChunks() const;
+
+  /// Method to run @a update for every registered vehicle index, splitting
+  /// the indices among the stage workers. Returns once all of them are done,
+  /// acting as a barrier between stages.
+  template <typename Functor>
+  void ParallelStageUpdate(Functor &&update);
+
+  /// Method to send the control frame to the simulator in a single call. The
+  /// vehicle controls go in a VehicleControlBatch, followed by any other
+  /// command.
+  void SendControlFrame(bool synchronous_mode);
+
 public:
   /// Private constructor for singleton lifecycle management.
   TrafficManagerLocal(std::vector<float> longitudinal_PID_parameters,
@@ -245,6 +275,9 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads running the per vehicle stage loops.
+  void SetWorkerThreads(const uint64_t number_of_threads);
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer);
 
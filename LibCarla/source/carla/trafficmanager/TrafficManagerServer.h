@@ -203,6 +203,11 @@ public:
         tm->SetOSMMode(mode_switch);
       });
 
+      /// Method to set the number of threads running the per vehicle stage loops.
+      server->bind("set_worker_threads", [=](const uint64_t number_of_threads) {
+        tm->SetWorkerThreads(number_of_threads);
+      });
+
       /// Method to set our own imported path.
       server->bind("set_path", [=](carla::rpc::Actor actor, const Path path, const bool empty_buffer) {
         tm->SetCustomPath(carla::client::detail::ActorVariant(actor).Get(tm->GetEpisodeProxy()), path, empty_buffer);
@@ -12,11 +12,13 @@ using namespace constants::VehicleLight;
 VehicleLightStage::VehicleLightStage(
   const std::vector<ActorId> &vehicle_id_list,
   const BufferMap &buffer_map,
+  const LocalMapPtr &local_map,
   const Parameters &parameters,
   const cc::World &world,
   ControlFrame& control_frame)
   : vehicle_id_list(vehicle_id_list),
     buffer_map(buffer_map),
+    local_map(local_map),
     parameters(parameters),
     world(world),
     control_frame(control_frame) {}
@@ -52,17 +54,18 @@ void VehicleLightStage::Update(const unsigned long index) {
 
   // Determine if the vehicle is truning left or right by checking the close waypoints
 
-  const Buffer& waypoint_buffer = buffer_map.at(actor_id);
-  cg::Location front_location = waypoint_buffer.front()->GetLocation();
+  const WaypointGraph &graph = local_map->GetGraph();
+  const Buffer& waypoint_buffer = buffer_map.Get(actor_id);
+  cg::Location front_location = graph.GetLocation(waypoint_buffer.front());
 
-  for (const SimpleWaypointPtr& waypoint : waypoint_buffer) {
-    if (waypoint->CheckJunction()) {
-      RoadOption target_ro = waypoint->GetRoadOption();
+  for (const NodeIndex waypoint : waypoint_buffer) {
+    if (graph.CheckJunction(waypoint)) {
+      RoadOption target_ro = graph.GetRoadOption(waypoint);
       if (target_ro == RoadOption::Left) left_turn_indicator = true;
       else if (target_ro == RoadOption::Right) right_turn_indicator = true;
       break;
     }
-    if (cg::Math::DistanceSquared(front_location, waypoint->GetLocation()) > MAX_DISTANCE_LIGHT_CHECK) {
+    if (graph.DistanceSquared(waypoint, front_location) > MAX_DISTANCE_LIGHT_CHECK) {
       break;
     }
   }
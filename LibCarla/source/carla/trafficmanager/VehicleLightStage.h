@@ -2,6 +2,7 @@
 #pragma once
 
 #include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
@@ -10,12 +11,15 @@
 namespace carla {
 namespace traffic_manager {
 
+using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+
 /// This class has functionality for turning on/off the vehicle lights
 /// according to the current vehicle state and its surrounding environment.
 class VehicleLightStage: Stage {
 private:
   const std::vector<ActorId> &vehicle_id_list;
   const BufferMap &buffer_map;
+  const LocalMapPtr &local_map;
   const Parameters &parameters;
   const cc::World &world;
   ControlFrame& control_frame;
@@ -27,6 +31,7 @@ private:
 public:
   VehicleLightStage(const std::vector<ActorId> &vehicle_id_list,
                     const BufferMap &buffer_map,
+                    const LocalMapPtr &local_map,
                     const Parameters &parameters,
                     const cc::World &world,
                     ControlFrame& control_frame);
@@ -0,0 +1,146 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/Debug.h"
+
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  void WaypointGraph::Clear() {
+    locations.Clear();
+    rotations.Clear();
+    forward_vectors.Clear();
+    right_vectors.Clear();
+    waypoint_ids.Clear();
+    road_ids.Clear();
+    section_ids.Clear();
+    lane_ids.Clear();
+    distances.Clear();
+    lane_widths.Clear();
+    junction_flags.Clear();
+    junction_ids.Clear();
+    geodesic_grid_ids.Clear();
+    road_options.Clear();
+    left_nodes.Clear();
+    right_nodes.Clear();
+    successor_offsets.Clear();
+    successor_nodes.Clear();
+    predecessor_offsets.Clear();
+    predecessor_nodes.Clear();
+  }
+
+  void WaypointGraph::Build(const std::vector<SimpleWaypointPtr> &nodes) {
+    Clear();
+
+    const size_t number_of_nodes = nodes.size();
+    std::vector<cg::Location> node_locations;
+    std::vector<cg::Rotation> node_rotations;
+    std::vector<cg::Vector3D> node_forward_vectors;
+    std::vector<cg::Vector3D> node_right_vectors;
+    std::vector<uint64_t> node_waypoint_ids;
+    std::vector<crd::RoadId> node_road_ids;
+    std::vector<crd::SectionId> node_section_ids;
+    std::vector<crd::LaneId> node_lane_ids;
+    std::vector<double> node_distances;
+    std::vector<float> node_lane_widths;
+    std::vector<uint8_t> node_junction_flags;
+    std::vector<GeoGridId> node_junction_ids;
+    std::vector<GeoGridId> node_geodesic_grid_ids;
+    std::vector<RoadOption> node_road_options;
+    std::vector<NodeIndex> node_left_nodes;
+    std::vector<NodeIndex> node_right_nodes;
+    std::vector<uint32_t> node_successor_offsets;
+    std::vector<NodeIndex> node_successor_nodes;
+    std::vector<uint32_t> node_predecessor_offsets;
+    std::vector<NodeIndex> node_predecessor_nodes;
+
+    node_locations.reserve(number_of_nodes);
+    node_rotations.reserve(number_of_nodes);
+    node_forward_vectors.reserve(number_of_nodes);
+    node_right_vectors.reserve(number_of_nodes);
+    node_waypoint_ids.reserve(number_of_nodes);
+    node_road_ids.reserve(number_of_nodes);
+    node_section_ids.reserve(number_of_nodes);
+    node_lane_ids.reserve(number_of_nodes);
+    node_distances.reserve(number_of_nodes);
+    node_lane_widths.reserve(number_of_nodes);
+    node_junction_flags.reserve(number_of_nodes);
+    node_junction_ids.reserve(number_of_nodes);
+    node_geodesic_grid_ids.reserve(number_of_nodes);
+    node_road_options.reserve(number_of_nodes);
+    node_left_nodes.reserve(number_of_nodes);
+    node_right_nodes.reserve(number_of_nodes);
+    node_successor_offsets.reserve(number_of_nodes + 1u);
+    node_predecessor_offsets.reserve(number_of_nodes + 1u);
+
+    auto index_of = [](const SimpleWaypointPtr &swp) {
+      return swp != nullptr ? swp->GetIndex() : INVALID_NODE;
+    };
+
+    node_successor_offsets.push_back(0u);
+    node_predecessor_offsets.push_back(0u);
+    for (const SimpleWaypointPtr &swp : nodes) {
+      DEBUG_ASSERT(swp->GetIndex() == node_locations.size());
+
+      const WaypointPtr raw_waypoint = swp->GetWaypoint();
+      const cg::Transform transform = swp->GetTransform();
+      node_locations.push_back(transform.location);
+      node_rotations.push_back(transform.rotation);
+      node_forward_vectors.push_back(swp->GetForwardVector());
+      node_right_vectors.push_back(transform.GetRightVector());
+      node_waypoint_ids.push_back(raw_waypoint->GetId());
+      node_road_ids.push_back(raw_waypoint->GetRoadId());
+      node_section_ids.push_back(raw_waypoint->GetSectionId());
+      node_lane_ids.push_back(raw_waypoint->GetLaneId());
+      node_distances.push_back(raw_waypoint->GetDistance());
+      node_lane_widths.push_back(swp->GetLaneWidth());
+      node_junction_flags.push_back(swp->CheckJunction() ? 1u : 0u);
+      node_junction_ids.push_back(swp->GetJunctionId());
+      node_geodesic_grid_ids.push_back(swp->GetGeodesicGridId());
+      node_road_options.push_back(swp->GetRoadOption());
+      node_left_nodes.push_back(index_of(swp->GetLeftWaypoint()));
+      node_right_nodes.push_back(index_of(swp->GetRightWaypoint()));
+
+      for (const SimpleWaypointPtr &next : swp->GetNextWaypoint()) {
+        node_successor_nodes.push_back(next->GetIndex());
+      }
+      node_successor_offsets.push_back(static_cast<uint32_t>(node_successor_nodes.size()));
+
+      for (const SimpleWaypointPtr &previous : swp->GetPreviousWaypoint()) {
+        node_predecessor_nodes.push_back(previous->GetIndex());
+      }
+      node_predecessor_offsets.push_back(static_cast<uint32_t>(node_predecessor_nodes.size()));
+    }
+
+    node_successor_nodes.shrink_to_fit();
+    node_predecessor_nodes.shrink_to_fit();
+
+    locations.Assign(std::move(node_locations));
+    rotations.Assign(std::move(node_rotations));
+    forward_vectors.Assign(std::move(node_forward_vectors));
+    right_vectors.Assign(std::move(node_right_vectors));
+    waypoint_ids.Assign(std::move(node_waypoint_ids));
+    road_ids.Assign(std::move(node_road_ids));
+    section_ids.Assign(std::move(node_section_ids));
+    lane_ids.Assign(std::move(node_lane_ids));
+    distances.Assign(std::move(node_distances));
+    lane_widths.Assign(std::move(node_lane_widths));
+    junction_flags.Assign(std::move(node_junction_flags));
+    junction_ids.Assign(std::move(node_junction_ids));
+    geodesic_grid_ids.Assign(std::move(node_geodesic_grid_ids));
+    road_options.Assign(std::move(node_road_options));
+    left_nodes.Assign(std::move(node_left_nodes));
+    right_nodes.Assign(std::move(node_right_nodes));
+    successor_offsets.Assign(std::move(node_successor_offsets));
+    successor_nodes.Assign(std::move(node_successor_nodes));
+    predecessor_offsets.Assign(std::move(node_predecessor_offsets));
+    predecessor_nodes.Assign(std::move(node_predecessor_nodes));
+  }
+
+} // namespace traffic_manager
+} // namespace carla
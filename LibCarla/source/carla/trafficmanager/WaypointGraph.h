@@ -0,0 +1,186 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+#include "carla/geom/Rotation.h"
+#include "carla/geom/Transform.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/ListView.h"
+#include "carla/road/RoadTypes.h"
+
+#include "carla/trafficmanager/FlatArray.h"
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+  namespace crd = carla::road;
+
+  /// Position of a waypoint inside the InMemoryMap dense topology.
+  using NodeIndex = uint32_t;
+  using NodeRange = ListView<const NodeIndex *>;
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+
+  /// Sentinel used where a SimpleWaypointPtr would be nullptr.
+  static constexpr NodeIndex INVALID_NODE = std::numeric_limits<NodeIndex>::max();
+
+  class InMemoryMapImage;
+
+  /// Flat, read-only view of the InMemoryMap used by the stages in the hot
+  /// path. Every attribute the stages read per tick is stored in its own
+  /// contiguous array indexed by NodeIndex, and connectivity is stored in
+  /// compressed sparse row form, so walking a path buffer touches a handful
+  /// of cache lines instead of chasing shared pointers through the
+  /// client::Waypoint cache. The arrays are either built from the dense
+  /// topology or viewed directly from a mapped InMemoryMapImage.
+  class WaypointGraph {
+
+  public:
+
+    /// Builds the graph from the dense topology. Every node must have its
+    /// index already set to its position in @a nodes.
+    void Build(const std::vector<SimpleWaypointPtr> &nodes);
+
+    void Clear();
+
+    size_t Size() const {
+      return locations.size();
+    }
+
+    bool IsValid(const NodeIndex node) const {
+      return node < locations.size();
+    }
+
+    const cg::Location &GetLocation(const NodeIndex node) const {
+      return locations[node];
+    }
+
+    const cg::Rotation &GetRotation(const NodeIndex node) const {
+      return rotations[node];
+    }
+
+    cg::Transform GetTransform(const NodeIndex node) const {
+      return cg::Transform(locations[node], rotations[node]);
+    }
+
+    const cg::Vector3D &GetForwardVector(const NodeIndex node) const {
+      return forward_vectors[node];
+    }
+
+    const cg::Vector3D &GetRightVector(const NodeIndex node) const {
+      return right_vectors[node];
+    }
+
+    /// Unique id of the underlying client::Waypoint.
+    uint64_t GetWaypointId(const NodeIndex node) const {
+      return waypoint_ids[node];
+    }
+
+    crd::RoadId GetRoadId(const NodeIndex node) const {
+      return road_ids[node];
+    }
+
+    crd::SectionId GetSectionId(const NodeIndex node) const {
+      return section_ids[node];
+    }
+
+    crd::LaneId GetLaneId(const NodeIndex node) const {
+      return lane_ids[node];
+    }
+
+    /// Distance of the waypoint along its road (OpenDRIVE s).
+    double GetDistance(const NodeIndex node) const {
+      return distances[node];
+    }
+
+    float GetLaneWidth(const NodeIndex node) const {
+      return lane_widths[node];
+    }
+
+    /// Whether the node belongs to a junction, as decided by the InMemoryMap.
+    bool CheckJunction(const NodeIndex node) const {
+      return junction_flags[node] != 0u;
+    }
+
+    /// OpenDRIVE junction id of the node, -1 outside junctions.
+    GeoGridId GetJunctionId(const NodeIndex node) const {
+      return junction_ids[node];
+    }
+
+    GeoGridId GetGeodesicGridId(const NodeIndex node) const {
+      return geodesic_grid_ids[node];
+    }
+
+    RoadOption GetRoadOption(const NodeIndex node) const {
+      return road_options[node];
+    }
+
+    NodeIndex GetLeftNode(const NodeIndex node) const {
+      return left_nodes[node];
+    }
+
+    NodeIndex GetRightNode(const NodeIndex node) const {
+      return right_nodes[node];
+    }
+
+    NodeRange GetSuccessors(const NodeIndex node) const {
+      return NodeRange(successor_nodes.data() + successor_offsets[node],
+                       successor_nodes.data() + successor_offsets[node + 1u]);
+    }
+
+    NodeRange GetPredecessors(const NodeIndex node) const {
+      return NodeRange(predecessor_nodes.data() + predecessor_offsets[node],
+                       predecessor_nodes.data() + predecessor_offsets[node + 1u]);
+    }
+
+    float DistanceSquared(const NodeIndex node, const cg::Location &location) const {
+      return cg::Math::DistanceSquared(locations[node], location);
+    }
+
+    float DistanceSquared(const NodeIndex node, const NodeIndex other) const {
+      return cg::Math::DistanceSquared(locations[node], locations[other]);
+    }
+
+  private:
+
+    friend class InMemoryMapImage;
+
+    FlatArray<cg::Location> locations;
+    FlatArray<cg::Rotation> rotations;
+    FlatArray<cg::Vector3D> forward_vectors;
+    FlatArray<cg::Vector3D> right_vectors;
+    FlatArray<uint64_t> waypoint_ids;
+    FlatArray<crd::RoadId> road_ids;
+    FlatArray<crd::SectionId> section_ids;
+    FlatArray<crd::LaneId> lane_ids;
+    FlatArray<double> distances;
+    FlatArray<float> lane_widths;
+    FlatArray<uint8_t> junction_flags;
+    FlatArray<GeoGridId> junction_ids;
+    FlatArray<GeoGridId> geodesic_grid_ids;
+    FlatArray<RoadOption> road_options;
+    FlatArray<NodeIndex> left_nodes;
+    FlatArray<NodeIndex> right_nodes;
+
+    /// Successors of node i are successor_nodes[successor_offsets[i], successor_offsets[i+1]).
+    FlatArray<uint32_t> successor_offsets;
+    FlatArray<NodeIndex> successor_nodes;
+    /// Predecessors of node i, same layout as the successors.
+    FlatArray<uint32_t> predecessor_offsets;
+    FlatArray<NodeIndex> predecessor_nodes;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,548 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+// Standalone benchmark of the streaming library over loopback. Sweeps the
+// message size, the number of streams, the number of subscribers per stream
+// and the mode of the server, and prints one line per combination with the
+// end-to-end latency percentiles, the throughput and the CPU time per byte,
+// as JSON or CSV, so runs can be compared with each other. "dropped" counts
+// the messages the server discarded for a slow subscriber, "lost" every
+// message that did not arrive.
+
+#include <carla/Buffer.h>
+#include <carla/ThreadGroup.h>
+#include <carla/streaming/Client.h>
+#include <carla/streaming/Server.h>
+#include <carla/streaming/detail/Telemetry.h>
+#include <carla/streaming/detail/Token.h>
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace carla::streaming;
+using namespace std::chrono_literals;
+
+using clock_type = std::chrono::steady_clock;
+
+static constexpr auto USAGE = R"(Usage: libcarla_benchmark_streaming [options]
+
+Options, lists are comma-separated and sizes accept K, M and G suffixes:
+  --sizes=LIST          message sizes (default 1K,16K,256K,1M,4M,16M,64M)
+  --streams=LIST        number of streams (default 1,4)
+  --subscribers=LIST    clients subscribed to every stream (default 1,4)
+  --modes=LIST          server modes, async and/or sync (default async,sync)
+  --messages=N          messages written per stream (default 200)
+  --max-bytes=SIZE      caps the bytes written per run, fewer messages are
+                        written of big sizes, but never less than 10 (default 4G)
+  --window=N            messages in flight per subscriber of a stream (default 4)
+  --threads=N           worker threads of the server and of each client (default 2)
+  --format=FORMAT       json (one object per line) or csv (default json)
+)";
+
+// =============================================================================
+// -- Settings -----------------------------------------------------------------
+// =============================================================================
+
+struct Settings {
+  std::vector<size_t> sizes = {
+      1u << 10u, 16u << 10u, 256u << 10u, 1u << 20u, 4u << 20u, 16u << 20u, 64u << 20u};
+
+  std::vector<size_t> streams = {1u, 4u};
+
+  std::vector<size_t> subscribers = {1u, 4u};
+
+  std::vector<bool> synchronous = {false, true};
+
+  size_t messages = 200u;
+
+  size_t max_bytes = size_t(4u) << 30u;
+
+  size_t window = 4u;
+
+  /// In-flight messages of a stream stop growing at this many bytes.
+  size_t max_bytes_in_flight = 256u << 20u;
+
+  size_t threads = 2u;
+
+  bool csv = false;
+};
+
+// The benchmark is built with the server library, without exceptions, so
+// parsing reports errors by returning false.
+static bool ParseSize(const std::string &text, size_t &value) {
+  if (text.empty() || (text[0u] < '0') || (text[0u] > '9')) {
+    return false;
+  }
+  errno = 0;
+  char *end = nullptr;
+  const auto number = std::strtoull(text.c_str(), &end, 10);
+  if (errno == ERANGE) {
+    return false;
+  }
+  const auto position = static_cast<size_t>(end - text.c_str());
+  if (position + 1u < text.size()) {
+    return false;
+  }
+  const auto suffix = position < text.size() ? text[position] : '\0';
+  switch (suffix) {
+    case 'K': case 'k': value = number << 10u; return true;
+    case 'M': case 'm': value = number << 20u; return true;
+    case 'G': case 'g': value = number << 30u; return true;
+    case '\0': value = number; return true;
+    default: return false;
+  }
+}
+
+static std::vector<std::string> Split(const std::string &text) {
+  std::vector<std::string> items;
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+static bool ParseSizes(const std::string &text, std::vector<size_t> &sizes) {
+  sizes.clear();
+  for (auto &item : Split(text)) {
+    size_t size;
+    if (!ParseSize(item, size)) {
+      return false;
+    }
+    sizes.emplace_back(size);
+  }
+  return true;
+}
+
+/// Returns false and sets @a error if an argument is not valid.
+static bool ParseArguments(int argc, char *argv[], Settings &settings, std::string &error) {
+  for (auto i = 1; i < argc; ++i) {
+    const std::string argument = argv[i];
+    const auto equal = argument.find('=');
+    const auto key = argument.substr(0u, equal);
+    const auto value = equal == std::string::npos ? std::string() : argument.substr(equal + 1u);
+    bool valid = true;
+    if (key == "--sizes") {
+      valid = ParseSizes(value, settings.sizes);
+    } else if (key == "--streams") {
+      valid = ParseSizes(value, settings.streams);
+    } else if (key == "--subscribers") {
+      valid = ParseSizes(value, settings.subscribers);
+    } else if (key == "--modes") {
+      settings.synchronous.clear();
+      for (auto &mode : Split(value)) {
+        if ((mode != "async") && (mode != "sync")) {
+          error = "unknown mode " + mode;
+          return false;
+        }
+        settings.synchronous.emplace_back(mode == "sync");
+      }
+    } else if (key == "--messages") {
+      valid = ParseSize(value, settings.messages);
+    } else if (key == "--max-bytes") {
+      valid = ParseSize(value, settings.max_bytes);
+    } else if (key == "--window") {
+      valid = ParseSize(value, settings.window);
+      settings.window = std::max<size_t>(1u, settings.window);
+    } else if (key == "--threads") {
+      valid = ParseSize(value, settings.threads);
+      settings.threads = std::max<size_t>(1u, settings.threads);
+    } else if (key == "--format") {
+      if ((value != "json") && (value != "csv")) {
+        error = "unknown format " + value;
+        return false;
+      }
+      settings.csv = (value == "csv");
+    } else {
+      error = "unknown option " + argument;
+      return false;
+    }
+    if (!valid) {
+      error = "invalid value in " + argument;
+      return false;
+    }
+  }
+  return true;
+}
+
+// =============================================================================
+// -- Benchmark ----------------------------------------------------------------
+// =============================================================================
+
+/// Written at the front of every message.
+struct MessageHeader {
+  uint64_t sent_at;
+
+  /// Warm-up messages are not measured.
+  uint64_t measured;
+};
+
+struct Configuration {
+  size_t message_size;
+  size_t streams;
+  size_t subscribers;
+  bool synchronous;
+  size_t messages;
+  size_t window;
+};
+
+struct Result {
+  size_t expected = 0u;
+  size_t received = 0u;
+  size_t dropped = 0u;
+  size_t bytes = 0u;
+  double seconds = 0.0;
+  double cpu_seconds = 0.0;
+  detail::LatencySnapshot latency;
+};
+
+static uint64_t Now() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      clock_type::now().time_since_epoch()).count());
+}
+
+class Benchmark {
+public:
+
+  explicit Benchmark(const Configuration &config, size_t threads)
+    : _config(config),
+      _server(0u) {
+    _server.SetSynchronousMode(config.synchronous);
+    _server.AsyncRun(threads);
+    for (auto i = 0u; i < config.subscribers; ++i) {
+      _clients.emplace_back(std::make_unique<Client>());
+      _clients.back()->AsyncRun(threads);
+    }
+    for (auto i = 0u; i < config.streams; ++i) {
+      _streams.emplace_back(std::make_unique<StreamState>(_server.MakeStream(), config.subscribers));
+    }
+    for (auto &state : _streams) {
+      for (auto j = 0u; j < _clients.size(); ++j) {
+        auto *stream = state.get();
+        auto *warm_up_counter = &state->warmed_up[j];
+        _clients[j]->Subscribe(state->stream.token(), [=](carla::Buffer message) {
+          OnMessage(message, *stream, *warm_up_counter);
+        });
+      }
+    }
+  }
+
+  ~Benchmark() {
+    // The callbacks of the clients use the rest of the members.
+    _clients.clear();
+  }
+
+  /// Returns nothing if the subscribers did not connect in time.
+  boost::optional<Result> Run() {
+    if (!WarmUp()) {
+      return boost::none;
+    }
+    Result result;
+    result.expected = _config.messages * _config.streams * _config.subscribers;
+    for (auto &state : _streams) {
+      state->dropped_before = GetDropped(*state);
+    }
+    const auto cpu_begin = std::clock();
+    const auto begin = clock_type::now();
+    _measuring = true;
+    {
+      carla::ThreadGroup writers;
+      for (auto &state : _streams) {
+        writers.CreateThread([this, stream=state.get()]() { Write(*stream); });
+      }
+    }
+    WaitForReceived([&]() {
+      return
+          (_messages_received.load() >= result.expected) ||
+          (_messages_received.load() + GetDropped() >= result.expected);
+    });
+    result.seconds = std::max(0.0, std::chrono::duration<double>(_last_received.load() - begin).count());
+    result.cpu_seconds = static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+    result.received = _messages_received;
+    result.dropped = GetDropped();
+    result.bytes = _bytes_received;
+    result.latency = _latency.Snapshot();
+    return result;
+  }
+
+private:
+
+  struct StreamState {
+    StreamState(Stream s, size_t subscribers)
+      : stream(std::move(s)),
+        warmed_up(subscribers) {}
+
+    Stream stream;
+
+    size_t sent = 0u;
+
+    /// Measured messages received, all subscribers included.
+    std::atomic_size_t received{0u};
+
+    /// Messages the server dropped before measuring.
+    size_t dropped_before = 0u;
+
+    std::vector<std::atomic_size_t> warmed_up;
+
+    bool IsWarmedUp() const {
+      return std::all_of(warmed_up.begin(), warmed_up.end(), [](auto &count) {
+        return count.load() > 0u;
+      });
+    }
+  };
+
+  void OnMessage(
+      const carla::Buffer &message,
+      StreamState &stream,
+      std::atomic_size_t &warmed_up) {
+    MessageHeader header;
+    std::memcpy(&header, message.data(), sizeof(header));
+    if ((header.measured == 0u) || !_measuring) {
+      ++warmed_up;
+    } else {
+      const auto now = Now();
+      _latency.Record(now > header.sent_at ? now - header.sent_at : 0u);
+      _bytes_received += message.size();
+      _last_received = clock_type::now();
+      ++stream.received;
+      ++_messages_received;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _condition.notify_all();
+  }
+
+  void WriteMessage(StreamState &state, bool measured) {
+    auto buffer = state.stream.MakeBuffer(_config.message_size);
+    buffer.reset(_config.message_size);
+    const MessageHeader header{Now(), measured ? 1u : 0u};
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    state.stream.Write(std::move(buffer));
+  }
+
+  /// Writes until every subscriber got a message of every stream, so all of
+  /// them are connected before measuring. Returns false if they did not
+  /// connect in time.
+  bool WarmUp() {
+    const auto deadline = clock_type::now() + 10s;
+    for (;;) {
+      const bool ready = std::all_of(_streams.begin(), _streams.end(), [](auto &state) {
+        return state->IsWarmedUp();
+      });
+      if (ready) {
+        break;
+      }
+      if (clock_type::now() > deadline) {
+        return false;
+      }
+      for (auto &state : _streams) {
+        if (!state->IsWarmedUp()) {
+          WriteMessage(*state, false);
+        }
+      }
+      std::this_thread::sleep_for(10ms);
+    }
+    // Let the last warm-up messages arrive.
+    std::this_thread::sleep_for(100ms);
+    return true;
+  }
+
+  /// Messages of @a state dropped by the server, every subscriber counts.
+  size_t GetDropped(const StreamState &state) {
+    const auto id = carla::streaming::detail::token_type(state.stream.token()).get_stream_id();
+    const auto telemetry = _server.GetTelemetry();
+    const auto it = telemetry.streams.find(id);
+    const auto dropped = it != telemetry.streams.end() ? it->second.dropped_messages : 0u;
+    return static_cast<size_t>(dropped) - std::min<size_t>(dropped, state.dropped_before);
+  }
+
+  size_t GetDropped() {
+    size_t dropped = 0u;
+    for (auto &state : _streams) {
+      dropped += GetDropped(*state);
+    }
+    return dropped;
+  }
+
+  /// Keeps at most the configured window of messages in flight per
+  /// subscriber. Messages dropped by the server keep counting as in flight,
+  /// otherwise the writer would refill the queue of the session as fast as it
+  /// drops them and measure only the drops.
+  void Write(StreamState &state) {
+    const auto max_in_flight = _config.window * _config.subscribers;
+    for (auto i = 0u; i < _config.messages; ++i) {
+      const bool has_room = WaitForReceived([&]() {
+        return state.sent * _config.subscribers - state.received.load() < max_in_flight;
+      });
+      if (!has_room) {
+        return; // the rest count as lost.
+      }
+      WriteMessage(state, true);
+      ++state.sent;
+    }
+  }
+
+  /// Waits until @a predicate is true, or until no message arrives for some
+  /// time, in which case returns false.
+  template <typename Predicate>
+  bool WaitForReceived(Predicate &&predicate) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto last_count = _messages_received.load();
+    auto last_progress = clock_type::now();
+    while (!predicate()) {
+      _condition.wait_for(lock, 100ms);
+      const auto count = _messages_received.load();
+      if (count != last_count) {
+        last_count = count;
+        last_progress = clock_type::now();
+      } else if (clock_type::now() - last_progress > 10s) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const Configuration _config;
+
+  Server _server;
+
+  std::vector<std::unique_ptr<Client>> _clients;
+
+  std::vector<std::unique_ptr<StreamState>> _streams;
+
+  std::atomic_bool _measuring{false};
+
+  std::atomic_size_t _messages_received{0u};
+
+  std::atomic_size_t _bytes_received{0u};
+
+  std::atomic<clock_type::time_point> _last_received{clock_type::now()};
+
+  detail::LatencyHistogram _latency;
+
+  std::mutex _mutex;
+
+  std::condition_variable _condition;
+};
+
+// =============================================================================
+// -- Output -------------------------------------------------------------------
+// =============================================================================
+
+static void PrintCsvHeader(std::ostream &out) {
+  out << "message_size,streams,subscribers,mode,expected,received,dropped,lost,seconds,"
+         "throughput_bytes_per_second,messages_per_second,cpu_seconds,cpu_ns_per_byte,"
+         "latency_us_mean,latency_us_p50,latency_us_p99,latency_us_p999,latency_us_max"
+      << std::endl;
+}
+
+static void Print(std::ostream &out, bool csv, const Configuration &config, const Result &result) {
+  const auto seconds = std::max(result.seconds, 1e-9);
+  const auto throughput = static_cast<double>(result.bytes) / seconds;
+  const auto messages_per_second = static_cast<double>(result.received) / seconds;
+  const auto cpu_ns_per_byte = result.bytes > 0u ?
+      1e9 * result.cpu_seconds / static_cast<double>(result.bytes) :
+      0.0;
+  const char *mode = config.synchronous ? "sync" : "async";
+  const auto lost = result.expected - std::min(result.expected, result.received);
+  out << std::fixed << std::setprecision(3);
+  if (csv) {
+    out << config.message_size << ',' << config.streams << ',' << config.subscribers << ','
+        << mode << ',' << result.expected << ',' << result.received << ','
+        << result.dropped << ',' << lost << ','
+        << result.seconds << ',' << throughput << ',' << messages_per_second << ','
+        << result.cpu_seconds << ',' << cpu_ns_per_byte << ','
+        << result.latency.mean << ',' << result.latency.p50 << ',' << result.latency.p99 << ','
+        << result.latency.p999 << ',' << result.latency.max << std::endl;
+  } else {
+    out << "{\"message_size\":" << config.message_size
+        << ",\"streams\":" << config.streams
+        << ",\"subscribers\":" << config.subscribers
+        << ",\"mode\":\"" << mode << '"'
+        << ",\"expected\":" << result.expected
+        << ",\"received\":" << result.received
+        << ",\"dropped\":" << result.dropped
+        << ",\"lost\":" << lost
+        << ",\"seconds\":" << result.seconds
+        << ",\"throughput_bytes_per_second\":" << throughput
+        << ",\"messages_per_second\":" << messages_per_second
+        << ",\"cpu_seconds\":" << result.cpu_seconds
+        << ",\"cpu_ns_per_byte\":" << cpu_ns_per_byte
+        << ",\"latency_us\":{\"mean\":" << result.latency.mean
+        << ",\"p50\":" << result.latency.p50
+        << ",\"p99\":" << result.latency.p99
+        << ",\"p999\":" << result.latency.p999
+        << ",\"max\":" << result.latency.max << "}}" << std::endl;
+  }
+}
+
+// =============================================================================
+// -- main ---------------------------------------------------------------------
+// =============================================================================
+
+int main(int argc, char *argv[]) {
+  Settings settings;
+  std::string error;
+  if (!ParseArguments(argc, argv, settings, error)) {
+    std::cerr << "error: " << error << "\n\n" << USAGE;
+    return 1;
+  }
+  if (settings.csv) {
+    PrintCsvHeader(std::cout);
+  }
+  int status = 0;
+  for (auto synchronous : settings.synchronous) {
+    for (auto subscribers : settings.subscribers) {
+      for (auto streams : settings.streams) {
+        for (auto size : settings.sizes) {
+          Configuration config;
+          config.message_size = std::max(size, sizeof(MessageHeader));
+          config.streams = std::max<size_t>(1u, streams);
+          config.subscribers = std::max<size_t>(1u, subscribers);
+          config.synchronous = synchronous;
+          const auto bytes_per_message = config.message_size * config.streams;
+          config.messages = std::min(
+              settings.messages,
+              std::max<size_t>(10u, settings.max_bytes / bytes_per_message));
+          config.window = std::min(
+              settings.window,
+              std::max<size_t>(1u, settings.max_bytes_in_flight / config.message_size));
+          std::cerr << "running " << config.message_size << " bytes, " << config.streams
+                    << " streams, " << config.subscribers << " subscribers, "
+                    << (synchronous ? "sync" : "async") << " mode..." << std::endl;
+          Benchmark benchmark(config, settings.threads);
+          const auto result = benchmark.Run();
+          if (result.has_value()) {
+            Print(std::cout, settings.csv, config, *result);
+          } else {
+            std::cerr << "error: subscribers did not connect in time" << std::endl;
+            status = 1;
+          }
+        }
+      }
+    }
+  }
+  return status;
+}
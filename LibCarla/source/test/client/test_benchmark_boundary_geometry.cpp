@@ -0,0 +1,134 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/trafficmanager/BoundaryGeometry.h>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace carla::traffic_manager;
+using namespace util;
+
+namespace bg = boost::geometry;
+
+using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
+
+static constexpr size_t NUMBER_OF_ACTORS = 200u;
+static constexpr size_t NUMBER_OF_ROUNDS = 5u;
+static constexpr double OVERLAP_THRESHOLD = 0.1;
+
+// Bounding box followed by a path boundary of 5 to 20 points along a curve,
+// laid out like CollisionStage::GetGeodesicBoundary does.
+static LocationVector MakeGeodesicBoundary(LocationVector &bbox) {
+  const float x = static_cast<float>(Random::Uniform(-100.0, 100.0));
+  const float y = static_cast<float>(Random::Uniform(-100.0, 100.0));
+  float yaw = static_cast<float>(Random::Uniform(-3.14, 3.14));
+  const float curvature = static_cast<float>(Random::Uniform(-0.15, 0.15));
+  const float length = static_cast<float>(Random::Uniform(1.5, 3.0));
+  const float width = static_cast<float>(Random::Uniform(0.8, 1.2));
+
+  auto corner = [&](float along, float across) {
+    return carla::geom::Location(
+        x + along * std::cos(yaw) - across * std::sin(yaw),
+        y + along * std::sin(yaw) + across * std::cos(yaw),
+        0.0f);
+  };
+  bbox = {corner(length, -width), corner(-length, -width), corner(-length, width), corner(length, width)};
+
+  LocationVector left;
+  LocationVector right;
+  carla::geom::Location point = corner(length, 0.0f);
+  const int points = static_cast<int>(Random::Uniform(5.0, 20.0));
+  for (int i = 0; i < points; ++i) {
+    const carla::geom::Location across(-std::sin(yaw) * width, std::cos(yaw) * width, 0.0f);
+    left.push_back(point + across);
+    right.push_back(point - across);
+    point += carla::geom::Location(2.0f * std::cos(yaw), 2.0f * std::sin(yaw), 0.0f);
+    yaw += curvature;
+  }
+
+  LocationVector boundary(right.rbegin(), right.rend());
+  boundary.insert(boundary.end(), bbox.begin(), bbox.end());
+  boundary.insert(boundary.end(), left.begin(), left.end());
+  return boundary;
+}
+
+static Polygon MakePolygon(const LocationVector &boundary) {
+  Polygon polygon;
+  for (const carla::geom::Location &location : boundary) {
+    bg::append(polygon.outer(), bg::model::d2::point_xy<double>(location.x, location.y));
+  }
+  bg::append(polygon.outer(), bg::model::d2::point_xy<double>(boundary.front().x, boundary.front().y));
+  return polygon;
+}
+
+TEST(boundary_geometry, distance_matches_boost) {
+  std::vector<Polygon> bbox_polygons;
+  std::vector<Polygon> geodesic_polygons;
+  std::vector<BoundaryHandle> bbox_handles;
+  std::vector<BoundaryHandle> geodesic_handles;
+  BoundaryStore store;
+  for (auto i = 0u; i < NUMBER_OF_ACTORS; ++i) {
+    LocationVector bbox;
+    const LocationVector geodesic = MakeGeodesicBoundary(bbox);
+    bbox_polygons.push_back(MakePolygon(bbox));
+    geodesic_polygons.push_back(MakePolygon(geodesic));
+    bbox_handles.push_back(store.Add(bbox));
+    geodesic_handles.push_back(store.Add(geodesic));
+  }
+
+  // The four comparisons done by CollisionStage for every pair of actors.
+  std::vector<double> boost_distances;
+  carla::StopWatch boost_watch;
+  for (auto round = 0u; round < NUMBER_OF_ROUNDS; ++round) {
+    boost_distances.clear();
+    for (auto i = 0u; i < NUMBER_OF_ACTORS; ++i) {
+      for (auto j = i + 1u; j < NUMBER_OF_ACTORS; ++j) {
+        boost_distances.push_back(bg::distance(bbox_polygons[i], geodesic_polygons[j]));
+        boost_distances.push_back(bg::distance(bbox_polygons[j], geodesic_polygons[i]));
+        boost_distances.push_back(bg::distance(geodesic_polygons[i], geodesic_polygons[j]));
+        boost_distances.push_back(bg::distance(bbox_polygons[i], bbox_polygons[j]));
+      }
+    }
+  }
+  boost_watch.Stop();
+
+  std::vector<double> distances;
+  carla::StopWatch watch;
+  for (auto round = 0u; round < NUMBER_OF_ROUNDS; ++round) {
+    distances.clear();
+    for (auto i = 0u; i < NUMBER_OF_ACTORS; ++i) {
+      for (auto j = i + 1u; j < NUMBER_OF_ACTORS; ++j) {
+        distances.push_back(BoundaryDistance(store.Get(bbox_handles[i]), store.Get(geodesic_handles[j])));
+        distances.push_back(BoundaryDistance(store.Get(bbox_handles[j]), store.Get(geodesic_handles[i])));
+        distances.push_back(BoundaryDistance(store.Get(geodesic_handles[i]), store.Get(geodesic_handles[j])));
+        distances.push_back(BoundaryDistance(store.Get(bbox_handles[i]), store.Get(bbox_handles[j])));
+      }
+    }
+  }
+  watch.Stop();
+
+  ASSERT_EQ(boost_distances.size(), distances.size());
+  size_t touching = 0u;
+  for (auto i = 0u; i < distances.size(); ++i) {
+    ASSERT_EQ(boost_distances[i] < OVERLAP_THRESHOLD, distances[i] < OVERLAP_THRESHOLD) << "comparison " << i;
+    ASSERT_NEAR(boost_distances[i], distances[i], 1e-9) << "comparison " << i;
+    touching += distances[i] < OVERLAP_THRESHOLD ? 1u : 0u;
+  }
+
+  carla::logging::log(
+      distances.size(), "boundary comparisons,", touching, "touching, per round (us): boost::geometry",
+      boost_watch.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_ROUNDS,
+      "BoundaryDistance", watch.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_ROUNDS);
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/road/element/Geometry.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace carla::road::element;
+using namespace util;
+
+using Integration = carla::geom::ArcLengthTable::Integration;
+
+static constexpr size_t NUMBER_OF_GEOMETRIES = 500u;
+static constexpr size_t NUMBER_OF_QUERIES = 200u;
+
+// Normalized parametric cubics like the ones exported by RoadRunner: u goes
+// along the road and v bends it sideways.
+static std::vector<std::unique_ptr<GeometryParamPoly3>> MakeGeometries(
+    const std::vector<std::vector<double>> &coefficients,
+    Integration integration) {
+  std::vector<std::unique_ptr<GeometryParamPoly3>> geometries;
+  for (const auto &c : coefficients) {
+    geometries.emplace_back(std::make_unique<GeometryParamPoly3>(
+        0.0, c[0u], c[1u], carla::geom::Location(0.0f, 0.0f, 0.0f),
+        0.0, c[0u], 0.0, 0.0,
+        0.0, 0.0, c[2u], c[3u],
+        false, integration));
+  }
+  return geometries;
+}
+
+template <typename Geometries>
+static double RunQueries(const Geometries &geometries, const std::vector<double> &fractions) {
+  double checksum = 0.0;
+  for (const auto &geometry : geometries) {
+    for (const auto fraction : fractions) {
+      const auto point = geometry->PosFromDist(fraction * geometry->GetLength());
+      checksum += point.location.x + point.location.y + point.tangent;
+    }
+  }
+  return checksum;
+}
+
+TEST(geometry, benchmark_param_poly3) {
+  std::vector<std::vector<double>> coefficients;
+  for (auto i = 0u; i < NUMBER_OF_GEOMETRIES; ++i) {
+    const double length = Random::Uniform(10.0, 150.0);
+    coefficients.push_back({
+        length,
+        Random::Uniform(-3.14, 3.14),
+        Random::Uniform(-0.1, 0.1) * length,
+        Random::Uniform(-0.05, 0.05) * length});
+  }
+  std::vector<double> fractions;
+  for (auto i = 0u; i < NUMBER_OF_QUERIES; ++i) {
+    fractions.push_back(Random::Uniform(0.0, 1.0));
+  }
+
+  carla::StopWatch chords_setup;
+  const auto chords = MakeGeometries(coefficients, Integration::Chords);
+  chords_setup.Stop();
+  carla::StopWatch gauss_setup;
+  const auto gauss = MakeGeometries(coefficients, Integration::GaussLegendre);
+  gauss_setup.Stop();
+
+  // Both integrations place the points within a few centimeters.
+  for (auto i = 0u; i < NUMBER_OF_GEOMETRIES; ++i) {
+    for (const auto fraction : fractions) {
+      const double s = fraction * chords[i]->GetLength();
+      const auto a = chords[i]->PosFromDist(s);
+      const auto b = gauss[i]->PosFromDist(s);
+      ASSERT_NEAR(a.location.Distance(b.location), 0.0f, 0.05f);
+      ASSERT_NEAR(a.tangent, b.tangent, 1e-2);
+    }
+  }
+
+  carla::StopWatch chords_watch;
+  const double chords_checksum = RunQueries(chords, fractions);
+  chords_watch.Stop();
+  carla::StopWatch gauss_watch;
+  const double gauss_checksum = RunQueries(gauss, fractions);
+  gauss_watch.Stop();
+  ASSERT_FALSE(std::isnan(chords_checksum + gauss_checksum));
+
+  const double queries = static_cast<double>(NUMBER_OF_GEOMETRIES * NUMBER_OF_QUERIES);
+  carla::logging::log(
+      "param poly3 set up (ms): chords", chords_setup.GetElapsedTime(),
+      "gauss-legendre", gauss_setup.GetElapsedTime());
+  carla::logging::log(
+      "param poly3 PosFromDist (ns): chords",
+      1e3 * chords_watch.GetElapsedTime<std::chrono::microseconds>() / queries,
+      "gauss-legendre", 1e3 * gauss_watch.GetElapsedTime<std::chrono::microseconds>() / queries);
+}
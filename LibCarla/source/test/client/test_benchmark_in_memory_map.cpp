@@ -0,0 +1,217 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/Memory.h>
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace carla::traffic_manager;
+using namespace util;
+
+static constexpr size_t NUMBER_OF_VEHICLES = 500u;
+static constexpr size_t BUFFER_LENGTH = 60u;
+static constexpr size_t NUMBER_OF_TICKS = 50u;
+static constexpr size_t NUMBER_OF_QUERIES = 2000u;
+
+using Buffers = std::vector<std::vector<SimpleWaypointPtr>>;
+
+// Emulates the waypoint buffers of the vehicles by following successors
+// from random starting points of the dense topology.
+static Buffers MakeBuffers(const InMemoryMap &local_map) {
+  const NodeList dense_topology = local_map.GetDenseTopology();
+  Buffers buffers(NUMBER_OF_VEHICLES);
+  for (auto &buffer : buffers) {
+    const auto start = static_cast<size_t>(Random::Uniform(0.0, static_cast<double>(dense_topology.size() - 1u)));
+    SimpleWaypointPtr current = dense_topology.at(start);
+    buffer.push_back(current);
+    while (buffer.size() < BUFFER_LENGTH && !current->GetNextWaypoint().empty()) {
+      current = current->GetNextWaypoint().front();
+      buffer.push_back(current);
+    }
+  }
+  return buffers;
+}
+
+// The per-waypoint reads done by the localization stage: location, heading,
+// lane width and junction id.
+template <typename ReadFunctor>
+static double RunTicks(const Buffers &buffers, ReadFunctor &&read) {
+  double checksum = 0.0;
+  for (auto tick = 0u; tick < NUMBER_OF_TICKS; ++tick) {
+    for (const auto &buffer : buffers) {
+      const carla::geom::Location front_location = read(buffer.front(), checksum);
+      for (const auto &swp : buffer) {
+        const carla::geom::Location location = read(swp, checksum);
+        checksum += carla::geom::Math::DistanceSquared(front_location, location);
+      }
+    }
+  }
+  return checksum;
+}
+
+TEST(in_memory_map, benchmark_localization_reads) {
+  for (const auto &file : OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<const carla::client::Map>(file, OpenDrive::Load(file));
+
+    carla::StopWatch setup_watch;
+    InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    setup_watch.Stop();
+
+    if (local_map.GetDenseTopology().empty()) {
+      continue;
+    }
+    const Buffers buffers = MakeBuffers(local_map);
+
+    // The buffers hold nodes of the dense topology, which are re-created
+    // from the graph; they must be at the same position for the checksums
+    // below to match.
+    const WaypointGraph &graph = local_map.GetGraph();
+    for (const auto &buffer : buffers) {
+      for (const auto &swp : buffer) {
+        ASSERT_EQ(swp->GetLocation(), graph.GetLocation(swp->GetIndex()));
+        ASSERT_EQ(swp->GetWaypoint()->GetTransform().location, graph.GetLocation(swp->GetIndex()));
+      }
+    }
+
+    // Reads going through client::Waypoint and road::Map, as SimpleWaypoint
+    // used to do.
+    carla::StopWatch uncached_watch;
+    const double uncached_checksum = RunTicks(buffers, [](const SimpleWaypointPtr &swp, double &checksum) {
+      const auto waypoint = swp->GetWaypoint();
+      const carla::geom::Transform transform = waypoint->GetTransform();
+      checksum += transform.GetForwardVector().x;
+      checksum += static_cast<float>(waypoint->GetLaneWidth());
+      checksum += waypoint->GetJunctionId();
+      return transform.location;
+    });
+    uncached_watch.Stop();
+
+    // Values cached in the SimpleWaypoint by InMemoryMap::SetUp.
+    carla::StopWatch cached_watch;
+    const double cached_checksum = RunTicks(buffers, [](const SimpleWaypointPtr &swp, double &checksum) {
+      checksum += swp->GetForwardVector().x;
+      checksum += swp->GetLaneWidth();
+      checksum += swp->GetJunctionId();
+      return swp->GetLocation();
+    });
+    cached_watch.Stop();
+
+    // Same reads through the flat waypoint graph used by the stages.
+    carla::StopWatch graph_watch;
+    const double graph_checksum = RunTicks(buffers, [&graph](const SimpleWaypointPtr &swp, double &checksum) {
+      const NodeIndex node = swp->GetIndex();
+      checksum += graph.GetForwardVector(node).x;
+      checksum += graph.GetLaneWidth(node);
+      checksum += graph.GetJunctionId(node);
+      return graph.GetLocation(node);
+    });
+    graph_watch.Stop();
+
+    ASSERT_DOUBLE_EQ(uncached_checksum, cached_checksum);
+    ASSERT_DOUBLE_EQ(uncached_checksum, graph_checksum);
+
+    carla::logging::log(
+        file, local_map.GetDenseTopology().size(), "waypoints, set up in",
+        1e-3f * setup_watch.GetElapsedTime(), "seconds.");
+    carla::logging::log(
+        file, "localization reads per tick (us): uncached",
+        uncached_watch.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_TICKS,
+        "cached", cached_watch.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_TICKS,
+        "graph", graph_watch.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_TICKS);
+  }
+}
+
+TEST(in_memory_map, image_round_trip) {
+  const std::string image_path = "test_in_memory_map_image.bin";
+  for (const auto &file : OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<const carla::client::Map>(file, OpenDrive::Load(file));
+
+    carla::StopWatch setup_watch;
+    InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    setup_watch.Stop();
+    ASSERT_TRUE(local_map.Save(image_path));
+
+    carla::StopWatch open_watch;
+    InMemoryMap mapped_map(world_map);
+    ASSERT_TRUE(mapped_map.Open(image_path));
+    open_watch.Stop();
+
+    const WaypointGraph &graph = local_map.GetGraph();
+    const WaypointGraph &mapped_graph = mapped_map.GetGraph();
+    ASSERT_EQ(graph.Size(), mapped_graph.Size());
+    for (NodeIndex node = 0u; node < graph.Size(); ++node) {
+      ASSERT_EQ(graph.GetLocation(node), mapped_graph.GetLocation(node));
+      ASSERT_EQ(graph.GetRotation(node), mapped_graph.GetRotation(node));
+      ASSERT_EQ(graph.GetWaypointId(node), mapped_graph.GetWaypointId(node));
+      ASSERT_EQ(graph.GetLaneWidth(node), mapped_graph.GetLaneWidth(node));
+      ASSERT_EQ(graph.GetJunctionId(node), mapped_graph.GetJunctionId(node));
+      ASSERT_EQ(graph.GetRoadOption(node), mapped_graph.GetRoadOption(node));
+      ASSERT_EQ(graph.GetLeftNode(node), mapped_graph.GetLeftNode(node));
+      ASSERT_EQ(graph.GetRightNode(node), mapped_graph.GetRightNode(node));
+      const std::vector<NodeIndex> successors(graph.GetSuccessors(node).begin(), graph.GetSuccessors(node).end());
+      const std::vector<NodeIndex> mapped_successors(mapped_graph.GetSuccessors(node).begin(), mapped_graph.GetSuccessors(node).end());
+      ASSERT_EQ(successors, mapped_successors);
+
+      // Waypoints created from the image are the ones the graph was made of.
+      const SimpleWaypointPtr swp = mapped_map.GetNode(node);
+      ASSERT_EQ(swp->GetIndex(), node);
+      ASSERT_EQ(swp->GetWaypoint()->GetRoadId(), graph.GetRoadId(node));
+      ASSERT_EQ(swp->GetWaypoint()->GetSectionId(), graph.GetSectionId(node));
+      ASSERT_EQ(swp->GetWaypoint()->GetLaneId(), graph.GetLaneId(node));
+      ASSERT_EQ(swp->GetWaypoint()->GetDistance(), graph.GetDistance(node));
+      ASSERT_EQ(swp->GetLocation(), graph.GetLocation(node));
+    }
+
+    // Nearest waypoint queries match a brute force search.
+    if (graph.Size() > 0u) {
+      const cg::Location &first = graph.GetLocation(0u);
+      for (auto i = 0u; i < NUMBER_OF_QUERIES; ++i) {
+        const cg::Location query(
+            first.x + static_cast<float>(Random::Uniform(-200.0, 200.0)),
+            first.y + static_cast<float>(Random::Uniform(-200.0, 200.0)),
+            first.z + static_cast<float>(Random::Uniform(-5.0, 5.0)));
+        float best_distance = std::numeric_limits<float>::max();
+        for (NodeIndex node = 0u; node < graph.Size(); ++node) {
+          best_distance = std::min(best_distance, graph.DistanceSquared(node, query));
+        }
+        const NodeIndex nearest = local_map.GetWaypointIndex(query);
+        ASSERT_EQ(graph.DistanceSquared(nearest, query), best_distance);
+        ASSERT_EQ(nearest, mapped_map.GetWaypointIndex(query));
+      }
+    }
+
+    // Linking the whole topology of the image reproduces the set up one.
+    const NodeList dense_topology = local_map.GetDenseTopology();
+    const NodeList mapped_topology = mapped_map.GetDenseTopology();
+    ASSERT_EQ(dense_topology.size(), mapped_topology.size());
+    for (auto i = 0u; i < dense_topology.size(); ++i) {
+      const auto next = dense_topology[i]->GetNextWaypoint();
+      const auto mapped_next = mapped_topology[i]->GetNextWaypoint();
+      ASSERT_EQ(next.size(), mapped_next.size());
+      for (auto j = 0u; j < next.size(); ++j) {
+        ASSERT_EQ(next[j]->GetIndex(), mapped_next[j]->GetIndex());
+      }
+    }
+
+    carla::logging::log(
+        file, graph.Size(), "waypoints, set up in",
+        setup_watch.GetElapsedTime<std::chrono::microseconds>(), "us, image opened in",
+        open_watch.GetElapsedTime<std::chrono::microseconds>(), "us.");
+  }
+  std::remove(image_path.c_str());
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+
+#include <thread>
+
+using carla::opendrive::OpenDriveParser;
+
+static constexpr size_t NUMBER_OF_BUILDS = 20u;
+
+TEST(map_build, benchmark_and_determinism) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto expected = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(expected.has_value());
+    const auto expected_waypoints = expected->GenerateWaypoints(1.0);
+
+    carla::StopWatch watch;
+    for (auto i = 0u; i < NUMBER_OF_BUILDS; ++i) {
+      auto map = OpenDriveParser::Load(opendrive);
+      ASSERT_TRUE(map.has_value());
+      // Roads parsed and geometries created by several threads are added to
+      // the map in the same order every time.
+      if (i == 0u) {
+        const auto waypoints = map->GenerateWaypoints(1.0);
+        ASSERT_EQ(waypoints.size(), expected_waypoints.size());
+        for (auto j = 0u; j < waypoints.size(); ++j) {
+          ASSERT_EQ(waypoints[j], expected_waypoints[j]);
+          ASSERT_EQ(map->ComputeTransform(waypoints[j]), expected->ComputeTransform(expected_waypoints[j]));
+          const auto location = map->ComputeTransform(waypoints[j]).location;
+          const auto closest = map->GetClosestWaypointOnRoad(location);
+          const auto expected_closest = expected->GetClosestWaypointOnRoad(location);
+          ASSERT_EQ(closest.has_value(), expected_closest.has_value());
+          if (closest.has_value()) {
+            ASSERT_EQ(*closest, *expected_closest);
+          }
+        }
+      }
+    }
+    watch.Stop();
+
+    carla::logging::log(
+        file, "build (us):", watch.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_BUILDS,
+        "hardware threads:", std::thread::hardware_concurrency());
+  }
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/InformationSet.h>
+#include <carla/road/element/RoadInfoElevation.h>
+#include <carla/road/element/RoadInfoLaneOffset.h>
+#include <carla/road/element/RoadInfoLaneWidth.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace carla::road;
+using namespace carla::road::element;
+using namespace util;
+
+static constexpr size_t NUMBER_OF_INFOS = 300u;
+static constexpr size_t NUMBER_OF_QUERIES = 2000u;
+static constexpr size_t NUMBER_OF_ROUNDS = 200u;
+
+// Last info of type T with distance <= s, found by a linear scan.
+template <typename T>
+static const T *FindInfo(const std::vector<const T *> &infos, double s) {
+  const T *result = nullptr;
+  for (auto *info : infos) {
+    if (info->GetDistance() <= s) {
+      result = info;
+    }
+  }
+  return result;
+}
+
+TEST(road_info, information_set_lookup) {
+  std::vector<std::unique_ptr<RoadInfo>> infos;
+  for (auto i = 0u; i < NUMBER_OF_INFOS; ++i) {
+    const double s = static_cast<double>(static_cast<int>(Random::Uniform(0.0, 100.0)));
+    switch (i % 3u) {
+      case 0u: infos.emplace_back(std::make_unique<RoadInfoLaneWidth>(s, 1.0 * i, 0.0, 0.0, 0.0)); break;
+      case 1u: infos.emplace_back(std::make_unique<RoadInfoLaneOffset>(s, 1.0 * i, 0.0, 0.0, 0.0)); break;
+      default: infos.emplace_back(std::make_unique<RoadInfoElevation>(s, 1.0 * i, 0.0, 0.0, 0.0)); break;
+    }
+  }
+  const InformationSet set(std::move(infos));
+
+  const auto widths = set.GetInfos<RoadInfoLaneWidth>();
+  ASSERT_EQ(widths.size(), NUMBER_OF_INFOS / 3u);
+  for (auto i = 1u; i < widths.size(); ++i) {
+    ASSERT_LE(widths[i - 1u]->GetDistance(), widths[i]->GetDistance());
+  }
+
+  for (auto i = 0u; i < NUMBER_OF_QUERIES; ++i) {
+    const double s = Random::Uniform(-10.0, 110.0);
+    ASSERT_EQ(set.GetInfo<RoadInfoLaneWidth>(s), FindInfo(widths, s));
+
+    const double t = Random::Uniform(-10.0, 110.0);
+    const auto range = set.GetInfos<RoadInfoLaneWidth>(s, t);
+    std::vector<const RoadInfoLaneWidth *> expected;
+    for (auto *info : widths) {
+      const double d = info->GetDistance();
+      if ((d >= std::min(s, t)) && (d <= std::max(s, t))) {
+        expected.emplace_back(info);
+      }
+    }
+    if (s >= t) {
+      std::reverse(expected.begin(), expected.end());
+    }
+    ASSERT_EQ(range, expected);
+  }
+}
+
+TEST(road_info, benchmark_lookups) {
+  for (const auto &file : OpenDrive::GetAvailableFiles()) {
+    auto map = carla::opendrive::OpenDriveParser::Load(OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto waypoints = map->GenerateWaypoints(1.0);
+
+    // Every transform and lane width looks up geometry, lane offset, lane
+    // section, lane width and elevation infos of the road.
+    double checksum = 0.0;
+    carla::StopWatch watch;
+    for (auto round = 0u; round < NUMBER_OF_ROUNDS; ++round) {
+      for (const auto &waypoint : waypoints) {
+        const auto transform = map->ComputeTransform(waypoint);
+        checksum += transform.location.x + transform.location.z;
+        checksum += map->GetLaneWidth(waypoint);
+      }
+    }
+    watch.Stop();
+    ASSERT_FALSE(std::isnan(checksum));
+
+    const auto lookups = NUMBER_OF_ROUNDS * waypoints.size();
+    carla::logging::log(
+        file, waypoints.size(), "waypoints,",
+        lookups == 0u ? 0.0 : 1e3 * watch.GetElapsedTime<std::chrono::microseconds>() / static_cast<double>(lookups),
+        "ns per transform and lane width.");
+  }
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/MsgPack.h>
+#include <carla/StopWatch.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/VehicleControlBatch.h>
+
+#include <vector>
+
+using namespace carla::rpc;
+using namespace util;
+
+static constexpr size_t NUMBER_OF_VEHICLES = 1000u;
+static constexpr size_t NUMBER_OF_ROUNDS = 100u;
+
+// What the TM sends every tick, one ApplyVehicleControl per vehicle, against
+// the same controls in a VehicleControlBatch.
+TEST(benchmark_vehicle_control_batch, encode_decode) {
+  using mp = carla::MsgPack;
+  std::vector<Command> commands;
+  VehicleControlBatch batch;
+  for (auto i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+    VehicleControl control;
+    control.throttle = static_cast<float>(Random::Uniform(0.0, 1.0));
+    control.steer = static_cast<float>(Random::Uniform(-1.0, 1.0));
+    control.brake = static_cast<float>(Random::Uniform(0.0, 1.0));
+    commands.emplace_back(Command::ApplyVehicleControl(100u + i, control));
+    batch.Add(100u + i, control);
+  }
+
+  carla::Buffer commands_buffer;
+  carla::StopWatch commands_encode;
+  for (auto round = 0u; round < NUMBER_OF_ROUNDS; ++round) {
+    commands_buffer = mp::Pack(commands);
+  }
+  commands_encode.Stop();
+  std::vector<Command> decoded_commands;
+  carla::StopWatch commands_decode;
+  for (auto round = 0u; round < NUMBER_OF_ROUNDS; ++round) {
+    decoded_commands = mp::UnPack<std::vector<Command>>(commands_buffer);
+  }
+  commands_decode.Stop();
+
+  carla::Buffer batch_buffer;
+  carla::StopWatch batch_encode;
+  for (auto round = 0u; round < NUMBER_OF_ROUNDS; ++round) {
+    batch_buffer = mp::Pack(batch);
+  }
+  batch_encode.Stop();
+  VehicleControlBatch decoded_batch;
+  carla::StopWatch batch_decode;
+  for (auto round = 0u; round < NUMBER_OF_ROUNDS; ++round) {
+    decoded_batch = mp::UnPack<VehicleControlBatch>(batch_buffer);
+  }
+  batch_decode.Stop();
+
+  ASSERT_EQ(decoded_commands.size(), NUMBER_OF_VEHICLES);
+  ASSERT_EQ(decoded_batch.size(), NUMBER_OF_VEHICLES);
+  for (auto i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+    const auto &command = boost::variant2::get<Command::ApplyVehicleControl>(decoded_commands[i].command);
+    ASSERT_EQ(decoded_batch.GetActorId(i), command.actor);
+    ASSERT_EQ(decoded_batch.GetControl(i), command.control);
+  }
+  ASSERT_LT(batch_buffer.size(), commands_buffer.size());
+
+  carla::logging::log(
+      NUMBER_OF_VEHICLES, "vehicle controls, per round (us): commands",
+      commands_buffer.size(), "bytes, encode",
+      commands_encode.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_ROUNDS,
+      "decode", commands_decode.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_ROUNDS,
+      "; batch", batch_buffer.size(), "bytes, encode",
+      batch_encode.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_ROUNDS,
+      "decode", batch_decode.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_ROUNDS);
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+
+#include <memory>
+#include <vector>
+
+using namespace carla::road;
+using namespace util;
+
+static constexpr size_t NUMBER_OF_LOCATIONS = 20000u;
+
+TEST(waypoint_batch, matches_single_queries) {
+  for (const auto &file : OpenDrive::GetAvailableFiles()) {
+    auto map = carla::opendrive::OpenDriveParser::Load(OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto topology = map->GenerateWaypoints(2.0);
+    if (topology.empty()) {
+      continue;
+    }
+
+    // Points scattered around the roads, some of them off the road.
+    std::vector<carla::geom::Location> locations;
+    for (auto i = 0u; i < NUMBER_OF_LOCATIONS; ++i) {
+      const auto index = static_cast<size_t>(Random::Uniform(0.0, static_cast<double>(topology.size() - 1u)));
+      auto location = map->ComputeTransform(topology[index]).location;
+      location.x += static_cast<float>(Random::Uniform(-5.0, 5.0));
+      location.y += static_cast<float>(Random::Uniform(-5.0, 5.0));
+      locations.emplace_back(location);
+    }
+    const auto lane_type = static_cast<int32_t>(Lane::LaneType::Driving);
+
+    for (const bool project_to_road : {true, false}) {
+      carla::StopWatch single_watch;
+      std::vector<boost::optional<element::Waypoint>> expected;
+      for (const auto &location : locations) {
+        expected.emplace_back(project_to_road ?
+            map->GetClosestWaypointOnRoad(location, lane_type) :
+            map->GetWaypoint(location, lane_type));
+      }
+      single_watch.Stop();
+
+      std::vector<element::Waypoint> waypoints(locations.size());
+      std::vector<carla::geom::Transform> transforms(locations.size());
+      std::unique_ptr<bool[]> found(new bool[locations.size()]);
+      carla::StopWatch batch_watch;
+      map->GetWaypoints(
+          locations.data(),
+          locations.size(),
+          project_to_road,
+          lane_type,
+          waypoints.data(),
+          transforms.data(),
+          found.get(),
+          4u);
+      batch_watch.Stop();
+
+      for (auto i = 0u; i < locations.size(); ++i) {
+        ASSERT_EQ(found[i], expected[i].has_value());
+        if (found[i]) {
+          ASSERT_EQ(waypoints[i], *expected[i]);
+          ASSERT_EQ(transforms[i], map->ComputeTransform(*expected[i]));
+        }
+      }
+
+      std::vector<carla::geom::Transform> recomputed(locations.size());
+      map->ComputeTransforms(waypoints.data(), waypoints.size(), recomputed.data(), 2u);
+      for (auto i = 0u; i < locations.size(); ++i) {
+        if (found[i]) {
+          ASSERT_EQ(recomputed[i], transforms[i]);
+        }
+      }
+
+      carla::logging::log(
+          file, project_to_road ? "closest waypoints (ms): single" : "waypoints (ms): single",
+          single_watch.GetElapsedTime(), "batch", batch_watch.GetElapsedTime());
+    }
+  }
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/MapImage.h>
+
+#include <vector>
+
+using namespace carla::road;
+using carla::opendrive::OpenDriveParser;
+
+static void AssertEqualMaps(const Map &expected, const Map &map) {
+  ASSERT_EQ(map.GetSignals().size(), expected.GetSignals().size());
+  ASSERT_EQ(map.GetControllers().size(), expected.GetControllers().size());
+  ASSERT_EQ(map.GetGeoReference().latitude, expected.GetGeoReference().latitude);
+  ASSERT_EQ(map.GetGeoReference().longitude, expected.GetGeoReference().longitude);
+
+  const auto expected_waypoints = expected.GenerateWaypoints(1.0);
+  const auto waypoints = map.GenerateWaypoints(1.0);
+  ASSERT_EQ(waypoints.size(), expected_waypoints.size());
+  for (auto i = 0u; i < waypoints.size(); ++i) {
+    ASSERT_EQ(waypoints[i], expected_waypoints[i]);
+    ASSERT_EQ(map.ComputeTransform(waypoints[i]), expected.ComputeTransform(expected_waypoints[i]));
+    ASSERT_EQ(map.GetLaneWidth(waypoints[i]), expected.GetLaneWidth(expected_waypoints[i]));
+    ASSERT_EQ(map.GetLaneType(waypoints[i]), expected.GetLaneType(expected_waypoints[i]));
+    ASSERT_EQ(map.GetNext(waypoints[i], 2.0).size(), expected.GetNext(expected_waypoints[i], 2.0).size());
+  }
+  ASSERT_EQ(map.GenerateTopology().size(), expected.GenerateTopology().size());
+  ASSERT_EQ(map.GetAllCrosswalkZones().size(), expected.GetAllCrosswalkZones().size());
+}
+
+TEST(map_image, round_trip) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+
+    std::vector<uint8_t> image;
+    carla::StopWatch parse_watch;
+    auto expected = OpenDriveParser::Load(opendrive, image);
+    parse_watch.Stop();
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_FALSE(image.empty());
+
+    carla::StopWatch load_watch;
+    auto map = OpenDriveParser::LoadImage(opendrive, image);
+    load_watch.Stop();
+    ASSERT_TRUE(map.has_value());
+    AssertEqualMaps(*expected, *map);
+
+    carla::logging::log(
+        file, "parse OpenDRIVE (us):", parse_watch.GetElapsedTime<std::chrono::microseconds>(),
+        "load image (us):", load_watch.GetElapsedTime<std::chrono::microseconds>(),
+        "image size (KB):", image.size() / 1024u);
+  }
+}
+
+TEST(map_image, rejects_other_content) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    std::vector<uint8_t> image;
+    ASSERT_TRUE(OpenDriveParser::Load(opendrive, image).has_value());
+
+    // Another OpenDRIVE content.
+    ASSERT_FALSE(OpenDriveParser::LoadImage(opendrive + " ", image).has_value());
+
+    // Truncated and corrupted images.
+    auto truncated = image;
+    truncated.resize(truncated.size() / 2u);
+    ASSERT_FALSE(OpenDriveParser::LoadImage(opendrive, truncated).has_value());
+    ASSERT_FALSE(OpenDriveParser::LoadImage(opendrive, {}).has_value());
+    auto corrupted = image;
+    corrupted[0u] = 'X';
+    ASSERT_FALSE(OpenDriveParser::LoadImage(opendrive, corrupted).has_value());
+  }
+}
+
+TEST(map_image, rejects_unknown_ids) {
+  constexpr uint64_t hash = 42u;
+
+  // A single road with one lane section and a lane added to @a section_id.
+  auto make_image = [](SectionId section_id) {
+    MapImage image(hash);
+    image.Record(MapImage::Op::AddRoad, RoadId(1u), std::string("road"), 10.0, JuncId(-1), RoadId(0u), RoadId(0u));
+    image.Record(MapImage::Op::AddRoadSection, RoadId(1u), SectionId(0u), 0.0);
+    image.Record(
+        MapImage::Op::AddRoadSectionLane, RoadId(1u), section_id, LaneId(0), uint32_t(0u), false, LaneId(0), LaneId(0));
+    image.Record(MapImage::Op::AddRoadGeometryLine, RoadId(1u), 0.0, 0.0, 0.0, 0.0, 10.0);
+    return image.Finish();
+  };
+
+  ASSERT_TRUE(MapImage::Load(make_image(0u), hash).has_value());
+  ASSERT_FALSE(MapImage::Load(make_image(7u), hash).has_value());
+
+  // A connection of a junction that was never added.
+  MapImage image(hash);
+  image.Record(MapImage::Op::AddJunction, JuncId(1), std::string("junction"));
+  image.Record(MapImage::Op::AddConnection, JuncId(2), ConId(0u), RoadId(0u), RoadId(0u));
+  ASSERT_FALSE(MapImage::Load(image.Finish(), hash).has_value());
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/PathBuffer.h>
+
+#include <vector>
+
+using carla::ActorId;
+using carla::traffic_manager::NodeIndex;
+using carla::traffic_manager::PathBuffer;
+using carla::traffic_manager::PathBufferMap;
+using carla::traffic_manager::PATH_BUFFER_CAPACITY;
+using carla::traffic_manager::constants::FrameMemory::GROWTH_STEP_SIZE;
+
+static std::vector<NodeIndex> ToVector(const PathBuffer &buffer) {
+  std::vector<NodeIndex> result;
+  for (auto node : buffer) {
+    result.emplace_back(node);
+  }
+  return result;
+}
+
+// Fills the buffer of @a actor_id with a path that starts at @a first and
+// whose head is not at the start of the slot.
+static void FillPath(PathBufferMap &map, ActorId actor_id, NodeIndex first) {
+  auto &buffer = map.Acquire(actor_id);
+  buffer.push_back(0u);
+  buffer.push_back(0u);
+  buffer.pop_front();
+  buffer.pop_front();
+  for (NodeIndex i = 0u; i < 10u; ++i) {
+    buffer.push_back(first + i);
+  }
+}
+
+TEST(path_buffer, full_at_capacity) {
+  PathBufferMap map;
+  auto &buffer = map.Acquire(1u);
+  ASSERT_TRUE(buffer.empty());
+  ASSERT_EQ(PathBuffer::capacity(), PATH_BUFFER_CAPACITY);
+  for (NodeIndex i = 0u; i < PATH_BUFFER_CAPACITY; ++i) {
+    ASSERT_FALSE(buffer.full());
+    buffer.push_back(i);
+  }
+  ASSERT_TRUE(buffer.full());
+  ASSERT_EQ(buffer.size(), PATH_BUFFER_CAPACITY);
+  ASSERT_EQ(buffer.front(), 0u);
+  ASSERT_EQ(buffer.back(), PATH_BUFFER_CAPACITY - 1u);
+  buffer.pop_front();
+  ASSERT_FALSE(buffer.full());
+  buffer.push_back(PATH_BUFFER_CAPACITY);
+  ASSERT_TRUE(buffer.full());
+  buffer.clear();
+  ASSERT_TRUE(buffer.empty());
+  ASSERT_FALSE(buffer.full());
+}
+
+TEST(path_buffer, push_and_pop_across_the_wrap_point) {
+  constexpr NodeIndex half = PATH_BUFFER_CAPACITY / 2u;
+  PathBufferMap map;
+  auto &buffer = map.Acquire(1u);
+  std::vector<NodeIndex> expected;
+
+  // Move the head to the second half of the slot, then push past its end.
+  for (NodeIndex i = 0u; i < PATH_BUFFER_CAPACITY - 3u; ++i) {
+    buffer.push_back(i);
+  }
+  for (NodeIndex i = 0u; i < PATH_BUFFER_CAPACITY - 3u - half; ++i) {
+    buffer.pop_front();
+  }
+  for (NodeIndex i = PATH_BUFFER_CAPACITY - 3u - half; i < PATH_BUFFER_CAPACITY - 3u; ++i) {
+    expected.emplace_back(i);
+  }
+  for (NodeIndex i = 0u; i < PATH_BUFFER_CAPACITY - half; ++i) {
+    buffer.push_back(10000u + i);
+    expected.emplace_back(10000u + i);
+  }
+  ASSERT_TRUE(buffer.full());
+  ASSERT_EQ(buffer.size(), expected.size());
+  ASSERT_EQ(ToVector(buffer), expected);
+
+  // Front, back and index access after the wrap.
+  ASSERT_EQ(buffer.front(), expected.front());
+  ASSERT_EQ(buffer.back(), expected.back());
+  for (size_t i = 0u; i < expected.size(); ++i) {
+    ASSERT_EQ(buffer[i], expected[i]);
+    ASSERT_EQ(buffer.at(i), expected[i]);
+  }
+
+  // Pop from both ends until the head itself has wrapped.
+  for (auto i = 0u; i < half + 5u; ++i) {
+    buffer.pop_front();
+  }
+  buffer.pop_back();
+  expected.erase(expected.begin(), expected.begin() + half + 5u);
+  expected.pop_back();
+  ASSERT_EQ(ToVector(buffer), expected);
+  ASSERT_EQ(buffer.front(), expected.front());
+  ASSERT_EQ(buffer.back(), expected.back());
+
+  while (!buffer.empty()) {
+    buffer.pop_front();
+  }
+  buffer.push_back(42u);
+  ASSERT_EQ(buffer.front(), 42u);
+  ASSERT_EQ(buffer.back(), 42u);
+  ASSERT_EQ(buffer[0u], 42u);
+}
+
+TEST(path_buffer, slot_reused_after_remove) {
+  PathBufferMap map;
+  FillPath(map, 1u, 100u);
+  FillPath(map, 2u, 200u);
+  const PathBuffer *removed = &map.Get(1u);
+
+  map.Remove(1u);
+  ASSERT_FALSE(map.Contains(1u));
+  ASSERT_EQ(map.Find(1u), nullptr);
+
+  // The next actor gets the slot of the removed one, empty.
+  auto &buffer = map.Acquire(3u);
+  ASSERT_EQ(&buffer, removed);
+  ASSERT_TRUE(buffer.empty());
+  buffer.push_back(300u);
+  ASSERT_EQ(ToVector(buffer), std::vector<NodeIndex>{300u});
+  ASSERT_EQ(ToVector(map.Get(2u)), (std::vector<NodeIndex>{
+      200u, 201u, 202u, 203u, 204u, 205u, 206u, 207u, 208u, 209u}));
+
+  // Acquiring an actor again returns its buffer untouched.
+  ASSERT_EQ(&map.Acquire(3u), &buffer);
+  ASSERT_EQ(buffer.size(), 1u);
+
+  map.Clear();
+  ASSERT_FALSE(map.Contains(2u));
+  ASSERT_FALSE(map.Contains(3u));
+  ASSERT_TRUE(map.Acquire(4u).empty());
+}
+
+TEST(path_buffer, growth_keeps_existing_buffers) {
+  constexpr ActorId number_of_actors = 2u * GROWTH_STEP_SIZE + 1u;
+  PathBufferMap map;
+  for (ActorId id = 1u; id <= number_of_actors; ++id) {
+    FillPath(map, id, 1000u * id);
+  }
+
+  // Every buffer added before a growth of the arena keeps its path.
+  for (ActorId id = 1u; id <= number_of_actors; ++id) {
+    const PathBuffer *buffer = map.Find(id);
+    ASSERT_NE(buffer, nullptr);
+    ASSERT_EQ(buffer->size(), 10u);
+    for (NodeIndex i = 0u; i < 10u; ++i) {
+      ASSERT_EQ((*buffer)[i], 1000u * id + i);
+    }
+  }
+
+  // Removing and adding actors after the growth reuses the free slots.
+  map.Remove(1u);
+  map.Remove(number_of_actors);
+  FillPath(map, number_of_actors + 1u, 7u);
+  ASSERT_EQ(ToVector(map.Get(number_of_actors + 1u)).front(), 7u);
+  ASSERT_EQ(ToVector(map.Get(2u)).front(), 2000u);
+}
@@ -62,3 +62,35 @@ TEST(rpc, server_bind_sync_run_on_game_thread) {
   std::cout << "game thread: run " << i << " slices.\n";
   ASSERT_TRUE(done);
 }
+
+TEST(rpc, future_call_pipelined) {
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+
+  Server server(port);
+
+  server.BindSync("do_the_thing", [](int x, int y) -> int {
+    return x + y;
+  });
+
+  server.AsyncRun(1u);
+
+  std::atomic_bool done{false};
+
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    std::vector<decltype(client.future_call("do_the_thing", 0, 0))> futures;
+    for (auto i = 0; i < 300; ++i) {
+      futures.emplace_back(client.future_call("do_the_thing", i, 1));
+    }
+    for (auto i = 0; i < 300; ++i) {
+      EXPECT_EQ(futures[i].get().as<int>(), i + 1);
+    }
+    done = true;
+  });
+
+  for (auto i = 0u; (i < 1'000'000u) && !done; ++i) {
+    server.SyncRunFor(2ms);
+  }
+  ASSERT_TRUE(done);
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/SimulationState.h>
+
+#include <vector>
+
+using carla::ActorId;
+using carla::geom::Location;
+using carla::geom::Rotation;
+using carla::geom::Vector3D;
+using carla::traffic_manager::ActorSlot;
+using carla::traffic_manager::ActorType;
+using carla::traffic_manager::KinematicState;
+using carla::traffic_manager::SimulationState;
+using carla::traffic_manager::StaticAttributes;
+using carla::traffic_manager::TLS;
+using carla::traffic_manager::TrafficLightState;
+
+// State of an actor derived from its id, so it can be checked after the
+// actor has been moved to another slot.
+static KinematicState MakeKinematicState(ActorId actor_id) {
+  const float value = static_cast<float>(actor_id);
+  return KinematicState{
+      Location{value, 2.0f * value, 3.0f * value},
+      Rotation{0.0f, 10.0f * value, 0.0f},
+      Vector3D{-value, 0.5f * value, 0.0f},
+      20.0f + value,
+      actor_id % 2u == 0u,
+      actor_id % 3u == 0u,
+      Location{-value, -2.0f * value, 0.0f}};
+}
+
+static StaticAttributes MakeStaticAttributes(ActorId actor_id) {
+  const float value = static_cast<float>(actor_id);
+  return StaticAttributes{
+      actor_id % 2u == 0u ? ActorType::Vehicle : ActorType::Pedestrian,
+      value,
+      0.5f * value,
+      0.25f * value};
+}
+
+static TrafficLightState MakeTrafficLightState(ActorId actor_id) {
+  return TrafficLightState{
+      actor_id % 2u == 0u ? TLS::Red : TLS::Yellow,
+      actor_id % 3u == 0u};
+}
+
+static void AddActor(SimulationState &state, ActorId actor_id) {
+  state.AddActor(
+      actor_id,
+      MakeKinematicState(actor_id),
+      MakeStaticAttributes(actor_id),
+      MakeTrafficLightState(actor_id));
+}
+
+static void CheckActor(const SimulationState &state, ActorId actor_id) {
+  SCOPED_TRACE(actor_id);
+  ASSERT_TRUE(state.ContainsActor(actor_id));
+  const ActorSlot slot = state.GetSlot(actor_id);
+  ASSERT_TRUE(slot.IsValid());
+  ASSERT_LT(slot.index, state.Size());
+  ASSERT_EQ(state.GetActorId(slot), actor_id);
+  ASSERT_EQ(state.GetActorIds()[slot.index], actor_id);
+
+  const auto kinematic = MakeKinematicState(actor_id);
+  ASSERT_EQ(state.GetLocation(actor_id), kinematic.location);
+  ASSERT_EQ(state.GetLocations()[slot.index], kinematic.location);
+  ASSERT_EQ(state.GetRotation(actor_id), kinematic.rotation);
+  ASSERT_EQ(state.GetHeading(actor_id), kinematic.rotation.GetForwardVector());
+  ASSERT_EQ(state.GetVelocity(actor_id), kinematic.velocity);
+  ASSERT_EQ(state.GetSpeedLimit(actor_id), kinematic.speed_limit);
+  ASSERT_EQ(state.IsPhysicsEnabled(actor_id), kinematic.physics_enabled);
+  ASSERT_EQ(state.IsDormant(actor_id), kinematic.is_dormant);
+  ASSERT_EQ(state.GetHybridEndLocation(actor_id), kinematic.hybrid_end_location);
+
+  const auto attributes = MakeStaticAttributes(actor_id);
+  ASSERT_EQ(state.GetType(actor_id), attributes.actor_type);
+  ASSERT_EQ(state.GetDimensions(actor_id),
+            (Vector3D{attributes.half_length, attributes.half_width, attributes.half_height}));
+
+  const auto tl_state = MakeTrafficLightState(actor_id);
+  ASSERT_EQ(state.GetTLS(actor_id).tl_state, tl_state.tl_state);
+  ASSERT_EQ(state.GetTLS(actor_id).at_traffic_light, tl_state.at_traffic_light);
+}
+
+static void CheckRemoved(const SimulationState &state, ActorId actor_id) {
+  ASSERT_FALSE(state.ContainsActor(actor_id));
+  ASSERT_FALSE(state.FindSlot(actor_id).IsValid());
+}
+
+TEST(simulation_state, remove_middle_and_last_actor) {
+  SimulationState state;
+  const std::vector<ActorId> actor_ids = {10u, 11u, 12u, 13u, 14u, 15u};
+  for (auto actor_id : actor_ids) {
+    AddActor(state, actor_id);
+  }
+  ASSERT_EQ(state.Size(), actor_ids.size());
+  for (auto actor_id : actor_ids) {
+    CheckActor(state, actor_id);
+  }
+
+  // The last actor takes the slot of the removed one.
+  const ActorSlot middle_slot = state.GetSlot(12u);
+  state.RemoveActor(12u);
+  ASSERT_EQ(state.Size(), 5u);
+  CheckRemoved(state, 12u);
+  ASSERT_EQ(state.GetSlot(15u).index, middle_slot.index);
+  for (auto actor_id : {10u, 11u, 13u, 14u, 15u}) {
+    CheckActor(state, actor_id);
+  }
+
+  // Removing the last slot moves nothing.
+  const ActorId last = state.GetActorIds().back();
+  ASSERT_EQ(last, 14u);
+  state.RemoveActor(last);
+  ASSERT_EQ(state.Size(), 4u);
+  CheckRemoved(state, 14u);
+  for (auto actor_id : {10u, 11u, 13u, 15u}) {
+    CheckActor(state, actor_id);
+  }
+
+  // Removing an unknown actor does nothing.
+  state.RemoveActor(12u);
+  ASSERT_EQ(state.Size(), 4u);
+
+  // A removed actor can be added again.
+  AddActor(state, 12u);
+  ASSERT_EQ(state.Size(), 5u);
+  for (auto actor_id : {10u, 11u, 12u, 13u, 15u}) {
+    CheckActor(state, actor_id);
+  }
+
+  // Down to no actors, removing the first slot each time.
+  while (state.Size() > 0u) {
+    const ActorId first = state.GetActorIds().front();
+    state.RemoveActor(first);
+    CheckRemoved(state, first);
+    for (auto actor_id : state.GetActorIds()) {
+      CheckActor(state, actor_id);
+    }
+  }
+}
+
+TEST(simulation_state, updates_follow_moved_actor) {
+  SimulationState state;
+  for (ActorId actor_id = 1u; actor_id <= 3u; ++actor_id) {
+    AddActor(state, actor_id);
+  }
+  state.RemoveActor(1u);
+
+  // Actor 3 is now in slot 0, updates by id and by slot must reach it.
+  ASSERT_EQ(state.GetSlot(3u).index, 0u);
+  auto kinematic = MakeKinematicState(3u);
+  kinematic.location = Location{7.0f, 8.0f, 9.0f};
+  state.UpdateKinematicState(3u, kinematic);
+  state.UpdateKinematicHybridEndLocation(state.GetSlot(3u), Location{1.0f, 1.0f, 1.0f});
+  state.UpdateTrafficLightState(3u, TrafficLightState{TLS::Green, true});
+
+  ASSERT_EQ(state.GetLocation(3u), (Location{7.0f, 8.0f, 9.0f}));
+  ASSERT_EQ(state.GetHybridEndLocation(3u), (Location{1.0f, 1.0f, 1.0f}));
+  ASSERT_EQ(state.GetTLS(3u).tl_state, TLS::Green);
+  ASSERT_TRUE(state.GetTLS(3u).at_traffic_light);
+  CheckActor(state, 2u);
+}
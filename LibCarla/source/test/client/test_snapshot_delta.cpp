@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/WorldSnapshot.h>
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <carla/trafficmanager/SnapshotDelta.h>
+
+#include <algorithm>
+#include <vector>
+
+using carla::ActorId;
+using carla::client::WorldSnapshot;
+using carla::sensor::data::ActorDynamicState;
+using carla::traffic_manager::SnapshotDelta;
+
+// Builds a snapshot the way the client does, from the serialized state of the
+// episode sent by the world observer.
+static WorldSnapshot MakeSnapshot(const std::vector<ActorDynamicState> &actors) {
+  using namespace carla::sensor;
+  static uint64_t frame = 0u;
+
+  const auto index = SensorRegistry::get<FWorldObserver *>::index;
+  auto sensor_header = s11n::SensorHeaderSerializer::Serialize(index, ++frame, 0.0, carla::rpc::Transform{});
+
+  s11n::EpisodeStateSerializer::Header episode_header{};
+  std::vector<unsigned char> bytes(sensor_header.begin(), sensor_header.end());
+  const auto *header_bytes = reinterpret_cast<const unsigned char *>(&episode_header);
+  bytes.insert(bytes.end(), header_bytes, header_bytes + sizeof(episode_header));
+  const auto *actor_bytes = reinterpret_cast<const unsigned char *>(actors.data());
+  bytes.insert(bytes.end(), actor_bytes, actor_bytes + actors.size() * sizeof(ActorDynamicState));
+
+  auto data = Deserializer::Deserialize(carla::Buffer(bytes));
+  const auto &raw_state = static_cast<const data::RawEpisodeState &>(*data);
+  return WorldSnapshot(std::make_shared<const carla::client::detail::EpisodeState>(raw_state));
+}
+
+static ActorDynamicState MakeActor(ActorId id, float x = 0.0f) {
+  ActorDynamicState actor{};
+  actor.id = id;
+  actor.actor_state = carla::rpc::ActorState::Active;
+  actor.transform.location.x = x;
+  return actor;
+}
+
+static std::vector<ActorId> Sorted(std::vector<ActorId> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST(snapshot_delta, spawn_change_and_destroy) {
+  SnapshotDelta delta;
+
+  delta.Update(MakeSnapshot({MakeActor(1u), MakeActor(2u)}));
+  ASSERT_EQ(Sorted(delta.GetAddedActors()), (std::vector<ActorId>{1u, 2u}));
+  ASSERT_TRUE(delta.GetRemovedActors().empty());
+  ASSERT_TRUE(delta.GetChangedActors().empty());
+
+  // Nothing moved.
+  delta.Update(MakeSnapshot({MakeActor(1u), MakeActor(2u)}));
+  ASSERT_TRUE(delta.GetAddedActors().empty());
+  ASSERT_TRUE(delta.GetRemovedActors().empty());
+  ASSERT_TRUE(delta.GetChangedActors().empty());
+
+  // Actor 2 moves, actor 3 spawns.
+  delta.Update(MakeSnapshot({MakeActor(1u), MakeActor(2u, 1.0f), MakeActor(3u)}));
+  ASSERT_EQ(delta.GetAddedActors(), (std::vector<ActorId>{3u}));
+  ASSERT_TRUE(delta.GetRemovedActors().empty());
+  ASSERT_EQ(delta.GetChangedActors(), (std::vector<ActorId>{2u}));
+
+  // Actor 1 is destroyed.
+  delta.Update(MakeSnapshot({MakeActor(2u, 1.0f), MakeActor(3u)}));
+  ASSERT_TRUE(delta.GetAddedActors().empty());
+  ASSERT_EQ(delta.GetRemovedActors(), (std::vector<ActorId>{1u}));
+  ASSERT_TRUE(delta.GetChangedActors().empty());
+
+  // Actor 2 is destroyed as actor 4 spawns, the actor count does not change.
+  delta.Update(MakeSnapshot({MakeActor(3u), MakeActor(4u)}));
+  ASSERT_EQ(delta.GetAddedActors(), (std::vector<ActorId>{4u}));
+  ASSERT_EQ(delta.GetRemovedActors(), (std::vector<ActorId>{2u}));
+  ASSERT_TRUE(delta.GetChangedActors().empty());
+}
+
+TEST(snapshot_delta, forget_and_reset) {
+  SnapshotDelta delta;
+  delta.Update(MakeSnapshot({MakeActor(1u), MakeActor(2u)}));
+
+  // A forgotten actor still present is reported as added again.
+  delta.Forget(1u);
+  delta.Update(MakeSnapshot({MakeActor(1u), MakeActor(2u)}));
+  ASSERT_EQ(delta.GetAddedActors(), (std::vector<ActorId>{1u}));
+  ASSERT_TRUE(delta.GetRemovedActors().empty());
+  ASSERT_TRUE(delta.GetChangedActors().empty());
+
+  // A forgotten actor that disappears is not reported as removed.
+  delta.Forget(2u);
+  delta.Update(MakeSnapshot({MakeActor(1u)}));
+  ASSERT_TRUE(delta.GetAddedActors().empty());
+  ASSERT_TRUE(delta.GetRemovedActors().empty());
+
+  delta.Reset();
+  ASSERT_TRUE(delta.GetAddedActors().empty());
+  delta.Update(MakeSnapshot({MakeActor(1u)}));
+  ASSERT_EQ(delta.GetAddedActors(), (std::vector<ActorId>{1u}));
+}
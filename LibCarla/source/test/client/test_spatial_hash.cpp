@@ -0,0 +1,189 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/geom/Math.h>
+#include <carla/trafficmanager/SimulationState.h>
+#include <carla/trafficmanager/SpatialHash.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using carla::ActorId;
+using carla::geom::Location;
+using carla::geom::Math;
+using carla::traffic_manager::ActorType;
+using carla::traffic_manager::KinematicState;
+using carla::traffic_manager::SimulationState;
+using carla::traffic_manager::SpatialHash;
+using carla::traffic_manager::SpatialHashHit;
+using carla::traffic_manager::StaticAttributes;
+using carla::traffic_manager::TLS;
+using carla::traffic_manager::TrafficLightState;
+
+static constexpr float CELL_SIZE = 10.0f;
+
+static void AddActor(SimulationState &state, ActorId actor_id, const Location &location) {
+  KinematicState kinematic_state{location, {}, {}, 30.0f, true, false, location};
+  StaticAttributes attributes{ActorType::Vehicle, 2.0f, 1.0f, 1.0f};
+  state.AddActor(actor_id, kinematic_state, attributes, TrafficLightState{TLS::Green, false});
+}
+
+// Ids of the hits, sorted, after checking that every hit matches the slot of
+// its actor in @a state.
+static std::vector<ActorId> GetIds(
+    const SimulationState &state,
+    const Location &location,
+    const std::vector<SpatialHashHit> &hits) {
+  std::vector<ActorId> ids;
+  for (const auto &hit : hits) {
+    EXPECT_EQ(state.GetActorId(hit.slot), hit.actor_id);
+    EXPECT_EQ(state.GetLocation(hit.slot), hit.location);
+    EXPECT_EQ(Math::DistanceSquared(hit.location, location), hit.distance_squared);
+    ids.emplace_back(hit.actor_id);
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+static std::vector<ActorId> Query(
+    const SpatialHash &hash,
+    const SimulationState &state,
+    const Location &location,
+    float radius) {
+  std::vector<SpatialHashHit> hits;
+  hash.Query(location, radius * radius, hits);
+  return GetIds(state, location, hits);
+}
+
+static std::vector<ActorId> BruteForce(
+    const SimulationState &state,
+    const Location &location,
+    float radius) {
+  std::vector<ActorId> ids;
+  for (uint32_t i = 0u; i < state.Size(); ++i) {
+    const auto &other = state.GetLocations()[i];
+    if (Math::DistanceSquared(other, location) < radius * radius) {
+      ids.emplace_back(state.GetActorIds()[i]);
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST(spatial_hash, empty) {
+  SimulationState state;
+  SpatialHash hash(CELL_SIZE);
+  hash.Build(state);
+  ASSERT_EQ(hash.Size(), 0u);
+  ASSERT_TRUE(Query(hash, state, {0.0f, 0.0f, 0.0f}, 100.0f).empty());
+}
+
+TEST(spatial_hash, neighbours_across_cell_borders) {
+  SimulationState state;
+  // Around the corner shared by the cells (0, 0), (1, 0), (0, 1) and (1, 1).
+  AddActor(state, 1u, {9.9f, 9.9f, 0.0f});
+  AddActor(state, 2u, {10.1f, 9.9f, 0.0f});
+  AddActor(state, 3u, {9.9f, 10.1f, 0.0f});
+  AddActor(state, 4u, {10.1f, 10.1f, 0.0f});
+  // Two cells away from the corner.
+  AddActor(state, 5u, {25.0f, 10.0f, 0.0f});
+  SpatialHash hash(CELL_SIZE);
+  hash.Build(state);
+  ASSERT_EQ(hash.Size(), 5u);
+
+  const Location corner{10.0f, 10.0f, 0.0f};
+  ASSERT_EQ(Query(hash, state, corner, 1.0f), (std::vector<ActorId>{1u, 2u, 3u, 4u}));
+  ASSERT_EQ(Query(hash, state, {9.9f, 9.9f, 0.0f}, 0.25f), (std::vector<ActorId>{1u, 2u, 3u}));
+  ASSERT_EQ(Query(hash, state, corner, 15.0f), (std::vector<ActorId>{1u, 2u, 3u, 4u}));
+  ASSERT_EQ(Query(hash, state, corner, 15.1f), (std::vector<ActorId>{1u, 2u, 3u, 4u, 5u}));
+  // The radius is exclusive.
+  ASSERT_EQ(Query(hash, state, {20.0f, 10.0f, 0.0f}, 5.0f), std::vector<ActorId>{});
+}
+
+TEST(spatial_hash, negative_coordinates) {
+  SimulationState state;
+  AddActor(state, 1u, {-0.5f, -0.5f, 0.0f});
+  AddActor(state, 2u, {0.5f, 0.5f, 0.0f});
+  AddActor(state, 3u, {-0.5f, 0.5f, 0.0f});
+  AddActor(state, 4u, {-10.5f, -0.5f, 0.0f});
+  AddActor(state, 5u, {-1000.0f, -2000.0f, 0.0f});
+  SpatialHash hash(CELL_SIZE);
+  hash.Build(state);
+
+  const Location origin{0.0f, 0.0f, 0.0f};
+  ASSERT_EQ(Query(hash, state, origin, 1.0f), (std::vector<ActorId>{1u, 2u, 3u}));
+  ASSERT_EQ(Query(hash, state, {-10.0f, 0.0f, 0.0f}, 1.0f), std::vector<ActorId>{4u});
+  ASSERT_EQ(Query(hash, state, {-9.8f, -0.5f, 0.0f}, 9.5f), (std::vector<ActorId>{1u, 3u, 4u}));
+  ASSERT_EQ(Query(hash, state, {-1000.0f, -1999.0f, 0.0f}, 1.5f), std::vector<ActorId>{5u});
+}
+
+TEST(spatial_hash, actors_removed_and_added_between_builds) {
+  SimulationState state;
+  AddActor(state, 1u, {1.0f, 1.0f, 0.0f});
+  AddActor(state, 2u, {2.0f, 2.0f, 0.0f});
+  AddActor(state, 3u, {3.0f, 3.0f, 0.0f});
+  SpatialHash hash(CELL_SIZE);
+  const Location location{2.0f, 2.0f, 0.0f};
+
+  hash.Build(state);
+  ASSERT_EQ(Query(hash, state, location, 5.0f), (std::vector<ActorId>{1u, 2u, 3u}));
+
+  // Removing an actor moves the last one to its slot.
+  state.RemoveActor(1u);
+  hash.Build(state);
+  ASSERT_EQ(hash.Size(), 2u);
+  ASSERT_EQ(Query(hash, state, location, 5.0f), (std::vector<ActorId>{2u, 3u}));
+
+  // Added again somewhere else.
+  AddActor(state, 1u, {-30.0f, 40.0f, 0.0f});
+  hash.Build(state);
+  ASSERT_EQ(Query(hash, state, location, 5.0f), (std::vector<ActorId>{2u, 3u}));
+  ASSERT_EQ(Query(hash, state, {-30.0f, 40.0f, 0.0f}, 5.0f), std::vector<ActorId>{1u});
+
+  // Added again at its old place.
+  state.RemoveActor(1u);
+  AddActor(state, 1u, {1.0f, 1.0f, 0.0f});
+  hash.Build(state);
+  ASSERT_EQ(Query(hash, state, location, 5.0f), (std::vector<ActorId>{1u, 2u, 3u}));
+
+  hash.Clear();
+  ASSERT_EQ(hash.Size(), 0u);
+  ASSERT_TRUE(Query(hash, state, location, 5.0f).empty());
+}
+
+TEST(spatial_hash, same_as_brute_force) {
+  std::mt19937 engine(42u);
+  std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+  std::uniform_int_distribution<ActorId> actor(1u, 400u);
+  const float radii[] = {0.5f, 5.0f, CELL_SIZE, 23.0f, 80.0f, 1000.0f};
+
+  SimulationState state;
+  SpatialHash hash(CELL_SIZE);
+  for (auto cycle = 0u; cycle < 20u; ++cycle) {
+    // Every cycle some actors leave and others join, at random places.
+    for (auto i = 0u; i < 40u; ++i) {
+      const ActorId actor_id = actor(engine);
+      if (state.ContainsActor(actor_id)) {
+        state.RemoveActor(actor_id);
+      } else {
+        AddActor(state, actor_id, {coordinate(engine), coordinate(engine), 0.0f});
+      }
+    }
+    hash.Build(state);
+    ASSERT_EQ(hash.Size(), state.Size());
+
+    for (auto i = 0u; i < 20u; ++i) {
+      const Location location{coordinate(engine), coordinate(engine), 0.0f};
+      for (auto radius : radii) {
+        ASSERT_EQ(Query(hash, state, location, radius), BruteForce(state, location, radius))
+            << "cycle " << cycle << ", radius " << radius;
+      }
+    }
+  }
+}
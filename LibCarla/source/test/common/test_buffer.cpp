@@ -134,3 +134,45 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_size_classes) {
+  using carla::BufferPool;
+  BufferPool::Settings settings;
+  settings.max_buffers_per_class = 2u;
+  settings.huge_page_threshold = 1u << 20u;
+  auto pool = std::make_shared<BufferPool>(settings);
+
+  const carla::Buffer::value_type *data = nullptr;
+  {
+    auto buffer = pool->Pop(100u << 10u);
+    ASSERT_GE(buffer.capacity(), 100u << 10u);
+    data = buffer.data();
+  }
+  {
+    auto buffer = pool->Pop(110u << 10u);
+    ASSERT_EQ(buffer.data(), data);
+    auto bigger = pool->Pop(1u << 20u);
+    ASSERT_NE(bigger.data(), data);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(bigger.data()) % (2u << 20u), 0u);
+  }
+  auto stats = pool->GetStats();
+  ASSERT_EQ(stats.hits, 1u);
+  ASSERT_EQ(stats.misses, 2u);
+  ASSERT_EQ(stats.buffers_retained, 2u);
+
+  {
+    std::vector<carla::Buffer> buffers;
+    for (auto i = 0u; i < 3u; ++i) {
+      buffers.emplace_back(pool->Pop(100u << 10u));
+    }
+  }
+  stats = pool->GetStats();
+  ASSERT_EQ(stats.discarded, 1u);
+  ASSERT_EQ(stats.buffers_retained, 3u);
+
+  const auto retained = stats.bytes_retained;
+  ASSERT_EQ(pool->Trim(), retained);
+  stats = pool->GetStats();
+  ASSERT_EQ(stats.buffers_retained, 0u);
+  ASSERT_EQ(stats.bytes_retained, 0u);
+}
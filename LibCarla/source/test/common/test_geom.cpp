@@ -6,10 +6,12 @@
 
 #include "test.h"
 
+#include <carla/geom/ArcLengthTable.h>
 #include <carla/geom/Vector3D.h>
 #include <carla/geom/Math.h>
 #include <carla/geom/BoundingBox.h>
 #include <carla/geom/Transform.h>
+#include <cmath>
 #include <limits>
 
 namespace carla {
@@ -227,3 +229,26 @@ TEST(geom, nearest_point_arc) {
   ASSERT_NEAR(Math::DistanceArcToPoint(Vector3D(1,2,0),
       Vector3D(0,0,0), 1.57f, 0, 1).second, 1.0f, 0.01f);
 }
+
+TEST(geom, arc_length_table) {
+  // Parabola y = a x^2, whose arc length from the origin is known. Its
+  // curvature at the origin is the one of a 10 m radius curve.
+  constexpr double a = 0.05;
+  const auto speed = [=](double x) { return std::sqrt(1.0 + 4.0 * a * a * x * x); };
+  const auto length = [=](double x) {
+    return 0.5 * x * speed(x) + std::asinh(2.0 * a * x) / (4.0 * a);
+  };
+  ArcLengthTable table;
+  double s = 0.0;
+  table.Add(0.0, s, speed(0.0));
+  for (double x = 0.0; x < 100.0; x += 2.0) {
+    s += ArcLengthTable::GaussLegendreLength(speed, x, x + 2.0);
+    table.Add(x + 2.0, s, speed(x + 2.0));
+  }
+  ASSERT_NEAR(table.GetLength(), length(100.0), 1e-6);
+  for (double x = 0.0; x <= 100.0; x += 0.1) {
+    ASSERT_NEAR(table.GetParameter(length(x)), x, 1e-3);
+  }
+  ASSERT_NEAR(table.GetParameter(-1.0), -1.0, 1e-9);
+  ASSERT_NEAR(table.GetParameter(table.GetLength() + 1.0), 100.0 + 1.0 / speed(100.0), 1e-9);
+}
@@ -6,8 +6,61 @@
 
 #include "test.h"
 
+#include <carla/ParallelFor.h>
+#include <carla/ThreadPool.h>
 #include <carla/Version.h>
 
+#include <stdexcept>
+#include <vector>
+
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+TEST(miscellaneous, parallel_for) {
+  constexpr size_t size = 1000u;
+  for (const size_t number_of_threads : {0u, 1u, 4u}) {
+    std::vector<size_t> visits(size, 0u);
+    carla::ParallelFor(size, number_of_threads, 16u, [&](size_t i) { ++visits[i]; });
+    for (const auto count : visits) {
+      ASSERT_EQ(count, 1u);
+    }
+  }
+  carla::ParallelFor(0u, 4u, 16u, [](size_t) { FAIL(); });
+}
+
+TEST(miscellaneous, parallel_for_with_pool) {
+  constexpr size_t size = 1000u;
+  carla::ThreadPool pool;
+  pool.AsyncRun(3u);
+  for (auto *p : {&pool, static_cast<carla::ThreadPool *>(nullptr)}) {
+    std::vector<size_t> visits(size, 0u);
+    carla::ParallelFor(p, size, 4u, [&](size_t i) { ++visits[i]; });
+    for (const auto count : visits) {
+      ASSERT_EQ(count, 1u);
+    }
+  }
+  carla::ParallelFor(&pool, 0u, 4u, [](size_t) { FAIL(); });
+}
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+TEST(miscellaneous, parallel_for_exceptions) {
+  constexpr size_t size = 1000u;
+  ASSERT_THROW(
+      carla::ParallelFor(size, 4u, 16u, [](size_t i) {
+        if (i == size - 1u) {
+          throw std::runtime_error("last index");
+        }
+      }),
+      std::runtime_error);
+  carla::ThreadPool pool;
+  pool.AsyncRun(3u);
+  ASSERT_THROW(
+      carla::ParallelFor(&pool, size, 4u, [](size_t i) {
+        if (i == size / 2u) {
+          throw std::runtime_error("middle index");
+        }
+      }),
+      std::runtime_error);
+}
+#endif // LIBCARLA_NO_EXCEPTIONS
@@ -9,6 +9,7 @@
 #include <carla/MsgPackAdaptors.h>
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/Response.h>
+#include <carla/rpc/VehicleControlBatch.h>
 
 #include <thread>
 
@@ -105,3 +106,29 @@ TEST(msgpack, optional) {
   ASSERT_TRUE(result.has_value());
   ASSERT_EQ(*result, 42.0f);
 }
+
+TEST(msgpack, vehicle_control_batch) {
+  using mp = carla::MsgPack;
+  VehicleControlBatch batch;
+  batch.Add(1u, VehicleControl{0.5f, -0.25f, 0.0f, false, false, false, 0});
+  batch.Add(7u, VehicleControl{0.0f, 0.0f, 1.0f, true, true, false, 0});
+  auto result = mp::UnPack<VehicleControlBatch>(mp::Pack(batch));
+  ASSERT_EQ(result.size(), 2u);
+  for (auto i = 0u; i < batch.size(); ++i) {
+    ASSERT_EQ(result.GetActorId(i), batch.GetActorId(i));
+    ASSERT_EQ(result.GetControl(i), batch.GetControl(i));
+  }
+  // The gears are only sent once some vehicle sets one.
+  batch.Add(9u, VehicleControl{1.0f, 1.0f, 0.0f, false, false, true, 3});
+  result = mp::UnPack<VehicleControlBatch>(mp::Pack(batch));
+  ASSERT_EQ(result.size(), 3u);
+  ASSERT_EQ(result.GetControl(0u).gear, 0);
+  ASSERT_EQ(result.GetControl(2u), batch.GetControl(2u));
+  result = mp::UnPack<VehicleControlBatch>(mp::Pack(VehicleControlBatch()));
+  ASSERT_TRUE(result.empty());
+  // Columns of different length are rejected.
+  auto buffer = mp::Pack(std::make_tuple(
+      std::vector<char>(8u), std::vector<char>(4u), std::vector<char>(8u),
+      std::vector<char>(8u), std::vector<char>(2u), std::vector<char>()));
+  ASSERT_THROW(mp::UnPack<VehicleControlBatch>(buffer), clmdep_msgpack::type_error);
+}
@@ -10,12 +10,19 @@
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 #include <carla/streaming/detail/Dispatcher.h>
+#include <carla/streaming/detail/tcp/Batch.h>
 #include <carla/streaming/detail/tcp/Client.h>
 #include <carla/streaming/detail/tcp/Server.h>
+#include <carla/streaming/detail/udp/Client.h>
+#include <carla/streaming/detail/udp/Server.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -138,14 +145,14 @@ TEST(streaming, low_level_tcp_small_message) {
 
   const std::string msg = "Hola!";
 
-  srv.Listen([&](std::shared_ptr<tcp::ServerSession> session) {
+  srv.Listen([&](std::shared_ptr<Session> session) {
     ASSERT_EQ(session->get_stream_id(), 1u);
     while (!done) {
       session->Write(carla::Buffer(msg));
       std::this_thread::sleep_for(1ns);
     }
     std::cout << "done!\n";
-  }, [](std::shared_ptr<tcp::ServerSession>) { std::cout << "session closed!\n"; });
+  }, [](std::shared_ptr<Session>) { std::cout << "session closed!\n"; });
 
   Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
   auto stream = dispatcher.MakeStream();
@@ -172,6 +179,250 @@ TEST(streaming, low_level_tcp_small_message) {
   c->Stop();
 }
 
+TEST(streaming, low_level_tcp_shared_memory_ring_full) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+
+  // Messages held by the client keep their frames in use, so the ring fills
+  // up and the rest of the messages have to be sent inline.
+  constexpr size_t message_size = 1u << 20u;
+  constexpr size_t number_of_messages = 2u * shm::Ring::DEFAULT_CAPACITY / message_size;
+
+  boost::asio::io_context io_context;
+  tcp::Server::endpoint ep(boost::asio::ip::tcp::v4(), TESTING_PORT);
+
+  tcp::Server srv(io_context, ep);
+  srv.SetTimeout(1s);
+  srv.SetSynchronousMode(true);
+
+  // Keep the session open once all the messages are written.
+  std::shared_ptr<Session> open_session;
+  srv.Listen([&](std::shared_ptr<Session> session) {
+    open_session = session;
+    for (auto i = 0u; i < number_of_messages; ++i) {
+      carla::Buffer message(message_size);
+      std::fill(message.begin(), message.end(), static_cast<unsigned char>(i));
+      session->Write(std::move(message));
+    }
+  }, [](std::shared_ptr<Session>) {});
+
+  std::mutex mutex;
+  std::vector<carla::Buffer> received;
+
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
+  auto stream = dispatcher.MakeStream();
+  auto c = std::make_shared<tcp::Client>(io_context, stream.token(), [&](carla::Buffer message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    received.emplace_back(std::move(message));
+  });
+  c->Connect();
+
+  carla::ThreadGroup threads;
+  threads.CreateThreads(
+      std::max(2u, std::thread::hardware_concurrency()),
+      [&]() { io_context.run(); });
+
+  for (auto i = 0u; i < 200u; ++i) {
+    std::this_thread::sleep_for(10ms);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (received.size() == number_of_messages) {
+      break;
+    }
+  }
+  c->Stop();
+  io_context.stop();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(received.size(), number_of_messages);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    ASSERT_EQ(received[i].size(), message_size);
+    const auto expected = static_cast<unsigned char>(i);
+    ASSERT_TRUE(std::all_of(received[i].begin(), received[i].end(), [=](auto byte) {
+      return byte == expected;
+    }));
+  }
+}
+
+TEST(streaming, low_level_udp_fragmented_messages) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+
+  // Single datagram, exactly one fragment, and many fragments.
+  const std::vector<size_t> message_sizes = {13u, udp::FRAGMENT_SIZE, 100000u};
+  constexpr auto number_of_messages = 50u;
+
+  std::mutex mutex;
+  std::vector<std::string> received;
+
+  io_context_running io;
+
+  carla::streaming::low_level::Server<udp::Server> srv(io.service, TESTING_PORT);
+  srv.SetTimeout(1s);
+
+  auto stream = srv.MakeStream();
+  ASSERT_TRUE(token_type(stream.token()).protocol_is_udp());
+
+  carla::streaming::low_level::Client<udp::Client> c;
+  c.Subscribe(io.service, stream.token(), [&](auto message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    received.emplace_back(as_string(message));
+  });
+
+  std::vector<std::string> sent;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    const auto size = message_sizes[i % message_sizes.size()];
+    std::string message(size, static_cast<char>('a' + i % 26u));
+    std::this_thread::sleep_for(2ms);
+    stream << message;
+    sent.emplace_back(std::move(message));
+  }
+  std::this_thread::sleep_for(20ms);
+
+  // Losses are allowed, but whatever arrives is complete and in order.
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_GE(received.size(), number_of_messages - 5u);
+  auto next = sent.begin();
+  for (auto &message : received) {
+    next = std::find(next, sent.end(), message);
+    ASSERT_NE(next, sent.end());
+    ++next;
+  }
+}
+
+TEST(streaming, low_level_udp_mismatched_fragment) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using udp_protocol = boost::asio::ip::udp;
+
+  io_context_running io;
+
+  // Play the server by hand, so we can send a fragment that does not belong
+  // to the message being reassembled.
+  udp_protocol::socket server(io.service, udp_protocol::endpoint(make_localhost_address(), TESTING_PORT));
+  const token_type token(42u, make_endpoint<udp_protocol>(server.local_endpoint()));
+
+  std::mutex mutex;
+  std::vector<std::string> received;
+
+  auto client = std::make_shared<udp::Client>(
+      io.service,
+      token,
+      [&](carla::Buffer message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.emplace_back(as_string(message));
+      });
+  client->Connect();
+
+  udp::Request request;
+  udp_protocol::endpoint client_endpoint;
+  server.receive_from(boost::asio::buffer(&request, sizeof(request)), client_endpoint);
+  ASSERT_EQ(request.stream_id, 42u);
+
+  constexpr auto fragment_size = udp::FRAGMENT_SIZE;
+  const std::string message(3u * fragment_size, 'x');
+
+  auto send_fragment = [&](uint32_t message_size, uint16_t index, const char *payload) {
+    udp::FragmentHeader header;
+    header.session_tag = 1u;
+    header.sequence = 1u;
+    header.message_size = message_size;
+    header.fragment_index = index;
+    header.fragment_count = udp::GetFragmentCount(message_size);
+    std::vector<char> datagram(sizeof(header) + fragment_size);
+    std::memcpy(datagram.data(), &header, sizeof(header));
+    std::memcpy(datagram.data() + sizeof(header), payload, fragment_size);
+    server.send_to(boost::asio::buffer(datagram), client_endpoint);
+    std::this_thread::sleep_for(2ms);
+  };
+
+  const std::string garbage(fragment_size, 'y');
+  send_fragment(message.size(), 0u, message.data());
+  // Valid on their own, but larger than the message they claim to continue.
+  send_fragment(10u * fragment_size, 1u, garbage.data());
+  send_fragment(10u * fragment_size, 5u, garbage.data());
+  send_fragment(message.size(), 1u, message.data() + fragment_size);
+  send_fragment(message.size(), 2u, message.data() + 2u * fragment_size);
+  std::this_thread::sleep_for(20ms);
+
+  client->Stop();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(received.size(), 1u);
+  ASSERT_EQ(received[0u], message);
+}
+
+TEST(streaming, udp_stream) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 100u;
+  const std::string message = "Hello client, over UDP!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+
+  auto udp_stream = srv.MakeUdpStream();
+  auto tcp_stream = srv.MakeStream();
+  ASSERT_TRUE(stream_token(udp_stream.token()).protocol_is_udp());
+  ASSERT_TRUE(stream_token(tcp_stream.token()).protocol_is_tcp());
+
+  std::atomic_size_t udp_messages{0u};
+  std::atomic_size_t tcp_messages{0u};
+
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(udp_stream.token(), [&](auto buffer) {
+    ASSERT_EQ(as_string(buffer), message);
+    ++udp_messages;
+  });
+  c.Subscribe(tcp_stream.token(), [&](auto buffer) {
+    ASSERT_EQ(as_string(buffer), message);
+    ++tcp_messages;
+  });
+
+  std::this_thread::sleep_for(20ms);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(1ms);
+    udp_stream << message;
+    tcp_stream << message;
+  }
+  std::this_thread::sleep_for(20ms);
+
+  ASSERT_GE(udp_messages, number_of_messages - 3u);
+  ASSERT_GE(tcp_messages, number_of_messages - 3u);
+}
+
+TEST(streaming, udp_server_started_with_first_udp_stream) {
+  using namespace carla::streaming;
+  using udp_protocol = boost::asio::ip::udp;
+
+  Server srv(TESTING_PORT);
+  srv.SetSynchronousMode(true);
+  srv.AsyncRun(1u);
+
+  const auto port = srv.GetLocalEndpoint().port();
+  auto can_bind_udp_port = [port]() {
+    boost::asio::io_context io_context;
+    udp_protocol::socket socket(io_context);
+    boost::system::error_code ec;
+    socket.open(udp_protocol::v4(), ec);
+    if (!ec) {
+      socket.bind(udp_protocol::endpoint(udp_protocol::v4(), port), ec);
+    }
+    return !ec;
+  };
+
+  // Without UDP streams the server leaves the UDP port alone.
+  srv.MakeStream();
+  ASSERT_TRUE(can_bind_udp_port());
+
+  auto stream = srv.MakeUdpStream();
+  ASSERT_TRUE(stream_token(stream.token()).protocol_is_udp());
+  ASSERT_FALSE(can_bind_udp_port());
+  srv.MakeUdpStream();
+}
+
 struct DoneGuard {
   ~DoneGuard() { done = true; };
   std::atomic_bool &done;
@@ -259,3 +510,257 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, multiplexed_streams) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 100u;
+  constexpr size_t number_of_streams = 8u;
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+
+  std::vector<Stream> streams;
+  std::vector<std::atomic_size_t> messages_received(number_of_streams);
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    streams.emplace_back(srv.MakeStream());
+    messages_received[i] = 0u;
+  }
+
+  Client c;
+  c.AsyncRun(2u);
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    c.Subscribe(streams[i].token(), [&, i](auto buffer) {
+      ASSERT_EQ(as_string(buffer), "stream " + std::to_string(i));
+      ++messages_received[i];
+    });
+  }
+
+  std::this_thread::sleep_for(20ms);
+  for (auto j = 0u; j < number_of_messages; ++j) {
+    std::this_thread::sleep_for(1ms);
+    for (auto i = 0u; i < number_of_streams; ++i) {
+      streams[i] << ("stream " + std::to_string(i));
+    }
+  }
+  std::this_thread::sleep_for(20ms);
+
+  for (auto &count : messages_received) {
+    ASSERT_GE(count, number_of_messages - 3u);
+  }
+
+  // Unsubscribing from half of the streams keeps the others flowing.
+  for (auto i = 0u; i < number_of_streams; i += 2u) {
+    c.UnSubscribe(streams[i].token());
+  }
+  std::this_thread::sleep_for(20ms);
+  std::vector<size_t> before(messages_received.begin(), messages_received.end());
+  for (auto j = 0u; j < number_of_messages; ++j) {
+    std::this_thread::sleep_for(1ms);
+    for (auto i = 0u; i < number_of_streams; ++i) {
+      streams[i] << ("stream " + std::to_string(i));
+    }
+  }
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    if (i % 2u == 0u) {
+      ASSERT_EQ(messages_received[i], before[i]);
+    } else {
+      ASSERT_GE(messages_received[i], before[i] + number_of_messages - 3u);
+    }
+  }
+}
+
+TEST(streaming, coalesced_streams) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 50u;
+  constexpr size_t number_of_streams = 8u;
+  constexpr size_t big_message_size = 64u << 10u;
+
+  Server srv(TESTING_PORT);
+  srv.SetCoalescing(1024u, carla::time_duration::milliseconds(2u));
+  srv.AsyncRun(2u);
+
+  std::vector<Stream> streams;
+  std::vector<std::atomic_size_t> messages_received(number_of_streams);
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    streams.emplace_back(srv.MakeStream());
+    messages_received[i] = 0u;
+  }
+
+  Client c;
+  c.AsyncRun(2u);
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    c.Subscribe(streams[i].token(), [&, i](auto buffer) {
+      // The last stream sends messages too big to coalesce.
+      if (i + 1u == number_of_streams) {
+        ASSERT_EQ(buffer.size(), big_message_size);
+      } else {
+        ASSERT_EQ(as_string(buffer), "stream " + std::to_string(i));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % detail::tcp::BATCH_ALIGNMENT, 0u);
+      }
+      ++messages_received[i];
+    });
+  }
+
+  const std::string big_message(big_message_size, 'x');
+  std::this_thread::sleep_for(20ms);
+  for (auto j = 0u; j < number_of_messages; ++j) {
+    std::this_thread::sleep_for(5ms);
+    for (auto i = 0u; i + 1u < number_of_streams; ++i) {
+      streams[i] << ("stream " + std::to_string(i));
+    }
+    streams.back() << big_message;
+  }
+  std::this_thread::sleep_for(50ms);
+
+  for (auto &count : messages_received) {
+    ASSERT_GE(count, number_of_messages - 3u);
+  }
+  // Every message is counted once, coalesced or not.
+  auto telemetry = c.GetTelemetry();
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    const auto id = stream_token(streams[i].token()).get_stream_id();
+    ASSERT_EQ(telemetry.streams[id].messages, messages_received[i]);
+  }
+}
+
+TEST(streaming, send_queue_policies) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t message_size = 1u << 20u;
+  constexpr size_t number_of_messages = 100u;
+
+  for (auto synchronous : {true, false}) {
+    Server srv(TESTING_PORT);
+    srv.AsyncRun(2u);
+    srv.SetSynchronousMode(synchronous);
+    srv.SetSendQueue(2u, detail::tcp::SendQueuePolicy::DropOldest);
+    auto stream = srv.MakeStream();
+
+    std::mutex mutex;
+    std::vector<unsigned char> received;
+
+    Client c;
+    c.AsyncRun(2u);
+    c.Subscribe(stream.token(), [&](auto buffer) {
+      ASSERT_EQ(buffer.size(), message_size);
+      std::lock_guard<std::mutex> lock(mutex);
+      received.emplace_back(buffer.data()[0u]);
+    });
+    std::this_thread::sleep_for(20ms);
+
+    for (auto i = 0u; i < number_of_messages; ++i) {
+      carla::Buffer message(message_size);
+      std::fill(message.begin(), message.end(), static_cast<unsigned char>(i));
+      stream.Write(std::move(message));
+    }
+    for (auto i = 0u; i < 200u; ++i) {
+      std::this_thread::sleep_for(10ms);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!received.empty() && (received.back() == number_of_messages - 1u)) {
+        break;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_TRUE(std::is_sorted(received.begin(), received.end()));
+    // The newest message is never dropped.
+    ASSERT_FALSE(received.empty());
+    ASSERT_EQ(received.back(), number_of_messages - 1u);
+
+    auto stats = srv.GetTelemetry().streams[stream_token(stream.token()).get_stream_id()];
+    ASSERT_EQ(stats.messages, received.size());
+    if (synchronous) {
+      ASSERT_EQ(received.size(), number_of_messages);
+      ASSERT_EQ(stats.dropped_bytes, 0u);
+    } else {
+      ASSERT_EQ(stats.stalled_bytes, 0u);
+      ASSERT_EQ(stats.dropped_messages, number_of_messages - received.size());
+      ASSERT_EQ(stats.dropped_bytes, (number_of_messages - received.size()) * message_size);
+    }
+  }
+}
+
+TEST(streaming, latency_histogram) {
+  using carla::streaming::detail::LatencyHistogram;
+
+  // Every value falls in a bucket whose bounds hold it, within the precision.
+  for (uint64_t value : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull, ~0ull}) {
+    const auto bucket = LatencyHistogram::GetBucket(value);
+    ASSERT_LT(bucket, LatencyHistogram::BUCKET_COUNT);
+    const auto upper = LatencyHistogram::GetBucketUpperBound(bucket);
+    ASSERT_GE(upper, value);
+    ASSERT_LE(upper - value, value / LatencyHistogram::SUB_BUCKET_COUNT);
+    if (bucket > 0u) {
+      ASSERT_LT(LatencyHistogram::GetBucketUpperBound(bucket - 1u), value);
+    }
+  }
+
+  LatencyHistogram histogram;
+  for (uint64_t value = 1u; value <= 10000u; ++value) {
+    histogram.Record(value);
+  }
+  const auto snapshot = histogram.Snapshot();
+  ASSERT_EQ(snapshot.count, 10000u);
+  ASSERT_EQ(snapshot.max, 10000u);
+  ASSERT_NEAR(snapshot.mean, 5000.5, 1e-6);
+  ASSERT_NEAR(snapshot.p50, 5000.0, 5000.0 / LatencyHistogram::SUB_BUCKET_COUNT);
+  ASSERT_NEAR(snapshot.p99, 9900.0, 9900.0 / LatencyHistogram::SUB_BUCKET_COUNT);
+  ASSERT_LE(snapshot.p999, snapshot.max);
+}
+
+TEST(streaming, telemetry) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 100u;
+  const std::string message = "Hello client, this is telemetry!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+  auto tcp_stream = srv.MakeStream();
+  auto udp_stream = srv.MakeUdpStream();
+  const auto tcp_id = stream_token(tcp_stream.token()).get_stream_id();
+  const auto udp_id = stream_token(udp_stream.token()).get_stream_id();
+
+  std::atomic_size_t messages_received{0u};
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(tcp_stream.token(), [&](auto) { ++messages_received; });
+  c.Subscribe(udp_stream.token(), [&](auto) { ++messages_received; });
+
+  std::this_thread::sleep_for(20ms);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(1ms);
+    tcp_stream << message;
+    udp_stream << message;
+  }
+  std::this_thread::sleep_for(20ms);
+
+  auto server_telemetry = srv.GetTelemetry();
+  auto client_telemetry = c.GetTelemetry();
+  for (auto id : {tcp_id, udp_id}) {
+    ASSERT_EQ(server_telemetry.streams.count(id), 1u);
+    ASSERT_EQ(client_telemetry.streams.count(id), 1u);
+    const auto &sent = server_telemetry.streams[id];
+    const auto &received = client_telemetry.streams[id];
+    ASSERT_GE(sent.messages, number_of_messages - 3u);
+    ASSERT_EQ(sent.bytes, sent.messages * message.size());
+    ASSERT_EQ(sent.latency.count, sent.messages);
+    ASSERT_LE(received.messages, sent.messages);
+    ASSERT_EQ(received.bytes, received.messages * message.size());
+    ASSERT_EQ(received.latency.count, received.messages);
+    ASSERT_EQ(received.reconnects, 0u);
+  }
+  ASSERT_EQ(
+      client_telemetry.streams[tcp_id].messages + client_telemetry.streams[udp_id].messages,
+      messages_received);
+
+  const auto json = client_telemetry.ToJson();
+  ASSERT_EQ(json.front(), '{');
+  ASSERT_EQ(json.back(), '}');
+  ASSERT_NE(json.find("\"" + std::to_string(tcp_id) + "\":{\"messages\":"), std::string::npos);
+  ASSERT_NE(json.find("\"latency_us\":{\"count\":"), std::string::npos);
+}
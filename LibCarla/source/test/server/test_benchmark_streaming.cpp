@@ -12,6 +12,8 @@
 #include <boost/asio/post.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <ctime>
 
 using namespace carla::streaming;
 using namespace std::chrono_literals;
@@ -163,3 +165,62 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+/// Many small sensors, written all at once every frame from the game thread
+/// as the simulator does, with and without coalescing their messages.
+static void benchmark_small_sensors(const bool coalescing) {
+  constexpr auto number_of_streams = 64u;
+  constexpr auto number_of_frames = 200u;
+  constexpr auto message_size = 64u;
+  carla::logging::log(
+      "Benchmark:", number_of_streams, "small sensors at 100FPS,",
+      coalescing ? "coalesced." : "not coalesced.");
+
+  Server server(TESTING_PORT);
+  if (coalescing) {
+    server.SetCoalescing(1024u, carla::time_duration::milliseconds(1u));
+  }
+  server.AsyncRun(2u);
+
+  Client client;
+  client.AsyncRun(2u);
+
+  const auto message = make_special_message(message_size);
+  std::atomic_size_t number_of_messages_received{0u};
+  std::vector<Stream> streams;
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    streams.emplace_back(server.MakeStream());
+    client.Subscribe(streams.back().token(), [&](carla::Buffer DEBUG_ONLY(msg)) {
+      DEBUG_ASSERT(msg == message);
+      ++number_of_messages_received;
+    });
+  }
+  std::this_thread::sleep_for(1s);
+
+  // Writes and wake-ups show in the CPU time of the whole process.
+  const auto cpu_begin = std::clock();
+  for (auto frame = 0u; frame < number_of_frames; ++frame) {
+    std::this_thread::sleep_for(10ms);
+    CARLA_PROFILE_SCOPE(game, write_frame);
+    for (auto &stream : streams) {
+      stream << message.buffer();
+    }
+  }
+  std::this_thread::sleep_for(100ms);
+  const auto cpu_time = 1000.0 * static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+
+  const auto expected_number_of_messages = number_of_streams * number_of_frames;
+  std::cout << "received " << number_of_messages_received
+            << " of " << expected_number_of_messages << " messages, "
+            << cpu_time << "ms of CPU time" << std::endl;
+
+  ASSERT_GE(number_of_messages_received, static_cast<size_t>(0.9 * expected_number_of_messages));
+}
+
+TEST(benchmark_streaming, small_sensors) {
+  benchmark_small_sensors(false);
+}
+
+TEST(benchmark_streaming, small_sensors_coalesced) {
+  benchmark_small_sensors(true);
+}
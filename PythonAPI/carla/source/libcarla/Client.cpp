@@ -170,6 +170,14 @@ static auto ApplyBatchCommandsSync(
   return result;
 }
 
+static auto GetTelemetryStreams(const carla::streaming::TelemetrySnapshot &self) {
+  boost::python::dict result;
+  for (const auto &item : self.streams) {
+    result[item.first] = item.second;
+  }
+  return result;
+}
+
 void export_client() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -186,11 +194,41 @@ void export_client() {
     .def_readwrite("enable_pedestrian_navigation", &rpc::OpendriveGenerationParameters::enable_pedestrian_navigation)
   ;
 
+  class_<carla::streaming::LatencySnapshot>("StreamingLatency", no_init)
+    .def_readonly("count", &carla::streaming::LatencySnapshot::count)
+    .def_readonly("mean", &carla::streaming::LatencySnapshot::mean)
+    .def_readonly("max", &carla::streaming::LatencySnapshot::max)
+    .def_readonly("p50", &carla::streaming::LatencySnapshot::p50)
+    .def_readonly("p90", &carla::streaming::LatencySnapshot::p90)
+    .def_readonly("p99", &carla::streaming::LatencySnapshot::p99)
+    .def_readonly("p999", &carla::streaming::LatencySnapshot::p999)
+  ;
+
+  class_<carla::streaming::StreamTelemetrySnapshot>("StreamTelemetry", no_init)
+    .def_readonly("messages", &carla::streaming::StreamTelemetrySnapshot::messages)
+    .def_readonly("bytes", &carla::streaming::StreamTelemetrySnapshot::bytes)
+    .def_readonly("dropped_messages", &carla::streaming::StreamTelemetrySnapshot::dropped_messages)
+    .def_readonly("dropped_bytes", &carla::streaming::StreamTelemetrySnapshot::dropped_bytes)
+    .def_readonly("reconnects", &carla::streaming::StreamTelemetrySnapshot::reconnects)
+    .def_readonly("latency", &carla::streaming::StreamTelemetrySnapshot::latency)
+  ;
+
+  class_<carla::streaming::TelemetrySnapshot>("StreamingTelemetry", no_init)
+    .add_property("streams", &GetTelemetryStreams)
+    .def("to_json", &carla::streaming::TelemetrySnapshot::ToJson)
+  ;
+
+  class_<PythonFuture>("Future", no_init)
+    .def("result", &PythonFuture::Result)
+    .def("__await__", &AwaitPythonFuture)
+  ;
+
   class_<cc::Client>("Client",
       init<std::string, uint16_t, size_t>((arg("host"), arg("port"), arg("worker_threads")=0u)))
     .def("set_timeout", &::SetTimeout, (arg("seconds")))
     .def("get_client_version", &cc::Client::GetClientVersion)
     .def("get_server_version", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerVersion))
+    .def("get_streaming_telemetry", &cc::Client::GetStreamingTelemetry)
     .def("get_world", &cc::Client::GetWorld)
     .def("get_available_maps", &GetAvailableMaps)
     .def("set_files_base_folder", &cc::Client::SetFilesBaseFolder, (arg("path")))
@@ -15,6 +15,8 @@
 
 #include <ostream>
 #include <fstream>
+#include <stdexcept>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -72,6 +74,96 @@ static auto GetLaneValidities(const carla::client::Landmark &self){
   return result;
 }
 
+/// Buffer of a Python object, e.g. the memory of a NumPy array, released on
+/// destruction.
+class PythonBuffer : private carla::NonCopyable {
+public:
+
+  PythonBuffer(const boost::python::object &object, int flags) {
+    if (PyObject_GetBuffer(object.ptr(), &_view, flags) != 0) {
+      boost::python::throw_error_already_set();
+    }
+  }
+
+  ~PythonBuffer() {
+    PyBuffer_Release(&_view);
+  }
+
+  template <typename T>
+  T *data() const {
+    return static_cast<T *>(_view.buf);
+  }
+
+private:
+
+  Py_buffer _view;
+};
+
+/// Projects an array of locations onto the road at once. The locations are
+/// read straight from the memory of the array when it already is a
+/// contiguous float32 array, and the results are written straight into the
+/// returned NumPy arrays.
+static boost::python::dict GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    int32_t lane_type) {
+  namespace py = boost::python;
+  namespace cg = carla::geom;
+  static_assert(sizeof(cg::Location) == 3u * sizeof(float), "Location does not match a row of three floats");
+  static_assert(sizeof(cg::Transform) == 6u * sizeof(float), "Transform does not match a row of six floats");
+  static_assert(sizeof(bool) == 1u, "bool does not match numpy.bool_");
+
+  py::object numpy = py::import("numpy");
+  py::object input = numpy.attr("ascontiguousarray")(locations, "float32");
+  if ((py::extract<int>(input.attr("ndim"))() != 2) ||
+      (py::extract<int>(input.attr("shape")[1])() != 3)) {
+    throw std::invalid_argument("locations must be an array of shape (N, 3)");
+  }
+  const size_t size = py::extract<size_t>(input.attr("shape")[0]);
+  py::object found = numpy.attr("empty")(size, "bool");
+  py::object road_id = numpy.attr("empty")(size, "uint32");
+  py::object section_id = numpy.attr("empty")(size, "uint32");
+  py::object lane_id = numpy.attr("empty")(size, "int32");
+  py::object s = numpy.attr("empty")(size, "float64");
+  py::object transform = numpy.attr("empty")(py::make_tuple(size, 6u), "float32");
+  {
+    const int flags = PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE;
+    PythonBuffer input_buffer(input, PyBUF_C_CONTIGUOUS);
+    PythonBuffer found_buffer(found, flags);
+    PythonBuffer road_id_buffer(road_id, flags);
+    PythonBuffer section_id_buffer(section_id, flags);
+    PythonBuffer lane_id_buffer(lane_id, flags);
+    PythonBuffer s_buffer(s, flags);
+    PythonBuffer transform_buffer(transform, flags);
+
+    carla::PythonUtil::ReleaseGIL unlock;
+    std::vector<carla::road::element::Waypoint> waypoints(size);
+    self.GetMap().GetWaypoints(
+        input_buffer.data<cg::Location>(),
+        size,
+        project_to_road,
+        lane_type,
+        waypoints.data(),
+        transform_buffer.data<cg::Transform>(),
+        found_buffer.data<bool>());
+    for (auto i = 0u; i < size; ++i) {
+      road_id_buffer.data<carla::road::RoadId>()[i] = waypoints[i].road_id;
+      section_id_buffer.data<carla::road::SectionId>()[i] = waypoints[i].section_id;
+      lane_id_buffer.data<carla::road::LaneId>()[i] = waypoints[i].lane_id;
+      s_buffer.data<double>()[i] = waypoints[i].s;
+    }
+  }
+  py::dict result;
+  result["found"] = found;
+  result["road_id"] = road_id;
+  result["section_id"] = section_id;
+  result["lane_id"] = lane_id;
+  result["s"] = s;
+  result["transform"] = transform;
+  return result;
+}
+
 static carla::geom::GeoLocation ToGeolocation(
     const carla::client::Map &self,
     const carla::geom::Location &location) {
@@ -159,6 +251,7 @@ void export_map() {
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
     .def("get_topology", &GetTopology)
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
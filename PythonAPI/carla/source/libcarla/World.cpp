@@ -99,6 +99,26 @@ static auto GetLevelBBs(const carla::client::World &self, uint8_t queried_tag) {
   return result;
 }
 
+static auto GetVehiclesLightStatesAsync(carla::client::World &self) {
+  return PythonFuture(self.GetVehiclesLightStatesAsync(), [](auto list) {
+    boost::python::dict dict;
+    for (auto &vehicle : list) {
+      dict[vehicle.first] = vehicle.second;
+    }
+    return dict;
+  });
+}
+
+static auto GetLevelBBsAsync(const carla::client::World &self, uint8_t queried_tag) {
+  return PythonFuture(self.GetLevelBBsAsync(queried_tag), [](auto bbs) {
+    boost::python::list result;
+    for (const auto &bb : bbs) {
+      result.append(bb);
+    }
+    return result;
+  });
+}
+
 static auto GetEnvironmentObjects(const carla::client::World &self, uint8_t queried_tag) {
   boost::python::list result;
   for (const auto &object : self.GetEnvironmentObjects(queried_tag)) {
@@ -308,6 +328,7 @@ void export_world() {
     .def("unload_map_layer", CONST_CALL_WITHOUT_GIL_1(cc::World, UnloadLevelLayer, cr::MapLayer), arg("map_layers"))
     .def("get_blueprint_library", CONST_CALL_WITHOUT_GIL(cc::World, GetBlueprintLibrary))
     .def("get_vehicles_light_states", &GetVehiclesLightStates)
+    .def("get_vehicles_light_states_async", &GetVehiclesLightStatesAsync)
     .def("get_map", CONST_CALL_WITHOUT_GIL(cc::World, GetMap))
     .def("get_random_location_from_navigation", CALL_RETURNING_OPTIONAL_WITHOUT_GIL(cc::World, GetRandomLocationFromNavigation))
     .def("get_spectator", CONST_CALL_WITHOUT_GIL(cc::World, GetSpectator))
@@ -336,6 +357,7 @@ void export_world() {
     .def("get_lightmanager", CONST_CALL_WITHOUT_GIL(cc::World, GetLightManager))
     .def("freeze_all_traffic_lights", &cc::World::FreezeAllTrafficLights, (arg("frozen")))
     .def("get_level_bbs", &GetLevelBBs, (arg("bb_type")=cr::CityObjectLabel::Any))
+    .def("get_level_bbs_async", &GetLevelBBsAsync, (arg("bb_type")=cr::CityObjectLabel::Any))
     .def("get_environment_objects", &GetEnvironmentObjects, (arg("object_type")=cr::CityObjectLabel::Any))
     .def("enable_environment_objects", &EnableEnvironmentObjects, (arg("env_objects_ids"), arg("enable")))
     .def("cast_ray", CALL_RETURNING_LIST_2(cc::World, CastRay, cg::Location, cg::Location), (arg("initial_location"), arg("final_location")))
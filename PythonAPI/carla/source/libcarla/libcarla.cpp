@@ -8,6 +8,9 @@
 #include <carla/PythonUtil.h>
 #include <carla/Time.h>
 
+#include <exception>
+#include <functional>
+#include <future>
 #include <ostream>
 #include <type_traits>
 #include <vector>
@@ -216,6 +219,69 @@ static auto MakeCallback(boost::python::object callback) {
   };
 }
 
+/// A future returned to Python by the calls that do not wait for the
+/// simulator. result() waits for the value with the GIL released and converts
+/// it with the function given; awaiting it waits in the default executor of
+/// the event loop instead. Every caller waits for the same value, so result()
+/// may be called from several threads at once.
+class PythonFuture {
+public:
+
+  template <typename T, typename ConvertT>
+  PythonFuture(std::future<T> future, ConvertT convert)
+    : _state(std::make_shared<State>()) {
+    auto shared_future = future.share();
+    _state->wait = [shared_future]() {
+      carla::PythonUtil::ReleaseGIL unlock;
+      shared_future.wait();
+    };
+    _state->get = [shared_future, convert=std::move(convert)]() {
+      return boost::python::object(convert(shared_future.get()));
+    };
+  }
+
+  /// Wait for the value and return it, or raise the exception of the call.
+  boost::python::object Result() const {
+    _state->wait();
+    // Back with the GIL, which serializes the conversion; the first caller
+    // converts the value and the others reuse it.
+    if (_state->get) {
+      auto get = std::move(_state->get);
+      _state->get = nullptr;
+      try {
+        _state->result = get();
+      } catch (...) {
+        _state->exception = std::current_exception();
+      }
+    }
+    if (_state->exception) {
+      std::rethrow_exception(_state->exception);
+    }
+    return _state->result;
+  }
+
+private:
+
+  struct State {
+    std::function<void()> wait;
+
+    std::function<boost::python::object()> get;
+
+    boost::python::object result;
+
+    std::exception_ptr exception;
+  };
+
+  std::shared_ptr<State> _state;
+};
+
+static boost::python::object AwaitPythonFuture(boost::python::object self) {
+  namespace py = boost::python;
+  auto loop = py::import("asyncio").attr("get_event_loop")();
+  auto task = loop.attr("run_in_executor")(py::object(), self.attr("result"));
+  return task.attr("__await__")();
+}
+
 #include "Geom.cpp"
 #include "Actor.cpp"
 #include "Blueprint.cpp"
@@ -54,6 +54,7 @@
 #include <carla/rpc/VehicleDoor.h>
 #include <carla/rpc/VehicleAckermannControl.h>
 #include <carla/rpc/VehicleControl.h>
+#include <carla/rpc/VehicleControlBatch.h>
 #include <carla/rpc/VehiclePhysicsControl.h>
 #include <carla/rpc/VehicleLightState.h>
 #include <carla/rpc/VehicleLightStateList.h>
@@ -2332,6 +2333,33 @@ void FCarlaServer::FPimpl::BindActions()
     return result;
   };
 
+  BIND_SYNC(apply_vehicle_control_batch) << [=](
+      const cr::VehicleControlBatch &batch,
+      const std::vector<cr::Command> &commands,
+      bool do_tick_cue) -> R<std::vector<cr::ActorId>>
+  {
+    REQUIRE_CARLA_EPISODE();
+    std::vector<cr::ActorId> failed;
+    for (size_t i = 0u; i < batch.size(); ++i)
+    {
+      const cr::ActorId VehicleId = batch.GetActorId(i);
+      if (apply_control_to_vehicle(VehicleId, batch.GetControl(i)).HasError())
+      {
+        failed.emplace_back(VehicleId);
+      }
+    }
+    // Applied after the controls, saves a second call to apply_batch.
+    for (const auto &command : commands)
+    {
+      boost::variant2::visit(command_visitor, command.command);
+    }
+    if (do_tick_cue)
+    {
+      tick_cue();
+    }
+    return failed;
+  };
+
   // ~~ Light Subsystem ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(query_lights_state) << [this](std::string client) -> R<std::vector<cr::LightState>>
@@ -70,6 +70,9 @@ benchmark: LibCarla.release
 	@${CARLA_BUILD_TOOLS_FOLDER}/Check.sh --benchmark $(ARGS)
 	@cat profiler.csv
 
+benchmark.streaming: LibCarla.server.release
+	@LD_LIBRARY_PATH=${LIBCARLA_INSTALL_SERVER_FOLDER}/lib ${LIBCARLA_INSTALL_SERVER_FOLDER}/test/libcarla_benchmark_streaming $(ARGS)
+
 smoke_tests:
 	@${CARLA_BUILD_TOOLS_FOLDER}/Check.sh --smoke $(ARGS)
 